@@ -0,0 +1,130 @@
+/*
+ * B.I.T.E.S - ADC Engine Benchmark
+ *
+ * Boots the system with eight piezo pads and the sensor task polling at
+ * 1 kHz, then strikes the pads one at a time with short pulses (shorter
+ * than two poll periods) and counts the SENSOR_TRIGGERED events that come
+ * back. The strikes are repeated with the ADC engine stopped, where the
+ * sensor task converts each pad once per poll, to show what the
+ * continuous scan recovers.
+ *
+ * Usage: bench_adc [--strikes N] [--pulse-us N]
+ * The exit code is non-zero if the engine misses more than 10% of the
+ * strikes, or does not detect more of them than direct reads.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/event_queue.h"
+#include "core/system_manager.h"
+#include "sensors/adc_engine.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/tasks.h"
+
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::EventQueue;
+using Core::EventType;
+using Sensors::AdcEngine;
+using Sensors::SensorManager;
+
+namespace {
+
+constexpr uint8_t PADS = 8;
+constexpr uint8_t FIRST_PIN = 100;
+constexpr int STRIKE_COUNTS = 1023;
+constexpr uint32_t STRIKE_GAP_MS = 60;
+
+struct PhaseResult {
+    uint32_t strikes;
+    uint32_t detected;
+    uint32_t spurious;
+};
+
+PhaseResult runPhase(uint8_t subscriber, uint32_t strikes, uint32_t pulseUs) {
+    PhaseResult result = {strikes, 0, 0};
+    Core::Event event;
+    while (EventQueue::poll(subscriber, event)) {
+    }
+
+    for (uint32_t strike = 0; strike < strikes; strike++) {
+        uint8_t pad = strike % PADS;
+        Host::setAnalogValue(FIRST_PIN + pad, STRIKE_COUNTS);
+        std::this_thread::sleep_for(std::chrono::microseconds(pulseUs));
+        Host::setAnalogValue(FIRST_PIN + pad, 0);
+        delay(STRIKE_GAP_MS);
+
+        bool hit = false;
+        while (EventQueue::poll(subscriber, event)) {
+            if (event.sourceId == pad && !hit) {
+                hit = true;
+            } else {
+                result.spurious++;
+            }
+        }
+        if (hit) {
+            result.detected++;
+        }
+    }
+    return result;
+}
+
+void printPhase(const char* name, const PhaseResult& result) {
+    printf("  %-14s %8u %9u %9.1f%% %9u\n", name, result.strikes, result.detected,
+           result.strikes ? 100.0 * result.detected / result.strikes : 0.0, result.spurious);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t strikes = 40;
+    uint32_t pulseUs = 400;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--strikes") == 0 && i + 1 < argc) {
+            strikes = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--pulse-us") == 0 && i + 1 < argc) {
+            pulseUs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_adc [--strikes N] [--pulse-us N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    for (uint8_t pad = 0; pad < PADS; pad++) {
+        Host::setAnalogValue(FIRST_PIN + pad, 0);
+        SensorManager::registerSensor(Sensors::SensorType::PIEZO, pad, FIRST_PIN + pad);
+    }
+    RTOS::setEventDriven(false);
+    uint8_t subscriber = EventQueue::addSubscriber(Core::eventMask(EventType::SENSOR_TRIGGERED));
+    delay(50);
+
+    bool engineRunning = AdcEngine::isRunning();
+    PhaseResult engine = runPhase(subscriber, strikes, pulseUs);
+    uint32_t overruns = AdcEngine::getOverrunCount();
+    AdcEngine::stop();
+    delay(10);
+    PhaseResult direct = runPhase(subscriber, strikes, pulseUs);
+
+    printf("Piezo strikes of %u us, %u pads, sensor task at 1 kHz\n", pulseUs, PADS);
+    printf("  %-14s %8s %9s %10s %9s\n", "acquisition", "strikes", "detected", "rate", "spurious");
+    printPhase("adc engine", engine);
+    printPhase("direct reads", direct);
+    printf("  engine scans %u, overruns %u\n", AdcEngine::getScanCount(), overruns);
+
+    printf("RESULT adc engine_detected=%u direct_detected=%u strikes=%u overruns=%u\n", engine.detected,
+           direct.detected, strikes, overruns);
+
+    bool ok = engineRunning && engine.detected * 10 >= strikes * 9 && engine.detected > direct.detected &&
+              engine.spurious == 0;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*
+ * B.I.T.E.S - Boot Time Benchmark
+ *
+ * Cold-boots the system the way it comes back after a power blip on stage:
+ * no serial monitor attached and WiFi credentials stored for an access
+ * point that isn't there. Reports the per-stage boot profile, the time until
+ * notes can be played and the time until a played note reaches the audio
+ * output. Background stages (AI, network) are not waited for.
+ *
+ * Usage: bench_boot [--budget-ms N]
+ * With --budget-ms the exit code is non-zero if the first sound comes later.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/config_manager.h"
+#include "audio/audio_manager.h"
+#include "audio/sample_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::BootStage;
+using Core::SystemManager;
+
+namespace {
+
+constexpr uint8_t CLICK_TRACK = 0;
+constexpr uint8_t CLICK_NOTE = 60;
+constexpr uint32_t SOUND_TIMEOUT_US = 100000;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t budgetMs = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc) {
+            budgetMs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_boot [--budget-ms N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Host::setSerialConnected(false);
+
+    // Left over from rehearsal: the venue has no such network
+    Core::ConfigManager::init();
+    Core::ConfigManager::setWiFiSSID("rehearsal-room");
+    Core::ConfigManager::setWiFiPassword("not-here");
+    Core::ConfigManager::save();
+
+    uint32_t bootStart = micros();
+    SystemManager::init();
+    uint32_t initReturned = micros();
+
+    // Every note gets a short click so the first output sample is non-silent
+    static int16_t click[64];
+    for (int i = 0; i < 64; i++) {
+        click[i] = static_cast<int16_t>((i % 2 ? -20000 : 20000) * (64 - i) / 64);
+    }
+    Audio::SampleManager::loadSample(CLICK_TRACK, CLICK_NOTE, click, 64);
+
+    bool sounded = false;
+    Host::setAudioSink([&](const int16_t* left, const int16_t*, size_t samples) {
+        for (size_t i = 0; i < samples && !sounded; i++) {
+            sounded = left[i] != 0;
+        }
+    });
+    bool played = Audio::AudioManager::playNote(CLICK_TRACK, CLICK_NOTE, 1.0f);
+    while (played && !sounded && micros() - initReturned < SOUND_TIMEOUT_US) {
+        Host::renderAudioBlock();
+    }
+    uint32_t firstSound = micros();
+    Host::setAudioSink(nullptr);
+
+    printf("Boot profile (no serial monitor, WiFi access point absent)\n");
+    printf("  %-14s %10s %10s\n", "stage", "start us", "took us");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::COUNT); i++) {
+        const Core::BootStageInfo& stage = SystemManager::getBootStage(static_cast<BootStage>(i));
+        if (!stage.done) {
+            printf("  %-14s %10s %10s  %s\n", stage.name, "-", "-", "pending in background");
+            continue;
+        }
+        printf("  %-14s %10u %10u%s\n", stage.name, stage.startUs - bootStart, stage.durationUs,
+               stage.background ? "  background" : "");
+    }
+
+    uint32_t firstNoteUs = SystemManager::getTimeToFirstNote() - bootStart;
+    uint32_t firstSoundUs = firstSound - bootStart;
+    printf("Playable after %.1f ms, first sound after %.1f ms%s\n", firstNoteUs / 1000.0,
+           firstSoundUs / 1000.0, sounded ? "" : " (NO SOUND)");
+
+    const Core::BootStageInfo& network = SystemManager::getBootStage(BootStage::NETWORK);
+    printf("RESULT boot first_note_us=%u first_sound_us=%u network_blocked_boot=%d\n",
+           firstNoteUs, firstSoundUs, network.done && network.startUs < SystemManager::getTimeToFirstNote());
+
+    bool ok = sounded;
+    if (budgetMs > 0 && firstSoundUs > budgetMs * 1000) {
+        printf("First sound over the %u ms budget\n", budgetMs);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/*
+ * B.I.T.E.S - Background Calibration Benchmark
+ *
+ * Calibrates 64 analog channels (32 piezo, 16 pressure, 16 flex) and one
+ * MPU6050 while the sensor ticks keep running. Each channel rests at its
+ * own baseline with noise, and piezo pads are struck every few ticks
+ * throughout. The IMU has a gyro bias and a 3% accel scale error, and is
+ * moved for the first 200 ticks. Each run checks that:
+ * - calibrate() returns at once
+ * - the ticks read the ADC no more often than without calibration
+ * - every baseline is within 2 counts of the truth, strikes notwithstanding
+ * - piezo and pressure thresholds are the baseline plus their margin
+ * - once calibrated, the IMU at rest reads under 0.2 °/s of its 1.8 °/s
+ *   gyro bias, and 1 g
+ *
+ * Usage: bench_calibration [--runs N]
+ * The exit code is non-zero if any check fails. The "before" figure is
+ * the blocking calibration this replaced: 100 readings 10 ms apart in the
+ * calling task, plus as long again for the IMU.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "sensors/calibration_engine.h"
+#include "sensors/mpu6050_driver.h"
+#include "sensors/piezo_driver.h"
+#include "sensors/pressure_driver.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/semaphores.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::CalibrationEngine;
+using Sensors::MPU6050Data;
+using Sensors::MPU6050Driver;
+using Sensors::PiezoDriver;
+using Sensors::PressureDriver;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+
+namespace {
+
+constexpr uint8_t PIEZOS = 32;
+constexpr uint8_t PRESSURES = 16;
+constexpr uint8_t FLEXES = 16;
+constexpr uint8_t CHANNELS = PIEZOS + PRESSURES + FLEXES;
+constexpr uint8_t IMU_ID = CHANNELS;
+constexpr uint8_t FIRST_PIN = 100;
+constexpr uint32_t MOVING_TICKS = 200;
+constexpr uint32_t MAX_TICKS = 4000;
+constexpr uint32_t STRIKE_EVERY_TICKS = 37;
+// Four standard errors at CALIBRATION_TOLERANCE_COUNTS
+constexpr float BASELINE_TOLERANCE_COUNTS = 4 * CALIBRATION_TOLERANCE_COUNTS;
+constexpr float GYRO_BIAS[3] = {1.5f, -0.8f, 0.6f};
+constexpr float ACCEL_GAIN = 1.03f;
+constexpr double BEFORE_MS = 2 * 100 * 10;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t rngState = 23;
+// Uniform in [-1, 1)
+float noise() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 8388608.0f - 1.0f;
+}
+
+// Biased and mis-scaled, with noise; swings about Z while moving
+class BiasedMPU6050 : public Host::SimulatedMPU6050 {
+public:
+    bool moving = true;
+
+    uint8_t readRegister(uint8_t reg) override {
+        if (reg == MPU6050_ACCEL_XOUT_H) {
+            float swing = moving ? 60.0f * sinf(step++ * 0.05f) : 0.0f;
+            setAccel(0.0f, 0.0f, ACCEL_GAIN + 0.002f * noise());
+            setGyro(GYRO_BIAS[0] + 0.3f * noise(), GYRO_BIAS[1] + 0.3f * noise(),
+                    GYRO_BIAS[2] + swing + 0.3f * noise());
+        }
+        return SimulatedMPU6050::readRegister(reg);
+    }
+
+private:
+    static constexpr uint8_t MPU6050_ACCEL_XOUT_H = 0x3B;
+    uint32_t step = 0;
+};
+
+struct Channel {
+    SensorType type;
+    float baseline;     // Counts
+    float spread;       // Counts either side
+};
+
+Channel channels[CHANNELS];
+
+void setReadings(uint32_t tick) {
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        const Channel& channel = channels[id];
+        float reading = channel.baseline + channel.spread * noise();
+        // A strike on one pad or another every few ticks
+        if (channel.type == SensorType::PIEZO && tick % STRIKE_EVERY_TICKS == 0 &&
+            (tick / STRIKE_EVERY_TICKS) % PIEZOS == id) {
+            reading = 1000.0f;
+        }
+        Host::setAnalogValue(FIRST_PIN + id, static_cast<int>(lroundf(reading)));
+    }
+}
+
+struct RunResult {
+    double callUs;
+    uint32_t ticks;
+    double readsPerTick;
+    double idleReadsPerTick;
+    double tickNs;
+    double idleTickNs;
+    float worstBaseline;
+    bool thresholdsCorrect;
+    float gyroResidual;
+    float accelError;
+};
+
+// Mean ticked update() cost and ADC reads per tick
+void tick(uint32_t n, double& ns, uint32_t& reads) {
+    setReadings(n);
+    uint32_t readsBefore = Host::getAnalogReadCount();
+    double start = nowNs();
+    SensorManager::update();
+    ns += nowNs() - start;
+    reads += Host::getAnalogReadCount() - readsBefore;
+    delay(1);
+}
+
+RunResult runOnce(BiasedMPU6050& imu) {
+    RunResult result = {};
+    imu.moving = true;
+    MPU6050Driver::get(0).setCalibration({{0.0f, 0.0f, 0.0f}, 1.0f});
+
+    // Reference cost before calibrating
+    double idleNs = 0.0;
+    uint32_t idleReads = 0;
+    for (uint32_t n = 0; n < 50; n++) {
+        tick(n, idleNs, idleReads);
+    }
+
+    double start = nowNs();
+    SensorManager::calibrate();
+    result.callUs = (nowNs() - start) / 1000.0;
+
+    double ns = 0.0;
+    uint32_t reads = 0;
+    uint32_t n = 0;
+    while (SensorManager::isCalibrating() && n < MAX_TICKS) {
+        imu.moving = n < MOVING_TICKS;
+        tick(n, ns, reads);
+        n++;
+    }
+    result.ticks = n;
+    result.readsPerTick = n ? static_cast<double>(reads) / n : 0.0;
+    result.idleReadsPerTick = idleReads / 50.0;
+    result.tickNs = n ? ns / n : 0.0;
+    result.idleTickNs = idleNs / 50;
+
+    result.thresholdsCorrect = true;
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        const Channel& channel = channels[id];
+        float baseline = CalibrationEngine::getChannel(id).baseline;
+        result.worstBaseline = fmaxf(result.worstBaseline, fabsf(baseline - channel.baseline));
+        float expected;
+        if (channel.type == SensorType::PIEZO) {
+            expected = baseline * PiezoDriver::MILLIVOLTS_PER_COUNT + PiezoDriver::CALIBRATION_MARGIN_MV;
+        } else if (channel.type == SensorType::PRESSURE) {
+            expected = baseline * PressureDriver::VOLTS_PER_COUNT + PressureDriver::CALIBRATION_MARGIN_V;
+        } else {
+            continue;
+        }
+        if (fabsf(SensorManager::getThreshold(id) - expected) > 1e-3f * expected) {
+            result.thresholdsCorrect = false;
+        }
+    }
+
+    // The IMU at rest after calibration
+    uint32_t from = MPU6050Driver::get(0).getSampleCount();
+    double idle = 0.0;
+    uint32_t idleCount = 0;
+    for (uint32_t i = 0; i < 40; i++) {
+        tick(n + i, idle, idleCount);
+    }
+    MPU6050Data samples[IMU_RING_SAMPLES];
+    uint8_t count = MPU6050Driver::get(0).readSamples(from, samples, IMU_RING_SAMPLES);
+    float gyro[3] = {};
+    float accel = 0.0f;
+    for (uint8_t i = 0; i < count; i++) {
+        gyro[0] += samples[i].gyroX / count;
+        gyro[1] += samples[i].gyroY / count;
+        gyro[2] += samples[i].gyroZ / count;
+        accel += sqrtf(samples[i].accelX * samples[i].accelX + samples[i].accelY * samples[i].accelY +
+                       samples[i].accelZ * samples[i].accelZ) / count;
+    }
+    result.gyroResidual = count ? sqrtf(gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2]) : 99.0f;
+    result.accelError = count ? fabsf(accel - 1.0f) : 99.0f;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t runs = 3;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_calibration [--runs N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    static BiasedMPU6050 imu;
+    Host::attachI2CDevice(0, MPU6050_I2C_ADDRESS, &imu);
+    RTOS::createSemaphores();
+    SensorManager::init();
+
+    // Quiet pads, noisier pressure pads and flex sensors with a wide spread
+    bool registered = true;
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        Channel& channel = channels[id];
+        if (id < PIEZOS) {
+            channel = {SensorType::PIEZO, 40.0f + id, 3.0f};
+        } else if (id < PIEZOS + PRESSURES) {
+            channel = {SensorType::PRESSURE, 300.0f + 7 * id, 10.0f};
+        } else {
+            channel = {SensorType::FLEX, 400.0f + 8 * id, 20.0f};
+        }
+        Host::setAnalogValue(FIRST_PIN + id, static_cast<int>(channel.baseline));
+        registered = SensorManager::registerSensor(channel.type, id, FIRST_PIN + id) && registered;
+    }
+    registered = SensorManager::registerSensor(SensorType::MPU6050, IMU_ID, 0) && registered;
+
+    bool ok = registered;
+    printf("  %-4s %10s %7s %12s %11s %11s %13s %10s %12s %11s\n", "run", "call us", "ticks", "reads/tick",
+           "tick ns", "idle ns", "baseline err", "thresholds", "gyro resid", "accel err");
+    RunResult worst = {};
+    for (uint32_t run = 0; run < runs; run++) {
+        RunResult result = runOnce(imu);
+        printf("  %-4u %10.1f %7u %12.1f %11.0f %11.0f %13.2f %10s %12.3f %11.4f\n", run, result.callUs,
+               result.ticks, result.readsPerTick, result.tickNs, result.idleTickNs, result.worstBaseline,
+               result.thresholdsCorrect ? "ok" : "WRONG", result.gyroResidual, result.accelError);
+        ok = ok && result.callUs < 1000.0 && result.ticks < MAX_TICKS && result.readsPerTick <= result.idleReadsPerTick &&
+             result.worstBaseline <= BASELINE_TOLERANCE_COUNTS && result.thresholdsCorrect &&
+             result.gyroResidual < 0.2f && result.accelError < 0.005f;
+        worst.callUs = fmax(worst.callUs, result.callUs);
+        worst.ticks = result.ticks > worst.ticks ? result.ticks : worst.ticks;
+        worst.worstBaseline = fmaxf(worst.worstBaseline, result.worstBaseline);
+    }
+
+    printf("RESULT calibration call_us=%.1f before_blocking_ms=%.0f ticks=%u baseline_err=%.2f\n", worst.callUs,
+           BEFORE_MS, worst.ticks, worst.worstBaseline);
+    return ok ? 0 : 1;
+}
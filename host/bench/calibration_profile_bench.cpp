@@ -0,0 +1,347 @@
+/*
+ * B.I.T.E.S - Calibration Profile Benchmark
+ *
+ * Boots 16, 32 and 64 analog channels (piezo, pressure and flex in turn)
+ * and one MPU6050 twice against the same EEPROM: cold, with no profiles,
+ * calibrating in the background and saving the results; then warm, after a
+ * "reboot" that unregisters everything and replays the config store from
+ * EEPROM. Each size checks that:
+ * - warm channels have the cold run's thresholds, flex baselines and IMU
+ *   corrections as soon as they are registered, before any tick
+ * - the drift check then runs in the background and, with nothing moved,
+ *   writes nothing to EEPROM
+ * Then, with 16 channels:
+ * - a pressure pad whose baseline drifted is corrected by the drift check,
+ *   and its new profile is what the next boot starts from
+ * - a profile taken 20 °C away, or from another pin, is not used
+ *
+ * Usage: bench_calibration_profile
+ * The exit code is non-zero if any check fails. "Playable" is the time
+ * from registering the sensors until every threshold is calibrated: the
+ * whole run when cold, the registration itself when warm.
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "host_shim.h"
+#include "core/config_manager.h"
+#include "core/config_store.h"
+#include "sensors/mpu6050_driver.h"
+#include "sensors/piezo_driver.h"
+#include "sensors/pressure_driver.h"
+#include "sensors/flex_driver.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/semaphores.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::ConfigManager;
+using Core::ConfigStore;
+using Sensors::FlexDriver;
+using Sensors::ImuCalibration;
+using Sensors::MPU6050Driver;
+using Sensors::PiezoDriver;
+using Sensors::PressureDriver;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+
+namespace {
+
+constexpr uint8_t MAX_CHANNELS = 64;
+constexpr uint8_t IMU_ID = MAX_CHANNELS;
+constexpr uint8_t FIRST_PIN = 100;
+constexpr uint8_t OTHER_PIN = 99;
+constexpr uint32_t MAX_TICKS = 4000;
+constexpr float GYRO_BIAS[3] = {1.2f, -0.7f, 0.4f};
+constexpr float ACCEL_GAIN = 0.98f;
+constexpr float DRIFT_COUNTS = 30.0f;
+// Profiles keep baselines to 1/16 count
+constexpr float PROFILE_COUNTS = 0.1f;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t rngState = 24;
+// Uniform in [-1, 1)
+float noise() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 8388608.0f - 1.0f;
+}
+
+// Biased and mis-scaled, at rest
+class BiasedMPU6050 : public Host::SimulatedMPU6050 {
+public:
+    uint8_t readRegister(uint8_t reg) override {
+        if (reg == MPU6050_ACCEL_XOUT_H) {
+            setAccel(0.0f, 0.0f, ACCEL_GAIN + 0.002f * noise());
+            setGyro(GYRO_BIAS[0] + 0.3f * noise(), GYRO_BIAS[1] + 0.3f * noise(), GYRO_BIAS[2] + 0.3f * noise());
+        }
+        return SimulatedMPU6050::readRegister(reg);
+    }
+
+private:
+    static constexpr uint8_t MPU6050_ACCEL_XOUT_H = 0x3B;
+};
+
+SensorType typeOf(uint8_t id) {
+    const SensorType types[] = {SensorType::PIEZO, SensorType::PRESSURE, SensorType::FLEX};
+    return types[id % 3];
+}
+
+float baselines[MAX_CHANNELS];     // Counts
+
+// Narrow enough that two runs' baselines never differ by
+// CALIBRATION_PROFILE_SAVE_COUNTS from noise alone: with 100 samples the
+// difference has a standard deviation of 0.4 counts
+float spreadOf(uint8_t id) {
+    return typeOf(id) == SensorType::PIEZO ? 3.0f : 5.0f;
+}
+
+void tick() {
+    for (uint8_t id = 0; id < MAX_CHANNELS; id++) {
+        float reading = baselines[id] + spreadOf(id) * noise();
+        Host::setAnalogValue(FIRST_PIN + id, static_cast<int>(lroundf(reading)));
+    }
+    SensorManager::update();
+    delay(1);
+}
+
+// Ticks until a background run has started and finished
+uint32_t ticksToCalibrate() {
+    uint32_t n = 0;
+    do {
+        tick();
+        n++;
+    } while (SensorManager::isCalibrating() && n < MAX_TICKS);
+    return n;
+}
+
+// Registration time in microseconds
+double registerAll(uint8_t channels) {
+    double start = nowNs();
+    for (uint8_t id = 0; id < channels; id++) {
+        SensorManager::registerSensor(typeOf(id), id, FIRST_PIN + id);
+    }
+    SensorManager::registerSensor(SensorType::MPU6050, IMU_ID, 0);
+    return (nowNs() - start) / 1000.0;
+}
+
+// As far as calibration goes: every sensor gone, the IMU uncorrected and
+// the config store replayed from EEPROM
+void reboot(uint8_t channels) {
+    for (uint8_t id = 0; id < channels; id++) {
+        SensorManager::unregisterSensor(id);
+    }
+    SensorManager::unregisterSensor(IMU_ID);
+    MPU6050Driver::get(0).setCalibration({{0.0f, 0.0f, 0.0f}, 1.0f});
+    ConfigManager::load();
+}
+
+float defaultThreshold(uint8_t id) {
+    switch (typeOf(id)) {
+        case SensorType::PIEZO: return PiezoDriver::DEFAULT_THRESHOLD_MV;
+        case SensorType::PRESSURE: return PressureDriver::DEFAULT_THRESHOLD_V;
+        default: return FlexDriver::DEFAULT_THRESHOLD;
+    }
+}
+
+float scaleOf(uint8_t id) {
+    switch (typeOf(id)) {
+        case SensorType::PIEZO: return PiezoDriver::MILLIVOLTS_PER_COUNT;
+        case SensorType::PRESSURE: return PressureDriver::VOLTS_PER_COUNT;
+        default: return FlexDriver::FULL_SCALE_PER_COUNT;
+    }
+}
+
+// Thresholds equal to the reference, to within the profile's rounding
+bool sameThresholds(const float* reference, uint8_t channels) {
+    for (uint8_t id = 0; id < channels; id++) {
+        float tolerance = PROFILE_COUNTS * CALIBRATION_NOISE_SIGMAS * scaleOf(id);
+        if (fabsf(SensorManager::getThreshold(id) - reference[id]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameImuCalibration(const ImuCalibration& reference) {
+    ImuCalibration calibration = MPU6050Driver::get(0).getCalibration();
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        if (calibration.gyroBias[axis] != reference.gyroBias[axis]) {
+            return false;
+        }
+    }
+    return calibration.accelScale == reference.accelScale && reference.accelScale != 1.0f;
+}
+
+// Flex values are measured from the baseline once calibrated
+bool flexAtRest(uint8_t channels) {
+    for (uint8_t id = 0; id < channels; id++) {
+        if (typeOf(id) == SensorType::FLEX &&
+            SensorManager::getSensorData(id).value > 4.0f * spreadOf(id) * FlexDriver::FULL_SCALE_PER_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct BootResult {
+    uint8_t channels;
+    uint32_t coldTicks;
+    double coldRegisterUs;
+    double warmRegisterUs;
+    bool warmReady;
+    uint32_t driftTicks;
+    uint32_t driftWrites;
+};
+
+BootResult bootTwice(uint8_t channels) {
+    BootResult result = {channels, 0, 0.0, 0.0, false, 0, 0};
+    ConfigStore::erase();
+
+    // Cold: defaults until a calibration run completes, then saved
+    result.coldRegisterUs = registerAll(channels);
+    SensorManager::calibrate();
+    result.coldTicks = ticksToCalibrate();
+    SensorManager::saveCalibration();
+    float calibrated[MAX_CHANNELS];
+    for (uint8_t id = 0; id < channels; id++) {
+        calibrated[id] = SensorManager::getThreshold(id);
+    }
+    ImuCalibration imu = MPU6050Driver::get(0).getCalibration();
+
+    // Warm: the saved profiles apply as the sensors register
+    reboot(channels);
+    result.warmRegisterUs = registerAll(channels);
+    result.warmReady = sameThresholds(calibrated, channels) && sameImuCalibration(imu);
+    tick();
+    result.warmReady = result.warmReady && flexAtRest(channels);
+
+    // The drift check finds nothing worth rewriting
+    EEPROM.resetWriteCounts();
+    result.driftTicks = 1 + ticksToCalibrate();
+    SensorManager::saveCalibration();
+    result.driftWrites = EEPROM.getWriteCount();
+    reboot(channels);
+    return result;
+}
+
+// A drifted pressure pad is recalibrated by the drift check and saved
+bool checkDrift(uint8_t channels) {
+    const uint8_t drifted = 1;      // Pressure
+    ConfigStore::erase();
+    registerAll(channels);
+    SensorManager::calibrate();
+    ticksToCalibrate();
+    SensorManager::saveCalibration();
+    float before = SensorManager::getThreshold(drifted);
+
+    reboot(channels);
+    baselines[drifted] += DRIFT_COUNTS;
+    registerAll(channels);
+    bool warm = fabsf(SensorManager::getThreshold(drifted) - before) < 1e-3f;
+    EEPROM.resetWriteCounts();
+    ticksToCalibrate();
+    SensorManager::saveCalibration();
+    float expected = before + DRIFT_COUNTS * PressureDriver::VOLTS_PER_COUNT;
+    float tolerance = 4.0f * CALIBRATION_TOLERANCE_COUNTS * PressureDriver::VOLTS_PER_COUNT;
+    bool corrected = fabsf(SensorManager::getThreshold(drifted) - expected) < tolerance;
+    bool saved = EEPROM.getWriteCount() > 0;
+    float after = SensorManager::getThreshold(drifted);
+
+    reboot(channels);
+    registerAll(channels);
+    bool kept = fabsf(SensorManager::getThreshold(drifted) - after) <
+                PROFILE_COUNTS * PressureDriver::VOLTS_PER_COUNT;
+    ticksToCalibrate();
+    reboot(channels);
+    baselines[drifted] -= DRIFT_COUNTS;
+
+    bool ok = warm && corrected && saved && kept;
+    printf("  drift of %.0f counts: warm %s, corrected %s, saved %s, next boot %s\n", DRIFT_COUNTS,
+           warm ? "ok" : "WRONG", corrected ? "ok" : "WRONG", saved ? "ok" : "WRONG", kept ? "ok" : "WRONG");
+    return ok;
+}
+
+// Profiles that no longer describe the hardware leave the defaults
+bool checkRejected(uint8_t channels) {
+    ConfigStore::erase();
+    registerAll(channels);
+    SensorManager::calibrate();
+    ticksToCalibrate();
+    SensorManager::saveCalibration();
+    reboot(channels);
+
+    // 20 °C warmer than when calibrated
+    Host::setBoardTemperature(45.0f);
+    registerAll(channels);
+    bool temperature = MPU6050Driver::get(0).getCalibration().accelScale == 1.0f;
+    for (uint8_t id = 0; id < channels; id++) {
+        temperature = temperature && SensorManager::getThreshold(id) == defaultThreshold(id);
+    }
+    tick();
+    temperature = temperature && !SensorManager::isCalibrating();
+    reboot(channels);
+    Host::setBoardTemperature(25.0f);
+
+    // Sensor 1 moved to another pin
+    Host::setAnalogValue(OTHER_PIN, static_cast<int>(baselines[1]));
+    SensorManager::registerSensor(typeOf(1), 1, OTHER_PIN);
+    bool pin = SensorManager::getThreshold(1) == defaultThreshold(1);
+    SensorManager::unregisterSensor(1);
+
+    printf("  profile rejected at +20 C %s, on another pin %s\n", temperature ? "ok" : "WRONG",
+           pin ? "ok" : "WRONG");
+    return temperature && pin;
+}
+
+} // namespace
+
+int main(int argc, char**) {
+    if (argc > 1) {
+        fprintf(stderr, "usage: bench_calibration_profile\n");
+        return 2;
+    }
+
+    Host::setSerialEnabled(false);
+    static BiasedMPU6050 imu;
+    Host::attachI2CDevice(0, MPU6050_I2C_ADDRESS, &imu);
+    RTOS::createSemaphores();
+    ConfigManager::init();
+    SensorManager::init();
+
+    // Quiet pads resting below their default threshold, noisier pressure
+    // pads and flex sensors, all below the host ADC's 10-bit full scale
+    for (uint8_t id = 0; id < MAX_CHANNELS; id++) {
+        baselines[id] = typeOf(id) == SensorType::PIEZO ? 30.0f + id : 200.0f + 11.0f * id;
+    }
+
+    bool ok = true;
+    const uint8_t sizes[] = {16, 32, 64};
+    BootResult results[3];
+    printf("  %-9s %11s %14s %14s %11s %12s %14s\n", "channels", "cold ticks", "cold reg us", "warm reg us",
+           "warm ready", "drift ticks", "drift writes");
+    for (uint8_t i = 0; i < 3; i++) {
+        results[i] = bootTwice(sizes[i]);
+        const BootResult& result = results[i];
+        printf("  %-9u %11u %14.1f %14.1f %11s %12u %14u\n", result.channels, result.coldTicks,
+               result.coldRegisterUs, result.warmRegisterUs, result.warmReady ? "ok" : "WRONG", result.driftTicks,
+               result.driftWrites);
+        ok = ok && result.coldTicks < MAX_TICKS && result.warmReady && result.driftTicks < MAX_TICKS &&
+             result.driftWrites == 0;
+    }
+    ok = checkDrift(16) && ok;
+    ok = checkRejected(16) && ok;
+
+    // Cold playable time is the calibration run, at one tick per millisecond
+    printf("RESULT calibration_profile cold16_ms=%u cold64_ms=%u warm16_us=%.1f warm64_us=%.1f drift_writes=%u\n",
+           results[0].coldTicks * 1000 / SENSOR_POLL_RATE_HZ, results[2].coldTicks * 1000 / SENSOR_POLL_RATE_HZ,
+           results[0].warmRegisterUs, results[2].warmRegisterUs, results[2].driftWrites);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/*
+ * B.I.T.E.S - Config Store Benchmark
+ *
+ * Measures ConfigManager lookups against the snprintf-and-compare key path
+ * they replaced, EEPROM writes per batched save, and wear across many saves
+ * (busiest cell vs. rewriting a value in place). A file-backed EEPROM is
+ * then "rebooted" to check that committed values survive, including after a
+ * save torn halfway through a record.
+ *
+ * Usage: bench_config_store [--saves N] [--file PATH]
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "host_shim.h"
+#include "core/config_manager.h"
+#include "core/config_store.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::ConfigManager;
+using Core::ConfigStore;
+using Core::ConfigStoreStats;
+
+namespace {
+
+constexpr uint8_t SENSORS = 16;
+constexpr uint8_t AI_FEATURES = 5;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+volatile uint32_t sink = 0;
+
+// The key path ConfigManager used before: format the key, then search a
+// string-keyed table
+struct LegacyEntry {
+    char key[24];
+    uint8_t value;
+};
+
+LegacyEntry legacyTable[2 * SENSORS + AI_FEATURES + 4];
+uint8_t legacyCount = 0;
+
+void legacyPut(const char* key, uint8_t value) {
+    for (uint8_t i = 0; i < legacyCount; i++) {
+        if (strcmp(legacyTable[i].key, key) == 0) {
+            legacyTable[i].value = value;
+            return;
+        }
+    }
+    strncpy(legacyTable[legacyCount].key, key, sizeof(legacyTable[0].key) - 1);
+    legacyTable[legacyCount].value = value;
+    legacyCount++;
+}
+
+uint8_t legacyGet(const char* key) {
+    for (uint8_t i = 0; i < legacyCount; i++) {
+        if (strcmp(legacyTable[i].key, key) == 0) {
+            return legacyTable[i].value;
+        }
+    }
+    return 0;
+}
+
+void populate() {
+    char key[32];
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        ConfigManager::setSensorEnabled(i, i % 3 != 0);
+        ConfigManager::setSensorGPIO(i, 14 + i);
+        snprintf(key, sizeof(key), "sensor_%d_en", i);
+        legacyPut(key, i % 3 != 0);
+        snprintf(key, sizeof(key), "sensor_%d_gpio", i);
+        legacyPut(key, 14 + i);
+    }
+    for (uint8_t i = 0; i < AI_FEATURES; i++) {
+        ConfigManager::setAIEnabled(i, i != 2);
+        snprintf(key, sizeof(key), "ai_%d_en", i);
+        legacyPut(key, i != 2);
+    }
+    ConfigManager::setInstrumentType(2);
+    ConfigManager::setVolume(0.65f);
+    ConfigManager::setBluetoothEnabled(true);
+    ConfigManager::setWiFiSSID("bits-stage");
+    ConfigManager::setWiFiPassword("correct horse battery staple");
+    legacyPut("instrument_type", 2);
+    legacyPut("bluetooth_en", 1);
+}
+
+bool verify(const char* stage) {
+    bool ok = ConfigManager::getInstrumentType() == 2 &&
+              ConfigManager::getVolume() == 0.65f &&
+              ConfigManager::getBluetoothEnabled() &&
+              ConfigManager::getWiFiSSID() == "bits-stage" &&
+              ConfigManager::getWiFiPassword() == "correct horse battery staple";
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        ok = ok && ConfigManager::getSensorEnabled(i) == (i % 3 != 0) &&
+             ConfigManager::getSensorGPIO(i) == 14 + i;
+    }
+    for (uint8_t i = 0; i < AI_FEATURES; i++) {
+        ok = ok && ConfigManager::getAIEnabled(i) == (i != 2);
+    }
+    if (!ok) {
+        printf("  MISMATCH: values differ %s\n", stage);
+    }
+    return ok;
+}
+
+void lookups(uint32_t iterations) {
+    uint32_t writesBefore = EEPROM.getWriteCount();
+    double start = nowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint8_t id = i % SENSORS;
+        sink = sink + ConfigManager::getSensorEnabled(id) + ConfigManager::getSensorGPIO(id);
+    }
+    double storeNs = (nowNs() - start) / (2.0 * iterations);
+
+    char key[32];
+    start = nowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint8_t id = i % SENSORS;
+        snprintf(key, sizeof(key), "sensor_%d_en", id);
+        sink = sink + legacyGet(key);
+        snprintf(key, sizeof(key), "sensor_%d_gpio", id);
+        sink = sink + legacyGet(key);
+    }
+    double legacyNs = (nowNs() - start) / (2.0 * iterations);
+
+    printf("Per-sensor lookup, ns\n");
+    printf("  %-22s %10.1f\n", "snprintf + key search", legacyNs);
+    printf("  %-22s %10.1f\n", "hashed RAM cache", storeNs);
+    printf("  EEPROM writes during lookups: %u\n", EEPROM.getWriteCount() - writesBefore);
+    printf("RESULT config_store lookup_ns=%.1f legacy_ns=%.1f\n", storeNs, legacyNs);
+}
+
+uint32_t maxCellWrites() {
+    uint32_t busiest = 0;
+    for (int address = 0; address < EEPROM.length(); address++) {
+        uint32_t writes = EEPROM.getWriteCount(address);
+        busiest = writes > busiest ? writes : busiest;
+    }
+    return busiest;
+}
+
+bool wear(uint32_t saves) {
+    // One changed value per save, as when a user nudges the volume
+    EEPROM.resetWriteCounts();
+    uint32_t compactionsBefore = ConfigStore::getStats().compactions;
+    double start = nowNs();
+    for (uint32_t i = 0; i < saves; i++) {
+        ConfigManager::setVolume((i & 1) ? 0.5f : 0.65f);
+        ConfigStore::save();
+    }
+    double saveUs = (nowNs() - start) / saves / 1000.0;
+    uint32_t compactions = ConfigStore::getStats().compactions - compactionsBefore;
+    uint32_t busiest = maxCellWrites();
+
+    double compactStart = nowNs();
+    ConfigStore::compact();
+    double compactUs = (nowNs() - compactStart) / 1000.0;
+
+    printf("Wear over %u single-value saves\n", saves);
+    printf("  EEPROM writes %u (%.1f per save), compactions %u\n",
+           EEPROM.getWriteCount(), static_cast<double>(EEPROM.getWriteCount()) / saves, compactions);
+    printf("  busiest cell %u writes (in-place update: %u)\n", busiest, saves);
+    printf("  save %.2f us, compaction %.1f us\n", saveUs, compactUs);
+    printf("RESULT config_store save_us=%.2f compact_us=%.1f max_cell_writes=%u saves=%u\n",
+           saveUs, compactUs, busiest, saves);
+
+    ConfigManager::setVolume(0.65f);
+    ConfigStore::save();
+    if (saves >= 1000 && busiest * 10 > saves) {
+        printf("  UNEXPECTED: busiest cell takes more than 10%% of saves\n");
+        return false;
+    }
+    return true;
+}
+
+bool batching() {
+    // Ten changes committed together vs. one save each
+    EEPROM.resetWriteCounts();
+    for (uint8_t i = 0; i < 10; i++) {
+        ConfigManager::setSensorGPIO(i, 40 + i);
+    }
+    ConfigStore::save();
+    uint32_t batched = EEPROM.getWriteCount();
+
+    EEPROM.resetWriteCounts();
+    for (uint8_t i = 0; i < 10; i++) {
+        ConfigManager::setSensorGPIO(i, 14 + i);
+        ConfigStore::save();
+    }
+    uint32_t separate = EEPROM.getWriteCount();
+
+    printf("Ten changes: %u byte writes in one save, %u in ten saves\n", batched, separate);
+    return batched < separate;
+}
+
+void reboot(const char* path) {
+    EEPROM.setBackingFile(nullptr);
+    EEPROM.erase();
+    EEPROM.setBackingFile(path);
+    ConfigManager::load();
+}
+
+bool persistence(const char* path) {
+    remove(path);
+    if (!EEPROM.setBackingFile(path)) {
+        printf("  cannot open %s\n", path);
+        return false;
+    }
+    ConfigManager::load();
+    populate();
+    ConfigManager::save();
+
+    reboot(path);
+    bool ok = verify("after reboot");
+
+    // Power loss mid-save: an uncommitted half record at the end of the log
+    ConfigManager::setVolume(0.1f);
+    ConfigStoreStats stats = ConfigStore::getStats();
+    int tail = stats.activeBankAddress + stats.logBytes;
+    Core::ConfigKey key = Core::configKey("audio_volume");
+    for (int i = 0; i < 4; i++) {
+        EEPROM.write(tail + i, (key >> (i * 8)) & 0xFF);
+    }
+    EEPROM.write(tail + 4, sizeof(float));
+    reboot(path);
+    ok = verify("after torn save") && ok;
+
+    ConfigManager::setVolume(0.3f);
+    ConfigManager::save();
+    reboot(path);
+    ok = ConfigManager::getVolume() == 0.3f && ok;
+    printf("Persistence through file-backed reboots: %s\n", ok ? "ok" : "FAILED");
+
+    EEPROM.setBackingFile(nullptr);
+    remove(path);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t saves = 20000;
+    const char* path = "bench_config_store.eeprom";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--saves") == 0 && i + 1 < argc) {
+            saves = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: bench_config_store [--saves N] [--file PATH]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    ConfigManager::init();
+    populate();
+    ConfigManager::save();
+
+    bool ok = verify("after save");
+    lookups(1000000);
+    ok = batching() && ok;
+    ok = wear(saves) && ok;
+    ok = verify("after wear run") && ok;
+    ok = persistence(path) && ok;
+
+    ConfigStoreStats stats = ConfigStore::getStats();
+    printf("Store: %u entries, %u/%u bytes in bank at %u, generation %u\n",
+           stats.liveEntries, stats.logBytes, stats.bankSize, stats.activeBankAddress, stats.generation);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * B.I.T.E.S - Deadline Watchdog Benchmark
+ *
+ * Boots the system with an MPU6050 and a pressure sensor registered and
+ * runs the tasks at their fixed periods in three phases: nominal, with the
+ * ADC engine stopped and the sensor task's own conversion stretched past
+ * the 1 ms sensor period (the sensor loop slipping under load), and with
+ * the audio task hung inside its instrument. Reports the deadline misses
+ * and missed check-ins TaskManager counted in each phase and whether the
+ * hardware watchdog would have been fed.
+ *
+ * Usage: bench_deadline [--phase-ms N] [--load-us N]
+ * The exit code is non-zero unless the slipping sensor loop is reported,
+ * the hung audio task is caught and stops the watchdog feed, and feeding
+ * resumes once it recovers.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/task_manager.h"
+#include "core/schedule_manager.h"
+#include "core/watchdog.h"
+#include "instruments/base_instrument.h"
+#include "sensors/adc_engine.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/tasks.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::TaskId;
+using Core::TaskManager;
+using Core::Watchdog;
+
+namespace {
+
+// Instrument whose update() blocks the audio task while held
+class StuckInstrument : public Instruments::BaseInstrument {
+public:
+    std::atomic<bool> hold{false};
+    std::atomic<bool> stuck{false};
+
+    StuckInstrument() : BaseInstrument(InstrumentType::DRUMS) {}
+    void init() override {}
+    void handleSensorInput(uint8_t, float, float) override {}
+    void update() override {
+        while (hold.load()) {
+            stuck = true;
+            delay(1);
+        }
+        stuck = false;
+    }
+};
+
+// Outlives the tasks: it is built before main() registers the kernel's
+// exit handler, so it is destroyed after the handler has stopped them
+StuckInstrument instrument;
+
+struct PhaseResult {
+    uint32_t activations;
+    uint32_t sensorMisses;
+    uint32_t worstOverrunUs;
+    uint32_t audioCheckIns;
+    bool fed;
+};
+
+PhaseResult measure() {
+    const Core::TaskTiming& sensor = TaskManager::getTaskTiming(TaskId::SENSOR);
+    PhaseResult result = {};
+    result.fed = Watchdog::feed();
+    result.activations = sensor.activations;
+    result.sensorMisses = TaskManager::getDeadlineMisses(TaskId::SENSOR);
+    result.worstOverrunUs = sensor.worstOverrunUs;
+    result.audioCheckIns = TaskManager::getMissedCheckIns(TaskId::AUDIO);
+    return result;
+}
+
+void printPhase(const char* name, const PhaseResult& result) {
+    printf("  %-8s %11u %13u %11u %16u %6s\n", name, result.activations, result.sensorMisses,
+           result.worstOverrunUs, result.audioCheckIns, result.fed ? "yes" : "NO");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t phaseMs = 500;
+    uint32_t loadUs = 1500;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--phase-ms") == 0 && i + 1 < argc) {
+            phaseMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--load-us") == 0 && i + 1 < argc) {
+            loadUs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_deadline [--phase-ms N] [--load-us N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::MPU6050, 0, 0);
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::PRESSURE, 1, A0);
+    RTOS::setActiveInstrument(&instrument);
+
+    // The 1 kHz sensor loop as a fixed-period task
+    RTOS::setEventDriven(false);
+    delay(50);
+
+    TaskManager::resetTaskTimings();
+    delay(phaseMs);
+    PhaseResult nominal = measure();
+
+    TaskManager::resetTaskTimings();
+    Sensors::AdcEngine::stop();
+    Host::setAnalogReadDelay(loadUs);
+    delay(phaseMs);
+    PhaseResult loaded = measure();
+    Host::setAnalogReadDelay(0);
+    Sensors::AdcEngine::start();
+
+    TaskManager::resetTaskTimings();
+    instrument.hold = true;
+    while (!instrument.stuck) {
+        delay(1);
+    }
+    delay(phaseMs);
+    PhaseResult hung = measure();
+    uint32_t hungAt = TaskManager::getTaskTiming(TaskId::AUDIO).lastMissMs;
+
+    // The stuck activation checks in as it ends; a second one means that
+    // check-in is complete, however long a loaded host takes to get there
+    uint32_t stuckActivations = TaskManager::getTaskTiming(TaskId::AUDIO).activations;
+    instrument.hold = false;
+    uint32_t releasedAt = millis();
+    while (TaskManager::getTaskTiming(TaskId::AUDIO).activations - stuckActivations < 2 &&
+           millis() - releasedAt < 1000) {
+        delay(1);
+    }
+    bool recovered = Watchdog::feed();
+
+    uint32_t sensorDeadlineUs = Core::ScheduleManager::getTaskSchedule(TaskId::SENSOR).periodUs;
+    uint32_t audioPeriodUs = Core::ScheduleManager::getTaskSchedule(TaskId::AUDIO).periodUs;
+    printf("Sensor deadline %u us, audio check-in window %u us (fixed periods)\n", sensorDeadlineUs,
+           2 * audioPeriodUs + RTOS_CHECKIN_GRACE_MS * 1000);
+    printf("  %-8s %11s %13s %11s %16s %6s\n", "phase", "activations", "sensor misses", "worst +us",
+           "audio check-ins", "fed");
+    printPhase("nominal", nominal);
+    printPhase("loaded", loaded);
+    printPhase("hung", hung);
+    printf("Audio hang flagged at %u ms, watchdog fed after recovery: %s\n", hungAt, recovered ? "yes" : "NO");
+
+    printf("RESULT deadline nominal_misses=%u loaded_misses=%u loaded_activations=%u hang_detected=%d "
+           "feed_withheld=%d recovered=%d\n",
+           nominal.sensorMisses, loaded.sensorMisses, loaded.activations, hung.audioCheckIns > 0, !hung.fed,
+           recovered);
+
+    bool ok = loaded.sensorMisses * 2 >= loaded.activations && loaded.sensorMisses > nominal.sensorMisses &&
+              loaded.fed && nominal.fed && hung.audioCheckIns > 0 && !hung.fed && recovered;
+    return ok ? 0 : 1;
+}
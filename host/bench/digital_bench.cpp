@@ -0,0 +1,221 @@
+/*
+ * B.I.T.E.S - Digital Scanner Benchmark
+ *
+ * Checks DigitalScanner's vertical-counter debouncing against a per-channel
+ * reference: 96 active-low inputs spread over four ports are driven with
+ * random bouncing, and after every scan each channel's debounced state and
+ * reported change must match a plain counter that flips the state after
+ * DIGITAL_DEBOUNCE_SAMPLES disagreeing samples. Then times one scan with 8,
+ * 32 and 96 channels against the per-channel polling it replaced
+ * (digitalRead() twice and a millis() debounce per channel).
+ *
+ * Usage: bench_digital [--scans N]
+ * The exit code is non-zero on any mismatch with the reference, or if
+ * scanning 96 channels costs more than polling 8 the old way.
+ * Note: digitalRead() is an array load on the host, so the per-channel
+ * numbers are a lower bound for target.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "sensors/digital_scanner.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::DigitalScanner;
+
+namespace {
+
+constexpr uint8_t WORDS = MAX_SENSORS / 32;
+constexpr uint8_t FIRST_PIN = 2;
+constexpr uint8_t CHECK_CHANNELS = 96;
+constexpr uint8_t REPEATS = 5;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t rngState = 1;
+uint32_t randomNext() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+bool isSet(const uint32_t* bits, uint8_t id) {
+    return (bits[id / 32] >> (id & 31)) & 1;
+}
+
+// One channel of the reference debouncer
+struct Reference {
+    bool state;
+    uint8_t count;
+
+    bool sample(bool active) {
+        if (active == state) {
+            count = 0;
+            return false;
+        }
+        if (++count < DIGITAL_DEBOUNCE_SAMPLES) {
+            return false;
+        }
+        state = active;
+        count = 0;
+        return true;
+    }
+};
+
+struct CheckResult {
+    uint32_t stateMismatches;
+    uint32_t changeMismatches;
+    uint32_t changes;
+    uint32_t rejected;      // Input changes that did not last long enough
+};
+
+CheckResult checkDebounce(uint32_t scans) {
+    CheckResult result = {};
+    DigitalScanner::init();
+    Reference reference[CHECK_CHANNELS];
+    for (uint8_t id = 0; id < CHECK_CHANNELS; id++) {
+        Host::setDigitalValue(FIRST_PIN + id, HIGH);
+        DigitalScanner::addChannel(id, FIRST_PIN + id, true);
+        reference[id] = {false, 0};
+    }
+
+    bool level[CHECK_CHANNELS];
+    memset(level, 1, sizeof(level));
+    for (uint32_t scan = 0; scan < scans; scan++) {
+        // Each channel is quiet, bouncing or held, changing every few scans
+        for (uint8_t id = 0; id < CHECK_CHANNELS; id++) {
+            uint32_t roll = randomNext() % 100;
+            bool bouncing = (scan / 64 + id) % 3 == 0;
+            if (roll < (bouncing ? 45u : 3u)) {
+                level[id] = !level[id];
+                Host::setDigitalValue(FIRST_PIN + id, level[id] ? HIGH : LOW);
+            }
+        }
+
+        uint32_t changed[WORDS] = {};
+        DigitalScanner::scan(changed);
+        const uint32_t* state = DigitalScanner::getStateBits();
+        for (uint8_t id = 0; id < CHECK_CHANNELS; id++) {
+            bool active = !level[id];
+            uint8_t countBefore = reference[id].count;
+            bool flipped = reference[id].sample(active);
+            if (!flipped && countBefore > 0 && reference[id].count == 0) {
+                result.rejected++;
+            }
+            result.changes += flipped;
+            result.stateMismatches += isSet(state, id) != reference[id].state;
+            result.changeMismatches += isSet(changed, id) != flipped;
+        }
+    }
+    return result;
+}
+
+// The per-channel poll of IRDriver::read() and isTriggered()
+struct LegacyChannel {
+    uint8_t gpio;
+    uint32_t lastTriggerTime;
+    bool triggered;
+};
+
+double timeLegacy(uint8_t channels, uint32_t scans) {
+    LegacyChannel legacy[MAX_SENSORS];
+    for (uint8_t i = 0; i < channels; i++) {
+        legacy[i] = {static_cast<uint8_t>(FIRST_PIN + i), 0, false};
+    }
+    volatile uint32_t sink = 0;
+    double best = 0.0;
+    for (uint8_t repeat = 0; repeat < REPEATS; repeat++) {
+        double start = nowNs();
+        for (uint32_t scan = 0; scan < scans; scan++) {
+            for (uint8_t i = 0; i < channels; i++) {
+                LegacyChannel& channel = legacy[i];
+                float value = digitalRead(channel.gpio) == LOW ? 1.0f : 0.0f;
+                bool state = digitalRead(channel.gpio) == LOW;
+                uint32_t now = millis();
+                bool fired = false;
+                if (state) {
+                    if (now - channel.lastTriggerTime > 10) {
+                        channel.triggered = true;
+                        channel.lastTriggerTime = now;
+                        fired = true;
+                    }
+                } else {
+                    channel.triggered = false;
+                }
+                sink = sink + fired + (value > 0.0f);
+            }
+        }
+        double elapsed = (nowNs() - start) / scans;
+        best = (repeat == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+double timeScanner(uint8_t channels, uint8_t firstPin, uint32_t scans) {
+    DigitalScanner::init();
+    for (uint8_t id = 0; id < channels; id++) {
+        Host::setDigitalValue(firstPin + id, HIGH);
+        DigitalScanner::addChannel(id, firstPin + id, true);
+    }
+    double best = 0.0;
+    for (uint8_t repeat = 0; repeat < REPEATS; repeat++) {
+        double start = nowNs();
+        for (uint32_t scan = 0; scan < scans; scan++) {
+            uint32_t changed[WORDS] = {};
+            DigitalScanner::scan(changed);
+        }
+        double elapsed = (nowNs() - start) / scans;
+        best = (repeat == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t scans = 100000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scans") == 0 && i + 1 < argc) {
+            scans = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_digital [--scans N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+
+    CheckResult check = checkDebounce(scans / 10);
+    printf("Debounce check: %u channels, %u scans, %u-sample counters\n", CHECK_CHANNELS, scans / 10,
+           DIGITAL_DEBOUNCE_SAMPLES);
+    printf("  debounced changes %u, short changes rejected %u\n", check.changes, check.rejected);
+    printf("  state mismatches %u, change mismatches %u\n", check.stateMismatches, check.changeMismatches);
+
+    // 8 and 32 channels share one port (pins 32-63); 96 span all four
+    const uint8_t sizes[] = {8, 32, 96};
+    const uint8_t firstPins[] = {32, 32, FIRST_PIN};
+    double scanner[3];
+    double legacy[3];
+    printf("  %-9s %14s %19s\n", "channels", "scanner ns", "per-channel poll ns");
+    for (uint8_t i = 0; i < 3; i++) {
+        scanner[i] = timeScanner(sizes[i], firstPins[i], scans);
+        legacy[i] = timeLegacy(sizes[i], scans);
+        printf("  %-9u %14.1f %19.1f\n", sizes[i], scanner[i], legacy[i]);
+    }
+
+    printf("RESULT digital mismatches=%u changes=%u scan8_ns=%.1f scan32_ns=%.1f scan96_ns=%.1f "
+           "legacy8_ns=%.1f legacy32_ns=%.1f legacy96_ns=%.1f\n",
+           check.stateMismatches + check.changeMismatches, check.changes, scanner[0], scanner[1], scanner[2],
+           legacy[0], legacy[1], legacy[2]);
+
+    bool ok = check.stateMismatches == 0 && check.changeMismatches == 0 && check.changes > 0 &&
+              (check.rejected > 0 || DIGITAL_DEBOUNCE_SAMPLES == 1) && scanner[2] < legacy[0];
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+/*
+ * B.I.T.E.S - Event Bus Benchmark
+ *
+ * Compares EventQueue publish/poll against the xQueueSend/xQueueReceive path
+ * it replaced, for 1 and 3 consumers (instrument, AI, network). The queue
+ * path needs one queue and one send per consumer to fan out. Events are sent
+ * in bursts of 16 and drained after each burst, so neither side overflows.
+ *
+ * A second phase runs concurrent publishers and polling consumers on host
+ * threads and checks that every event is either delivered or counted as a
+ * drop.
+ *
+ * Usage: bench_event_bus [--events N]
+ * Note: on the host the FreeRTOS queue calls go through the shim's kernel
+ * lock; the ratio, not the absolute numbers, is what carries to target.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/event_queue.h"
+#include <queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace BITS;
+using Core::Event;
+using Core::EventQueue;
+using Core::EventType;
+using Core::SubscriberId;
+
+namespace {
+
+constexpr uint32_t BURST = 16;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Event makeEvent(uint32_t sequence) {
+    Event event;
+    event.type = EventType::SENSOR_TRIGGERED;
+    event.timestamp = sequence;
+    event.sourceId = static_cast<uint8_t>(sequence);
+    memset(event.data, 0, sizeof(event.data));
+    return event;
+}
+
+// Returns ns per published event
+double runQueue(uint32_t consumers, uint32_t events, uint64_t& checksum) {
+    std::vector<QueueHandle_t> queues;
+    for (uint32_t c = 0; c < consumers; c++) {
+        queues.push_back(xQueueCreate(32, sizeof(Event)));
+    }
+
+    double start = nowNs();
+    for (uint32_t sent = 0; sent < events; sent += BURST) {
+        for (uint32_t i = 0; i < BURST; i++) {
+            Event event = makeEvent(sent + i);
+            for (QueueHandle_t queue : queues) {
+                xQueueSend(queue, &event, 0);
+            }
+        }
+        for (QueueHandle_t queue : queues) {
+            Event event;
+            while (xQueueReceive(queue, &event, 0) == pdTRUE) {
+                checksum += event.timestamp;
+            }
+        }
+    }
+    double elapsed = nowNs() - start;
+
+    for (QueueHandle_t queue : queues) {
+        vQueueDelete(queue);
+    }
+    return elapsed / events;
+}
+
+double runBus(uint32_t consumers, uint32_t events, uint64_t& checksum) {
+    std::vector<SubscriberId> ids;
+    for (uint32_t c = 0; c < consumers; c++) {
+        ids.push_back(EventQueue::addSubscriber(Core::eventMask(EventType::SENSOR_TRIGGERED)));
+    }
+
+    double start = nowNs();
+    for (uint32_t sent = 0; sent < events; sent += BURST) {
+        for (uint32_t i = 0; i < BURST; i++) {
+            EventQueue::publish(makeEvent(sent + i));
+        }
+        for (SubscriberId id : ids) {
+            Event event;
+            while (EventQueue::poll(id, event)) {
+                checksum += event.timestamp;
+            }
+        }
+    }
+    double elapsed = nowNs() - start;
+
+    for (SubscriberId id : ids) {
+        EventQueue::removeSubscriber(id);
+    }
+    return elapsed / events;
+}
+
+// Two publishers (a task and an "ISR") against three polling consumers
+bool runConcurrent(uint32_t events) {
+    constexpr uint32_t PUBLISHERS = 2;
+    constexpr uint32_t CONSUMERS = 3;
+    SubscriberId ids[CONSUMERS];
+    for (uint32_t c = 0; c < CONSUMERS; c++) {
+        ids[c] = EventQueue::addSubscriber(Core::ALL_EVENTS);
+    }
+
+    std::atomic<uint32_t> publishersDone{0};
+    uint64_t received[CONSUMERS] = {0};
+    uint32_t outOfOrder[CONSUMERS] = {0};
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < PUBLISHERS; p++) {
+        threads.emplace_back([&, p]() {
+            for (uint32_t i = 0; i < events; i++) {
+                Event event = makeEvent(i);
+                event.sourceId = static_cast<uint8_t>(p);
+                if (p == 0) {
+                    EventQueue::publish(event);
+                } else {
+                    BaseType_t woken = pdFALSE;
+                    EventQueue::publishFromISR(event, &woken);
+                }
+                if (i % BURST == BURST - 1) {
+                    std::this_thread::yield();  // Give consumers a chance on single-core hosts
+                }
+            }
+            publishersDone++;
+        });
+    }
+    for (uint32_t c = 0; c < CONSUMERS; c++) {
+        threads.emplace_back([&, c]() {
+            uint32_t last[PUBLISHERS] = {0};
+            bool seen[PUBLISHERS] = {false};
+            Event event;
+            while (true) {
+                bool done = publishersDone == PUBLISHERS;
+                if (!EventQueue::poll(ids[c], event)) {
+                    if (done) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Each publisher's events must arrive in order
+                uint8_t p = event.sourceId;
+                if (seen[p] && event.timestamp <= last[p]) outOfOrder[c]++;
+                seen[p] = true;
+                last[p] = event.timestamp;
+                received[c]++;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool ok = true;
+    for (uint32_t c = 0; c < CONSUMERS; c++) {
+        uint64_t drops = EventQueue::getDropCount(ids[c]);
+        uint64_t expected = static_cast<uint64_t>(events) * PUBLISHERS;
+        bool consistent = received[c] + drops == expected && outOfOrder[c] == 0;
+        printf("  consumer %u: received %llu, dropped %llu, high watermark %u, out of order %u%s\n",
+               c, static_cast<unsigned long long>(received[c]), static_cast<unsigned long long>(drops),
+               EventQueue::getHighWatermark(ids[c]), outOfOrder[c], consistent ? "" : "  MISMATCH");
+        ok = ok && consistent;
+        EventQueue::removeSubscriber(ids[c]);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t events = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc) {
+            events = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_event_bus [--events N]\n");
+            return 2;
+        }
+    }
+    events = (events + BURST - 1) / BURST * BURST;
+
+    Host::setSerialEnabled(false);
+    EventQueue::init();
+
+    printf("Fan-out of %u events, ns per published event\n", events);
+    printf("  %-10s %12s %12s %9s\n", "consumers", "xQueueSend", "EventQueue", "speedup");
+    bool ok = true;
+    for (uint32_t consumers : {1u, 3u}) {
+        uint64_t queueChecksum = 0;
+        uint64_t busChecksum = 0;
+        double queueNs = runQueue(consumers, events, queueChecksum);
+        double busNs = runBus(consumers, events, busChecksum);
+        printf("  %-10u %12.1f %12.1f %8.1fx\n", consumers, queueNs, busNs, queueNs / busNs);
+        printf("RESULT event_bus consumers=%u queue_ns=%.1f bus_ns=%.1f\n", consumers, queueNs, busNs);
+        if (queueChecksum != busChecksum) {
+            printf("  MISMATCH: bus delivered different events than the queue\n");
+            ok = false;
+        }
+    }
+
+    printf("Concurrent: 2 publishers x %u events, 3 consumers\n", events);
+    ok = runConcurrent(events) && ok;
+
+    return ok ? 0 : 1;
+}
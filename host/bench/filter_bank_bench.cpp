@@ -0,0 +1,310 @@
+/*
+ * B.I.T.E.S - Filter Bank Benchmark
+ *
+ * Checks FilterBank against per-channel scalar filters and times it. Each
+ * filter type (Kalman, EWMA, one-pole low-pass, median of 3) runs on noisy
+ * steps in a bank and in a scalar reference written one object per
+ * channel; the outputs must agree. Then a bank of 64 and of 128 channels
+ * with the filter types mixed is timed against the same channels filtered
+ * one object at a time, and against a SensorManager::update() tick polling
+ * that many pressure channels without filters. Last, a low-pass pressure
+ * channel must keep its cutoff in Hz when the sensor period changes.
+ *
+ * Usage: bench_filter_bank [--ticks N]
+ * The exit code is non-zero if any output differs from the reference by
+ * more than 1e-5 (relative), or if filtering 64 or 128 channels costs as
+ * much as polling them.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/schedule_manager.h"
+#include "sensors/filter_bank.h"
+#include "sensors/pressure_driver.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/tasks.h"
+#include "rtos/semaphores.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::ScheduleManager;
+using Core::TaskId;
+using Sensors::FilterBank;
+using Sensors::FilterConfig;
+using Sensors::FilterType;
+using Sensors::PressureDriver;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+
+namespace {
+
+constexpr float RATE_HZ = SENSOR_POLL_RATE_HZ;
+constexpr uint32_t CHECK_SAMPLES = 5000;
+constexpr float TOLERANCE = 1e-5f;
+constexpr uint8_t FIRST_PIN = 100;
+constexpr uint8_t REPEATS = 5;
+// Timed passes stay well under a scheduler time slice, so on a loaded host
+// the best of them still ran unpreempted
+constexpr uint32_t CHUNK_TICKS = 256;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// One filter per object, updated one sample at a time
+class ScalarFilter {
+public:
+    void init(const FilterConfig& config) {
+        type = config.type;
+        q = config.a;
+        r = config.b;
+        p = 1.0f;
+        alpha = config.a;
+        if (type == FilterType::LOW_PASS) {
+            alpha = 1.0f - expf(-2.0f * PI * config.a / RATE_HZ);
+        }
+        started = false;
+    }
+
+    float update(float x) {
+        if (!started) {
+            y = x1 = x2 = x;
+            started = true;
+        }
+        switch (type) {
+            case FilterType::KALMAN: {
+                p += q;
+                float k = p / (p + r);
+                y += k * (x - y);
+                p = (1.0f - k) * p;
+                return y;
+            }
+            case FilterType::EWMA:
+            case FilterType::LOW_PASS:
+                y += alpha * (x - y);
+                return y;
+            case FilterType::MEDIAN3: {
+                float median = fmaxf(fminf(x, x1), fminf(fmaxf(x, x1), x2));
+                x2 = x1;
+                x1 = x;
+                return median;
+            }
+            default:
+                return x;
+        }
+    }
+
+private:
+    FilterType type;
+    float q, r, p, alpha;
+    float y, x1, x2;
+    bool started;
+};
+
+FilterConfig configFor(uint8_t channel) {
+    switch (channel % 4) {
+        case 0: return FilterConfig::kalman(0.01f, 0.5f);
+        case 1: return FilterConfig::ewma(0.2f);
+        case 2: return FilterConfig::lowPass(30.0f);
+        default: return FilterConfig::median3();
+    }
+}
+
+uint32_t rngState = 22;
+// Uniform in [0, 1)
+float uniform() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 16777216.0f;
+}
+
+// Steps every 250 samples, noise and an occasional spike
+float sampleFor(uint8_t channel, uint32_t n) {
+    float level = ((n / 250 + channel) % 4) * 0.8f + channel * 0.01f;
+    float noise = (uniform() - 0.5f) * 0.1f;
+    float spike = uniform() < 0.01f ? 1.5f : 0.0f;
+    return level + noise + spike;
+}
+
+// Largest relative difference between bank and reference, per type
+bool checkType(const FilterConfig& config, const char* name) {
+    constexpr uint8_t CHANNELS = 8;
+    FilterBank bank;
+    ScalarFilter reference[CHANNELS];
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        bank.configure(c, config, RATE_HZ);
+        reference[c].init(config);
+    }
+    float worst = 0.0f;
+    float values[CHANNELS];
+    for (uint32_t n = 0; n < CHECK_SAMPLES; n++) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            values[c] = sampleFor(c, n);
+        }
+        float expected[CHANNELS];
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            expected[c] = reference[c].update(values[c]);
+        }
+        bank.process(values, CHANNELS);
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            float error = fabsf(values[c] - expected[c]) / fmaxf(1.0f, fabsf(expected[c]));
+            worst = fmaxf(worst, error);
+        }
+    }
+    bool ok = worst <= TOLERANCE;
+    printf("  %-9s max relative error %.2e %s\n", name, worst, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+// One step on a low-pass channel after the sensor period doubles: the
+// gain must be the one for the new rate
+bool checkRateChange() {
+    constexpr uint32_t PERIOD_US = 2000;
+    constexpr float CUTOFF_HZ = 30.0f;
+    constexpr int STEP_COUNTS = 800;
+
+    Host::setAnalogValue(FIRST_PIN, 0);
+    SensorManager::registerSensor(SensorType::PRESSURE, 0, FIRST_PIN);
+    SensorManager::setFilter(0, FilterConfig::lowPass(CUTOFF_HZ));
+    bool applied = ScheduleManager::setTaskPeriod(TaskId::SENSOR, PERIOD_US);
+    SensorManager::update();
+    Host::setAnalogValue(FIRST_PIN, STEP_COUNTS);
+    SensorManager::update();
+
+    float gain = 1.0f - expf(-2.0f * PI * CUTOFF_HZ * PERIOD_US / 1e6f);
+    float expected = gain * STEP_COUNTS * PressureDriver::VOLTS_PER_COUNT;
+    float value = SensorManager::getSensorData(0).value;
+    float error = fabsf(value - expected) / expected;
+    ScheduleManager::setTaskPeriod(TaskId::SENSOR, RTOS::TASK_PERIOD_SENSOR_US);
+    SensorManager::unregisterSensor(0);
+    Host::setAnalogValue(FIRST_PIN, 0);
+
+    bool ok = applied && error <= TOLERANCE;
+    printf("  %-9s relative error %.2e at %u us %s\n", "period", error, PERIOD_US, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+template <typename Pass>
+double bestNsPerTick(uint32_t ticks, Pass pass) {
+    double best = 0.0;
+    for (uint8_t repeat = 0; repeat < REPEATS; repeat++) {
+        for (uint32_t from = 0; from < ticks; from += CHUNK_TICKS) {
+            uint32_t to = ticks - from < CHUNK_TICKS ? ticks : from + CHUNK_TICKS;
+            double start = nowNs();
+            for (uint32_t tick = from; tick < to; tick++) {
+                pass(tick);
+            }
+            double elapsed = (nowNs() - start) / (to - from);
+            if ((repeat == 0 && from == 0) || elapsed < best) {
+                best = elapsed;
+            }
+        }
+    }
+    return best;
+}
+
+struct TimingResult {
+    uint8_t channels;
+    double bankNs;
+    double scalarNs;
+    double pollNs;
+};
+
+// Inputs are precomputed so the timed passes are only the filtering
+constexpr uint32_t INPUT_TICKS = 1024;
+float inputs[INPUT_TICKS][MAX_SENSORS];
+float sink;
+
+TimingResult timeChannels(uint8_t channels, uint32_t ticks) {
+    TimingResult result = {channels, 0.0, 0.0, 0.0};
+
+    static FilterBank bank;
+    static ScalarFilter scalars[MAX_SENSORS];
+    bank.init();
+    for (uint8_t c = 0; c < channels; c++) {
+        bank.configure(c, configFor(c), RATE_HZ);
+        scalars[c].init(configFor(c));
+    }
+    float values[MAX_SENSORS];
+    result.bankNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        memcpy(values, inputs[tick % INPUT_TICKS], channels * sizeof(float));
+        bank.process(values, channels);
+        sink += values[tick % channels];
+    });
+    result.scalarNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        const float* input = inputs[tick % INPUT_TICKS];
+        for (uint8_t c = 0; c < channels; c++) {
+            values[c] = scalars[c].update(input[c]);
+        }
+        sink += values[tick % channels];
+    });
+
+    // The same channels polled as pressure sensors, unfiltered
+    for (uint8_t id = 0; id < channels; id++) {
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+        SensorManager::registerSensor(SensorType::PRESSURE, id, FIRST_PIN + id);
+    }
+    uint8_t key = 0;
+    result.pollNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        Host::setAnalogValue(FIRST_PIN + key, tick % 2 ? 0 : 2048);
+        SensorManager::update();
+        key = (key + 1) % channels;
+    });
+    for (uint8_t id = 0; id < channels; id++) {
+        SensorManager::unregisterSensor(id);
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t ticks = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_filter_bank [--ticks N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    RTOS::createSemaphores();
+    SensorManager::init();
+
+    bool ok = true;
+    ok = checkType(FilterConfig::kalman(0.01f, 0.5f), "kalman") && ok;
+    ok = checkType(FilterConfig::ewma(0.2f), "ewma") && ok;
+    ok = checkType(FilterConfig::lowPass(30.0f), "low-pass") && ok;
+    ok = checkType(FilterConfig::median3(), "median3") && ok;
+    ok = checkRateChange() && ok;
+
+    for (uint32_t n = 0; n < INPUT_TICKS; n++) {
+        for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+            inputs[n][c] = sampleFor(c, n);
+        }
+    }
+
+    const uint8_t sizes[] = {64, 128};
+    TimingResult results[2];
+    printf("  %-9s %12s %12s %12s\n", "channels", "bank ns", "scalar ns", "poll ns");
+    for (uint8_t i = 0; i < 2; i++) {
+        results[i] = timeChannels(sizes[i], ticks);
+        const TimingResult& result = results[i];
+        printf("  %-9u %12.0f %12.0f %12.0f\n", result.channels, result.bankNs, result.scalarNs, result.pollNs);
+        ok = ok && result.bankNs < result.pollNs;
+    }
+
+    printf("RESULT filter_bank bank64_ns=%.0f scalar64_ns=%.0f poll64_ns=%.0f bank128_ns=%.0f scalar128_ns=%.0f "
+           "poll128_ns=%.0f\n",
+           results[0].bankNs, results[0].scalarNs, results[0].pollNs, results[1].bankNs, results[1].scalarNs,
+           results[1].pollNs);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/*
+ * B.I.T.E.S - I2C Engine Benchmark
+ *
+ * Runs the I2C engine against the simulated MPU6050 on the stand-in async
+ * master, with extra device latency on top of the 400 kHz bus time:
+ * - Stall: how long the caller is held by a 15-byte IMU burst, waited for
+ *   (the blocking path, as with Wire) versus submitted at 1 kHz as the
+ *   sensor task now does, and the submit-to-callback time of the latter
+ * - Task wait: the blocking path from a task, which sleeps on a notification
+ *   from the engine; notifications other senders give the task meanwhile
+ *   must all still be there afterwards
+ * - Order: a full queue of register writes and read-backs completes in
+ *   submission order with the written values, and one more is refused
+ *
+ * Usage: bench_i2c [--bursts N] [--latency-us N]
+ * The exit code is non-zero if a transaction fails, completes out of order
+ * or reads back the wrong value, a submit to a full queue is accepted, a
+ * task loses a notification to a transfer, or submitting costs the caller
+ * more than a tenth of a blocking burst.
+ */
+
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "host_shim.h"
+#include "sensors/i2c_engine.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::I2CEngine;
+using Sensors::I2CStatus;
+using Sensors::I2CTransaction;
+
+namespace {
+
+constexpr uint8_t IMU_ADDRESS = MPU6050_I2C_ADDRESS;
+constexpr uint8_t INT_STATUS = 0x3A;
+constexpr uint8_t BURST_BYTES = 15;
+// Free MPU6050 registers used as scratch for the ordering check
+constexpr uint8_t SCRATCH_REGISTER = 0x50;
+
+struct Timing {
+    double sumUs;
+    uint32_t maxUs;
+    uint32_t count;
+
+    void add(uint32_t us) {
+        sumUs += us;
+        maxUs = us > maxUs ? us : maxUs;
+        count++;
+    }
+    double mean() const { return count ? sumUs / count : 0.0; }
+};
+
+const uint8_t burstStart = INT_STATUS;
+uint8_t burstBytes[BURST_BYTES];
+uint32_t submittedAt;
+Timing completion;
+uint32_t failures;
+
+void onBurst(I2CTransaction&, bool ok) {
+    completion.add(micros() - submittedAt);
+    failures += !ok;
+}
+
+void setBurst(I2CTransaction& transaction) {
+    transaction.address = IMU_ADDRESS;
+    transaction.writeData = &burstStart;
+    transaction.writeLength = 1;
+    transaction.readData = burstBytes;
+    transaction.readLength = BURST_BYTES;
+}
+
+Timing timeBlocking(uint32_t bursts) {
+    Timing stall = {};
+    I2CTransaction burst;
+    setBurst(burst);
+    for (uint32_t i = 0; i < bursts; i++) {
+        uint32_t start = micros();
+        failures += !I2CEngine::transfer(burst);
+        stall.add(micros() - start);
+    }
+    return stall;
+}
+
+// Blocking transfers from a task while main gives it notifications of its own
+struct TaskWait {
+    Timing stall;
+    uint32_t given;
+    uint32_t kept;
+};
+
+TaskWait taskWait;
+uint32_t taskBursts;
+std::atomic<bool> transfersDone{false};
+std::atomic<bool> givesDone{false};
+
+void transferTask(void*) {
+    taskWait.stall = timeBlocking(taskBursts);
+    transfersDone = true;
+    while (!givesDone) {
+        delay(1);
+    }
+    taskWait.kept = ulTaskNotifyTake(pdTRUE, 0);
+    transfersDone = false;
+    vTaskDelete(nullptr);
+}
+
+void runTaskWait(uint32_t bursts) {
+    taskBursts = bursts;
+    TaskHandle_t task = nullptr;
+    xTaskCreate(transferTask, "i2c", 4096, nullptr, 2, &task);
+    while (!transfersDone) {
+        xTaskNotifyGive(task);
+        taskWait.given++;
+        delay(1);
+    }
+    givesDone = true;
+    while (transfersDone) {
+        delay(1);
+    }
+}
+
+Timing timeAsync(uint32_t bursts) {
+    Timing stall = {};
+    static I2CTransaction burst;
+    setBurst(burst);
+    burst.onComplete = onBurst;
+    for (uint32_t i = 0; i < bursts; i++) {
+        uint32_t start = micros();
+        submittedAt = start;
+        failures += !I2CEngine::submit(burst);
+        stall.add(micros() - start);
+        delay(1);
+        while (burst.isPending()) {
+            delay(1);
+        }
+    }
+    return stall;
+}
+
+// Order and data: writes to scratch registers, each followed by a read-back
+struct OrderResult {
+    uint32_t outOfOrder;
+    uint32_t wrongValues;
+    bool overflowRefused;
+};
+
+// A submit to the idle bus starts at once, so one more than the queue holds
+constexpr uint8_t ORDERED = I2C_QUEUE_DEPTH + 1;
+
+uint8_t completionOrder[ORDERED];
+uint8_t completions;
+
+void onOrdered(I2CTransaction& transaction, bool ok) {
+    completionOrder[completions++] = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(transaction.context));
+    failures += !ok;
+}
+
+OrderResult checkOrder() {
+    OrderResult result = {};
+    static I2CTransaction transactions[ORDERED + 1];
+    static uint8_t writes[ORDERED][2];
+    static uint8_t readRegisters[ORDERED];
+    static uint8_t readValues[ORDERED];
+    completions = 0;
+
+    // Queue everything before the bus can drain much of it
+    for (uint8_t i = 0; i < ORDERED; i++) {
+        I2CTransaction& transaction = transactions[i];
+        uint8_t reg = SCRATCH_REGISTER + i / 2;
+        transaction.address = IMU_ADDRESS;
+        transaction.onComplete = onOrdered;
+        transaction.context = reinterpret_cast<void*>(static_cast<uintptr_t>(i));
+        if (i % 2 == 0) {
+            writes[i][0] = reg;
+            writes[i][1] = static_cast<uint8_t>(0xA0 + i);
+            transaction.writeData = writes[i];
+            transaction.writeLength = 2;
+        } else {
+            readRegisters[i] = reg;
+            transaction.writeData = &readRegisters[i];
+            transaction.writeLength = 1;
+            transaction.readData = &readValues[i];
+            transaction.readLength = 1;
+        }
+        failures += !I2CEngine::submit(transaction);
+    }
+    // The bus is still on the first of them
+    transactions[ORDERED].address = IMU_ADDRESS;
+    result.overflowRefused = !I2CEngine::submit(transactions[ORDERED]);
+
+    while (!I2CEngine::isIdle()) {
+        delay(1);
+    }
+    for (uint8_t i = 0; i < ORDERED; i++) {
+        result.outOfOrder += i >= completions || completionOrder[i] != i;
+        if (i % 2 == 1) {
+            result.wrongValues += readValues[i] != 0xA0 + i - 1;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t bursts = 200;
+    uint32_t latencyUs = 100;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bursts") == 0 && i + 1 < argc) {
+            bursts = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--latency-us") == 0 && i + 1 < argc) {
+            latencyUs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_i2c [--bursts N] [--latency-us N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Host::setI2CDeviceLatency(0, IMU_ADDRESS, latencyUs);
+    bool running = I2CEngine::init();
+
+    Timing blocking = timeBlocking(bursts);
+    runTaskWait(bursts);
+    Timing async = timeAsync(bursts);
+    OrderResult order = checkOrder();
+    uint32_t rejected = I2CEngine::getRejectedCount();
+
+    printf("IMU bursts of %u bytes at %u Hz, %u us device latency\n", BURST_BYTES, I2C_CLOCK_HZ, latencyUs);
+    printf("  %-22s %10s %10s\n", "caller stall", "mean us", "max us");
+    printf("  %-22s %10.1f %10u\n", "blocking transfer", blocking.mean(), blocking.maxUs);
+    printf("  %-22s %10.1f %10u\n", "task transfer", taskWait.stall.mean(), taskWait.stall.maxUs);
+    printf("  %-22s %10.1f %10u\n", "async submit", async.mean(), async.maxUs);
+    printf("  %-22s %10.1f %10u\n", "submit to callback", completion.mean(), completion.maxUs);
+    printf("  task notifications: %u given, %u kept\n", taskWait.given, taskWait.kept);
+    printf("  ordering: %u out of order, %u wrong values, overflow %s\n", order.outOfOrder, order.wrongValues,
+           order.overflowRefused ? "refused" : "ACCEPTED");
+    printf("  completed %u, failed %u, rejected %u\n", I2CEngine::getCompletedCount(), I2CEngine::getFailedCount(),
+           rejected);
+
+    printf("RESULT i2c blocking_us=%.1f submit_us=%.1f callback_us=%.1f out_of_order=%u wrong=%u failures=%u\n",
+           blocking.mean(), async.mean(), completion.mean(), order.outOfOrder, order.wrongValues, failures);
+
+    bool ok = running && failures == 0 && completion.count == bursts && order.outOfOrder == 0 &&
+              order.wrongValues == 0 && order.overflowRefused && rejected == 1 &&
+              taskWait.stall.count == bursts && taskWait.kept == taskWait.given &&
+              async.mean() * 10 < blocking.mean();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/*
+ * B.I.T.E.S - IMU Sampling Benchmark
+ *
+ * Boots the system with an MPU6050 channel and counts I2C bursts to the IMU
+ * while another thread plays the consumers that used to read it on their
+ * own: sensor fusion (every getter) and gesture feature
+ * extraction, at the sensor rate. The simulated IMU steps its accel and gyro
+ * readings on every burst, so each sample in the ring can be told apart;
+ * the consumer checks that accel and gyro always come from the same sample
+ * and that the ring hands out samples in order with rising timestamps.
+ *
+ * Usage: bench_imu [--duration-ms N]
+ * The exit code is non-zero if the IMU is read more than once per sensor
+ * tick, a read mixes two samples, or the ring returns samples out of order.
+ * The "before" figure is what the same run would have cost with two bursts
+ * per tick in the sensor task and one per consumer read.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/task_manager.h"
+#include "sensors/mpu6050_driver.h"
+#include "sensors/sensor_fusion.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/tasks.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::TaskId;
+using Core::TaskManager;
+using Sensors::MPU6050Data;
+using Sensors::MPU6050Driver;
+using Sensors::SensorFusion;
+using Sensors::SensorManager;
+
+namespace {
+
+constexpr uint8_t IMU_ID = 0;
+constexpr uint32_t SAMPLE_WRAP = 1000;
+// Bus reads per round before: fusion update, five fusion getters and one
+// gesture feature read
+constexpr uint32_t READS_PER_ROUND = 7;
+
+// Every burst reads a new step: accel X of n / 1000 g, gyro X of n / 10 °/s
+class SteppingMPU6050 : public Host::SimulatedMPU6050 {
+public:
+    uint8_t readRegister(uint8_t reg) override {
+        if (reg == MPU6050_ACCEL_XOUT_H) {
+            step = (step + 1) % SAMPLE_WRAP;
+            setAccel(step / 1000.0f, 0.0f, 1.0f);
+            setGyro(step / 10.0f, 0.0f, 0.0f);
+        }
+        return SimulatedMPU6050::readRegister(reg);
+    }
+
+private:
+    static constexpr uint8_t MPU6050_ACCEL_XOUT_H = 0x3B;
+    uint32_t step = 0;
+};
+
+uint32_t accelStep(const MPU6050Data& data) {
+    return static_cast<uint32_t>(lroundf(data.accelX * 1000.0f)) % SAMPLE_WRAP;
+}
+
+uint32_t gyroStep(const MPU6050Data& data) {
+    return static_cast<uint32_t>(lroundf(data.gyroX * 10.0f)) % SAMPLE_WRAP;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_imu [--duration-ms N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    static SteppingMPU6050 imu;
+    Host::attachI2CDevice(0, MPU6050_I2C_ADDRESS, &imu);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    SensorManager::registerSensor(Sensors::SensorType::MPU6050, IMU_ID, 0);
+    RTOS::setEventDriven(false);
+    delay(50);
+
+    const MPU6050Driver& driver = MPU6050Driver::get(0);
+    const Core::TaskTiming& sensor = TaskManager::getTaskTiming(TaskId::SENSOR);
+    uint32_t startTicks = sensor.activations;
+    uint32_t startBursts = imu.getBurstReadCount();
+    uint32_t startSamples = driver.getSampleCount();
+    uint32_t nextSample = startSamples;
+
+    uint32_t rounds = 0;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t ringSamples = 0;
+    uint32_t lastStep = 0;
+    uint32_t lastTimestamp = 0;
+    bool haveLast = false;
+    uint32_t start = millis();
+    while (millis() - start < durationMs) {
+        // Consumers as they run in the AI and network tasks; fusion itself
+        // now runs in the sensor task
+        volatile float sink = SensorFusion::getRoll() + SensorFusion::getPitch() + SensorFusion::getYaw() +
+                              SensorFusion::getAccelMagnitude() + SensorFusion::getGyroMagnitude();
+        (void)sink;
+        MPU6050Data latest = driver.readAll();
+        torn += accelStep(latest) != gyroStep(latest);
+        rounds++;
+
+        // Windowed readers walk the ring
+        MPU6050Data block[IMU_RING_SAMPLES];
+        uint8_t count = driver.readSamples(nextSample, block, IMU_RING_SAMPLES);
+        nextSample += count;
+        for (uint8_t i = 0; i < count; i++) {
+            uint32_t step = accelStep(block[i]);
+            torn += step != gyroStep(block[i]);
+            if (haveLast) {
+                uint32_t advance = (step + SAMPLE_WRAP - lastStep) % SAMPLE_WRAP;
+                outOfOrder += advance == 0 || advance > SAMPLE_WRAP / 2 ||
+                              static_cast<int32_t>(block[i].timestamp - lastTimestamp) < 0;
+            }
+            lastStep = step;
+            lastTimestamp = block[i].timestamp;
+            haveLast = true;
+        }
+        ringSamples += count;
+        delay(1);
+    }
+
+    uint32_t ticks = sensor.activations - startTicks;
+    uint32_t bursts = imu.getBurstReadCount() - startBursts;
+    uint32_t samples = driver.getSampleCount() - startSamples;
+    uint32_t consumerReads = rounds * READS_PER_ROUND;
+    uint32_t before = 2 * ticks + consumerReads;
+
+    printf("IMU sampling over %u ms, %u sensor ticks, %u consumer rounds\n", durationMs, ticks, rounds);
+    printf("  I2C bursts          %8u (%.2f per tick)\n", bursts, ticks ? bursts / (double)ticks : 0.0);
+    printf("  before              %8u (2 per tick + %u consumer reads), %.1fx\n", before, consumerReads,
+           bursts ? before / (double)bursts : 0.0);
+    printf("  new samples         %8u (%u read from the ring)\n", samples, ringSamples);
+    printf("  torn reads          %8u\n", torn);
+    printf("  out of order        %8u\n", outOfOrder);
+
+    printf("RESULT imu ticks=%u bursts=%u before=%u samples=%u torn=%u out_of_order=%u\n", ticks, bursts, before,
+           samples, torn, outOfOrder);
+
+    bool ok = ticks > 0 && bursts <= ticks + 1 && samples > 0 && samples <= bursts && torn == 0 &&
+              outOfOrder == 0 && ringSamples > 0;
+    return ok ? 0 : 1;
+}
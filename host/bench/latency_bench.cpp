@@ -0,0 +1,581 @@
+/*
+ * B.I.T.E.S - Trigger-to-Sound Latency Benchmark
+ *
+ * Replays a timestamped sensor trace through the firmware trigger path on
+ * the virtual clock and reports latency from the sensor sample that crosses
+ * the trigger threshold to the first non-silent output sample.
+ *
+ * Pipeline model (all periods as configured in rtos/tasks.cpp):
+ *   sensor tick  1 ms   SensorManager::update()
+ *   audio tick   2 ms   instrument update() -> handleSensorInput() ->
+ *                       AudioManager::playNote(), then AudioManager::update()
+ *   audio block  128 samples at 44.1 kHz, one update pass of the audio graph;
+ *                a rendered block reaches the codec one block later (I2S DMA
+ *                double buffering)
+ * Events due at the same instant run in the order trace, sensor tick, audio
+ * tick, audio block.
+ *
+ * Trace format (text, '#' starts a comment):
+ *   <time_us> piezo|pressure <channel> <adc counts>
+ *   <time_us> ir <channel> <pin level 0|1>
+ *   <time_us> imu <channel> <ax> <ay> <az> <gx> <gy> <gz>   (g, deg/s)
+ * Channels are the instrument's sensor ids; values hold until the next line.
+ *
+ * Usage:
+ *   bench_latency [--instrument drums|bass|guitar|keyboard|all] [--hits N]
+ *                 [--seed S] [--trace FILE] [--write-trace FILE]
+ *                 [--budget-us US]
+ * Without --trace a synthetic trace is generated per instrument. With
+ * --budget-us the exit code is non-zero if any total latency exceeds it.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "audio/audio_manager.h"
+#include "audio/sample_manager.h"
+#include "instruments/bass_guitar.h"
+#include "instruments/drums.h"
+#include "instruments/guitar.h"
+#include "instruments/keyboard.h"
+#include "rtos/semaphores.h"
+#include "sensors/sensor_manager.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace BITS;
+
+namespace {
+
+constexpr uint32_t SENSOR_TICK_US = 1000;
+constexpr uint32_t AUDIO_TICK_US = 2000;
+constexpr double SAMPLE_US = 1000000.0 / AUDIO_SAMPLE_RATE_EXACT;
+constexpr double BLOCK_US = AUDIO_BLOCK_SAMPLES * SAMPLE_US;
+constexpr uint32_t STAGE_TIMEOUT_US = 50000;
+constexpr uint8_t CLICK_TRACK = 0;
+constexpr uint8_t CLICK_FIRST_NOTE = 21;   // A0
+constexpr uint8_t CLICK_LAST_NOTE = 108;   // C8
+
+enum class Kind { PIEZO, PRESSURE, IR, IMU };
+
+struct TraceEvent {
+    uint64_t timeUs;
+    Kind kind;
+    uint8_t channel;
+    float values[6];
+};
+
+struct Scenario {
+    const char* name;
+    Kind kind;
+    uint8_t channels;
+    uint8_t firstPin;       // pin of channel 0, as assigned by the instrument's init()
+};
+
+const Scenario SCENARIOS[] = {
+    {"drums", Kind::PIEZO, 8, A0},
+    {"bass", Kind::PIEZO, 4, A0},
+    {"guitar", Kind::IR, 6, 2},
+    {"keyboard", Kind::PRESSURE, 4, A10},
+};
+
+const char* kindName(Kind kind) {
+    switch (kind) {
+        case Kind::PIEZO: return "piezo";
+        case Kind::PRESSURE: return "pressure";
+        case Kind::IR: return "ir";
+        case Kind::IMU: return "imu";
+    }
+    return "?";
+}
+
+std::unique_ptr<Instruments::BaseInstrument> createInstrument(const Scenario& scenario) {
+    std::string name = scenario.name;
+    if (name == "drums") {
+        auto drums = std::make_unique<Instruments::Drums>();
+        drums->setPadCount(scenario.channels);
+        return drums;
+    }
+    if (name == "bass") {
+        auto bass = std::make_unique<Instruments::BassGuitar>();
+        bass->setStringCount(scenario.channels);
+        return bass;
+    }
+    if (name == "guitar") {
+        auto guitar = std::make_unique<Instruments::Guitar>();
+        guitar->setStringCount(scenario.channels);
+        return guitar;
+    }
+    auto keyboard = std::make_unique<Instruments::Keyboard>();
+    keyboard->setKeyCount(scenario.channels);
+    return keyboard;
+}
+
+// Trace I/O
+
+std::vector<TraceEvent> generateTrace(const Scenario& scenario, uint32_t hits, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> spacing(15000, 30000);
+    std::uniform_int_distribution<int> counts(300, 1000);
+    std::uniform_int_distribution<int> pressCounts(500, 1000);
+    std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+    std::vector<TraceEvent> trace;
+
+    uint64_t t = 10000;
+    uint8_t channel = 0;
+    for (uint32_t hit = 0; hit < hits; hit++) {
+        // Round-robin keeps re-strikes of a channel outside the debounce window
+        channel = (channel + 1) % scenario.channels;
+        switch (scenario.kind) {
+            case Kind::PIEZO: {
+                // Strike: step to peak, exponential decay sampled every 250 us
+                float value = static_cast<float>(counts(rng));
+                for (uint64_t dt = 0; value >= 20.0f; dt += 250, value *= 0.6f) {
+                    trace.push_back({t + dt, Kind::PIEZO, channel, {value}});
+                }
+                trace.push_back({t + 2500, Kind::PIEZO, channel, {0.0f}});
+                break;
+            }
+            case Kind::PRESSURE:
+                trace.push_back({t, Kind::PRESSURE, channel, {static_cast<float>(pressCounts(rng))}});
+                trace.push_back({t + 40000, Kind::PRESSURE, channel, {0.0f}});
+                break;
+            case Kind::IR:
+                trace.push_back({t, Kind::IR, channel, {0.0f}});
+                trace.push_back({t + 8000, Kind::IR, channel, {1.0f}});
+                break;
+            case Kind::IMU:
+                break;
+        }
+        t += spacing(rng);
+    }
+
+    // Background IMU motion at 1 kHz
+    for (uint64_t imuTime = 0; imuTime < t; imuTime += 1000) {
+        trace.push_back({imuTime, Kind::IMU, 0,
+                         {noise(rng), noise(rng), 1.0f + noise(rng),
+                          noise(rng) * 100.0f, noise(rng) * 100.0f, noise(rng) * 100.0f}});
+    }
+
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.timeUs < b.timeUs;
+    });
+    return trace;
+}
+
+bool parseKind(const char* name, Kind& kind) {
+    for (Kind k : {Kind::PIEZO, Kind::PRESSURE, Kind::IR, Kind::IMU}) {
+        if (strcmp(name, kindName(k)) == 0) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadTrace(const char* path, std::vector<TraceEvent>& trace) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open trace %s\n", path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        unsigned long long timeUs;
+        char kindText[16];
+        unsigned channel;
+        TraceEvent event = {};
+        int n = sscanf(line, "%llu %15s %u %f %f %f %f %f %f", &timeUs, kindText, &channel,
+                       &event.values[0], &event.values[1], &event.values[2],
+                       &event.values[3], &event.values[4], &event.values[5]);
+        if (n <= 0) {
+            continue;
+        }
+        if (n < 4 || !parseKind(kindText, event.kind) || (event.kind == Kind::IMU && n < 9)) {
+            fprintf(stderr, "%s:%d: malformed trace line\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+        event.timeUs = timeUs;
+        event.channel = static_cast<uint8_t>(channel);
+        trace.push_back(event);
+    }
+    fclose(file);
+
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.timeUs < b.timeUs;
+    });
+    return true;
+}
+
+bool writeTrace(const char* path, const Scenario& scenario, const std::vector<TraceEvent>& trace) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot write trace %s\n", path);
+        return false;
+    }
+    fprintf(file, "# B.I.T.E.S sensor trace (%s)\n# time_us kind channel values...\n", scenario.name);
+    for (const TraceEvent& event : trace) {
+        fprintf(file, "%llu %s %u", static_cast<unsigned long long>(event.timeUs),
+                kindName(event.kind), event.channel);
+        int count = event.kind == Kind::IMU ? 6 : 1;
+        for (int i = 0; i < count; i++) {
+            fprintf(file, " %g", event.values[i]);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return true;
+}
+
+// Measurement
+
+struct Onset {
+    uint8_t channel;
+    double sampleUs;
+    double detectUs;
+    double playUs;
+    double outputUs;
+};
+
+struct Stats {
+    double p50;
+    double p99;
+    double max;
+    double mean;
+};
+
+Stats computeStats(std::vector<double> values) {
+    Stats stats = {0.0, 0.0, 0.0, 0.0};
+    if (values.empty()) {
+        return stats;
+    }
+    std::sort(values.begin(), values.end());
+    auto rank = [&](double p) {
+        size_t index = static_cast<size_t>(p * values.size() + 0.999999);
+        return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+    };
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    stats.p50 = rank(0.50);
+    stats.p99 = rank(0.99);
+    stats.max = values.back();
+    stats.mean = sum / values.size();
+    return stats;
+}
+
+// Threshold in ADC counts equivalent to the driver's threshold, for onset
+// detection in the trace (conversions as in PiezoDriver/PressureDriver::read)
+float thresholdCounts(const Scenario& scenario, uint8_t channel) {
+    float threshold = Sensors::SensorManager::getThreshold(channel);
+    if (scenario.kind == Kind::PIEZO) {
+        return threshold / 3300.0f * 4095.0f;
+    }
+    return threshold / 5.0f * 4095.0f;
+}
+
+struct Result {
+    uint32_t onsets = 0;
+    uint32_t missedSensor = 0;
+    uint32_t missedDispatch = 0;
+    uint32_t missedOutput = 0;
+    std::vector<Onset> completed;
+};
+
+Result runScenario(const Scenario& scenario, const std::vector<TraceEvent>& trace) {
+    Result result;
+    auto instrument = createInstrument(scenario);
+    instrument->init();
+
+    // Pressure driver's default threshold (100 V) is never reached; use the
+    // value calibration would typically produce
+    if (scenario.kind == Kind::PRESSURE) {
+        for (uint8_t channel = 0; channel < scenario.channels; channel++) {
+            Sensors::SensorManager::setThreshold(channel, 0.5f);
+        }
+    }
+
+    int firstNonSilent = -1;
+    Host::setAudioSink([&](const int16_t* left, const int16_t*, size_t samples) {
+        for (size_t i = 0; i < samples && firstNonSilent < 0; i++) {
+            if (left[i] != 0) firstNonSilent = static_cast<int>(i);
+        }
+    });
+
+    std::vector<float> lastValue(scenario.channels, scenario.kind == Kind::IR ? 1.0f : 0.0f);
+    std::deque<Onset> waitingDetect;
+    std::deque<Onset> waitingDispatch;
+    std::deque<Onset> waitingOutput;
+
+    const uint64_t base = Host::nowMicros();
+    const uint64_t end = (trace.empty() ? 0 : trace.back().timeUs) + STAGE_TIMEOUT_US;
+    uint64_t now = 0;
+    uint64_t nextSensor = 0;
+    uint64_t nextAudio = 0;
+    uint64_t block = 0;
+    size_t next = 0;
+
+    while (now <= end) {
+        uint64_t nextBlock = static_cast<uint64_t>(block * BLOCK_US);
+        uint64_t due = std::min({nextSensor, nextAudio, nextBlock});
+        if (next < trace.size()) {
+            due = std::min(due, trace[next].timeUs);
+        }
+        Host::advanceTime(static_cast<uint32_t>(base + due - Host::nowMicros()));
+        now = due;
+
+        // Trace samples
+        while (next < trace.size() && trace[next].timeUs == now) {
+            const TraceEvent& event = trace[next++];
+            if (event.kind == Kind::IMU) {
+                Host::defaultMPU6050().setAccel(event.values[0], event.values[1], event.values[2]);
+                Host::defaultMPU6050().setGyro(event.values[3], event.values[4], event.values[5]);
+                continue;
+            }
+            if (event.kind != scenario.kind || event.channel >= scenario.channels) {
+                continue;
+            }
+            uint8_t pin = scenario.firstPin + event.channel;
+            bool onset;
+            if (event.kind == Kind::IR) {
+                Host::setDigitalValue(pin, event.values[0] != 0.0f);
+                onset = lastValue[event.channel] != 0.0f && event.values[0] == 0.0f;
+            } else {
+                Host::setAnalogValue(pin, static_cast<int>(event.values[0]));
+                float threshold = thresholdCounts(scenario, event.channel);
+                onset = lastValue[event.channel] <= threshold && event.values[0] > threshold;
+            }
+            lastValue[event.channel] = event.values[0];
+            if (onset) {
+                // A new onset supersedes one still waiting on the same channel
+                for (auto it = waitingDetect.begin(); it != waitingDetect.end();) {
+                    if (it->channel == event.channel) {
+                        it = waitingDetect.erase(it);
+                        result.missedSensor++;
+                    } else {
+                        ++it;
+                    }
+                }
+                waitingDetect.push_back({event.channel, static_cast<double>(now), 0.0, 0.0, 0.0});
+                result.onsets++;
+            }
+        }
+
+        // Sensor tick
+        if (now == nextSensor) {
+            Sensors::SensorManager::update();
+            for (auto it = waitingDetect.begin(); it != waitingDetect.end();) {
+                if (Sensors::SensorManager::getSensorData(it->channel).triggered) {
+                    it->detectUs = static_cast<double>(now);
+                    waitingDispatch.push_back(*it);
+                    it = waitingDetect.erase(it);
+                } else if (now - it->sampleUs > STAGE_TIMEOUT_US) {
+                    it = waitingDetect.erase(it);
+                    result.missedSensor++;
+                } else {
+                    ++it;
+                }
+            }
+            nextSensor += SENSOR_TICK_US;
+        }
+
+        // Audio tick: notes started by this update belong to the oldest
+        // detected onsets; detections the instrument did not act on are lost
+        if (now == nextAudio) {
+            uint32_t before = Audio::SampleManager::getNotesPlayed();
+            instrument->update();
+            Audio::AudioManager::update();
+            uint32_t started = Audio::SampleManager::getNotesPlayed() - before;
+            while (!waitingDispatch.empty()) {
+                Onset onset = waitingDispatch.front();
+                waitingDispatch.pop_front();
+                if (started > 0) {
+                    onset.playUs = static_cast<double>(now);
+                    waitingOutput.push_back(onset);
+                    started--;
+                } else {
+                    result.missedDispatch++;
+                }
+            }
+            nextAudio += AUDIO_TICK_US;
+        }
+
+        // Audio block
+        if (now == nextBlock) {
+            firstNonSilent = -1;
+            Host::renderAudioBlock();
+            if (firstNonSilent >= 0) {
+                double outputUs = (block + 1) * BLOCK_US + firstNonSilent * SAMPLE_US;
+                while (!waitingOutput.empty()) {
+                    Onset onset = waitingOutput.front();
+                    waitingOutput.pop_front();
+                    onset.outputUs = outputUs;
+                    result.completed.push_back(onset);
+                }
+            }
+            while (!waitingOutput.empty() && now - waitingOutput.front().playUs > STAGE_TIMEOUT_US) {
+                waitingOutput.pop_front();
+                result.missedOutput++;
+            }
+            block++;
+        }
+    }
+
+    result.missedSensor += waitingDetect.size();
+    result.missedDispatch += waitingDispatch.size();
+    result.missedOutput += waitingOutput.size();
+
+    // Leave the engine idle for the next scenario
+    Host::setAudioSink(nullptr);
+    Audio::AudioManager::stopAll();
+    for (uint8_t id = 0; id < MAX_SENSORS; id++) {
+        Sensors::SensorManager::unregisterSensor(id);
+    }
+    for (uint8_t channel = 0; channel < scenario.channels; channel++) {
+        Host::setAnalogValue(scenario.firstPin + channel, 0);
+        Host::setDigitalValue(scenario.firstPin + channel, HIGH);
+    }
+    return result;
+}
+
+double report(const Scenario& scenario, const Result& result) {
+    std::vector<double> sensor, dispatch, block, total;
+    for (const Onset& onset : result.completed) {
+        sensor.push_back(onset.detectUs - onset.sampleUs);
+        dispatch.push_back(onset.playUs - onset.detectUs);
+        block.push_back(onset.outputUs - onset.playUs);
+        total.push_back(onset.outputUs - onset.sampleUs);
+    }
+
+    uint32_t missed = result.missedSensor + result.missedDispatch + result.missedOutput;
+    printf("%s (%s, %u channels): %u onsets, %zu sounded, %u missed "
+           "(sensor %u, dispatch %u, output %u)\n",
+           scenario.name, kindName(scenario.kind), scenario.channels, result.onsets,
+           result.completed.size(), missed, result.missedSensor, result.missedDispatch,
+           result.missedOutput);
+    printf("  %-26s %9s %9s %9s %9s\n", "stage", "p50 us", "p99 us", "max us", "mean us");
+
+    const struct {
+        const char* name;
+        const std::vector<double>& values;
+    } stages[] = {
+        {"sensor tick (1 ms)", sensor},
+        {"audio tick (2 ms)", dispatch},
+        {"audio block + I2S buffer", block},
+        {"total", total},
+    };
+    Stats totalStats = {};
+    for (const auto& stage : stages) {
+        Stats stats = computeStats(stage.values);
+        printf("  %-26s %9.0f %9.0f %9.0f %9.0f\n", stage.name, stats.p50, stats.p99, stats.max, stats.mean);
+        totalStats = stats;
+    }
+
+    // Single line for tracking across commits
+    printf("RESULT latency %s p50_us=%.0f p99_us=%.0f max_us=%.0f sounded=%zu missed=%u\n\n",
+           scenario.name, totalStats.p50, totalStats.p99, totalStats.max,
+           result.completed.size(), missed);
+    return totalStats.max;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: bench_latency [--instrument drums|bass|guitar|keyboard|all] [--hits N]\n"
+            "                     [--seed S] [--trace FILE] [--write-trace FILE] [--budget-us US]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* instrumentName = "all";
+    const char* tracePath = nullptr;
+    const char* writePath = nullptr;
+    uint32_t hits = 500;
+    uint32_t seed = 1;
+    double budgetUs = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--instrument") == 0 && hasValue) {
+            instrumentName = argv[++i];
+        } else if (strcmp(argv[i], "--hits") == 0 && hasValue) {
+            hits = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--write-trace") == 0 && hasValue) {
+            writePath = argv[++i];
+        } else if (strcmp(argv[i], "--budget-us") == 0 && hasValue) {
+            budgetUs = strtod(argv[++i], nullptr);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    std::vector<const Scenario*> selected;
+    for (const Scenario& scenario : SCENARIOS) {
+        if (strcmp(instrumentName, "all") == 0 || strcmp(instrumentName, scenario.name) == 0) {
+            selected.push_back(&scenario);
+        }
+    }
+    if (selected.empty() || ((tracePath || writePath) && selected.size() != 1)) {
+        fprintf(stderr, "--trace and --write-trace need a single --instrument\n");
+        usage();
+        return 2;
+    }
+
+    // Engine bring-up, quietly and on the virtual clock
+    Host::setSerialEnabled(false);
+    Host::useVirtualTime(true);
+    RTOS::createSemaphores();
+    Sensors::SensorManager::init();
+    Audio::AudioManager::init();
+
+    // Every note gets a short click so the first output sample is non-silent
+    static int16_t click[64];
+    for (int i = 0; i < 64; i++) {
+        click[i] = static_cast<int16_t>((i % 2 ? -20000 : 20000) * (64 - i) / 64);
+    }
+    for (int note = CLICK_FIRST_NOTE; note <= CLICK_LAST_NOTE; note++) {
+        Audio::SampleManager::loadSample(CLICK_TRACK, note, click, 64);
+    }
+
+    bool overBudget = false;
+    for (const Scenario* scenario : selected) {
+        std::vector<TraceEvent> trace;
+        if (tracePath) {
+            if (!loadTrace(tracePath, trace)) {
+                return 1;
+            }
+        } else {
+            trace = generateTrace(*scenario, hits, seed);
+        }
+        if (writePath && !writeTrace(writePath, *scenario, trace)) {
+            return 1;
+        }
+
+        Result result = runScenario(*scenario, trace);
+        double maxUs = report(*scenario, result);
+        if (budgetUs > 0.0 && maxUs > budgetUs) {
+            printf("FAIL %s: max latency %.0f us exceeds budget %.0f us\n\n", scenario->name, maxUs, budgetUs);
+            overBudget = true;
+        }
+    }
+
+    return overBudget ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * B.I.T.E.S - Logger Benchmark
+ *
+ * Measures what a log call costs the calling task: immediate mode formats
+ * and writes the line in the caller, deferred mode only copies the format ID
+ * and arguments into the log ring. The drain (formatting off the hot path)
+ * is timed separately, as are bytes per record for text and binary output.
+ *
+ * It also checks that both modes reproduce snprintf for the format patterns
+ * the engine uses, long strings included, and that a deferred string too
+ * long for the record ends in "...".
+ *
+ * Usage: bench_log [--calls N] [--binary FILE]
+ * --binary writes a short binary log that tools/log_decoder.py can read.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/logger.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using namespace BITS;
+using Core::Logger;
+using Core::LogOutput;
+
+namespace {
+
+constexpr uint32_t DRAIN_EVERY = 32;
+
+std::string captured;
+size_t capturedBytes = 0;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Message text of the last captured line, without "[LEVEL] Nms: " and CRLF
+std::string lastMessage() {
+    size_t start = captured.find("ms: ");
+    size_t end = captured.find('\r');
+    if (start == std::string::npos || end == std::string::npos) {
+        return captured;
+    }
+    return captured.substr(start + 4, end - start - 4);
+}
+
+template <typename... Args>
+bool check(const char* expected, const char* format, Args... args) {
+    captured.clear();
+    Logger::info(format, args...);
+    Logger::flush();
+    std::string actual = lastMessage();
+    bool match = actual == expected;
+    if (!match) {
+        printf("  MISMATCH %-28s expected \"%s\" got \"%s\"\n", format, expected, actual.c_str());
+    }
+    return match;
+}
+
+bool checkFormatting() {
+    char expected[256];
+    bool ok = true;
+    uint32_t baud = 115200;
+    int32_t negative = -42;
+    float voltage = 3.14159f;
+    uint8_t address = 0x68;
+    int64_t wide = -1234567890123LL;
+
+    snprintf(expected, sizeof(expected), "Logger initialized at %lu baud", static_cast<unsigned long>(baud));
+    ok = check(expected, "Logger initialized at %lu baud", baud) && ok;
+    snprintf(expected, sizeof(expected), "Piezo sensor %d initialized on GPIO %d", 3, 14);
+    ok = check(expected, "Piezo sensor %d initialized on GPIO %d", 3, 14) && ok;
+    snprintf(expected, sizeof(expected), "Offset %d", negative);
+    ok = check(expected, "Offset %d", negative) && ok;
+    snprintf(expected, sizeof(expected), "Piezo sensor value: %.2f mV", voltage);
+    ok = check(expected, "Piezo sensor value: %.2f mV", voltage) && ok;
+    snprintf(expected, sizeof(expected), "I2C device at 0x%02X", address);
+    ok = check(expected, "I2C device at 0x%02X", address) && ok;
+    snprintf(expected, sizeof(expected), "CPU %5.1f%% on %s", 12.5, "AudioTask");
+    ok = check(expected, "CPU %5.1f%% on %s", 12.5, "AudioTask") && ok;
+    snprintf(expected, sizeof(expected), "Wide %lld", static_cast<long long>(wide));
+    ok = check(expected, "Wide %lld", wide) && ok;
+    snprintf(expected, sizeof(expected), "Chord: %s (%-6s|%4u)", "Cmaj7", "left", 7u);
+    ok = check(expected, "Chord: %s (%-6s|%4u)", "Cmaj7", "left", 7u) && ok;
+    ok = check("Sample: kick", "%s", String("Sample: kick").c_str()) && ok;
+
+    // As long as MQTT messages and network reports get
+    const char* topic = "bits/instruments/drums/pads/12/velocity";
+    const char* payload = "{\"value\": 0.82, \"sensor\": 12, \"timestamp\": 1234567}";
+    snprintf(expected, sizeof(expected), "MQTT %s = %s", topic, payload);
+    ok = check(expected, "MQTT %s = %s", topic, payload) && ok;
+    snprintf(expected, sizeof(expected), "Connected to %s, IP %s", "BITS-Stage-Network-5G-Backline", "192.168.100.200");
+    ok = check(expected, "Connected to %s, IP %s", "BITS-Stage-Network-5G-Backline", "192.168.100.200") && ok;
+    return ok;
+}
+
+// A deferred record keeps what fits of an over-long string and marks the cut
+bool checkTruncation() {
+    std::string text(200, 'x');
+    std::string expected = std::string(Core::LogRecord::TEXT_SIZE - 4, 'x') + "...";
+    return check(expected.c_str(), "%s", text.c_str());
+}
+
+double timeCalls(uint32_t calls, bool drain) {
+    double start = nowNs();
+    for (uint32_t i = 0; i < calls; i++) {
+        Logger::info("Sensor %d triggered, velocity %.2f", static_cast<int>(i & 15), i * 0.01f);
+        if (drain && i % DRAIN_EVERY == DRAIN_EVERY - 1) {
+            // Not part of the caller's cost; subtracted below
+            double drainStart = nowNs();
+            Logger::process();
+            start += nowNs() - drainStart;
+        }
+    }
+    return (nowNs() - start) / calls;
+}
+
+double timeDrain(uint32_t calls) {
+    double total = 0;
+    for (uint32_t i = 0; i < calls; i += DRAIN_EVERY) {
+        for (uint32_t j = 0; j < DRAIN_EVERY; j++) {
+            Logger::info("Sensor %d triggered, velocity %.2f", static_cast<int>(j & 15), j * 0.01f);
+        }
+        double start = nowNs();
+        Logger::process();
+        total += nowNs() - start;
+    }
+    return total / calls;
+}
+
+double bytesPerRecord(LogOutput output, uint32_t records) {
+    Logger::setOutput(output);
+    capturedBytes = 0;
+    for (uint32_t i = 0; i < records; i++) {
+        Logger::info("Sensor %d triggered, velocity %.2f", static_cast<int>(i & 15), i * 0.01f);
+    }
+    Logger::flush();
+    Logger::setOutput(LogOutput::TEXT);
+    return static_cast<double>(capturedBytes) / records;
+}
+
+bool writeBinary(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    Host::setSerialSink([file](const uint8_t* data, size_t length) {
+        fwrite(data, 1, length, file);
+    });
+    Logger::setOutput(LogOutput::BINARY);
+    Logger::info("Logger initialized at %lu baud", 115200UL);
+    for (int i = 0; i < 4; i++) {
+        Logger::info("Sensor %d triggered, velocity %.2f", i, i * 0.25f);
+    }
+    Logger::warning("Sample not found: %s", "snare_02");
+    Logger::error("I2C error %d at 0x%02X", -2, 0x68);
+    Logger::flush();
+    Logger::setOutput(LogOutput::TEXT);
+    fclose(file);
+    printf("Binary log written to %s\n", path);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t calls = 200000;
+    const char* binaryPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc) {
+            calls = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+            binaryPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: bench_log [--calls N] [--binary FILE]\n");
+            return 2;
+        }
+    }
+    calls = (calls + DRAIN_EVERY - 1) / DRAIN_EVERY * DRAIN_EVERY;
+
+    Host::setSerialSink([](const uint8_t* data, size_t length) {
+        captured.append(reinterpret_cast<const char*>(data), length);
+        capturedBytes += length;
+    });
+    Logger::init(SERIAL_BAUD_RATE);
+
+    printf("Immediate and deferred formatting vs snprintf\n");
+    bool ok = checkFormatting();
+    Logger::setDeferred(true);
+    ok = checkFormatting() && ok;
+    ok = checkTruncation() && ok;
+    printf("  %s\n", ok ? "all formats match" : "formatting differs");
+
+    // Keep the capture buffer from growing during the timing runs
+    Host::setSerialSink([](const uint8_t*, size_t length) {
+        capturedBytes += length;
+    });
+
+    Logger::setDeferred(false);
+    double immediateNs = timeCalls(calls, false);
+    Logger::setDeferred(true);
+    double deferredNs = timeCalls(calls, true);
+    double drainNs = timeDrain(calls);
+    double textBytes = bytesPerRecord(LogOutput::TEXT, 64);
+    double binaryBytes = bytesPerRecord(LogOutput::BINARY, 64);
+
+    printf("Caller cost of %u log calls, ns per call\n", calls);
+    printf("  %-12s %12s %12s %9s %12s\n", "immediate", "deferred", "drain", "speedup", "dropped");
+    printf("  %-12.1f %12.1f %12.1f %8.1fx %12u\n", immediateNs, deferredNs, drainNs,
+           immediateNs / deferredNs, Logger::getDroppedCount());
+    printf("Bytes per record: text %.1f, binary %.1f (dictionary amortized over 64)\n",
+           textBytes, binaryBytes);
+    printf("RESULT log immediate_ns=%.1f deferred_ns=%.1f drain_ns=%.1f text_bytes=%.1f binary_bytes=%.1f\n",
+           immediateNs, deferredNs, drainNs, textBytes, binaryBytes);
+
+    if (Logger::getDroppedCount() != 0) {
+        printf("  UNEXPECTED: records dropped with a drain every %u calls\n", DRAIN_EVERY);
+        ok = false;
+    }
+
+    if (binaryPath != nullptr) {
+        ok = writeBinary(binaryPath) && ok;
+    }
+
+    Logger::setDeferred(false);
+    Host::setSerialSink(nullptr);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * B.I.T.E.S - Memory Budget Benchmark
+ *
+ * Boots the system with static allocation, prints the per-subsystem memory
+ * budget, then runs the RTOS tasks while playing notes and moving events
+ * through the bus and counts every heap allocation made meanwhile, from any
+ * thread (global operator new plus the FreeRTOS heap). Finally checks that
+ * a FreeRTOS heap allocation after init trips the violation handler.
+ *
+ * Usage: bench_memory [--duration-ms N]
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/memory_budget.h"
+#include "core/event_queue.h"
+#include "sensors/sensor_manager.h"
+#include "audio/audio_manager.h"
+#include "ai/ai_engine.h"
+#include "network/wifi_manager.h"
+
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+namespace {
+
+std::atomic<uint32_t> allocations{0};
+uint32_t violations = 0;
+
+void countViolation(size_t) {
+    violations++;
+}
+
+size_t freertosHeapUsed() {
+    return configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize();
+}
+
+bool printBudget() {
+    bool ok = true;
+    printf("Static memory per subsystem, bytes\n");
+    for (uint8_t s = 0; s < static_cast<uint8_t>(MemorySubsystem::COUNT); s++) {
+        MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+        size_t reserved = MemoryBudget::getReserved(subsystem);
+        size_t budget = MemoryBudget::getBudget(subsystem);
+        printf("  %-10s %8zu / %8zu%s\n", MemoryBudget::getSubsystemName(subsystem), reserved, budget,
+               reserved > budget ? "  OVER BUDGET" : "");
+        for (uint8_t i = 0; i < MemoryBudget::getReservationCount(); i++) {
+            const Core::MemoryReservation& reservation = MemoryBudget::getReservation(i);
+            if (reservation.subsystem == subsystem) {
+                printf("    %-22s %8zu\n", reservation.name, reservation.bytes);
+            }
+        }
+        ok = ok && reserved <= budget;
+    }
+    printf("  %-10s %8zu\n", "total", MemoryBudget::getTotalReserved());
+    return ok;
+}
+
+} // namespace
+
+// Counts every C++ allocation in the process
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_memory [--duration-ms N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::MPU6050, 0, 0);
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::PIEZO, 1, A0);
+    AI::AIEngine::enableGestureRecognition(true);
+    Network::WiFiManager::startWebServer();
+    Core::SubscriberId subscriber = Core::EventQueue::addSubscriber(Core::ALL_EVENTS);
+
+    bool ok = printBudget();
+    size_t bootHeap = freertosHeapUsed();
+    printf("FreeRTOS heap used at boot: %zu bytes, heap %s\n", bootHeap,
+           MemoryBudget::isHeapLocked() ? "locked" : "open");
+
+    // Steady state: tasks running, notes, events and a web server restart
+    uint32_t allocationsBefore = allocations.load();
+    size_t heapBefore = freertosHeapUsed();
+    uint32_t start = millis();
+    uint32_t notes = 0;
+    while (millis() - start < durationMs) {
+        Audio::AudioManager::playNote(notes % 4, 36 + notes % 12, 0.8f);
+        Core::Event event = {};
+        event.type = Core::EventType::SENSOR_TRIGGERED;
+        event.timestamp = micros();
+        Core::EventQueue::publish(event);
+        while (Core::EventQueue::poll(subscriber, event)) {
+        }
+        if (notes % 50 == 0) {
+            Network::WiFiManager::stopWebServer();
+            Network::WiFiManager::startWebServer();
+        }
+        notes++;
+        delay(5);
+    }
+    uint32_t runtimeAllocations = allocations.load() - allocationsBefore;
+    size_t runtimeHeap = freertosHeapUsed() - heapBefore;
+    printf("After %u ms (%u notes): %u C++ allocations, %zu FreeRTOS heap bytes, %u violations\n",
+           durationMs, notes, runtimeAllocations, runtimeHeap, MemoryBudget::getViolationCount());
+
+    // A dynamic RTOS object after init must be caught
+    MemoryBudget::setViolationHandler(countViolation);
+    SemaphoreHandle_t late = xSemaphoreCreateBinary();
+    MemoryBudget::setViolationHandler(nullptr);
+    if (late != nullptr) {
+        vSemaphoreDelete(late);
+    }
+    printf("Late xSemaphoreCreateBinary: %s\n", violations == 1 ? "caught" : "NOT CAUGHT");
+
+    printf("RESULT memory static_bytes=%zu boot_heap_bytes=%zu runtime_allocs=%u runtime_heap_bytes=%zu "
+           "late_alloc_caught=%d\n",
+           MemoryBudget::getTotalReserved(), bootHeap, runtimeAllocations, runtimeHeap, violations == 1);
+
+    ok = ok && MemoryBudget::isHeapLocked() && runtimeAllocations == 0 && runtimeHeap == 0 && violations == 1;
+    return ok ? 0 : 1;
+}
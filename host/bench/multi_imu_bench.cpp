@@ -0,0 +1,145 @@
+/*
+ * B.I.T.E.S - Multi-IMU Benchmark
+ *
+ * Attaches four simulated MPU6050s where the driver expects them (0x68 and
+ * 0x69 on Wire and Wire1), each with its own accel and gyro reading, and
+ * brings them up one, two and four at a time. For each set, times a round
+ * of MPU6050Driver::pollAll() from the submit until every burst has
+ * completed, against one IMU's round times the number of IMUs, which is
+ * what reading them one after another on a single bus costs. Then checks
+ * that every sample in each IMU's ring is that IMU's reading, and that
+ * SensorFusion reports each IMU's own values.
+ *
+ * Usage: bench_multi_imu [--rounds N]
+ * The exit code is non-zero if an IMU fails to come up or has no samples,
+ * a sample or fused value belongs to another IMU, or two or four IMUs
+ * take as long as reading them one after another.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "sensors/i2c_engine.h"
+#include "sensors/mpu6050_driver.h"
+#include "sensors/sensor_fusion.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::I2CEngine;
+using Sensors::MPU6050Data;
+using Sensors::MPU6050Driver;
+using Sensors::SensorFusion;
+
+namespace {
+
+constexpr uint8_t SETS = 3;
+const uint8_t setSizes[SETS] = {1, 2, 4};
+
+// IMU n reads accel X of (n + 1) / 10 g and gyro X of (n + 1) * 10 °/s
+float accelOf(uint8_t imu) {
+    return (imu + 1) / 10.0f;
+}
+
+float gyroOf(uint8_t imu) {
+    return (imu + 1) * 10.0f;
+}
+
+double timeRounds(uint32_t rounds) {
+    double total = 0.0;
+    for (uint32_t round = 0; round < rounds; round++) {
+        // Leaves every IMU a new sample to flag
+        delay(2);
+        uint32_t start = micros();
+        MPU6050Driver::pollAll();
+        // Sleeps rather than spins, so the service interrupt's thread runs
+        while (!I2CEngine::isIdle()) {
+            delayMicroseconds(10);
+        }
+        total += micros() - start;
+    }
+    return rounds ? total / rounds : 0.0;
+}
+
+struct ImuResult {
+    uint32_t samples;
+    uint32_t foreign;       // Samples in the ring that are not this IMU's
+    float fusedGyro;
+};
+
+ImuResult checkImu(uint8_t imu) {
+    ImuResult result = {};
+    const MPU6050Driver& driver = MPU6050Driver::get(imu);
+    result.samples = driver.getSampleCount();
+    MPU6050Data block[IMU_RING_SAMPLES];
+    uint32_t from = result.samples > IMU_RING_SAMPLES ? result.samples - IMU_RING_SAMPLES : 0;
+    uint8_t count = driver.readSamples(from, block, IMU_RING_SAMPLES);
+    for (uint8_t i = 0; i < count; i++) {
+        result.foreign += fabsf(block[i].accelX - accelOf(imu)) > 0.01f || fabsf(block[i].gyroX - gyroOf(imu)) > 0.1f;
+    }
+    SensorFusion::update();
+    result.fusedGyro = SensorFusion::getGyroMagnitude(imu);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_multi_imu [--rounds N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    static Host::SimulatedMPU6050 imus[MAX_IMUS];
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        imus[imu].setAccel(accelOf(imu), 0.0f, 1.0f);
+        imus[imu].setGyro(gyroOf(imu), 0.0f, 0.0f);
+        Host::attachI2CDevice(imu % I2C_BUS_COUNT, MPU6050_I2C_ADDRESS + imu / I2C_BUS_COUNT, &imus[imu]);
+    }
+
+    bool up = true;
+    double roundUs[SETS];
+    uint8_t initialized = 0;
+    for (uint8_t set = 0; set < SETS; set++) {
+        for (; initialized < setSizes[set]; initialized++) {
+            up = MPU6050Driver::get(initialized).init() && up;
+        }
+        roundUs[set] = timeRounds(rounds);
+    }
+
+    printf("IMU rounds of one burst each, %u bus(es), %u rounds per set\n", I2C_BUS_COUNT, rounds);
+    printf("  %-6s %12s %16s %8s\n", "imus", "round us", "one by one us", "ratio");
+    for (uint8_t set = 0; set < SETS; set++) {
+        double serial = roundUs[0] * setSizes[set];
+        printf("  %-6u %12.1f %16.1f %8.2f\n", setSizes[set], roundUs[set], serial,
+               serial > 0.0 ? roundUs[set] / serial : 0.0);
+    }
+
+    uint32_t foreign = 0;
+    uint32_t wrongFusion = 0;
+    uint32_t empty = 0;
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        ImuResult result = checkImu(imu);
+        const MPU6050Driver& driver = MPU6050Driver::get(imu);
+        printf("  imu %u (bus %u, 0x%02X): %u samples, %u foreign, fused gyro %.1f of %.1f\n", imu, driver.getBus(),
+               driver.getAddress(), result.samples, result.foreign, result.fusedGyro, gyroOf(imu));
+        foreign += result.foreign;
+        wrongFusion += fabsf(result.fusedGyro - gyroOf(imu)) > 1.0f;
+        empty += result.samples == 0;
+    }
+
+    printf("RESULT multi_imu round1_us=%.1f round2_us=%.1f round4_us=%.1f foreign=%u wrong_fusion=%u\n", roundUs[0],
+           roundUs[1], roundUs[2], foreign, wrongFusion);
+
+    bool ok = up && foreign == 0 && wrongFusion == 0 && empty == 0 && roundUs[1] < 1.5 * roundUs[0] &&
+              roundUs[2] < 3.0 * roundUs[0];
+    return ok ? 0 : 1;
+}
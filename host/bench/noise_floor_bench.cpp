@@ -0,0 +1,449 @@
+/*
+ * B.I.T.E.S - Noise Floor Benchmark
+ *
+ * Compares thresholds that follow each channel's noise floor with the
+ * same calibrated thresholds held fixed, on 8 pressure and 8 piezo
+ * channels polled by SensorManager::update(). After calibrating at rest:
+ * - drift up: pressure floors rise 150 counts over 6 s (warming up)
+ * - drift down: pressure floors fall 100 counts, then soft presses 110
+ *   counts above the new floor
+ * - noise: piezo noise grows from 3 to 90 counts either side over 6 s
+ *   (cable movement, bleed from neighbouring pads)
+ * - strikes: piezo pads struck every 50 ticks for 6 s
+ * A false tick is a tick where a channel at rest reads above its
+ * threshold. Then NoiseFloorTracker is checked against a per-channel scalar
+ * reference, with the sample rate halved halfway through, and timed for 64
+ * and 128 channels, against the reference and against a poll of that many
+ * channels.
+ *
+ * Usage: bench_noise_floor [--ticks N]
+ * The exit code is non-zero if adaptive thresholds give any false tick or
+ * miss any soft press, if strikes move a floor by more than 2 counts, if
+ * the tracker differs from the reference by more than 1e-5 (relative), or
+ * if tracking 64 or 128 channels costs as much as polling them.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "sensors/noise_floor_tracker.h"
+#include "sensors/piezo_driver.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/semaphores.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::NoiseFloorTracker;
+using Sensors::PiezoDriver;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+
+namespace {
+
+constexpr uint8_t PRESSURES = 8;
+constexpr uint8_t PIEZOS = 8;
+constexpr uint8_t CHANNELS = PRESSURES + PIEZOS;
+constexpr uint8_t FIRST_PIN = 100;
+constexpr uint32_t RAMP_TICKS = 6000;
+constexpr uint32_t SETTLE_TICKS = 4000;
+constexpr uint32_t PRESSES = 20;
+constexpr uint32_t PRESS_TICKS = 20;
+constexpr float SOFT_PRESS_COUNTS = 110.0f;
+constexpr uint32_t STRIKE_EVERY_TICKS = 50;
+constexpr float FLOOR_TOLERANCE_COUNTS = 2.0f;
+constexpr float TOLERANCE = 1e-5f;
+constexpr float RATE_CHANGE_HZ = SENSOR_POLL_RATE_HZ / 2.0f;
+constexpr uint8_t REPEATS = 5;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t rngState = 25;
+// Uniform in [-1, 1)
+float noise() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 8388608.0f - 1.0f;
+}
+
+bool isPiezo(uint8_t id) {
+    return id >= PRESSURES;
+}
+
+float baselines[CHANNELS];     // Counts
+float spreads[CHANNELS];       // Counts either side
+
+void resetChannels() {
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        baselines[id] = isPiezo(id) ? 40.0f + 2 * id : 300.0f + 20 * id;
+        spreads[id] = isPiezo(id) ? 3.0f : 10.0f;
+    }
+}
+
+// Sets the readings, polls once; extra counts on the pressed channels
+void tick(uint32_t pressedBits = 0, float pressCounts = 0.0f) {
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        float reading = baselines[id] + spreads[id] * noise();
+        if (pressedBits & (1UL << id)) {
+            reading += pressCounts;
+        }
+        Host::setAnalogValue(FIRST_PIN + id, static_cast<int>(lroundf(reading)));
+    }
+    SensorManager::update();
+}
+
+// Channels at rest that read above their threshold this tick
+uint32_t falseTicks(uint32_t pressedBits = 0) {
+    uint32_t count = 0;
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        if (!(pressedBits & (1UL << id)) &&
+            SensorManager::getSensorData(id).value > SensorManager::getThreshold(id)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Registers and calibrates every channel at rest; fixed thresholds are the
+// calibrated ones, set explicitly
+void start(bool adaptive) {
+    resetChannels();
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        SensorManager::registerSensor(isPiezo(id) ? SensorType::PIEZO : SensorType::PRESSURE, id, FIRST_PIN + id);
+    }
+    SensorManager::calibrate();
+    do {
+        tick();
+    } while (SensorManager::isCalibrating());
+    if (!adaptive) {
+        for (uint8_t id = 0; id < CHANNELS; id++) {
+            SensorManager::setThreshold(id, SensorManager::getThreshold(id));
+        }
+    }
+}
+
+void stop() {
+    for (uint8_t id = 0; id < CHANNELS; id++) {
+        SensorManager::unregisterSensor(id);
+    }
+}
+
+struct ScenarioResult {
+    uint32_t falseTicks;
+    uint32_t missedPresses;
+    float floorError;       // Counts, strikes only
+};
+
+ScenarioResult driftUp(bool adaptive) {
+    ScenarioResult result = {};
+    start(adaptive);
+    for (uint32_t n = 0; n < RAMP_TICKS; n++) {
+        for (uint8_t id = 0; id < PRESSURES; id++) {
+            baselines[id] += 150.0f / RAMP_TICKS;
+        }
+        tick();
+        result.falseTicks += falseTicks();
+    }
+    stop();
+    return result;
+}
+
+ScenarioResult driftDown(bool adaptive) {
+    ScenarioResult result = {};
+    start(adaptive);
+    for (uint32_t n = 0; n < RAMP_TICKS + SETTLE_TICKS; n++) {
+        if (n < RAMP_TICKS) {
+            for (uint8_t id = 0; id < PRESSURES; id++) {
+                baselines[id] -= 100.0f / RAMP_TICKS;
+            }
+        }
+        tick();
+        result.falseTicks += falseTicks();
+    }
+
+    // Each press holds one key for a while, then rests as long
+    for (uint32_t press = 0; press < PRESSES; press++) {
+        uint32_t pressed = 1UL << (press % PRESSURES);
+        bool seen = false;
+        for (uint32_t n = 0; n < PRESS_TICKS; n++) {
+            tick(pressed, SOFT_PRESS_COUNTS);
+            seen = seen || SensorManager::isSensorTriggered(press % PRESSURES);
+            result.falseTicks += falseTicks(pressed);
+        }
+        result.missedPresses += seen ? 0 : 1;
+        for (uint32_t n = 0; n < PRESS_TICKS; n++) {
+            tick();
+            result.falseTicks += falseTicks();
+        }
+    }
+    stop();
+    return result;
+}
+
+ScenarioResult noiseRamp(bool adaptive) {
+    ScenarioResult result = {};
+    start(adaptive);
+    for (uint32_t n = 0; n < RAMP_TICKS + SETTLE_TICKS; n++) {
+        if (n < RAMP_TICKS) {
+            for (uint8_t id = PRESSURES; id < CHANNELS; id++) {
+                spreads[id] += 87.0f / RAMP_TICKS;
+            }
+        }
+        tick();
+        result.falseTicks += falseTicks();
+    }
+    stop();
+    return result;
+}
+
+ScenarioResult strikes(bool adaptive) {
+    ScenarioResult result = {};
+    start(adaptive);
+    for (uint32_t n = 0; n < RAMP_TICKS; n++) {
+        // Two ticks of a strike on one pad or another
+        uint8_t pad = PRESSURES + (n / STRIKE_EVERY_TICKS) % PIEZOS;
+        uint32_t struck = n % STRIKE_EVERY_TICKS < 2 ? 1UL << pad : 0;
+        tick(struck, 900.0f);
+        result.falseTicks += falseTicks(struck);
+    }
+
+    // The resting noise is well inside the margin, so the threshold is the
+    // floor plus the margin
+    constexpr float MARGIN_COUNTS = PiezoDriver::CALIBRATION_MARGIN_MV / PiezoDriver::MILLIVOLTS_PER_COUNT;
+    for (uint8_t id = PRESSURES; id < CHANNELS; id++) {
+        float floor = SensorManager::getThreshold(id) / PiezoDriver::MILLIVOLTS_PER_COUNT - MARGIN_COUNTS;
+        result.floorError = fmaxf(result.floorError, fabsf(floor - baselines[id]));
+    }
+    stop();
+    return result;
+}
+
+// The tracker's arithmetic, one object per channel with branches
+class ScalarNoiseFloor {
+public:
+    void init(float mean, float noise, float margin) {
+        setRate(SENSOR_POLL_RATE_HZ);
+        this->mean = mean;
+        variance = fmaxf(noise * noise, 1.0f / 12.0f);
+        this->margin = margin;
+    }
+
+    void setRate(float rateHz) {
+        alpha = 1.0f - expf(-1000.0f / (NOISE_FLOOR_TIME_CONSTANT_MS * rateHz));
+    }
+
+    float update(float x, bool held, float scale) {
+        float sigma = sqrtf(variance);
+        if (!held) {
+            float bound = NOISE_FLOOR_OUTLIER_SIGMAS * sigma;
+            float delta = x - mean;
+            if (delta > bound) {
+                delta = bound;
+            } else if (delta < -bound) {
+                delta = -bound;
+            }
+            mean += alpha * delta;
+            variance = fmaxf((1.0f - alpha) * (variance + alpha * delta * delta), 1.0f / 12.0f);
+        }
+        return (mean + fmaxf(margin, CALIBRATION_NOISE_SIGMAS * sigma)) * scale;
+    }
+
+private:
+    float alpha, mean, variance, margin;
+};
+
+// Floor steps, noise, spikes, and a held run now and then
+float sampleFor(uint8_t channel, uint32_t n) {
+    float floor = 200.0f + channel + ((n / 3000 + channel) % 3) * 40.0f;
+    float spike = (n * 7 + channel * 13) % 97 == 0 ? 300.0f : 0.0f;
+    return floor + (5.0f + channel % 4) * noise() + spike;
+}
+
+bool heldAt(uint8_t channel, uint32_t n) {
+    return (n + channel * 31) % 500 < 40;
+}
+
+bool checkReference() {
+    NoiseFloorTracker tracker;
+    ScalarNoiseFloor reference[MAX_SENSORS];
+    float scales[MAX_SENSORS];
+    float thresholds[MAX_SENSORS];
+    float counts[MAX_SENSORS];
+    for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+        // Every fourth channel is not tracked and keeps its threshold
+        scales[c] = 0.5f + c * 0.01f;
+        thresholds[c] = 1.0f;
+        if (c % 4 != 3) {
+            tracker.track(c, 200.0f + c, 4.0f, 30.0f);
+            reference[c].init(200.0f + c, 4.0f, 30.0f);
+        }
+    }
+    float worst = 0.0f;
+    for (uint32_t n = 0; n < 20000; n++) {
+        // Halfway, the sensor period doubles
+        if (n == 10000) {
+            tracker.setSampleRate(RATE_CHANGE_HZ);
+            for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+                reference[c].setRate(RATE_CHANGE_HZ);
+            }
+        }
+        uint32_t held[MAX_SENSORS / 32] = {};
+        for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+            counts[c] = sampleFor(c, n);
+            held[c / 32] |= static_cast<uint32_t>(heldAt(c, n)) << (c & 31);
+        }
+        tracker.update(counts, held, scales, thresholds, MAX_SENSORS);
+        for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+            float expected = c % 4 != 3 ? reference[c].update(counts[c], heldAt(c, n), scales[c]) : 1.0f;
+            worst = fmaxf(worst, fabsf(thresholds[c] - expected) / fmaxf(1.0f, fabsf(expected)));
+        }
+    }
+    bool ok = worst <= TOLERANCE;
+    printf("  tracker vs scalar reference: max relative error %.2e %s\n", worst, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+template <typename Pass>
+double bestNsPerTick(uint32_t ticks, Pass pass) {
+    double best = 0.0;
+    for (uint8_t repeat = 0; repeat < REPEATS; repeat++) {
+        double start = nowNs();
+        for (uint32_t tick = 0; tick < ticks; tick++) {
+            pass(tick);
+        }
+        double elapsed = (nowNs() - start) / ticks;
+        if (repeat == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+struct TimingResult {
+    uint8_t channels;
+    double trackerNs;
+    double scalarNs;
+    double pollNs;
+};
+
+// Inputs are precomputed so the timed passes are only the tracking
+constexpr uint32_t INPUT_TICKS = 1024;
+float inputs[INPUT_TICKS][MAX_SENSORS];
+uint32_t heldInputs[INPUT_TICKS][MAX_SENSORS / 32];
+float sink;
+
+TimingResult timeChannels(uint8_t channels, uint32_t ticks) {
+    TimingResult result = {channels, 0.0, 0.0, 0.0};
+
+    static NoiseFloorTracker tracker;
+    static ScalarNoiseFloor scalars[MAX_SENSORS];
+    float scales[MAX_SENSORS];
+    float thresholds[MAX_SENSORS];
+    tracker.init();
+    for (uint8_t c = 0; c < channels; c++) {
+        scales[c] = 1.0f;
+        thresholds[c] = 0.0f;
+        tracker.track(c, 200.0f, 4.0f, 30.0f);
+        scalars[c].init(200.0f, 4.0f, 30.0f);
+    }
+    result.trackerNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        tracker.update(inputs[tick % INPUT_TICKS], heldInputs[tick % INPUT_TICKS], scales, thresholds, channels);
+        sink += thresholds[tick % channels];
+    });
+    result.scalarNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        const float* input = inputs[tick % INPUT_TICKS];
+        const uint32_t* held = heldInputs[tick % INPUT_TICKS];
+        for (uint8_t c = 0; c < channels; c++) {
+            thresholds[c] = scalars[c].update(input[c], (held[c / 32] >> (c & 31)) & 1, scales[c]);
+        }
+        sink += thresholds[tick % channels];
+    });
+
+    // The same channels polled as pressure sensors, not calibrated
+    for (uint8_t id = 0; id < channels; id++) {
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+        SensorManager::registerSensor(SensorType::PRESSURE, id, FIRST_PIN + id);
+    }
+    uint8_t key = 0;
+    result.pollNs = bestNsPerTick(ticks, [&](uint32_t tick) {
+        Host::setAnalogValue(FIRST_PIN + key, tick % 2 ? 0 : 2048);
+        SensorManager::update();
+        key = (key + 1) % channels;
+    });
+    for (uint8_t id = 0; id < channels; id++) {
+        SensorManager::unregisterSensor(id);
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t ticks = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_noise_floor [--ticks N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    RTOS::createSemaphores();
+    SensorManager::init();
+
+    struct Scenario {
+        const char* name;
+        ScenarioResult (*run)(bool adaptive);
+    };
+    const Scenario scenarios[] = {
+        {"drift up", driftUp}, {"drift down", driftDown}, {"noise", noiseRamp}, {"strikes", strikes}
+    };
+    bool ok = true;
+    ScenarioResult adaptiveTotal = {};
+    ScenarioResult fixedTotal = {};
+    printf("  %-11s %18s %18s %16s %16s %12s\n", "scenario", "fixed false ticks", "adaptive false", "fixed missed",
+           "adaptive missed", "floor err");
+    for (const Scenario& scenario : scenarios) {
+        ScenarioResult fixed = scenario.run(false);
+        ScenarioResult adaptive = scenario.run(true);
+        printf("  %-11s %18u %18u %16u %16u %12.2f\n", scenario.name, fixed.falseTicks, adaptive.falseTicks,
+               fixed.missedPresses, adaptive.missedPresses, adaptive.floorError);
+        ok = ok && adaptive.falseTicks == 0 && adaptive.missedPresses == 0 &&
+             adaptive.floorError <= FLOOR_TOLERANCE_COUNTS;
+        adaptiveTotal.falseTicks += adaptive.falseTicks;
+        adaptiveTotal.missedPresses += adaptive.missedPresses;
+        fixedTotal.falseTicks += fixed.falseTicks;
+        fixedTotal.missedPresses += fixed.missedPresses;
+    }
+
+    ok = checkReference() && ok;
+    for (uint32_t n = 0; n < INPUT_TICKS; n++) {
+        for (uint8_t c = 0; c < MAX_SENSORS; c++) {
+            inputs[n][c] = sampleFor(c, n);
+            heldInputs[n][c / 32] |= static_cast<uint32_t>(heldAt(c, n)) << (c & 31);
+        }
+    }
+    const uint8_t sizes[] = {64, 128};
+    TimingResult results[2];
+    printf("  %-9s %12s %12s %12s\n", "channels", "tracker ns", "scalar ns", "poll ns");
+    for (uint8_t i = 0; i < 2; i++) {
+        results[i] = timeChannels(sizes[i], ticks);
+        const TimingResult& result = results[i];
+        printf("  %-9u %12.0f %12.0f %12.0f\n", result.channels, result.trackerNs, result.scalarNs, result.pollNs);
+        ok = ok && result.trackerNs < result.pollNs;
+    }
+
+    printf("RESULT noise_floor fixed_false_ticks=%u adaptive_false_ticks=%u fixed_missed=%u adaptive_missed=%u "
+           "tracker64_ns=%.0f tracker128_ns=%.0f poll128_ns=%.0f\n",
+           fixedTotal.falseTicks, adaptiveTotal.falseTicks, fixedTotal.missedPresses, adaptiveTotal.missedPresses,
+           results[0].trackerNs, results[1].trackerNs, results[1].pollNs);
+    return ok ? 0 : 1;
+}
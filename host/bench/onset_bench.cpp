@@ -0,0 +1,272 @@
+/*
+ * B.I.T.E.S - Piezo Onset Benchmark
+ *
+ * Plays a take of drum pad hits into OnsetDetector at 10 kHz and 20 kHz,
+ * and into the per-tick detection it replaced: one 1 kHz reading against the
+ * threshold, a 50 ms debounce and velocity taken as the change since the
+ * previous reading. The take mixes single hits with 40 Hz rolls. Every hit
+ * is a half-wave rectified, decaying 300-800 Hz oscillation, like a piezo
+ * on a pad, with ADC noise and 12-bit quantisation added. For every method
+ * the bench reports detected and spurious hits, the onset error, the time
+ * from a hit to its report, and how well velocity tracks the strike.
+ *
+ * Usage: bench_onset [--hits N]
+ * The exit code is non-zero if the detector misses a hit or reports a
+ * spurious one at either rate, places an onset more than 500 us off,
+ * reports later than 2 ms, or is off by more than 10% on velocity.
+ */
+
+#include "sensors/onset_detector.h"
+#include "sensors/piezo_driver.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace BITS;
+using Sensors::OnsetDetector;
+using Sensors::PiezoDriver;
+
+namespace {
+
+constexpr float THRESHOLD_MV = PiezoDriver::DEFAULT_THRESHOLD_MV;
+constexpr float NOISE_MV = 8.0f;
+constexpr float FULL_SCALE_MV = 3300.0f;
+constexpr uint32_t SINGLE_GAP_US = 150000;
+constexpr uint32_t ROLL_GAP_US = 25000;
+constexpr uint32_t ROLL_LENGTH = 6;
+constexpr uint32_t MATCH_WINDOW_US = 10000;
+constexpr uint32_t TAIL_US = 100000;
+
+struct Strike {
+    uint32_t startUs;
+    float amplitude;    // Largest value of the waveform, mV
+    float frequency;
+    float decayUs;
+    float gain;         // Scales the unit waveform to the amplitude
+};
+
+struct Detection {
+    uint32_t onsetUs;
+    uint32_t reportUs;
+    float velocity;
+};
+
+struct MethodResult {
+    uint32_t detected;
+    uint32_t spurious;
+    double onsetErrorSum;
+    uint32_t onsetErrorMax;
+    double latencySum;
+    uint32_t latencyMax;
+    double velocityErrorSum;
+    double correlation;
+};
+
+// Deterministic pseudo-random numbers, so every run plays the same take
+uint32_t rngState = 12345;
+float random01() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 16777216.0f;
+}
+
+std::vector<Strike> makeTake(uint32_t hits) {
+    std::vector<Strike> take;
+    uint32_t time = 20000;
+    while (take.size() < hits) {
+        bool roll = random01() < 0.4f;
+        uint32_t count = roll ? ROLL_LENGTH : 1;
+        float rollLevel = 400.0f + random01() * 2200.0f;
+        for (uint32_t i = 0; i < count && take.size() < hits; i++) {
+            Strike strike;
+            strike.startUs = time;
+            strike.amplitude = roll ? rollLevel * (0.8f + 0.4f * random01()) : 200.0f + random01() * 2900.0f;
+            strike.frequency = 300.0f + random01() * 500.0f;
+            strike.decayUs = 3000.0f + random01() * 3000.0f;
+            take.push_back(strike);
+            time += roll ? ROLL_GAP_US : SINGLE_GAP_US;
+        }
+        time += SINGLE_GAP_US;
+    }
+    return take;
+}
+
+float strikeShape(const Strike& strike, uint32_t timeUs) {
+    float t = static_cast<float>(timeUs - strike.startUs);
+    return expf(-t / strike.decayUs) * sinf(2.0f * static_cast<float>(M_PI) * strike.frequency * t * 1e-6f);
+}
+
+// Gain that puts the peak of the continuous waveform, found on a 1 us grid,
+// at the strike's amplitude
+void setGains(std::vector<Strike>& take) {
+    for (Strike& strike : take) {
+        float peak = 0.0f;
+        for (uint32_t t = 0; t < 5000; t++) {
+            float value = strikeShape(strike, strike.startUs + t);
+            peak = value > peak ? value : peak;
+        }
+        strike.gain = strike.amplitude / peak;
+    }
+}
+
+// What the ADC reads at timeUs: the sum of ringing hits, rectified by the
+// input stage, plus noise, quantised to counts
+float sampleAt(const std::vector<Strike>& take, size_t& first, uint32_t timeUs) {
+    while (first < take.size() && timeUs - take[first].startUs > 20 * take[first].decayUs &&
+           static_cast<int32_t>(timeUs - take[first].startUs) > 0) {
+        first++;
+    }
+    float value = 0.0f;
+    for (size_t i = first; i < take.size() && static_cast<int32_t>(timeUs - take[i].startUs) >= 0; i++) {
+        value += take[i].gain * strikeShape(take[i], timeUs);
+    }
+    value += (random01() * 2.0f - 1.0f) * NOISE_MV;
+    value = value < 0.0f ? 0.0f : (value > FULL_SCALE_MV ? FULL_SCALE_MV : value);
+    float counts = roundf(value / PiezoDriver::MILLIVOLTS_PER_COUNT);
+    return counts * PiezoDriver::MILLIVOLTS_PER_COUNT;
+}
+
+std::vector<Detection> runDetector(const std::vector<Strike>& take, uint32_t rateHz) {
+    std::vector<Detection> detections;
+    OnsetDetector detector;
+    detector.init(PiezoDriver::PEAK_HOLD_US, PiezoDriver::DEFAULT_RETRIGGER_MASK_US);
+    uint32_t end = take.back().startUs + TAIL_US;
+    size_t first = 0;
+    for (uint64_t n = 0;; n++) {
+        uint32_t time = static_cast<uint32_t>(n * 1000000ULL / rateHz);
+        if (time > end) {
+            break;
+        }
+        OnsetDetector::Hit hit;
+        if (detector.process(sampleAt(take, first, time), time, THRESHOLD_MV, hit)) {
+            detections.push_back({hit.onsetMicros, time, hit.peak});
+        }
+    }
+    return detections;
+}
+
+// The previous per-tick detection of PiezoDriver::isTriggered()
+std::vector<Detection> runPerTick(const std::vector<Strike>& take) {
+    std::vector<Detection> detections;
+    uint32_t end = take.back().startUs + TAIL_US;
+    size_t first = 0;
+    float lastValue = 0.0f;
+    uint32_t lastTriggerMs = 0;
+    for (uint32_t time = 0; time <= end; time += 1000) {
+        float value = sampleAt(take, first, time);
+        float velocity = fabsf(value - lastValue);
+        lastValue = value;
+        uint32_t nowMs = time / 1000;
+        if (value > THRESHOLD_MV && nowMs - lastTriggerMs > PiezoDriver::DEFAULT_DEBOUNCE_MS) {
+            lastTriggerMs = nowMs;
+            detections.push_back({time, time, velocity});
+        }
+    }
+    return detections;
+}
+
+MethodResult score(const std::vector<Strike>& take, const std::vector<Detection>& detections) {
+    MethodResult result = {};
+    std::vector<float> truth;
+    std::vector<float> estimate;
+    size_t next = 0;
+    for (const Detection& detection : detections) {
+        // The earliest unmatched strike that started shortly before the onset
+        while (next < take.size() &&
+               static_cast<int32_t>(detection.onsetUs - take[next].startUs) > static_cast<int32_t>(MATCH_WINDOW_US)) {
+            next++;
+        }
+        if (next >= take.size() || static_cast<int32_t>(detection.onsetUs - take[next].startUs) < 0) {
+            result.spurious++;
+            continue;
+        }
+        const Strike& strike = take[next++];
+        uint32_t onsetError = detection.onsetUs - strike.startUs;
+        uint32_t latency = detection.reportUs - strike.startUs;
+        result.detected++;
+        result.onsetErrorSum += onsetError;
+        result.onsetErrorMax = onsetError > result.onsetErrorMax ? onsetError : result.onsetErrorMax;
+        result.latencySum += latency;
+        result.latencyMax = latency > result.latencyMax ? latency : result.latencyMax;
+        result.velocityErrorSum += fabsf(detection.velocity - strike.amplitude) / strike.amplitude;
+        truth.push_back(strike.amplitude);
+        estimate.push_back(detection.velocity);
+    }
+
+    // Velocity units differ between methods, so also compare by correlation
+    double n = truth.size();
+    if (n > 1) {
+        double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+        for (size_t i = 0; i < truth.size(); i++) {
+            sx += truth[i];
+            sy += estimate[i];
+            sxx += truth[i] * truth[i];
+            syy += estimate[i] * estimate[i];
+            sxy += truth[i] * estimate[i];
+        }
+        double denominator = sqrt((n * sxx - sx * sx) * (n * syy - sy * sy));
+        result.correlation = denominator > 0 ? (n * sxy - sx * sy) / denominator : 0.0;
+    }
+    return result;
+}
+
+void printResult(const char* name, const MethodResult& result, uint32_t hits) {
+    double detected = result.detected ? result.detected : 1;
+    printf("  %-18s %5u/%-5u %8u %9.0f %8u %9.0f %8u %9.1f%% %7.3f\n", name, result.detected, hits,
+           result.spurious, result.onsetErrorSum / detected, result.onsetErrorMax, result.latencySum / detected,
+           result.latencyMax, 100.0 * result.velocityErrorSum / detected, result.correlation);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t hits = 200;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hits") == 0 && i + 1 < argc) {
+            hits = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_onset [--hits N]\n");
+            return 2;
+        }
+    }
+    if (hits == 0) {
+        return 2;
+    }
+
+    std::vector<Strike> take = makeTake(hits);
+    setGains(take);
+
+    uint32_t seed = rngState;
+    const uint32_t rates[] = {10000, 20000};
+    MethodResult detector[2];
+    for (uint8_t i = 0; i < 2; i++) {
+        rngState = seed;
+        detector[i] = score(take, runDetector(take, rates[i]));
+    }
+    rngState = seed;
+    MethodResult perTick = score(take, runPerTick(take));
+
+    printf("Onset detection on %u piezo hits (singles and 40 Hz rolls)\n", hits);
+    printf("  %-18s %11s %8s %9s %8s %9s %8s %10s %7s\n", "method", "detected", "spurious", "onset us",
+           "max", "report us", "max", "vel error", "corr");
+    printResult("onset 10 kHz", detector[0], hits);
+    printResult("onset 20 kHz", detector[1], hits);
+    printResult("per tick 1 kHz", perTick, hits);
+
+    printf("RESULT onset detected10k=%u detected20k=%u detected_tick=%u onset_us10k=%.0f report_us10k=%.0f "
+           "vel_error10k=%.3f corr10k=%.3f corr_tick=%.3f\n",
+           detector[0].detected, detector[1].detected, perTick.detected,
+           detector[0].onsetErrorSum / (detector[0].detected ? detector[0].detected : 1),
+           detector[0].latencySum / (detector[0].detected ? detector[0].detected : 1),
+           detector[0].velocityErrorSum / (detector[0].detected ? detector[0].detected : 1), detector[0].correlation,
+           perTick.correlation);
+
+    bool ok = true;
+    for (const MethodResult& result : detector) {
+        ok = ok && result.detected == hits && result.spurious == 0 && result.onsetErrorMax < 500 &&
+             result.latencyMax < 2000 && result.velocityErrorSum / result.detected < 0.10;
+    }
+    return ok ? 0 : 1;
+}
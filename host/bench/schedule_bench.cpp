@@ -0,0 +1,137 @@
+/*
+ * B.I.T.E.S - Schedule Admission Benchmark
+ *
+ * Boots the system with an MPU6050 registered and the tasks at fixed
+ * periods, measures each task's WCET online and asks ScheduleManager to
+ * push the sensor task to 4 kHz. If the response-time analysis admits it,
+ * the rate the sensor task then reaches is measured; if not, the schedule
+ * must be unchanged. Host threads are not prioritised and the host counts
+ * wall time, so measured WCETs include preemption by other tasks and the
+ * outcome varies between runs. For the same reason an admitted 4 kHz only
+ * has to reach twice the rate measured at 1 kHz, which scales with what
+ * the host leaves the sensor thread.
+ * The analysis itself is also checked with fixed WCETs: a 300 us sensor
+ * activation fits 2 kHz but not 4 kHz, and at 2 kHz it only meets its
+ * deadline with rate-monotonic priorities, not when it shares the audio
+ * task's priority (round-robin).
+ *
+ * Usage: bench_schedule [--phase-ms N]
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/config_manager.h"
+#include "core/schedule_manager.h"
+#include "core/task_manager.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/tasks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::ScheduleAnalysis;
+using Core::ScheduleManager;
+using Core::TaskId;
+using Core::TaskManager;
+
+namespace {
+
+constexpr uint8_t TASK_COUNT = static_cast<uint8_t>(TaskId::COUNT);
+const char* const TASK_NAMES[TASK_COUNT] = {"sensor", "audio", "ai", "network", "system"};
+
+// Sensor activations per second over one phase, with fresh WCETs
+double runPhase(uint32_t phaseMs) {
+    TaskManager::resetTaskTimings();
+    uint32_t start = millis();
+    delay(phaseMs);
+    uint32_t elapsedMs = millis() - start;
+    return TaskManager::getTaskTiming(TaskId::SENSOR).activations * 1000.0 / elapsedMs;
+}
+
+void printAnalysis(const char* label, const Core::Schedule& schedule, const ScheduleAnalysis& analysis) {
+    printf("%s: %s, utilization %.1f%% (RM bound %.1f%%)\n", label,
+           analysis.schedulable ? "admitted" : "REJECTED", analysis.utilization * 100.0f,
+           analysis.rmBound * 100.0f);
+    printf("  %-8s %9s %9s %12s %12s\n", "task", "priority", "wcet us", "response us", "deadline us");
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        const Core::TaskSchedule& task = schedule.tasks[i];
+        if (analysis.responseUs[i] == UINT32_MAX) {
+            printf("  %-8s %9u %9u %12s %12u\n", TASK_NAMES[i], task.priority, analysis.wcetUs[i], "unbounded",
+                   task.periodUs);
+        } else {
+            printf("  %-8s %9u %9u %12u %12u\n", TASK_NAMES[i], task.priority, analysis.wcetUs[i],
+                   analysis.responseUs[i], task.periodUs);
+        }
+    }
+}
+
+Core::Schedule withSensor(uint32_t periodUs, uint8_t priority) {
+    Core::Schedule schedule = ScheduleManager::getSchedule();
+    schedule.tasks[static_cast<uint8_t>(TaskId::SENSOR)].periodUs = periodUs;
+    schedule.tasks[static_cast<uint8_t>(TaskId::SENSOR)].priority = priority;
+    return schedule;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t phaseMs = 300;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--phase-ms") == 0 && i + 1 < argc) {
+            phaseMs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_schedule [--phase-ms N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::MPU6050, 0, 0);
+    RTOS::setEventDriven(false);
+    runPhase(phaseMs);      // Warm-up after boot
+
+    // Fixed WCETs: sensor 300 us, audio 400 us, the rest small
+    const uint32_t wcetUs[TASK_COUNT] = {300, 400, 50, 50, 100};
+    const uint8_t critical = static_cast<uint8_t>(RTOS::TaskPriority::CRITICAL);
+    const uint8_t realtime = static_cast<uint8_t>(RTOS::TaskPriority::REALTIME);
+    ScheduleAnalysis fixed4k, fixed2k, roundRobin;
+    Core::Schedule schedule4k = withSensor(250, critical);
+    Core::Schedule schedule2k = withSensor(500, critical);
+    Core::Schedule scheduleShared = withSensor(500, realtime);
+    bool admitted4k = ScheduleManager::analyze(schedule4k, wcetUs, fixed4k);
+    bool admitted2k = ScheduleManager::analyze(schedule2k, wcetUs, fixed2k);
+    bool admittedShared = ScheduleManager::analyze(scheduleShared, wcetUs, roundRobin);
+    printAnalysis("Fixed WCETs, sensor 4 kHz", schedule4k, fixed4k);
+    printAnalysis("Fixed WCETs, sensor 2 kHz", schedule2k, fixed2k);
+    printAnalysis("Fixed WCETs, sensor 2 kHz at audio priority", scheduleShared, roundRobin);
+
+    // Measured WCETs at 1 kHz, then the live request for 4 kHz
+    double baseRate = runPhase(phaseMs);
+    ScheduleAnalysis live;
+    bool liveAdmitted = ScheduleManager::setTaskPeriod(TaskId::SENSOR, 250, &live);
+    printAnalysis("Measured WCETs, sensor 4 kHz", schedule4k, live);
+    double liveRate = runPhase(phaseMs);
+    uint32_t activePeriodUs = ScheduleManager::getTaskSchedule(TaskId::SENSOR).periodUs;
+    uint32_t storedPeriodUs = Core::ConfigManager::getTaskPeriodUs(static_cast<uint8_t>(TaskId::SENSOR));
+    printf("Sensor rate %.0f/s at 1 kHz, %.0f/s after the request (period now %u us)\n", baseRate, liveRate,
+           activePeriodUs);
+
+    printf("RESULT schedule fixed_4khz=%d fixed_2khz=%d fixed_shared_priority=%d live_admitted=%d "
+           "live_rate=%.0f\n",
+           admitted4k, admitted2k, admittedShared, liveAdmitted, liveRate);
+
+    bool ok = !admitted4k && admitted2k && !admittedShared && roundRobin.failedTask == TaskId::SENSOR;
+    if (liveAdmitted) {
+        ok = ok && activePeriodUs == 250 && storedPeriodUs == 250 && liveRate >= 2 * baseRate;
+    } else {
+        ok = ok && activePeriodUs == 1000;
+    }
+    return ok ? 0 : 1;
+}
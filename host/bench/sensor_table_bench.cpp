@@ -0,0 +1,134 @@
+/*
+ * B.I.T.E.S - Sensor Table Benchmark
+ *
+ * Measures the cost of one SensorManager::update() tick with 16, 64 and
+ * 128 pressure channels registered (a keyboard with a key per channel).
+ * Every tick one key is pressed or released, so trigger edges and their
+ * events are part of the cost. Before timing, each table size is checked:
+ * every channel must register, and exactly the keys held above threshold
+ * must report as triggered.
+ *
+ * Usage: bench_sensor_table [--ticks N]
+ * The exit code is non-zero if a channel fails to register, a trigger is
+ * wrong, or the cost per channel at 128 channels is more than 1.5 times
+ * the cost at 16.
+ * Note: analogRead() is a table lookup on the host, so the numbers show
+ * the table passes rather than ADC conversion time.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/semaphores.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+
+namespace {
+
+constexpr uint8_t FIRST_PIN = 100;
+constexpr int HELD_COUNTS = 2048;       // About 2.5 V
+constexpr float THRESHOLD_V = 0.5f;
+constexpr uint8_t REPEATS = 5;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct TableResult {
+    uint8_t channels;
+    uint8_t registered;
+    bool triggersCorrect;
+    double tickNs;
+};
+
+TableResult runTable(uint8_t channels, uint32_t ticks) {
+    TableResult result = {channels, 0, true, 0.0};
+    for (uint8_t id = 0; id < channels; id++) {
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+        if (SensorManager::registerSensor(SensorType::PRESSURE, id, FIRST_PIN + id)) {
+            SensorManager::setThreshold(id, THRESHOLD_V);
+            result.registered++;
+        }
+    }
+
+    // Every third key held down
+    for (uint8_t id = 0; id < channels; id++) {
+        Host::setAnalogValue(FIRST_PIN + id, id % 3 == 0 ? HELD_COUNTS : 0);
+    }
+    SensorManager::update();
+    for (uint8_t id = 0; id < channels; id++) {
+        if (SensorManager::isSensorTriggered(id) != (id % 3 == 0)) {
+            result.triggersCorrect = false;
+        }
+    }
+
+    // Best of several runs, one key changing per tick
+    double best = 0.0;
+    uint8_t key = 0;
+    for (uint8_t repeat = 0; repeat < REPEATS; repeat++) {
+        double start = nowNs();
+        for (uint32_t tick = 0; tick < ticks; tick++) {
+            Host::setAnalogValue(FIRST_PIN + key, tick % 2 ? 0 : HELD_COUNTS);
+            SensorManager::update();
+            key = (key + 1) % channels;
+        }
+        double elapsed = (nowNs() - start) / ticks;
+        if (repeat == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    result.tickNs = best;
+
+    for (uint8_t id = 0; id < channels; id++) {
+        SensorManager::unregisterSensor(id);
+        Host::setAnalogValue(FIRST_PIN + id, 0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t ticks = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_sensor_table [--ticks N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    RTOS::createSemaphores();
+    SensorManager::init();
+
+    const uint8_t sizes[] = {16, 64, 128};
+    TableResult results[3];
+    printf("  %-9s %10s %10s %12s %14s\n", "channels", "registered", "triggers", "ns per tick", "ns per channel");
+    for (uint8_t i = 0; i < 3; i++) {
+        results[i] = runTable(sizes[i], ticks);
+        const TableResult& result = results[i];
+        printf("  %-9u %10u %10s %12.0f %14.1f\n", result.channels, result.registered,
+               result.triggersCorrect ? "ok" : "WRONG", result.tickNs, result.tickNs / result.channels);
+    }
+
+    double perChannel16 = results[0].tickNs / results[0].channels;
+    double perChannel128 = results[2].tickNs / results[2].channels;
+    printf("RESULT sensor_table tick16_ns=%.0f tick64_ns=%.0f tick128_ns=%.0f per_channel_ratio=%.2f\n",
+           results[0].tickNs, results[1].tickNs, results[2].tickNs, perChannel128 / perChannel16);
+
+    bool ok = perChannel128 <= perChannel16 * 1.5;
+    for (const TableResult& result : results) {
+        ok = ok && result.registered == result.channels && result.triggersCorrect;
+    }
+    return ok ? 0 : 1;
+}
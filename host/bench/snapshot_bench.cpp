@@ -0,0 +1,141 @@
+/*
+ * B.I.T.E.S - Sensor Snapshot Benchmark
+ *
+ * Boots the system with an MPU6050 and as many pressure keys as fit, with
+ * the sensor task polling at 1 kHz, then reads the published snapshot from
+ * the bench thread the way instruments do. The IMU stamps every burst
+ * read with a sample number in both its accel and gyro registers, so a copy
+ * whose value and velocity come from different polls shows up as torn.
+ * Also times a read while sensorMutex is held, as during a slow poll.
+ *
+ * Usage: bench_snapshot [--duration-ms N]
+ * The exit code is non-zero on a torn read, if reads wait for the mutex or
+ * if the readers did not see the IMU readings advance.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "sensors/sensor_manager.h"
+#include "rtos/semaphores.h"
+#include "rtos/tasks.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Sensors::SensorData;
+using Sensors::SensorManager;
+
+namespace {
+
+constexpr uint8_t MPU6050_ACCEL_XOUT_H = 0x3B;
+constexpr uint32_t SAMPLE_WRAP = 1000;
+constexpr uint8_t IMU_ID = 0;
+constexpr uint32_t MUTEX_HOLD_MS = 20;
+
+// IMU that encodes a new sample number in accel X (n / 1000 g) and gyro X
+// (n / 10 deg/s) at the start of every burst read
+class CountingMPU6050 : public Host::SimulatedMPU6050 {
+public:
+    uint8_t readRegister(uint8_t reg) override {
+        if (reg == MPU6050_ACCEL_XOUT_H) {
+            sample = (sample + 1) % SAMPLE_WRAP;
+            setAccel(sample / 1000.0f, 0.0f, 0.0f);
+            setGyro(sample / 10.0f, 0.0f, 0.0f);
+        }
+        return SimulatedMPU6050::readRegister(reg);
+    }
+
+private:
+    uint32_t sample = 0;
+};
+
+// A poll reads accel and gyro in one burst, so they carry the same sample;
+// anything else mixes two polls
+bool isTorn(const SensorData& data) {
+    uint32_t accelSample = static_cast<uint32_t>(lroundf(data.value * 1000.0f)) % SAMPLE_WRAP;
+    uint32_t gyroSample = static_cast<uint32_t>(lroundf(data.velocity * 10.0f)) % SAMPLE_WRAP;
+    return accelSample != gyroSample;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_snapshot [--duration-ms N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    static CountingMPU6050 imu;
+    Host::attachI2CDevice(0, MPU6050_I2C_ADDRESS, &imu);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    SensorManager::registerSensor(Sensors::SensorType::MPU6050, IMU_ID, 0);
+    for (uint8_t id = IMU_ID + 1; id < MAX_SENSORS; id++) {
+        SensorManager::registerSensor(Sensors::SensorType::PRESSURE, id, A0);
+    }
+    RTOS::setEventDriven(false);
+    delay(50);
+
+    // Instrument-style reads: the IMU plus a trigger check of every key
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    uint32_t imuUpdates = 0;
+    uint32_t scans = 0;
+    uint32_t scanUs = 0;
+    float lastValue = -1.0f;
+    uint32_t start = millis();
+    while (millis() - start < durationMs) {
+        SensorData data = SensorManager::getSensorData(IMU_ID);
+        reads++;
+        if (isTorn(data)) {
+            torn++;
+        }
+        if (data.value != lastValue) {
+            imuUpdates++;
+            lastValue = data.value;
+        }
+
+        uint32_t scanStart = micros();
+        volatile uint8_t held = 0;
+        for (uint8_t id = IMU_ID + 1; id < MAX_SENSORS; id++) {
+            held = held + SensorManager::isSensorTriggered(id);
+        }
+        scanUs += micros() - scanStart;
+        scans++;
+    }
+    uint32_t snapshotVersion = SensorManager::getSnapshotVersion();
+
+    // A read while the poller holds the table lock must not wait for it
+    xSemaphoreTake(RTOS::sensorMutex, portMAX_DELAY);
+    uint32_t lockedStart = micros();
+    SensorData locked = SensorManager::getSensorData(IMU_ID);
+    uint32_t lockedUs = micros() - lockedStart;
+    delay(MUTEX_HOLD_MS);
+    xSemaphoreGive(RTOS::sensorMutex);
+
+    printf("Sensor table: %u sensors, snapshot version %u after %u ms\n", SensorManager::getSensorCount(),
+           snapshotVersion, durationMs);
+    printf("  IMU reads       %10u (%u torn, %u distinct readings)\n", reads, torn, imuUpdates);
+    printf("  trigger scans   %10u (%.2f us per scan of %u ids)\n", scans, scans ? scanUs / (double)scans : 0.0,
+           MAX_SENSORS - 1);
+    printf("  read under lock %10u us (id %u)\n", lockedUs, locked.id);
+
+    printf("RESULT snapshot reads=%u torn=%u imu_updates=%u scan_us=%.2f locked_read_us=%u\n", reads, torn,
+           imuUpdates, scans ? scanUs / (double)scans : 0.0, lockedUs);
+
+    bool ok = torn == 0 && imuUpdates >= durationMs / 4 && locked.id == IMU_ID &&
+              lockedUs < MUTEX_HOLD_MS * 1000 / 2;
+    return ok ? 0 : 1;
+}
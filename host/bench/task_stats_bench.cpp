@@ -0,0 +1,184 @@
+/*
+ * B.I.T.E.S - Task Accounting Benchmark
+ *
+ * Replays the sensor (1 ms) and audio (2 ms) task loops on one host thread
+ * against a simulated cycle counter, each activation advancing it by a known
+ * load, and checks that TaskManager's CPU usage and execution histograms
+ * recover those loads. The replay switches between the tasks as the
+ * scheduler would on a single core and calls the context switch hooks: the
+ * audio loop wakes 0.7 ms into the sensor period, so every sensor activation
+ * preempts it, and that time must not count as audio execution. The counter
+ * only moves as the replay says, so the results do not depend on what else
+ * the host is running.
+ *
+ * Also reports the cost of one beginActivation/endActivation pair, timed
+ * with the real counter.
+ *
+ * Usage: bench_task_stats [--duration-ms N] [--sensor-us N] [--audio-us N]
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/task_manager.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BITS;
+using Core::TaskId;
+using Core::TaskManager;
+using Core::TaskTiming;
+
+namespace {
+
+struct SimTask {
+    const char* name;
+    TaskId id;
+    uint32_t periodMs;
+    uint32_t phaseUs;           // First wake after the start
+    uint32_t loadUs;
+    uint32_t nextWakeCycles;
+    uint32_t remainingCycles;   // Load left in the current activation
+    bool ready;
+    bool begun;
+};
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double hookCostNs(uint32_t pairs) {
+    TaskManager::registerTask(TaskId::SYSTEM, pdMS_TO_TICKS(1000));
+    double start = nowNs();
+    for (uint32_t i = 0; i < pairs; i++) {
+        TaskManager::beginActivation(TaskId::SYSTEM);
+        TaskManager::endActivation(TaskId::SYSTEM);
+    }
+    return (nowNs() - start) / pairs;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 1000;
+    uint32_t sensorUs = 150;
+    uint32_t audioUs = 400;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--sensor-us") == 0 && i + 1 < argc) {
+            sensorUs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--audio-us") == 0 && i + 1 < argc) {
+            audioUs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_task_stats [--duration-ms N] [--sensor-us N] [--audio-us N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Host::useSimulatedCycles(true);
+    TaskManager::init();
+
+    SimTask tasks[] = {
+        // Highest priority first
+        {"SensorTask", TaskId::SENSOR, 1, 0, sensorUs, 0, 0, false, false},
+        {"AudioTask", TaskId::AUDIO, 2, 700, audioUs, 0, 0, false, false},
+    };
+    const uint32_t cyclesPerMs = F_CPU_ACTUAL / 1000;
+    const uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000;
+    uint32_t begin = ARM_DWT_CYCCNT;
+    for (SimTask& task : tasks) {
+        TaskManager::registerTask(task.id, pdMS_TO_TICKS(task.periodMs));
+        task.nextWakeCycles = begin + task.phaseUs * cyclesPerUs;
+    }
+
+    // Start a fresh CPU window, then always run the highest-priority ready
+    // task until it finishes or another one wakes, and idle otherwise
+    TaskManager::monitorHealth();
+    uint32_t end = begin + durationMs * cyclesPerMs;
+    SimTask* running = nullptr;
+    while (static_cast<int32_t>(ARM_DWT_CYCCNT - end) < 0) {
+        uint32_t now = ARM_DWT_CYCCNT;
+        SimTask* next = nullptr;
+        uint32_t stepCycles = end - now;
+        for (SimTask& task : tasks) {
+            if (!task.ready && static_cast<int32_t>(task.nextWakeCycles - now) <= 0) {
+                task.ready = true;
+                task.remainingCycles = task.loadUs * cyclesPerUs;
+            }
+            if (task.ready) {
+                next = next != nullptr ? next : &task;
+            } else if (task.nextWakeCycles - now < stepCycles) {
+                stepCycles = task.nextWakeCycles - now;
+            }
+        }
+        if (next != running) {
+            if (running != nullptr) {
+                TaskManager::taskSwitchedOut(running->id);
+            }
+            if (next != nullptr) {
+                TaskManager::taskSwitchedIn(next->id);
+            }
+            running = next;
+        }
+        if (running == nullptr) {
+            Host::advanceCycles(stepCycles);
+            continue;
+        }
+        if (!running->begun) {
+            TaskManager::beginActivation(running->id);
+            running->begun = true;
+        }
+        if (running->remainingCycles < stepCycles) {
+            stepCycles = running->remainingCycles;
+        }
+        Host::advanceCycles(stepCycles);
+        running->remainingCycles -= stepCycles;
+        if (running->remainingCycles == 0) {
+            TaskManager::endActivation(running->id);
+            running->ready = false;
+            running->begun = false;
+            running->nextWakeCycles += running->periodMs * cyclesPerMs;
+        }
+    }
+    TaskManager::monitorHealth();
+
+    bool ok = true;
+    printf("Task accounting over %u ms\n", durationMs);
+    printf("  %-11s %8s %8s %11s %11s %11s %6s\n",
+           "task", "cpu%", "expect%", "exec p50", "exec max", "jitter p99", "late");
+    for (const SimTask& task : tasks) {
+        const TaskTiming& timing = TaskManager::getTaskTiming(task.id);
+        float expected = 100.0f * task.loadUs / (task.periodMs * 1000.0f);
+        float measured = TaskManager::getTaskCPUUsage(task.id);
+        uint32_t execP50 = timing.execution.percentileUs(0.5f);
+        printf("  %-11s %8.1f %8.1f %11u %11u %11u %6u\n", task.name, measured, expected,
+               execP50, timing.execution.maxUs, timing.jitter.percentileUs(0.99f),
+               timing.lateActivations);
+        printf("RESULT task_stats task=%s cpu=%.1f expected=%.1f exec_p50_us=%u exec_max_us=%u jitter_p99_us=%u\n",
+               task.name, measured, expected, execP50, timing.execution.maxUs,
+               timing.jitter.percentileUs(0.99f));
+
+        // Histograms are log2, so p50 is the upper edge of the load's bucket;
+        // the max is exact and would include any preemption
+        bool consistent = measured > expected - 5.0f && measured < expected + 5.0f &&
+                          execP50 >= task.loadUs && execP50 <= 2 * task.loadUs &&
+                          timing.execution.maxUs == task.loadUs;
+        if (!consistent) {
+            printf("  MISMATCH: %s accounting does not match its load\n", task.name);
+            ok = false;
+        }
+    }
+    printf("  total cpu %.1f%%\n", TaskManager::getCPUUsage());
+
+    Host::useSimulatedCycles(false);
+    double hookNs = hookCostNs(1000000);
+    printf("beginActivation + endActivation: %.1f ns\n", hookNs);
+    printf("RESULT task_stats hook_ns=%.1f\n", hookNs);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+/*
+ * B.I.T.E.S - Trace Benchmark
+ *
+ * Reports the cost of one TRACE_SCOPE. With tracing built in
+ * (-DBITS_HOST_TRACE=ON) it also runs the RTOS tasks in real time, dumps
+ * the trace buffers and checks that every instrumented task recorded its
+ * hot-path scopes. The dump can be saved and converted for
+ * chrome://tracing or ui.perfetto.dev:
+ *
+ *   bench_trace --out trace.txt
+ *   tools/trace_export.py trace.txt trace.json
+ *
+ * Usage: bench_trace [--duration-ms N] [--out FILE]
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/trace.h"
+#include "core/system_manager.h"
+#include "sensors/sensor_manager.h"
+#include "audio/audio_manager.h"
+#include "ai/ai_engine.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using namespace BITS;
+
+namespace {
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+volatile uint32_t sink = 0;
+
+double scopeCostNs(uint32_t scopes) {
+    double start = nowNs();
+    for (uint32_t i = 0; i < scopes; i++) {
+        TRACE_SCOPE("bench");
+        sink = sink + i;
+    }
+    double withScope = nowNs() - start;
+
+    start = nowNs();
+    for (uint32_t i = 0; i < scopes; i++) {
+        sink = sink + i;
+    }
+    return (withScope - (nowNs() - start)) / scopes;
+}
+
+#if BITS_TRACE_ENABLED
+
+std::string captured;
+
+bool hasScope(const std::string& dump, uint8_t track, const char* name) {
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "#TRACE X %u ", track);
+    size_t pos = 0;
+    while ((pos = dump.find(prefix, pos)) != std::string::npos) {
+        size_t end = dump.find('\r', pos);
+        std::string line = dump.substr(pos, end - pos);
+        if (line.size() > strlen(name) && line.compare(line.size() - strlen(name), strlen(name), name) == 0) {
+            return true;
+        }
+        pos = end;
+    }
+    return false;
+}
+
+bool runSystem(uint32_t durationMs, const char* outPath) {
+    Host::setSerialSink([](const uint8_t* data, size_t length) {
+        captured.append(reinterpret_cast<const char*>(data), length);
+    });
+
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::MPU6050, 0, 0);
+    Sensors::SensorManager::registerSensor(Sensors::SensorType::PIEZO, 1, A0);
+    AI::AIEngine::enableGestureRecognition(true);
+
+    Core::Tracer::clear();
+    delay(durationMs);
+    captured.clear();
+    Core::Tracer::dump();
+
+    // Keep only the dump lines; deferred log output may interleave
+    std::string dump;
+    size_t pos = 0;
+    while ((pos = captured.find("#TRACE", pos)) != std::string::npos) {
+        size_t end = captured.find('\n', pos);
+        dump += captured.substr(pos, end == std::string::npos ? std::string::npos : end - pos + 1);
+        pos = end;
+    }
+    Host::setSerialSink(nullptr);
+
+    printf("Events per track after %u ms\n", durationMs);
+    for (uint8_t track = 0; track < Core::Tracer::TRACK_COUNT; track++) {
+        printf("  %-12s %6u\n", Core::Tracer::getTrackName(track), Core::Tracer::getEventCount(track));
+    }
+
+    struct Expected {
+        uint8_t track;
+        const char* name;
+    };
+    const Expected expected[] = {
+        {0, "SensorManager::update"},
+        {0, "SensorManager::pollDriverChannel"},
+        {1, "Mixer::update"},
+        {2, "AIEngine::update"},
+        {2, "GestureRecognition::extractFeatures"},
+    };
+    bool ok = true;
+    for (const Expected& scope : expected) {
+        if (!hasScope(dump, scope.track, scope.name)) {
+            printf("  MISSING: %s on %s\n", scope.name, Core::Tracer::getTrackName(scope.track));
+            ok = false;
+        }
+    }
+
+    if (outPath != nullptr) {
+        FILE* file = fopen(outPath, "w");
+        if (file == nullptr) {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            return false;
+        }
+        fwrite(dump.data(), 1, dump.size(), file);
+        fclose(file);
+        printf("Trace dump written to %s\n", outPath);
+    }
+    return ok;
+}
+
+#endif // BITS_TRACE_ENABLED
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 300;
+    const char* outPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: bench_trace [--duration-ms N] [--out FILE]\n");
+            return 2;
+        }
+    }
+
+    double costNs = scopeCostNs(1000000);
+    printf("TRACE_SCOPE (%s): %.1f ns\n", BITS_TRACE_ENABLED ? "enabled" : "compiled out", costNs);
+    printf("RESULT trace enabled=%d scope_ns=%.1f\n", BITS_TRACE_ENABLED, costNs);
+
+#if BITS_TRACE_ENABLED
+    bool ok = runSystem(durationMs, outPath);
+    return ok ? 0 : 1;
+#else
+    (void)durationMs;
+    if (outPath != nullptr) {
+        printf("Nothing to dump: configure with -DBITS_HOST_TRACE=ON\n");
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,171 @@
+/*
+ * B.I.T.E.S - Task Wakeup Benchmark
+ *
+ * Boots the system with the guitar as the active instrument and plucks its
+ * IR strings (a beam break, released 15 ms later) while the RTOS tasks run
+ * in real time. Alternates fixed-period task loops and event-driven wakeups
+ * for a number of rounds, and reports per-task activations and CPU time plus
+ * the latency from the beam break to the instrument playing the note.
+ *
+ * Usage: bench_wakeup [--duration-ms N] [--pluck-interval-ms N] [--rounds N]
+ * The exit code is non-zero unless event-driven mode lowers the total number
+ * of task activations and the median latency, and every pluck plays a note
+ * in both modes. The median over all rounds' plucks is what is compared:
+ * the few plucks a loaded host preempts would sway a mean.
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include "core/system_manager.h"
+#include "core/task_manager.h"
+#include "audio/sample_manager.h"
+#include "instruments/guitar.h"
+#include "rtos/tasks.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace BITS;
+using Core::TaskId;
+using Core::TaskManager;
+
+namespace {
+
+constexpr uint8_t STRINGS = 6;
+constexpr uint8_t FIRST_STRING_PIN = 2;     // As assigned by Guitar::init()
+constexpr uint32_t RELEASE_AFTER_MS = 15;   // Longer than the IR debounce
+constexpr uint32_t NOTE_TIMEOUT_US = 50000;
+
+const TaskId MEASURED_TASKS[] = {TaskId::SENSOR, TaskId::AUDIO, TaskId::AI, TaskId::NETWORK};
+const char* const TASK_NAMES[] = {"sensor", "audio", "ai", "network"};
+
+// Outlives the tasks: it is built before main() registers the kernel's
+// exit handler, so it is destroyed after the handler has stopped them
+Instruments::Guitar guitar;
+
+struct ModeResult {
+    uint32_t activations[4];
+    uint64_t busyUs[4];
+    uint32_t totalActivations;
+    double meanLatencyUs;
+    uint32_t medianLatencyUs;
+    uint32_t maxLatencyUs;
+    uint32_t missed;
+    uint32_t elapsedUs;
+};
+
+// Adds one round of a mode to its totals; latencies are pooled over rounds
+void runMode(bool eventDriven, uint32_t durationMs, uint32_t intervalMs, ModeResult& result,
+             std::vector<uint32_t>& latencies) {
+    RTOS::setEventDriven(eventDriven);
+    delay(50);
+    TaskManager::resetTaskTimings();
+
+    uint32_t start = millis();
+    uint8_t string = 0;
+    while (millis() - start < durationMs) {
+        uint8_t pin = FIRST_STRING_PIN + string;
+        uint32_t notesBefore = Audio::SampleManager::getNotesPlayed();
+        uint32_t broken = micros();
+        Host::setDigitalValue(pin, LOW);
+        while (Audio::SampleManager::getNotesPlayed() == notesBefore && micros() - broken < NOTE_TIMEOUT_US) {
+            yield();
+        }
+        if (Audio::SampleManager::getNotesPlayed() != notesBefore) {
+            latencies.push_back(micros() - broken);
+        } else {
+            result.missed++;
+        }
+        delay(RELEASE_AFTER_MS);
+        Host::setDigitalValue(pin, HIGH);
+        delay(intervalMs > RELEASE_AFTER_MS ? intervalMs - RELEASE_AFTER_MS : 0);
+        string = (string + 1) % STRINGS;
+    }
+    result.elapsedUs += (millis() - start) * 1000;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        const Core::TaskTiming& timing = TaskManager::getTaskTiming(MEASURED_TASKS[i]);
+        result.activations[i] += timing.activations;
+        result.busyUs[i] += TaskManager::cyclesToMicros(timing.busyCycles);
+        result.totalActivations += timing.activations;
+    }
+}
+
+void summarizeLatency(ModeResult& result, std::vector<uint32_t>& latencies) {
+    if (latencies.empty()) {
+        return;
+    }
+    double sum = 0;
+    for (uint32_t latency : latencies) {
+        sum += latency;
+    }
+    result.meanLatencyUs = sum / latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    result.medianLatencyUs = latencies[latencies.size() / 2];
+    result.maxLatencyUs = latencies.back();
+}
+
+void printResult(const char* mode, const ModeResult& result) {
+    printf("%s\n", mode);
+    printf("  %-8s %12s %8s\n", "task", "wakeups/s", "cpu %");
+    for (uint8_t i = 0; i < 4; i++) {
+        printf("  %-8s %12.1f %8.3f\n", TASK_NAMES[i], result.activations[i] * 1000000.0 / result.elapsedUs,
+               100.0 * result.busyUs[i] / result.elapsedUs);
+    }
+    printf("  pluck to note: median %u us, mean %.0f us, max %u us, missed %u\n", result.medianLatencyUs,
+           result.meanLatencyUs, result.maxLatencyUs, result.missed);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t durationMs = 1000;
+    uint32_t intervalMs = 40;
+    uint32_t rounds = 3;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--pluck-interval-ms") == 0 && i + 1 < argc) {
+            intervalMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: bench_wakeup [--duration-ms N] [--pluck-interval-ms N] [--rounds N]\n");
+            return 2;
+        }
+    }
+
+    Host::setSerialEnabled(false);
+    Core::SystemManager::init();
+    while (!Core::SystemManager::isBootComplete()) {
+        delay(1);
+    }
+    guitar.init();
+    RTOS::setActiveInstrument(&guitar);
+
+    // Alternating spreads slow spells of the host over both modes
+    ModeResult fixed = {};
+    ModeResult event = {};
+    std::vector<uint32_t> fixedLatencies;
+    std::vector<uint32_t> eventLatencies;
+    for (uint32_t round = 0; round < rounds; round++) {
+        runMode(false, durationMs, intervalMs, fixed, fixedLatencies);
+        runMode(true, durationMs, intervalMs, event, eventLatencies);
+    }
+    summarizeLatency(fixed, fixedLatencies);
+    summarizeLatency(event, eventLatencies);
+    printResult("Fixed periods", fixed);
+    printResult("Event-driven", event);
+
+    printf("RESULT wakeup fixed_activations=%u event_activations=%u fixed_latency_us=%u "
+           "event_latency_us=%u missed=%u\n",
+           fixed.totalActivations, event.totalActivations, fixed.medianLatencyUs, event.medianLatencyUs,
+           fixed.missed + event.missed);
+
+    bool ok = event.totalActivations < fixed.totalActivations && event.medianLatencyUs < fixed.medianLatencyUs &&
+              fixed.missed == 0 && event.missed == 0;
+    return ok ? 0 : 1;
+}
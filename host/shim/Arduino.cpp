@@ -0,0 +1,371 @@
+#include <Arduino.h>
+#include "host_shim.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+HostSerial Serial;
+
+namespace {
+
+std::atomic<bool> virtualTime{false};
+std::atomic<uint64_t> virtualMicros{0};
+std::atomic<bool> simulatedCycles{false};
+std::atomic<uint32_t> simulatedCycleCount{0};
+std::atomic<bool> serialEnabled{true};
+std::atomic<bool> serialConnected{true};
+std::atomic<uint32_t> analogReadCount{0};
+std::atomic<uint32_t> analogReadDelayUs{0};
+std::atomic<float> boardTemperature{25.0f};
+
+const auto clockOrigin = std::chrono::steady_clock::now();
+
+std::atomic<int> analogValues[BITS::Host::MAX_PINS];
+std::atomic<int> digitalValues[BITS::Host::MAX_PINS];
+std::atomic<uint8_t> pinModes[BITS::Host::MAX_PINS];
+std::atomic<void (*)()> pinInterrupts[BITS::Host::MAX_PINS];
+std::atomic<int> pinInterruptModes[BITS::Host::MAX_PINS];
+// Port input registers, kept in step with digitalValues
+volatile uint32_t portRegisters[BITS::Host::MAX_PINS / 32];
+unsigned int analogResolution = 10;
+
+std::mutex serialLock;
+BITS::Host::SerialSink serialSink;
+
+void setPinLevel(uint8_t pin, int level) {
+    uint32_t mask = 1UL << (pin % 32);
+    if (level) {
+        __atomic_fetch_or(&portRegisters[pin / 32], mask, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_and(&portRegisters[pin / 32], ~mask, __ATOMIC_RELAXED);
+    }
+}
+
+} // namespace
+
+namespace BITS {
+namespace Host {
+
+// Defined in freertos_shim.cpp: wakes tasks blocked on virtual time
+void notifyTimeAdvanced();
+
+void useVirtualTime(bool enable) {
+    if (enable && !virtualTime) {
+        virtualMicros = nowMicros();
+    }
+    virtualTime = enable;
+}
+
+bool isVirtualTime() {
+    return virtualTime;
+}
+
+uint64_t nowMicros() {
+    if (virtualTime) {
+        return virtualMicros;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - clockOrigin).count());
+}
+
+void advanceTime(uint32_t us) {
+    if (virtualTime) {
+        virtualMicros += us;
+        notifyTimeAdvanced();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void useSimulatedCycles(bool enable) {
+    if (enable && !simulatedCycles) {
+        simulatedCycleCount = hostCycleCount();
+    }
+    simulatedCycles = enable;
+}
+
+void advanceCycles(uint32_t cycles) {
+    simulatedCycleCount += cycles;
+}
+
+void setAnalogValue(uint8_t pin, int value) {
+    analogValues[pin] = value;
+}
+
+void setDigitalValue(uint8_t pin, int value) {
+    int level = value ? HIGH : LOW;
+    int previous = digitalValues[pin].exchange(level);
+    setPinLevel(pin, level);
+    void (*handler)() = pinInterrupts[pin];
+    if (handler == nullptr || level == previous) {
+        return;
+    }
+    int mode = pinInterruptModes[pin];
+    if (mode == CHANGE || (mode == RISING && level == HIGH) || (mode == FALLING && level == LOW)) {
+        handler();
+    }
+}
+
+uint8_t getPinMode(uint8_t pin) {
+    return pinModes[pin];
+}
+
+void setAnalogReadDelay(uint32_t us) {
+    analogReadDelayUs = us;
+}
+
+uint32_t getAnalogReadCount() {
+    return analogReadCount;
+}
+
+void setBoardTemperature(float celsius) {
+    boardTemperature = celsius;
+}
+
+void setSerialEnabled(bool enable) {
+    serialEnabled = enable;
+}
+
+void setSerialConnected(bool connected) {
+    serialConnected = connected;
+}
+
+void setSerialSink(SerialSink sink) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    serialSink = sink;
+}
+
+} // namespace Host
+} // namespace BITS
+
+uint32_t F_CPU_ACTUAL = 600000000;
+
+uint32_t hostCycleCount() {
+    if (simulatedCycles) {
+        return simulatedCycleCount;
+    }
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - clockOrigin).count());
+    return static_cast<uint32_t>(ns * (F_CPU_ACTUAL / 1000000) / 1000);
+}
+
+uint32_t millis() {
+    return static_cast<uint32_t>(BITS::Host::nowMicros() / 1000);
+}
+
+uint32_t micros() {
+    return static_cast<uint32_t>(BITS::Host::nowMicros());
+}
+
+void delay(uint32_t ms) {
+    BITS::Host::advanceTime(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    BITS::Host::advanceTime(us);
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+        digitalValues[pin] = HIGH;
+        setPinLevel(pin, HIGH);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return digitalValues[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    digitalValues[pin] = value ? HIGH : LOW;
+    setPinLevel(pin, value ? HIGH : LOW);
+}
+
+volatile uint32_t* portInputRegister(uint8_t pin) {
+    return &portRegisters[pin / 32];
+}
+
+uint32_t digitalPinToBitMask(uint8_t pin) {
+    return 1UL << (pin % 32);
+}
+
+void attachInterrupt(uint8_t pin, void (*function)(), int mode) {
+    pinInterruptModes[pin] = mode;
+    pinInterrupts[pin] = function;
+}
+
+void detachInterrupt(uint8_t pin) {
+    pinInterrupts[pin] = nullptr;
+}
+
+float tempmonGetTemp() {
+    return boardTemperature;
+}
+
+int analogRead(uint8_t pin) {
+    analogReadCount++;
+    uint32_t delayUs = analogReadDelayUs;
+    if (delayUs > 0) {
+        if (virtualTime) {
+            BITS::Host::advanceTime(delayUs);
+        } else {
+            // A conversion busy-waits on target
+            uint64_t until = BITS::Host::nowMicros() + delayUs;
+            while (BITS::Host::nowMicros() < until) {
+            }
+        }
+    }
+    int value = analogValues[pin];
+    int maxValue = (1 << analogResolution) - 1;
+    return constrain(value, 0, maxValue);
+}
+
+void analogReadResolution(unsigned int bits) {
+    analogResolution = constrain(bits, 1u, 16u);
+}
+
+IntervalTimer::~IntervalTimer() {
+    end();
+}
+
+bool IntervalTimer::begin(void (*callback)(), uint32_t microseconds) {
+    end();
+    if (callback == nullptr || microseconds == 0) {
+        return false;
+    }
+    function = callback;
+    periodUs = microseconds;
+    running = true;
+    if (pthread_create(&thread, nullptr, run, this) != 0) {
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+void IntervalTimer::update(uint32_t microseconds) {
+    // Takes effect from the next interrupt, as on target
+    if (microseconds > 0) {
+        periodUs = microseconds;
+    }
+}
+
+void IntervalTimer::end() {
+    if (running.exchange(false)) {
+        pthread_join(thread, nullptr);
+    }
+}
+
+void* IntervalTimer::run(void* arg) {
+    IntervalTimer* timer = static_cast<IntervalTimer*>(arg);
+    uint64_t next = BITS::Host::nowMicros();
+    while (timer->running) {
+        uint32_t period = timer->periodUs;
+        next += period;
+        uint64_t now = BITS::Host::nowMicros();
+        while (timer->running && now < next) {
+            // Short sleeps keep end() responsive and follow virtual time
+            uint64_t remaining = next - now;
+            std::this_thread::sleep_for(std::chrono::microseconds(remaining < 1000 ? remaining : 1000));
+            now = BITS::Host::nowMicros();
+        }
+        if (!timer->running) {
+            break;
+        }
+        if (now - next >= period) {
+            // Fell a whole period behind: skip, the PIT does not queue interrupts
+            next = now;
+        }
+        timer->function.load()();
+    }
+    return nullptr;
+}
+
+void HostSerial::begin(uint32_t) {}
+
+void HostSerial::end() {}
+
+HostSerial::operator bool() const {
+    return serialConnected;
+}
+
+int HostSerial::available() {
+    return 0;
+}
+
+int HostSerial::read() {
+    return -1;
+}
+
+void HostSerial::flush() {
+    if (serialEnabled) {
+        fflush(stdout);
+    }
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    if (!serialEnabled || !serialConnected || buffer == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(serialLock);
+    if (serialSink) {
+        serialSink(buffer, size);
+        return size;
+    }
+    return fwrite(buffer, 1, size, stdout);
+}
+
+size_t HostSerial::print(const char* s) {
+    if (s == nullptr) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(s), strlen(s));
+}
+
+size_t HostSerial::print(char c) {
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t HostSerial::print(int value) {
+    return printf("%d", value);
+}
+
+size_t HostSerial::print(unsigned int value) {
+    return printf("%u", value);
+}
+
+size_t HostSerial::print(long value) {
+    return printf("%ld", value);
+}
+
+size_t HostSerial::print(unsigned long value) {
+    return printf("%lu", value);
+}
+
+size_t HostSerial::print(double value, int digits) {
+    return printf("%.*f", digits, value);
+}
+
+size_t HostSerial::println() {
+    size_t n = print("\n");
+    flush();
+    return n;
+}
+
+int HostSerial::printf(const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (n <= 0) {
+        return n;
+    }
+    return static_cast<int>(print(buffer));
+}
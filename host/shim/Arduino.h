@@ -0,0 +1,172 @@
+#ifndef BITS_HOST_ARDUINO_H
+#define BITS_HOST_ARDUINO_H
+
+/*
+ * B.I.T.E.S - Host Arduino Shim
+ *
+ * Minimal stand-in for the Teensyduino core so the engine builds natively
+ * on Linux. Only the API surface used under src/ is provided. Pin state and
+ * time are driven through host/shim/host_shim.h.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <atomic>
+#include <pthread.h>
+
+using std::abs;
+
+// Pin modes and levels
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define LOW 0
+#define HIGH 1
+
+// Interrupt trigger modes
+#define FALLING 2
+#define RISING 3
+#define CHANGE 4
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+// Teensy 4.1 analog pin numbers
+enum : uint8_t {
+    A0 = 14, A1 = 15, A2 = 16, A3 = 17, A4 = 18, A5 = 19, A6 = 20, A7 = 21,
+    A8 = 22, A9 = 23, A10 = 24, A11 = 25, A12 = 26, A13 = 27, A14 = 38,
+    A15 = 39, A16 = 40, A17 = 41
+};
+
+template <typename T, typename L, typename H>
+inline T constrain(T amt, L low, H high) {
+    return amt < static_cast<T>(low) ? static_cast<T>(low)
+         : (amt > static_cast<T>(high) ? static_cast<T>(high) : amt);
+}
+
+// Time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Cycle counter (DWT CYCCNT on Teensy 4, wraps every ~7 s at 600 MHz). The
+// host derives it from the monotonic clock, even in virtual time, so
+// measured execution costs are real (see Host::useSimulatedCycles()).
+extern uint32_t F_CPU_ACTUAL;
+uint32_t hostCycleCount();
+#define ARM_DWT_CYCCNT (hostCycleCount())
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+
+// GPIO port input registers (the PSR of GPIO6-9 on Teensy 4). On the host
+// pin p is bit p % 32 of port p / 32; code resolves the mapping through
+// these rather than assuming it.
+volatile uint32_t* portInputRegister(uint8_t pin);
+uint32_t digitalPinToBitMask(uint8_t pin);
+
+// Pin interrupts. On the host, Host::setDigitalValue() runs the handler on
+// the caller's thread when the level change matches the mode.
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t pin, void (*function)(), int mode);
+void detachInterrupt(uint8_t pin);
+void analogReadResolution(unsigned int bits);
+
+// Die temperature in °C (TEMPMON on Teensy 4); set with Host::setBoardTemperature()
+float tempmonGetTemp();
+
+// Periodic interrupt timer (Teensy PIT channel). On the host the callback
+// runs on a timer thread paced by the shim clock. The thread is a plain
+// pthread, so timers may start after the heap has been locked.
+class IntervalTimer {
+public:
+    IntervalTimer() = default;
+    ~IntervalTimer();
+    IntervalTimer(const IntervalTimer&) = delete;
+    IntervalTimer& operator=(const IntervalTimer&) = delete;
+
+    bool begin(void (*function)(), uint32_t microseconds);
+    void update(uint32_t microseconds);
+    void end();
+
+private:
+    std::atomic<void (*)()> function{nullptr};
+    std::atomic<uint32_t> periodUs{0};
+    std::atomic<bool> running{false};
+    pthread_t thread;
+
+    static void* run(void* timer);
+};
+
+// Arduino String (subset)
+class String {
+public:
+    String() = default;
+    String(const char* s) : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    explicit String(int value) : str(std::to_string(value)) {}
+    explicit String(unsigned long value) : str(std::to_string(value)) {}
+
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(str.size()); }
+    bool equals(const String& other) const { return str == other.str; }
+    bool operator==(const String& other) const { return str == other.str; }
+    bool operator!=(const String& other) const { return str != other.str; }
+    String& operator+=(const String& other) { str += other.str; return *this; }
+    String& operator+=(char c) { str += c; return *this; }
+    String operator+(const String& other) const { return String(str + other.str); }
+    char operator[](unsigned int index) const { return index < str.size() ? str[index] : '\0'; }
+
+private:
+    std::string str;
+};
+
+// Serial (USB CDC on target, stdout on host)
+class HostSerial {
+public:
+    void begin(uint32_t baudRate);
+    void end();
+    explicit operator bool() const;
+    int available();
+    int read();
+    void flush();
+
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T>
+    size_t println(const T& value) {
+        size_t n = print(value);
+        return n + println();
+    }
+
+    int printf(const char* format, ...);
+};
+
+extern HostSerial Serial;
+
+#endif // BITS_HOST_ARDUINO_H
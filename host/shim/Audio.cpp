@@ -0,0 +1,315 @@
+#include <Audio.h>
+#include "host_shim.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+uint16_t AudioStream::memory_used = 0;
+uint16_t AudioStream::memory_used_max = 0;
+float AudioStream::cpu_usage_total = 0.0f;
+float AudioStream::cpu_usage_total_max = 0.0f;
+AudioStream* AudioStream::firstUpdate = nullptr;
+
+namespace {
+
+// Function-local so it is usable from AudioStream objects constructed during
+// static initialisation in other translation units
+std::recursive_mutex& audioLock() {
+    static std::recursive_mutex lock;
+    return lock;
+}
+
+std::vector<audio_block_t> memoryPool;
+std::vector<bool> memoryInUse;
+BITS::Host::AudioSink audioSink;
+
+constexpr float BLOCK_PERIOD_US = AUDIO_BLOCK_SAMPLES * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT;
+
+} // namespace
+
+void AudioNoInterrupts() {
+    audioLock().lock();
+}
+
+void AudioInterrupts() {
+    audioLock().unlock();
+}
+
+// AudioStream
+
+AudioStream::AudioStream(unsigned char ninput, audio_block_t** iqueue)
+    : numInputs(ninput), inputQueue(iqueue), destinationList(nullptr),
+      cpuUsage(0.0f), cpuUsageMax(0.0f), nextUpdate(nullptr) {
+    for (unsigned char i = 0; i < numInputs; i++) {
+        inputQueue[i] = nullptr;
+    }
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    if (firstUpdate == nullptr) {
+        firstUpdate = this;
+    } else {
+        AudioStream* p = firstUpdate;
+        while (p->nextUpdate) p = p->nextUpdate;
+        p->nextUpdate = this;
+    }
+}
+
+AudioStream::~AudioStream() {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    AudioStream** p = &firstUpdate;
+    while (*p && *p != this) p = &(*p)->nextUpdate;
+    if (*p) *p = nextUpdate;
+}
+
+void AudioStream::initialize_memory(unsigned int num) {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    if (!memoryPool.empty()) {
+        return; // Like the target, the pool is sized once
+    }
+    memoryPool.resize(num);
+    memoryInUse.assign(num, false);
+    for (unsigned int i = 0; i < num; i++) {
+        memoryPool[i].memory_pool_index = static_cast<uint16_t>(i);
+    }
+}
+
+audio_block_t* AudioStream::allocate() {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    for (size_t i = 0; i < memoryPool.size(); i++) {
+        if (!memoryInUse[i]) {
+            memoryInUse[i] = true;
+            audio_block_t* block = &memoryPool[i];
+            block->ref_count = 1;
+            memory_used++;
+            if (memory_used > memory_used_max) memory_used_max = memory_used;
+            return block;
+        }
+    }
+    return nullptr;
+}
+
+void AudioStream::release(audio_block_t* block) {
+    if (block == nullptr) {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    if (block->ref_count > 1) {
+        block->ref_count--;
+    } else {
+        memoryInUse[block->memory_pool_index] = false;
+        memory_used--;
+    }
+}
+
+void AudioStream::transmit(audio_block_t* block, unsigned char index) {
+    for (AudioConnection* c = destinationList; c != nullptr; c = c->nextDest) {
+        if (c->srcIndex == index && c->dst.inputQueue[c->destIndex] == nullptr) {
+            c->dst.inputQueue[c->destIndex] = block;
+            block->ref_count++;
+        }
+    }
+}
+
+audio_block_t* AudioStream::receiveReadOnly(unsigned int index) {
+    if (index >= numInputs) {
+        return nullptr;
+    }
+    audio_block_t* block = inputQueue[index];
+    inputQueue[index] = nullptr;
+    return block;
+}
+
+audio_block_t* AudioStream::receiveWritable(unsigned int index) {
+    audio_block_t* block = receiveReadOnly(index);
+    if (block && block->ref_count > 1) {
+        audio_block_t* copy = allocate();
+        if (copy) {
+            memcpy(copy->data, block->data, sizeof(copy->data));
+        }
+        release(block);
+        block = copy;
+    }
+    return block;
+}
+
+void AudioStream::update_all() {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    auto start = std::chrono::steady_clock::now();
+    for (AudioStream* p = firstUpdate; p != nullptr; p = p->nextUpdate) {
+        auto objectStart = std::chrono::steady_clock::now();
+        p->update();
+        float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - objectStart).count();
+        p->cpuUsage = us / BLOCK_PERIOD_US * 100.0f;
+        if (p->cpuUsage > p->cpuUsageMax) p->cpuUsageMax = p->cpuUsage;
+    }
+    float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    cpu_usage_total = us / BLOCK_PERIOD_US * 100.0f;
+    if (cpu_usage_total > cpu_usage_total_max) cpu_usage_total_max = cpu_usage_total;
+}
+
+// AudioConnection
+
+AudioConnection::AudioConnection(AudioStream& source, AudioStream& destination)
+    : AudioConnection(source, 0, destination, 0) {
+}
+
+AudioConnection::AudioConnection(AudioStream& source, unsigned char sourceOutput,
+                                 AudioStream& destination, unsigned char destinationInput)
+    : src(source), dst(destination), srcIndex(sourceOutput), destIndex(destinationInput),
+      nextDest(nullptr) {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    AudioConnection** p = &src.destinationList;
+    while (*p) p = &(*p)->nextDest;
+    *p = this;
+}
+
+AudioConnection::~AudioConnection() {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    AudioConnection** p = &src.destinationList;
+    while (*p && *p != this) p = &(*p)->nextDest;
+    if (*p) *p = nextDest;
+}
+
+// AudioPlayMemory
+
+void AudioPlayMemory::play(const unsigned int* data) {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    playing = false;
+    if (data == nullptr) {
+        return;
+    }
+    uint32_t header = data[0];
+    if ((header >> 24) != 0x81) {
+        return;
+    }
+    beginning = data + 1;
+    next = beginning;
+    length = header & 0xFFFFFF;
+    position = 0;
+    playing = length > 0;
+}
+
+void AudioPlayMemory::stop() {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    playing = false;
+}
+
+uint32_t AudioPlayMemory::positionMillis() {
+    return static_cast<uint32_t>(position * 1000.0f / AUDIO_SAMPLE_RATE_EXACT);
+}
+
+uint32_t AudioPlayMemory::lengthMillis() {
+    return static_cast<uint32_t>(length * 1000.0f / AUDIO_SAMPLE_RATE_EXACT);
+}
+
+void AudioPlayMemory::update() {
+    if (!playing) {
+        return;
+    }
+    audio_block_t* block = allocate();
+    if (block == nullptr) {
+        return;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int16_t sample = 0;
+        if (position < length) {
+            uint32_t word = beginning[position / 2];
+            sample = static_cast<int16_t>((position & 1) ? (word >> 16) : (word & 0xFFFF));
+            position++;
+        }
+        block->data[i] = sample;
+    }
+    if (position >= length) {
+        playing = false;
+    }
+    transmit(block);
+    release(block);
+}
+
+// AudioMixer4
+
+void AudioMixer4::update() {
+    int32_t sum[AUDIO_BLOCK_SAMPLES] = {0};
+    bool any = false;
+    for (unsigned int channel = 0; channel < 4; channel++) {
+        audio_block_t* in = receiveReadOnly(channel);
+        if (in == nullptr) {
+            continue;
+        }
+        any = true;
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            sum[i] += static_cast<int32_t>(in->data[i] * multiplier[channel]);
+        }
+        release(in);
+    }
+    if (!any) {
+        return;
+    }
+    audio_block_t* out = allocate();
+    if (out == nullptr) {
+        return;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        out->data[i] = static_cast<int16_t>(constrain(sum[i], -32768, 32767));
+    }
+    transmit(out);
+    release(out);
+}
+
+// AudioOutputI2S
+
+void AudioOutputI2S::update() {
+    static const int16_t silence[AUDIO_BLOCK_SAMPLES] = {0};
+    audio_block_t* left = receiveReadOnly(0);
+    audio_block_t* right = receiveReadOnly(1);
+    if (audioSink) {
+        audioSink(left ? left->data : silence, right ? right->data : silence, AUDIO_BLOCK_SAMPLES);
+    }
+    release(left);
+    release(right);
+}
+
+// Effects
+
+void AudioEffectReverb::update() {
+    audio_block_t* block = receiveReadOnly(0);
+    if (block) {
+        transmit(block);
+        release(block);
+    }
+}
+
+void AudioEffectFreeverb::update() {
+    audio_block_t* block = receiveReadOnly(0);
+    if (block) {
+        transmit(block);
+        release(block);
+    }
+}
+
+void AudioEffectDelay::update() {
+    audio_block_t* block = receiveReadOnly(0);
+    if (block == nullptr) {
+        return;
+    }
+    for (unsigned char channel = 0; channel < 8; channel++) {
+        if (delayMs[channel] >= 0.0f) {
+            transmit(block, channel);
+        }
+    }
+    release(block);
+}
+
+namespace BITS {
+namespace Host {
+
+void renderAudioBlock() {
+    AudioStream::update_all();
+}
+
+void setAudioSink(AudioSink sink) {
+    std::lock_guard<std::recursive_mutex> lock(audioLock());
+    audioSink = sink;
+}
+
+} // namespace Host
+} // namespace BITS
@@ -0,0 +1,195 @@
+#ifndef BITS_HOST_AUDIO_H
+#define BITS_HOST_AUDIO_H
+
+/*
+ * B.I.T.E.S - Host Teensy Audio Shim
+ *
+ * Subset of the Teensy Audio Library block graph. Objects register in
+ * construction order and BITS::Host::renderAudioBlock() runs one update
+ * pass over them, the host equivalent of the audio software interrupt.
+ * Blocks are reference counted and drawn from the AudioMemory() pool.
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44100.0f
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+
+typedef struct audio_block_struct {
+    uint8_t ref_count;
+    uint8_t reserved1;
+    uint16_t memory_pool_index;
+    int16_t data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioConnection;
+
+class AudioStream {
+public:
+    AudioStream(unsigned char ninput, audio_block_t** iqueue);
+    virtual ~AudioStream();
+
+    static void initialize_memory(unsigned int num);
+    static void update_all();
+
+    float processorUsage() const { return cpuUsage; }
+    float processorUsageMax() const { return cpuUsageMax; }
+    void processorUsageMaxReset() { cpuUsageMax = cpuUsage; }
+
+    static uint16_t memory_used;
+    static uint16_t memory_used_max;
+    static float cpu_usage_total;
+    static float cpu_usage_total_max;
+
+protected:
+    static audio_block_t* allocate();
+    static void release(audio_block_t* block);
+    void transmit(audio_block_t* block, unsigned char index = 0);
+    audio_block_t* receiveReadOnly(unsigned int index = 0);
+    audio_block_t* receiveWritable(unsigned int index = 0);
+
+private:
+    friend class AudioConnection;
+    virtual void update() = 0;
+
+    unsigned char numInputs;
+    audio_block_t** inputQueue;
+    AudioConnection* destinationList;
+    float cpuUsage;
+    float cpuUsageMax;
+    AudioStream* nextUpdate;
+    static AudioStream* firstUpdate;
+};
+
+class AudioConnection {
+public:
+    AudioConnection(AudioStream& source, AudioStream& destination);
+    AudioConnection(AudioStream& source, unsigned char sourceOutput,
+                    AudioStream& destination, unsigned char destinationInput);
+    ~AudioConnection();
+
+private:
+    friend class AudioStream;
+    AudioStream& src;
+    AudioStream& dst;
+    unsigned char srcIndex;
+    unsigned char destIndex;
+    AudioConnection* nextDest;
+};
+
+#define AudioMemory(num) AudioStream::initialize_memory(num)
+#define AudioMemoryUsage() (AudioStream::memory_used)
+#define AudioMemoryUsageMax() (AudioStream::memory_used_max)
+#define AudioMemoryUsageMaxReset() (AudioStream::memory_used_max = AudioStream::memory_used)
+#define AudioProcessorUsage() (AudioStream::cpu_usage_total)
+#define AudioProcessorUsageMax() (AudioStream::cpu_usage_total_max)
+#define AudioProcessorUsageMaxReset() (AudioStream::cpu_usage_total_max = AudioStream::cpu_usage_total)
+
+// Blocks the render pass, like masking the audio interrupt on target
+void AudioNoInterrupts();
+void AudioInterrupts();
+
+// Plays Teensy-format sample arrays (header word: format << 24 | length).
+// Only 16-bit PCM at 44.1 kHz (format 0x81) is supported on the host.
+class AudioPlayMemory : public AudioStream {
+public:
+    AudioPlayMemory() : AudioStream(0, nullptr), next(nullptr), beginning(nullptr),
+                        length(0), position(0), playing(false) {}
+    void play(const unsigned int* data);
+    void stop();
+    bool isPlaying() { return playing; }
+    uint32_t positionMillis();
+    uint32_t lengthMillis();
+
+private:
+    void update() override;
+    const unsigned int* next;
+    const unsigned int* beginning;
+    uint32_t length;
+    uint32_t position;
+    volatile bool playing;
+};
+
+class AudioMixer4 : public AudioStream {
+public:
+    AudioMixer4() : AudioStream(4, inputQueueArray) {
+        for (int i = 0; i < 4; i++) multiplier[i] = 1.0f;
+    }
+    void gain(unsigned int channel, float gain) {
+        if (channel < 4) multiplier[channel] = gain;
+    }
+
+private:
+    void update() override;
+    audio_block_t* inputQueueArray[4];
+    float multiplier[4];
+};
+
+// Stereo output; rendered blocks are handed to BITS::Host::setAudioSink()
+class AudioOutputI2S : public AudioStream {
+public:
+    AudioOutputI2S() : AudioStream(2, inputQueueArray) {}
+
+private:
+    void update() override;
+    audio_block_t* inputQueueArray[2];
+};
+
+class AudioControlSGTL5000 {
+public:
+    bool enable() { enabled = true; return true; }
+    bool disable() { enabled = false; return true; }
+    bool volume(float level) { currentVolume = level; return true; }
+    float getVolume() const { return currentVolume; }
+
+private:
+    bool enabled = false;
+    float currentVolume = 0.0f;
+};
+
+// Effects pass audio through unchanged on the host; parameters are recorded
+class AudioEffectReverb : public AudioStream {
+public:
+    AudioEffectReverb() : AudioStream(1, inputQueueArray), time(0.0f) {}
+    void reverbTime(float seconds) { time = seconds; }
+
+private:
+    void update() override;
+    audio_block_t* inputQueueArray[1];
+    float time;
+};
+
+class AudioEffectFreeverb : public AudioStream {
+public:
+    AudioEffectFreeverb() : AudioStream(1, inputQueueArray), size(0.5f), damp(0.5f) {}
+    void roomsize(float n) { size = n; }
+    void damping(float n) { damp = n; }
+
+private:
+    void update() override;
+    audio_block_t* inputQueueArray[1];
+    float size;
+    float damp;
+};
+
+class AudioEffectDelay : public AudioStream {
+public:
+    AudioEffectDelay() : AudioStream(1, inputQueueArray) {
+        for (int i = 0; i < 8; i++) delayMs[i] = -1.0f;
+    }
+    void delay(uint8_t channel, float milliseconds) {
+        if (channel < 8) delayMs[channel] = milliseconds;
+    }
+    void disable(uint8_t channel) {
+        if (channel < 8) delayMs[channel] = -1.0f;
+    }
+
+private:
+    void update() override;
+    audio_block_t* inputQueueArray[1];
+    float delayMs[8];
+};
+
+#endif // BITS_HOST_AUDIO_H
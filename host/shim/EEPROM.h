@@ -0,0 +1,107 @@
+#ifndef BITS_HOST_EEPROM_H
+#define BITS_HOST_EEPROM_H
+
+/*
+ * B.I.T.E.S - Host EEPROM Shim
+ *
+ * RAM-backed emulation of the Teensy 4.1 EEPROM (4284 bytes). Erased cells
+ * read as 0xFF. begin()/commit() are accepted for the code paths that
+ * use them and are no-ops here. Host only: setBackingFile() loads a file and
+ * writes every change through to it, so data survives between runs, and
+ * per-cell write counts are kept for wear accounting.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+class EEPROMClass {
+public:
+    static constexpr uint16_t SIZE = 4284;
+
+    EEPROMClass() { erase(); }
+    ~EEPROMClass() { setBackingFile(nullptr); }
+
+    void begin(uint16_t) {}
+    bool commit() {
+        if (file != nullptr) fflush(file);
+        return true;
+    }
+
+    uint8_t read(int address) const {
+        return inRange(address) ? data[address] : 0xFF;
+    }
+    void write(int address, uint8_t value) {
+        if (inRange(address)) {
+            data[address] = value;
+            writeCount++;
+            cellWrites[address]++;
+            if (file != nullptr) {
+                fseek(file, address, SEEK_SET);
+                fputc(value, file);
+            }
+        }
+    }
+    void update(int address, uint8_t value) {
+        if (read(address) != value) write(address, value);
+    }
+    uint16_t length() const { return SIZE; }
+
+    template <typename T>
+    T& get(int address, T& value) const {
+        if (address >= 0 && address + sizeof(T) <= SIZE) memcpy(&value, &data[address], sizeof(T));
+        return value;
+    }
+    template <typename T>
+    const T& put(int address, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); i++) update(address + static_cast<int>(i), bytes[i]);
+        return value;
+    }
+
+    // Host only: number of cell writes, for wear accounting
+    uint32_t getWriteCount() const { return writeCount; }
+    uint32_t getWriteCount(int address) const { return inRange(address) ? cellWrites[address] : 0; }
+    void resetWriteCounts() {
+        writeCount = 0;
+        memset(cellWrites, 0, sizeof(cellWrites));
+    }
+
+    // Host only: back the contents with a file (nullptr detaches). A missing
+    // or short file reads as erased. Returns false if it cannot be opened.
+    bool setBackingFile(const char* path) {
+        if (file != nullptr) {
+            fclose(file);
+            file = nullptr;
+        }
+        if (path == nullptr) return true;
+
+        erase();
+        file = fopen(path, "r+b");
+        if (file != nullptr) {
+            size_t got = fread(data, 1, SIZE, file);
+            (void)got;
+        } else {
+            file = fopen(path, "w+b");
+            if (file == nullptr) return false;
+        }
+        fseek(file, 0, SEEK_SET);
+        fwrite(data, 1, SIZE, file);
+        fflush(file);
+        return true;
+    }
+
+    // Host only: back to the erased state (file contents are not touched)
+    void erase() { memset(data, 0xFF, sizeof(data)); }
+
+private:
+    static bool inRange(int address) { return address >= 0 && address < SIZE; }
+    uint8_t data[SIZE];
+    uint32_t cellWrites[SIZE] = {};
+    uint32_t writeCount = 0;
+    FILE* file = nullptr;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // BITS_HOST_EEPROM_H
@@ -0,0 +1,72 @@
+#ifndef BITS_HOST_FREERTOS_H
+#define BITS_HOST_FREERTOS_H
+
+/*
+ * B.I.T.E.S - Host FreeRTOS Shim
+ *
+ * Implements the subset of the FreeRTOS API used by the engine on top of
+ * std::thread. All kernel objects share one lock, which mirrors the
+ * single-core critical sections of the target. Task priorities are recorded
+ * but not enforced by the host scheduler.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define configTOTAL_HEAP_SIZE ((size_t)(512 * 1024))
+#define configMAX_PRIORITIES 8
+#define configMINIMAL_STACK_SIZE 128
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL ((BaseType_t)0)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((uint64_t)(xTimeInMs) * (uint64_t)configTICK_RATE_HZ) / (uint64_t)1000U))
+#define pdTICKS_TO_MS(xTicks) \
+    ((uint32_t)(((uint64_t)(xTicks) * (uint64_t)1000U) / (uint64_t)configTICK_RATE_HZ))
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+#define portEND_SWITCHING_ISR(x) ((void)(x))
+
+void vPortEnterCritical();
+void vPortExitCritical();
+#define portENTER_CRITICAL() vPortEnterCritical()
+#define portEXIT_CRITICAL() vPortExitCritical()
+#define taskENTER_CRITICAL() vPortEnterCritical()
+#define taskEXIT_CRITICAL() vPortExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR() (vPortEnterCritical(), (UBaseType_t)0)
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x), vPortExitCritical())
+
+// Caller-provided control blocks for the *CreateStatic APIs, sized like the
+// target's. The host keeps its own bookkeeping; these only stand in for the
+// memory so that static objects never count against the heap.
+typedef struct xSTATIC_TCB { uint8_t ucDummy[96]; } StaticTask_t;
+typedef struct xSTATIC_QUEUE { uint8_t ucDummy[80]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+typedef struct xSTATIC_TIMER { uint8_t ucDummy[48]; } StaticTimer_t;
+
+size_t xPortGetFreeHeapSize();
+size_t xPortGetMinimumEverFreeHeapSize();
+void* pvPortMalloc(size_t size);
+void vPortFree(void* ptr);
+
+// Called for every FreeRTOS heap allocation (pvPortMalloc and the dynamic
+// create APIs), as traceMALLOC in FreeRTOSConfig.h does on target. The shim
+// provides an empty weak default that applications may override.
+extern "C" void vApplicationHeapAllocHook(size_t xWantedSize);
+
+#endif // BITS_HOST_FREERTOS_H
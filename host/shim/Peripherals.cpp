@@ -0,0 +1,5 @@
+#include <EEPROM.h>
+#include <WiFi.h>
+
+EEPROMClass EEPROM;
+WiFiClass WiFi;
@@ -0,0 +1,72 @@
+#ifndef BITS_HOST_WIFI_H
+#define BITS_HOST_WIFI_H
+
+/*
+ * B.I.T.E.S - Host WiFi Shim
+ *
+ * Offline stand-in for the WiFi module API. begin() never associates, so
+ * status() stays WL_DISCONNECTED; servers accept no clients.
+ */
+
+#include <Arduino.h>
+
+#define WIFI_STA 1
+#define WIFI_AP 2
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class IPAddress {
+public:
+    IPAddress() : octets{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+    String toString() const {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(buffer);
+    }
+
+private:
+    uint8_t octets[4];
+};
+
+class WiFiClient {
+public:
+    explicit operator bool() const { return false; }
+    String readStringUntil(char) { return String(""); }
+    size_t readBytesUntil(char, char*, size_t) { return 0; }
+    void flush() {}
+    size_t println(const char* = "") { return 0; }
+    void stop() {}
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port) : port(port) {}
+    void begin() {}
+    void stop() {}
+    WiFiClient available() { return WiFiClient(); }
+
+private:
+    uint16_t port;
+};
+
+class WiFiClass {
+public:
+    void mode(int) {}
+    int begin(const char*, const char*) { return WL_DISCONNECTED; }
+    void disconnect() {}
+    wl_status_t status() const { return WL_DISCONNECTED; }
+    IPAddress localIP() const { return IPAddress(); }
+    int32_t RSSI() const { return 0; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // BITS_HOST_WIFI_H
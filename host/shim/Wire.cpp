@@ -0,0 +1,298 @@
+#include <Wire.h>
+#include <i2c_driver.h>
+#include "host_shim.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+TwoWire Wire2(2);
+
+namespace {
+
+constexpr uint8_t BUS_COUNT = 3;
+BITS::Host::I2CDevice* devices[BUS_COUNT][128] = {};
+std::atomic<uint32_t> deviceLatencies[BUS_COUNT][128];
+std::atomic<uint32_t> transactionCounts[BUS_COUNT];
+
+void attachDefaultDevices() {
+    static bool attached = false;
+    if (!attached) {
+        attached = true;
+        devices[0][0x68] = &BITS::Host::defaultMPU6050();
+    }
+}
+
+BITS::Host::I2CDevice* findDevice(uint8_t bus, uint8_t address) {
+    if (bus >= BUS_COUNT || address >= 128) {
+        return nullptr;
+    }
+    attachDefaultDevices();
+    return devices[bus][address];
+}
+
+} // namespace
+
+namespace BITS {
+namespace Host {
+
+// MPU6050 register map (subset)
+constexpr uint8_t MPU_REG_SMPLRT_DIV = 0x19;
+constexpr uint8_t MPU_REG_CONFIG = 0x1A;
+constexpr uint8_t MPU_REG_INT_ENABLE = 0x38;
+constexpr uint8_t MPU_REG_INT_STATUS = 0x3A;
+constexpr uint8_t MPU_REG_ACCEL_XOUT_H = 0x3B;
+constexpr uint8_t MPU_REG_TEMP_OUT_H = 0x41;
+constexpr uint8_t MPU_REG_GYRO_XOUT_H = 0x43;
+constexpr uint8_t MPU_REG_PWR_MGMT_1 = 0x6B;
+constexpr uint8_t MPU_REG_WHO_AM_I = 0x75;
+
+SimulatedMPU6050::SimulatedMPU6050() : burstReads(0), lastSample(UINT64_MAX) {
+    memset(registers, 0, sizeof(registers));
+    registers[MPU_REG_PWR_MGMT_1] = 0x40; // Sleep bit set after reset
+    registers[MPU_REG_WHO_AM_I] = 0x68;
+    setAccel(0.0f, 0.0f, 1.0f);
+    setGyro(0.0f, 0.0f, 0.0f);
+    setTemperature(25.0f);
+}
+
+uint8_t SimulatedMPU6050::readRegister(uint8_t reg) {
+    if (reg == MPU_REG_INT_STATUS) {
+        return takeDataReady();
+    }
+    if (reg == MPU_REG_ACCEL_XOUT_H) {
+        burstReads++;
+    }
+    return registers[reg & 0x7F];
+}
+
+void SimulatedMPU6050::writeRegister(uint8_t reg, uint8_t value) {
+    if (reg == MPU_REG_WHO_AM_I) {
+        return;
+    }
+    registers[reg & 0x7F] = value;
+}
+
+void SimulatedMPU6050::setAccel(float x, float y, float z) {
+    // ±2g full scale: 16384 LSB/g
+    setWord(MPU_REG_ACCEL_XOUT_H, static_cast<int16_t>(constrainf(x * 16384.0f)));
+    setWord(MPU_REG_ACCEL_XOUT_H + 2, static_cast<int16_t>(constrainf(y * 16384.0f)));
+    setWord(MPU_REG_ACCEL_XOUT_H + 4, static_cast<int16_t>(constrainf(z * 16384.0f)));
+}
+
+void SimulatedMPU6050::setGyro(float x, float y, float z) {
+    // ±250°/s full scale: 131 LSB/(°/s)
+    setWord(MPU_REG_GYRO_XOUT_H, static_cast<int16_t>(constrainf(x * 131.0f)));
+    setWord(MPU_REG_GYRO_XOUT_H + 2, static_cast<int16_t>(constrainf(y * 131.0f)));
+    setWord(MPU_REG_GYRO_XOUT_H + 4, static_cast<int16_t>(constrainf(z * 131.0f)));
+}
+
+void SimulatedMPU6050::setTemperature(float celsius) {
+    setWord(MPU_REG_TEMP_OUT_H, static_cast<int16_t>(lroundf((celsius - 36.53f) * 340.0f)));
+}
+
+uint8_t SimulatedMPU6050::takeDataReady() {
+    // Gyro output rate is 8 kHz, or 1 kHz with the low-pass filter enabled
+    uint8_t dlpf = registers[MPU_REG_CONFIG] & 0x07;
+    uint32_t rateHz = (dlpf == 0 || dlpf == 7 ? 8000 : 1000) / (1 + registers[MPU_REG_SMPLRT_DIV]);
+    uint64_t sample = nowMicros() * rateHz / 1000000;
+    bool ready = sample != lastSample;
+    lastSample = sample;
+    return (ready && (registers[MPU_REG_INT_ENABLE] & 0x01)) ? 0x01 : 0x00;
+}
+
+float SimulatedMPU6050::constrainf(float value) {
+    return value < -32768.0f ? -32768.0f : (value > 32767.0f ? 32767.0f : roundf(value));
+}
+
+void SimulatedMPU6050::setWord(uint8_t reg, int16_t value) {
+    registers[reg] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    registers[reg + 1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+void attachI2CDevice(uint8_t bus, uint8_t address, I2CDevice* device) {
+    attachDefaultDevices();
+    if (bus < BUS_COUNT && address < 128) {
+        devices[bus][address] = device;
+    }
+}
+
+SimulatedMPU6050& defaultMPU6050() {
+    static SimulatedMPU6050 device;
+    return device;
+}
+
+uint32_t getI2CTransactionCount(uint8_t bus) {
+    return bus < BUS_COUNT ? transactionCounts[bus].load() : 0;
+}
+
+void setI2CDeviceLatency(uint8_t bus, uint8_t address, uint32_t us) {
+    if (bus < BUS_COUNT && address < 128) {
+        deviceLatencies[bus][address] = us;
+    }
+}
+
+} // namespace Host
+} // namespace BITS
+
+TwoWire::TwoWire(uint8_t bus)
+    : bus(bus), clock(100000), txAddress(0), txLength(0), rxLength(0), rxIndex(0) {
+    memset(registerPointer, 0, sizeof(registerPointer));
+}
+
+void TwoWire::begin() {}
+
+void TwoWire::end() {}
+
+void TwoWire::setClock(uint32_t frequency) {
+    clock = frequency;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t) {
+    transactionCounts[bus]++;
+    BITS::Host::I2CDevice* device = findDevice(bus, txAddress);
+    if (device == nullptr) {
+        return 2; // NACK on address
+    }
+    if (txLength > 0) {
+        uint8_t reg = txBuffer[0];
+        for (size_t i = 1; i < txLength; i++) {
+            device->writeRegister(reg++, txBuffer[i]);
+        }
+        registerPointer[txAddress & 0x7F] = txBuffer[0];
+    }
+    txLength = 0;
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    if (txLength >= BUFFER_SIZE) {
+        return 0;
+    }
+    txBuffer[txLength++] = value;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && write(data[written])) {
+        written++;
+    }
+    return written;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t) {
+    transactionCounts[bus]++;
+    rxLength = 0;
+    rxIndex = 0;
+    BITS::Host::I2CDevice* device = findDevice(bus, address);
+    if (device == nullptr) {
+        return 0;
+    }
+    uint8_t reg = registerPointer[address & 0x7F];
+    while (rxLength < quantity && rxLength < BUFFER_SIZE) {
+        rxBuffer[rxLength++] = device->readRegister(reg++);
+    }
+    registerPointer[address & 0x7F] = reg;
+    return static_cast<uint8_t>(rxLength);
+}
+
+int TwoWire::available() {
+    return static_cast<int>(rxLength - rxIndex);
+}
+
+int TwoWire::read() {
+    if (rxIndex >= rxLength) {
+        return -1;
+    }
+    return rxBuffer[rxIndex++];
+}
+
+I2CMaster Master(0);
+I2CMaster Master1(1);
+I2CMaster Master2(2);
+
+I2CMaster::I2CMaster(uint8_t bus)
+    : bus(bus), frequency(100000), started(false), pending(false), reading(false), address(0),
+      writeBuffer(nullptr), readBuffer(nullptr), length(0), transferred(0), doneAt(0), error_(I2CError::ok) {
+    memset(registerPointer, 0, sizeof(registerPointer));
+}
+
+void I2CMaster::begin(uint32_t frequency) {
+    this->frequency = frequency ? frequency : 100000;
+    started = true;
+}
+
+void I2CMaster::end() {
+    started = false;
+    pending = false;
+}
+
+bool I2CMaster::finished() {
+    if (pending && BITS::Host::nowMicros() >= doneAt) {
+        complete();
+    }
+    return !pending;
+}
+
+size_t I2CMaster::get_bytes_transferred() {
+    return transferred;
+}
+
+void I2CMaster::write_async(uint8_t address, const uint8_t* buffer, size_t num_bytes, bool) {
+    writeBuffer = buffer;
+    reading = false;
+    start(address, num_bytes);
+}
+
+void I2CMaster::read_async(uint8_t address, uint8_t* buffer, size_t num_bytes, bool) {
+    readBuffer = buffer;
+    reading = true;
+    start(address, num_bytes);
+}
+
+void I2CMaster::start(uint8_t address, size_t num_bytes) {
+    transferred = 0;
+    if (!started || pending) {
+        error_ = I2CError::master_not_ready;
+        return;
+    }
+    error_ = I2CError::ok;
+    this->address = address;
+    length = num_bytes;
+    pending = true;
+    
+    // Start, address and data bytes of 9 clocks each, then the stop
+    uint64_t bits = (1 + num_bytes) * 9 + 2;
+    uint32_t latency = (bus < BUS_COUNT && address < 128) ? deviceLatencies[bus][address].load() : 0;
+    doneAt = BITS::Host::nowMicros() + (bits * 1000000 + frequency - 1) / frequency + latency;
+}
+
+void I2CMaster::complete() {
+    pending = false;
+    transactionCounts[bus]++;
+    BITS::Host::I2CDevice* device = findDevice(bus, address);
+    if (device == nullptr) {
+        error_ = I2CError::address_nak;
+        return;
+    }
+    uint8_t& pointer = registerPointer[address & 0x7F];
+    if (reading) {
+        for (size_t i = 0; i < length; i++) {
+            readBuffer[i] = device->readRegister(pointer++);
+        }
+    } else if (length > 0) {
+        pointer = writeBuffer[0];
+        uint8_t reg = pointer;
+        for (size_t i = 1; i < length; i++) {
+            device->writeRegister(reg++, writeBuffer[i]);
+        }
+    }
+    transferred = length;
+}
@@ -0,0 +1,57 @@
+#ifndef BITS_HOST_WIRE_H
+#define BITS_HOST_WIRE_H
+
+/*
+ * B.I.T.E.S - Host Wire Shim
+ *
+ * TwoWire stand-in that routes transactions to simulated devices attached
+ * through BITS::Host::attachI2CDevice(). Transfers complete instantly.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire {
+public:
+    explicit TwoWire(uint8_t bus);
+
+    void begin();
+    void end();
+    void setClock(uint32_t frequency);
+    uint32_t getClock() const { return clock; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(uint8_t sendStop);
+    uint8_t endTransmission() { return endTransmission(1); }
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* data, size_t length);
+
+    // Same overload set as the Teensy core
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return requestFrom(address, quantity, static_cast<uint8_t>(1)); }
+    uint8_t requestFrom(int address, int quantity, int sendStop) {
+        return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity),
+                           static_cast<uint8_t>(sendStop != 0));
+    }
+    uint8_t requestFrom(int address, int quantity) { return requestFrom(address, quantity, 1); }
+    int available();
+    int read();
+
+private:
+    static constexpr size_t BUFFER_SIZE = 32;
+    uint8_t bus;
+    uint32_t clock;
+    uint8_t txAddress;
+    uint8_t txBuffer[BUFFER_SIZE];
+    size_t txLength;
+    uint8_t rxBuffer[BUFFER_SIZE];
+    size_t rxLength;
+    size_t rxIndex;
+    uint8_t registerPointer[128];
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+extern TwoWire Wire2;
+
+#endif // BITS_HOST_WIRE_H
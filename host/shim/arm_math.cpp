@@ -0,0 +1,146 @@
+#include <arm_math.h>
+#include <math.h>
+#include <string.h>
+
+void arm_add_f32(const float32_t* pSrcA, const float32_t* pSrcB, float32_t* pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] + pSrcB[i];
+}
+
+void arm_mult_f32(const float32_t* pSrcA, const float32_t* pSrcB, float32_t* pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] * pSrcB[i];
+}
+
+void arm_scale_f32(const float32_t* pSrc, float32_t scale, float32_t* pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrc[i] * scale;
+}
+
+void arm_offset_f32(const float32_t* pSrc, float32_t offset, float32_t* pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrc[i] + offset;
+}
+
+void arm_dot_prod_f32(const float32_t* pSrcA, const float32_t* pSrcB, uint32_t blockSize, float32_t* result) {
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++) sum += pSrcA[i] * pSrcB[i];
+    *result = sum;
+}
+
+void arm_power_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult) {
+    arm_dot_prod_f32(pSrc, pSrc, blockSize, pResult);
+}
+
+void arm_mean_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult) {
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++) sum += pSrc[i];
+    *pResult = blockSize ? sum / blockSize : 0.0f;
+}
+
+void arm_std_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult) {
+    // Sample standard deviation (N - 1), as in CMSIS-DSP
+    if (blockSize <= 1) {
+        *pResult = 0.0f;
+        return;
+    }
+    float32_t mean;
+    arm_mean_f32(pSrc, blockSize, &mean);
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++) {
+        float32_t d = pSrc[i] - mean;
+        sum += d * d;
+    }
+    *pResult = sqrtf(sum / (blockSize - 1));
+}
+
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32* pSrcA, const arm_matrix_instance_f32* pSrcB,
+                            arm_matrix_instance_f32* pDst) {
+    if (pSrcA->numCols != pSrcB->numRows || pDst->numRows != pSrcA->numRows ||
+        pDst->numCols != pSrcB->numCols) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    for (uint16_t r = 0; r < pSrcA->numRows; r++) {
+        for (uint16_t c = 0; c < pSrcB->numCols; c++) {
+            float32_t sum = 0.0f;
+            for (uint16_t k = 0; k < pSrcA->numCols; k++) {
+                sum += pSrcA->pData[r * pSrcA->numCols + k] * pSrcB->pData[k * pSrcB->numCols + c];
+            }
+            pDst->pData[r * pDst->numCols + c] = sum;
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* S, uint16_t fftLen) {
+    if (fftLen < 32 || (fftLen & (fftLen - 1)) != 0 || fftLen > 4096) {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    S->fftLenRFFT = fftLen;
+    return ARM_MATH_SUCCESS;
+}
+
+// Direct DFT with the CMSIS packed layout: out[0] = DC, out[1] = Nyquist,
+// then interleaved (re, im) for bins 1..N/2-1. Correct but O(N^2).
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* S, float32_t* p, float32_t* pOut, uint8_t ifftFlag) {
+    const uint32_t n = S->fftLenRFFT;
+    const float32_t twoPi = 6.28318530717958647692f;
+
+    if (!ifftFlag) {
+        for (uint32_t k = 0; k <= n / 2; k++) {
+            float32_t re = 0.0f, im = 0.0f;
+            for (uint32_t t = 0; t < n; t++) {
+                float32_t angle = twoPi * k * t / n;
+                re += p[t] * cosf(angle);
+                im -= p[t] * sinf(angle);
+            }
+            if (k == 0) {
+                pOut[0] = re;
+            } else if (k == n / 2) {
+                pOut[1] = re;
+            } else {
+                pOut[2 * k] = re;
+                pOut[2 * k + 1] = im;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t t = 0; t < n; t++) {
+        float32_t sum = p[0] + ((t & 1) ? -p[1] : p[1]);
+        for (uint32_t k = 1; k < n / 2; k++) {
+            float32_t angle = twoPi * k * t / n;
+            sum += 2.0f * (p[2 * k] * cosf(angle) - p[2 * k + 1] * sinf(angle));
+        }
+        pOut[t] = sum / n;
+    }
+}
+
+void arm_fir_f32(const arm_fir_instance_f32* S, const float32_t* pSrc, float32_t* pDst, uint32_t blockSize) {
+    // State holds the last numTaps - 1 inputs followed by the new block;
+    // coefficients are stored time-reversed, as in CMSIS-DSP
+    const uint16_t numTaps = S->numTaps;
+    float32_t* state = S->pState;
+    memcpy(state + numTaps - 1, pSrc, blockSize * sizeof(float32_t));
+    for (uint32_t i = 0; i < blockSize; i++) {
+        float32_t acc = 0.0f;
+        for (uint16_t k = 0; k < numTaps; k++) {
+            acc += state[i + k] * S->pCoeffs[k];
+        }
+        pDst[i] = acc;
+    }
+    memmove(state, state + blockSize, (numTaps - 1) * sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32* S, const float32_t* pSrc,
+                                 float32_t* pDst, uint32_t blockSize) {
+    const float32_t* in = pSrc;
+    for (uint8_t stage = 0; stage < S->numStages; stage++) {
+        const float32_t* c = S->pCoeffs + stage * 5;
+        float32_t* d = S->pState + stage * 2;
+        for (uint32_t i = 0; i < blockSize; i++) {
+            float32_t x = in[i];
+            float32_t y = c[0] * x + d[0];
+            d[0] = c[1] * x + c[3] * y + d[1];
+            d[1] = c[2] * x + c[4] * y;
+            pDst[i] = y;
+        }
+        in = pDst;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef BITS_HOST_ARM_MATH_H
+#define BITS_HOST_ARM_MATH_H
+
+/*
+ * B.I.T.E.S - Host CMSIS-DSP Shim
+ *
+ * Portable scalar implementations of the CMSIS-DSP functions used by the
+ * engine, with the same signatures and data layouts as the target library.
+ */
+
+#include <stdint.h>
+
+typedef float float32_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+    ARM_MATH_LENGTH_ERROR = -2,
+    ARM_MATH_SIZE_MISMATCH = -3
+} arm_status;
+
+typedef struct {
+    uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+typedef struct {
+    uint16_t numTaps;
+    float32_t* pState;
+    const float32_t* pCoeffs;
+} arm_fir_instance_f32;
+
+typedef struct {
+    uint8_t numStages;
+    float32_t* pState;
+    const float32_t* pCoeffs;
+} arm_biquad_cascade_df2T_instance_f32;
+
+typedef struct {
+    uint16_t numRows;
+    uint16_t numCols;
+    float32_t* pData;
+} arm_matrix_instance_f32;
+
+// Basic math
+void arm_add_f32(const float32_t* pSrcA, const float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t* pSrcA, const float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+void arm_scale_f32(const float32_t* pSrc, float32_t scale, float32_t* pDst, uint32_t blockSize);
+void arm_offset_f32(const float32_t* pSrc, float32_t offset, float32_t* pDst, uint32_t blockSize);
+void arm_dot_prod_f32(const float32_t* pSrcA, const float32_t* pSrcB, uint32_t blockSize, float32_t* result);
+
+// Statistics
+void arm_power_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult);
+void arm_mean_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult);
+void arm_std_f32(const float32_t* pSrc, uint32_t blockSize, float32_t* pResult);
+
+// Matrix
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32* pSrcA, const arm_matrix_instance_f32* pSrcB,
+                            arm_matrix_instance_f32* pDst);
+
+// Transforms
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* S, uint16_t fftLen);
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* S, float32_t* p, float32_t* pOut, uint8_t ifftFlag);
+
+// Filters
+void arm_fir_f32(const arm_fir_instance_f32* S, const float32_t* pSrc, float32_t* pDst, uint32_t blockSize);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32* S, const float32_t* pSrc,
+                                 float32_t* pDst, uint32_t blockSize);
+
+#endif // BITS_HOST_ARM_MATH_H
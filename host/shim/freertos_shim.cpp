@@ -0,0 +1,966 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "host_shim.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct tskTaskControlBlock {
+    std::string name;
+    TaskFunction_t function;
+    void* parameters;
+    UBaseType_t priority;
+    uint32_t stackDepth;
+    bool suspended;
+    bool deleted;
+    bool blocked;
+    bool finished;
+    bool fromHeap;
+    uint32_t notifyValue;
+    bool notifyPending;
+};
+
+struct QueueDefinition {
+    enum class Kind { QUEUE, MUTEX, RECURSIVE_MUTEX, BINARY, COUNTING };
+    Kind kind;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::vector<uint8_t> heapStorage;
+    uint8_t* storage;               // heapStorage, or the caller's buffer
+    UBaseType_t head;
+    UBaseType_t count;
+    TaskHandle_t holder;
+    UBaseType_t recursion;
+    bool fromHeap;
+};
+
+struct tmrTimerControl {
+    std::string name;
+    TickType_t period;
+    bool autoReload;
+    void* id;
+    TimerCallbackFunction_t callback;
+    bool active;
+    bool deleted;
+    uint64_t expiry;
+    bool fromHeap;
+};
+
+namespace {
+
+// One lock for every kernel object, like a single-core critical section
+std::mutex kernelMutex;
+std::condition_variable kernelCv;
+std::recursive_mutex criticalMutex;
+
+std::vector<tskTaskControlBlock*> tasks;
+std::vector<tmrTimerControl*> timers;
+tskTaskControlBlock* timerDaemon = nullptr;
+uint32_t timerGeneration = 0;
+bool shuttingDown = false;
+
+thread_local tskTaskControlBlock* currentTask = nullptr;
+
+std::atomic<size_t> heapUsed{0};
+std::atomic<size_t> heapPeak{0};
+
+// Per-object overheads of the target kernel, used for heap accounting
+constexpr size_t TCB_OVERHEAD = sizeof(StaticTask_t);
+constexpr size_t QUEUE_OVERHEAD = sizeof(StaticQueue_t);
+constexpr size_t TIMER_OVERHEAD = sizeof(StaticTimer_t);
+
+// Thrown from kernel calls to unwind a task that has been deleted
+struct TaskExit {};
+
+void heapAllocate(size_t size) {
+    vApplicationHeapAllocHook(size);
+    size_t used = heapUsed.fetch_add(size) + size;
+    size_t peak = heapPeak.load();
+    while (used > peak && !heapPeak.compare_exchange_weak(peak, used)) {
+    }
+}
+
+void heapRelease(size_t size) {
+    heapUsed.fetch_sub(size);
+}
+
+uint64_t tickNow() {
+    return BITS::Host::nowMicros() / (1000000ULL / configTICK_RATE_HZ);
+}
+
+void checkCurrentTask(std::unique_lock<std::mutex>& lock) {
+    tskTaskControlBlock* self = currentTask;
+    if (self == nullptr) {
+        return;
+    }
+    while (self->suspended && !self->deleted) {
+        kernelCv.wait(lock);
+    }
+    if (self->deleted) {
+        throw TaskExit();
+    }
+}
+
+// Blocks the caller until pred() holds or xTicks have elapsed. Must be
+// called with kernelMutex held. Returns the final value of pred().
+template <typename Pred>
+bool waitTicks(std::unique_lock<std::mutex>& lock, TickType_t xTicks, Pred pred) {
+    checkCurrentTask(lock);
+    if (pred()) {
+        return true;
+    }
+    if (xTicks == 0) {
+        return false;
+    }
+
+    const bool forever = xTicks == portMAX_DELAY;
+    const uint64_t deadline = tickNow() + xTicks;
+    if (currentTask) currentTask->blocked = true;
+
+    bool result = false;
+    while (true) {
+        try {
+            checkCurrentTask(lock);
+        } catch (const TaskExit&) {
+            currentTask->blocked = false;
+            throw;
+        }
+        if (pred()) {
+            result = true;
+            break;
+        }
+        uint64_t now = tickNow();
+        if (!forever && now >= deadline) {
+            break;
+        }
+        if (forever || BITS::Host::isVirtualTime()) {
+            kernelCv.wait(lock);
+        } else {
+            kernelCv.wait_for(lock, std::chrono::milliseconds(pdTICKS_TO_MS(deadline - now)));
+        }
+    }
+
+    if (currentTask) currentTask->blocked = false;
+    return result;
+}
+
+void taskEntry(tskTaskControlBlock* tcb) {
+    currentTask = tcb;
+    try {
+        {
+            std::unique_lock<std::mutex> lock(kernelMutex);
+            checkCurrentTask(lock);
+        }
+        tcb->function(tcb->parameters);
+    } catch (const TaskExit&) {
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    tcb->deleted = true;
+    tcb->finished = true;
+    kernelCv.notify_all();
+}
+
+void shutdownKernel() {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    shuttingDown = true;
+    for (auto* task : tasks) {
+        task->deleted = true;
+    }
+    kernelCv.notify_all();
+    // Give running tasks a bounded window to reach their next kernel call
+    kernelCv.wait_for(lock, std::chrono::seconds(2), [] {
+        for (auto* task : tasks) {
+            if (!task->finished) return false;
+        }
+        return true;
+    });
+}
+
+tskTaskControlBlock* spawnTask(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                               void* parameters, UBaseType_t priority, bool fromHeap) {
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        std::atexit(shutdownKernel);
+    }
+
+    if (fromHeap) {
+        heapAllocate(TCB_OVERHEAD + stackDepth * sizeof(StackType_t));
+    }
+    auto* tcb = new tskTaskControlBlock{name ? name : "", function, parameters, priority,
+                                        stackDepth, false, false, false, false, fromHeap, 0, false};
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        tasks.push_back(tcb);
+    }
+    std::thread(taskEntry, tcb).detach();
+    return tcb;
+}
+
+// storage is the caller's item buffer for static queues, nullptr to use the heap
+QueueHandle_t createQueue(QueueDefinition::Kind kind, UBaseType_t length, UBaseType_t itemSize,
+                          UBaseType_t initialCount, uint8_t* storage, bool fromHeap) {
+    if (length == 0) {
+        return nullptr;
+    }
+    if (fromHeap) {
+        heapAllocate(QUEUE_OVERHEAD + length * itemSize);
+    }
+    auto* queue = new QueueDefinition{kind, length, itemSize, std::vector<uint8_t>(), storage, 0,
+                                      initialCount, nullptr, 0, fromHeap};
+    if (queue->storage == nullptr) {
+        queue->heapStorage.resize(length * itemSize);
+        queue->storage = queue->heapStorage.data();
+    }
+    return queue;
+}
+
+TimerHandle_t createTimer(const char* name, TickType_t period, UBaseType_t autoReload, void* id,
+                          TimerCallbackFunction_t callback, bool fromHeap);
+
+BaseType_t queueSend(QueueHandle_t xQueue, const void* item, TickType_t xTicksToWait, bool front) {
+    if (xQueue == nullptr) {
+        return pdFAIL;
+    }
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!waitTicks(lock, xTicksToWait, [&] { return xQueue->count < xQueue->length; })) {
+        return errQUEUE_FULL;
+    }
+    if (xQueue->itemSize > 0) {
+        UBaseType_t slot;
+        if (front) {
+            xQueue->head = (xQueue->head + xQueue->length - 1) % xQueue->length;
+            slot = xQueue->head;
+        } else {
+            slot = (xQueue->head + xQueue->count) % xQueue->length;
+        }
+        memcpy(&xQueue->storage[slot * xQueue->itemSize], item, xQueue->itemSize);
+    }
+    xQueue->count++;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t queueReceive(QueueHandle_t xQueue, void* buffer, TickType_t xTicksToWait, bool peek) {
+    if (xQueue == nullptr) {
+        return pdFAIL;
+    }
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!waitTicks(lock, xTicksToWait, [&] { return xQueue->count > 0; })) {
+        return errQUEUE_EMPTY;
+    }
+    if (xQueue->itemSize > 0 && buffer != nullptr) {
+        memcpy(buffer, &xQueue->storage[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+    }
+    if (!peek) {
+        xQueue->head = (xQueue->head + 1) % xQueue->length;
+        xQueue->count--;
+        kernelCv.notify_all();
+    }
+    return pdPASS;
+}
+
+void timerDaemonTask(void*) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    while (true) {
+        tmrTimerControl* next = nullptr;
+        for (auto* timer : timers) {
+            if (timer->active && !timer->deleted && (next == nullptr || timer->expiry < next->expiry)) {
+                next = timer;
+            }
+        }
+
+        if (next == nullptr) {
+            checkCurrentTask(lock);
+            kernelCv.wait(lock);
+            continue;
+        }
+
+        uint64_t now = tickNow();
+        if (now < next->expiry) {
+            uint64_t expiry = next->expiry;
+            TickType_t wait = static_cast<TickType_t>(expiry - now);
+            // Wake early if any timer is started, stopped or created
+            uint32_t generation = timerGeneration;
+            waitTicks(lock, wait, [&] {
+                return tickNow() >= expiry || timerGeneration != generation;
+            });
+            continue;
+        }
+
+        if (next->autoReload) {
+            next->expiry += next->period;
+        } else {
+            next->active = false;
+        }
+        TimerCallbackFunction_t callback = next->callback;
+        lock.unlock();
+        callback(next);
+        lock.lock();
+    }
+}
+
+} // namespace
+
+extern "C" __attribute__((weak)) void vApplicationHeapAllocHook(size_t) {
+}
+
+namespace BITS {
+namespace Host {
+
+void notifyTimeAdvanced() {
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    kernelCv.notify_all();
+}
+
+} // namespace Host
+} // namespace BITS
+
+// Port layer
+
+void vPortEnterCritical() {
+    criticalMutex.lock();
+}
+
+void vPortExitCritical() {
+    criticalMutex.unlock();
+}
+
+size_t xPortGetFreeHeapSize() {
+    size_t used = heapUsed;
+    return used < configTOTAL_HEAP_SIZE ? configTOTAL_HEAP_SIZE - used : 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize() {
+    size_t peak = heapPeak;
+    return peak < configTOTAL_HEAP_SIZE ? configTOTAL_HEAP_SIZE - peak : 0;
+}
+
+void* pvPortMalloc(size_t size) {
+    auto* block = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    block[0] = size;
+    heapAllocate(size);
+    return block + 1;
+}
+
+void vPortFree(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    size_t* block = static_cast<size_t*>(ptr) - 1;
+    heapRelease(block[0]);
+    free(block);
+}
+
+// Tasks
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask) {
+    TaskHandle_t handle = spawnTask(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, true);
+    if (pxCreatedTask != nullptr) {
+        *pxCreatedTask = handle;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth,
+                               void* pvParameters, UBaseType_t uxPriority, StackType_t* puxStackBuffer,
+                               StaticTask_t* pxTaskBuffer) {
+    if (puxStackBuffer == nullptr || pxTaskBuffer == nullptr) {
+        return nullptr;
+    }
+    return spawnTask(pxTaskCode, pcName, ulStackDepth, pvParameters, uxPriority, false);
+}
+
+void vTaskDelete(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    if (xTask == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        if (xTask->deleted) {
+            return;
+        }
+        xTask->deleted = true;
+        kernelCv.notify_all();
+    }
+    if (xTask->fromHeap) {
+        heapRelease(TCB_OVERHEAD + xTask->stackDepth * sizeof(StackType_t));
+    }
+    if (xTask == currentTask) {
+        throw TaskExit();
+    }
+}
+
+void vTaskSuspend(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    if (xTask == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    xTask->suspended = true;
+    kernelCv.notify_all();
+    if (xTask == currentTask) {
+        checkCurrentTask(lock);
+    }
+}
+
+void vTaskResume(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    xTask->suspended = false;
+    kernelCv.notify_all();
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    waitTicks(lock, xTicksToDelay, [] { return false; });
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t elapsed = now - *pxPreviousWakeTime;
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+    *pxPreviousWakeTime = wake;
+
+    if (elapsed >= xTimeIncrement) {
+        // Deadline already passed, return without blocking
+        std::unique_lock<std::mutex> lock(kernelMutex);
+        checkCurrentTask(lock);
+        return pdFALSE;
+    }
+    vTaskDelay(wake - now);
+    return pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement);
+}
+
+// Notifications
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction) {
+    if (xTaskToNotify == nullptr) {
+        return pdFAIL;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    switch (eAction) {
+        case eSetBits:
+            xTaskToNotify->notifyValue |= ulValue;
+            break;
+        case eIncrement:
+            xTaskToNotify->notifyValue++;
+            break;
+        case eSetValueWithOverwrite:
+            xTaskToNotify->notifyValue = ulValue;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (xTaskToNotify->notifyPending) {
+                return pdFAIL;
+            }
+            xTaskToNotify->notifyValue = ulValue;
+            break;
+        case eNoAction:
+            break;
+    }
+    xTaskToNotify->notifyPending = true;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction,
+                              BaseType_t* pxHigherPriorityTaskWoken) {
+    if (pxHigherPriorityTaskWoken != nullptr) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return xTaskNotify(xTaskToNotify, ulValue, eAction);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit,
+                           uint32_t* pulNotificationValue, TickType_t xTicksToWait) {
+    tskTaskControlBlock* self = currentTask;
+    if (self == nullptr) {
+        return pdFAIL;
+    }
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    if (!self->notifyPending) {
+        self->notifyValue &= ~ulBitsToClearOnEntry;
+    }
+    bool notified = waitTicks(lock, xTicksToWait, [&] { return self->notifyPending; });
+    if (pulNotificationValue != nullptr) {
+        *pulNotificationValue = self->notifyValue;
+    }
+    if (notified) {
+        self->notifyValue &= ~ulBitsToClearOnExit;
+    }
+    self->notifyPending = false;
+    return notified ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    return xTaskNotify(xTaskToNotify, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    xTaskNotifyFromISR(xTaskToNotify, 0, eIncrement, pxHigherPriorityTaskWoken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    tskTaskControlBlock* self = currentTask;
+    if (self == nullptr) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    waitTicks(lock, xTicksToWait, [&] { return self->notifyValue != 0; });
+    uint32_t value = self->notifyValue;
+    if (value != 0) {
+        self->notifyValue = xClearCountOnExit ? 0 : value - 1;
+    }
+    self->notifyPending = false;
+    return value;
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(tickNow());
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+void taskYIELD() {
+    {
+        std::unique_lock<std::mutex> lock(kernelMutex);
+        checkCurrentTask(lock);
+    }
+    std::this_thread::yield();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    return xTask ? xTask->name.c_str() : "main";
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    return xTask ? xTask->priority : 0;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    if (xTask != nullptr) {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xTask->priority = uxNewPriority;
+    }
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        xTask = currentTask;
+    }
+    // Host threads run on large native stacks; report the requested depth
+    return xTask ? xTask->stackDepth : 0;
+}
+
+eTaskState eTaskGetState(TaskHandle_t xTask) {
+    if (xTask == nullptr) {
+        return eInvalid;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    if (xTask->deleted) return eDeleted;
+    if (xTask->suspended) return eSuspended;
+    if (xTask == currentTask) return eRunning;
+    if (xTask->blocked) return eBlocked;
+    return eReady;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    UBaseType_t count = 0;
+    for (auto* task : tasks) {
+        if (!task->deleted) count++;
+    }
+    return count;
+}
+
+void vTaskStartScheduler() {
+    // Tasks start running on creation; the scheduler call never returns
+    std::unique_lock<std::mutex> lock(kernelMutex);
+    kernelCv.wait(lock, [] { return shuttingDown; });
+}
+
+BaseType_t xTaskGetSchedulerState() {
+    return taskSCHEDULER_RUNNING;
+}
+
+void vTaskSuspendAll() {
+    criticalMutex.lock();
+}
+
+BaseType_t xTaskResumeAll() {
+    criticalMutex.unlock();
+    return pdFALSE;
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    return createQueue(QueueDefinition::Kind::QUEUE, uxQueueLength, uxItemSize, 0, nullptr, true);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize,
+                                 uint8_t* pucQueueStorage, StaticQueue_t* pxQueueBuffer) {
+    if (pxQueueBuffer == nullptr || (uxItemSize > 0 && pucQueueStorage == nullptr)) {
+        return nullptr;
+    }
+    return createQueue(QueueDefinition::Kind::QUEUE, uxQueueLength, uxItemSize, 0, pucQueueStorage, false);
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    if (xQueue == nullptr) {
+        return;
+    }
+    if (xQueue->fromHeap) {
+        heapRelease(QUEUE_OVERHEAD + xQueue->length * xQueue->itemSize);
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    delete xQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t xQueue, const void* pvItemToQueue) {
+    if (xQueue == nullptr) {
+        return pdFAIL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xQueue->count = 0;
+        xQueue->head = 0;
+    }
+    return queueSend(xQueue, pvItemToQueue, 0, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void* pvItemToQueue,
+                             BaseType_t* pxHigherPriorityTaskWoken) {
+    if (pxHigherPriorityTaskWoken != nullptr) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return queueSend(xQueue, pvItemToQueue, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queueReceive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queueReceive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void* pvBuffer,
+                                BaseType_t* pxHigherPriorityTaskWoken) {
+    if (pxHigherPriorityTaskWoken != nullptr) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return queueReceive(xQueue, pvBuffer, 0, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    if (xQueue == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    if (xQueue == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    return xQueue->length - xQueue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+    if (xQueue == nullptr) {
+        return pdFAIL;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    xQueue->head = 0;
+    xQueue->count = 0;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+// Semaphores
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return createQueue(QueueDefinition::Kind::MUTEX, 1, 0, 1, nullptr, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return createQueue(QueueDefinition::Kind::RECURSIVE_MUTEX, 1, 0, 1, nullptr, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return createQueue(QueueDefinition::Kind::BINARY, 1, 0, 0, nullptr, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return createQueue(QueueDefinition::Kind::COUNTING, uxMaxCount, 0, uxInitialCount, nullptr, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer) {
+    if (pxMutexBuffer == nullptr) {
+        return nullptr;
+    }
+    return createQueue(QueueDefinition::Kind::MUTEX, 1, 0, 1, nullptr, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t* pxMutexBuffer) {
+    if (pxMutexBuffer == nullptr) {
+        return nullptr;
+    }
+    return createQueue(QueueDefinition::Kind::RECURSIVE_MUTEX, 1, 0, 1, nullptr, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer) {
+    if (pxSemaphoreBuffer == nullptr) {
+        return nullptr;
+    }
+    return createQueue(QueueDefinition::Kind::BINARY, 1, 0, 0, nullptr, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount,
+                                                 StaticSemaphore_t* pxSemaphoreBuffer) {
+    if (pxSemaphoreBuffer == nullptr) {
+        return nullptr;
+    }
+    return createQueue(QueueDefinition::Kind::COUNTING, uxMaxCount, 0, uxInitialCount, nullptr, false);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) {
+    vQueueDelete(xSemaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+    BaseType_t result = queueReceive(xSemaphore, nullptr, xBlockTime, false);
+    if (result == pdPASS) {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xSemaphore->holder = currentTask;
+    }
+    return result;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    if (xSemaphore != nullptr) {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xSemaphore->holder = nullptr;
+    }
+    return queueSend(xSemaphore, nullptr, 0, false);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime) {
+    if (xMutex == nullptr) {
+        return pdFAIL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        if (xMutex->recursion > 0 && xMutex->holder == currentTask) {
+            xMutex->recursion++;
+            return pdPASS;
+        }
+    }
+    BaseType_t result = xSemaphoreTake(xMutex, xBlockTime);
+    if (result == pdPASS) {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xMutex->recursion = 1;
+    }
+    return result;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex) {
+    if (xMutex == nullptr) {
+        return pdFAIL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        if (xMutex->holder != currentTask || xMutex->recursion == 0) {
+            return pdFAIL;
+        }
+        if (--xMutex->recursion > 0) {
+            return pdPASS;
+        }
+    }
+    return xSemaphoreGive(xMutex);
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken) {
+    return xQueueReceiveFromISR(xSemaphore, nullptr, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken) {
+    return xQueueSendFromISR(xSemaphore, nullptr, pxHigherPriorityTaskWoken);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore) {
+    return uxQueueMessagesWaiting(xSemaphore);
+}
+
+// Timers
+
+TimerHandle_t xTimerCreate(const char* pcTimerName, TickType_t xTimerPeriodInTicks,
+                           UBaseType_t uxAutoReload, void* pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction) {
+    return createTimer(pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, true);
+}
+
+TimerHandle_t xTimerCreateStatic(const char* pcTimerName, TickType_t xTimerPeriodInTicks,
+                                 UBaseType_t uxAutoReload, void* pvTimerID,
+                                 TimerCallbackFunction_t pxCallbackFunction,
+                                 StaticTimer_t* pxTimerBuffer) {
+    if (pxTimerBuffer == nullptr) {
+        return nullptr;
+    }
+    return createTimer(pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, false);
+}
+
+namespace {
+
+TimerHandle_t createTimer(const char* name, TickType_t period, UBaseType_t autoReload, void* id,
+                          TimerCallbackFunction_t callback, bool fromHeap) {
+    if (period == 0 || callback == nullptr) {
+        return nullptr;
+    }
+    if (fromHeap) {
+        heapAllocate(TIMER_OVERHEAD);
+    }
+    auto* timer = new tmrTimerControl{name ? name : "", period, autoReload != pdFALSE, id, callback,
+                                      false, false, 0, fromHeap};
+
+    bool startDaemon = false;
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        timers.push_back(timer);
+        timerGeneration++;
+        startDaemon = timerDaemon == nullptr;
+        kernelCv.notify_all();
+    }
+    if (startDaemon) {
+        // With static timers the daemon stack is application-provided, as on target
+        timerDaemon = spawnTask(timerDaemonTask, "Tmr Svc", configMINIMAL_STACK_SIZE * 2, nullptr,
+                                configMAX_PRIORITIES - 1, fromHeap);
+    }
+    return timer;
+}
+
+} // namespace
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t) {
+    if (xTimer == nullptr) {
+        return pdFAIL;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    xTimer->active = true;
+    xTimer->expiry = tickNow() + xTimer->period;
+    timerGeneration++;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t) {
+    if (xTimer == nullptr) {
+        return pdFAIL;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    xTimer->active = false;
+    timerGeneration++;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    return xTimerStart(xTimer, xTicksToWait);
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait) {
+    if (xTimer == nullptr || xNewPeriod == 0) {
+        return pdFAIL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(kernelMutex);
+        xTimer->period = xNewPeriod;
+    }
+    return xTimerStart(xTimer, xTicksToWait);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t) {
+    if (xTimer == nullptr) {
+        return pdFAIL;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    // The daemon may still hold the pointer, so the control block is retired, not freed
+    xTimer->active = false;
+    xTimer->deleted = true;
+    timerGeneration++;
+    if (xTimer->fromHeap) {
+        heapRelease(TIMER_OVERHEAD);
+    }
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer) {
+    if (xTimer == nullptr) {
+        return pdFALSE;
+    }
+    std::lock_guard<std::mutex> lock(kernelMutex);
+    return xTimer->active ? pdTRUE : pdFALSE;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t xTimer) {
+    return xTimer ? xTimer->id : nullptr;
+}
+
+const char* pcTimerGetName(TimerHandle_t xTimer) {
+    return xTimer ? xTimer->name.c_str() : "";
+}
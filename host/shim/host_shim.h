@@ -0,0 +1,105 @@
+#ifndef BITS_HOST_SHIM_H
+#define BITS_HOST_SHIM_H
+
+/*
+ * B.I.T.E.S - Host Shim Control API
+ *
+ * Hooks used by host tests and benchmarks to drive the shimmed hardware:
+ * the clock, GPIO/ADC pin levels, simulated I2C devices and the audio
+ * block graph. None of this exists on target.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+namespace BITS {
+namespace Host {
+
+// Clock
+// Real mode follows the host monotonic clock. Virtual mode only moves when
+// advanceTime() or delay() is called, which makes tests deterministic.
+void useVirtualTime(bool enable);
+bool isVirtualTime();
+uint64_t nowMicros();
+void advanceTime(uint32_t us);
+// ARM_DWT_CYCCNT follows the host clock in both modes, unless simulated: a
+// simulated counter only moves when advanceCycles() is called
+void useSimulatedCycles(bool enable);
+void advanceCycles(uint32_t cycles);
+
+// GPIO / ADC
+constexpr uint16_t MAX_PINS = 256;
+void setAnalogValue(uint8_t pin, int value);
+void setDigitalValue(uint8_t pin, int value);
+uint8_t getPinMode(uint8_t pin);
+uint32_t getAnalogReadCount();
+// Time each analogRead() takes (default 0)
+void setAnalogReadDelay(uint32_t us);
+// What tempmonGetTemp() reports (default 25 °C)
+void setBoardTemperature(float celsius);
+
+// Serial
+// Output is written to stdout unless silenced (benchmarks keep it quiet) or
+// redirected to a sink. Passing nullptr restores stdout.
+using SerialSink = std::function<void(const uint8_t* data, size_t length)>;
+void setSerialEnabled(bool enable);
+void setSerialSink(SerialSink sink);
+// Whether a monitor is attached, i.e. what `if (Serial)` reports on target
+// (default true). Output written while detached is discarded.
+void setSerialConnected(bool connected);
+
+// I2C
+// Register-mapped device model: the first byte of a write selects the
+// register, further bytes are written with auto-increment, reads continue
+// from the selected register with auto-increment.
+class I2CDevice {
+public:
+    virtual ~I2CDevice() = default;
+    virtual uint8_t readRegister(uint8_t reg) = 0;
+    virtual void writeRegister(uint8_t reg, uint8_t value) = 0;
+};
+
+// Simulated MPU6050 register file (defaults to ±2g / ±250°/s scaling).
+// DATA_RDY in INT_STATUS follows a sample clock on nowMicros() at the rate
+// set by CONFIG and SMPLRT_DIV, and is cleared by reading INT_STATUS.
+class SimulatedMPU6050 : public I2CDevice {
+public:
+    SimulatedMPU6050();
+    uint8_t readRegister(uint8_t reg) override;
+    void writeRegister(uint8_t reg, uint8_t value) override;
+
+    void setAccel(float x, float y, float z);
+    void setGyro(float x, float y, float z);
+    void setTemperature(float celsius);
+    uint32_t getBurstReadCount() const { return burstReads; }
+
+private:
+    uint8_t registers[128];
+    uint32_t burstReads;
+    uint64_t lastSample;
+    uint8_t takeDataReady();
+    static float constrainf(float value);
+    void setWord(uint8_t reg, int16_t value);
+};
+
+// Attach a device to bus 0 (Wire), 1 (Wire1) or 2 (Wire2). Passing nullptr
+// detaches it. A SimulatedMPU6050 is attached to Wire at 0x68 by default.
+void attachI2CDevice(uint8_t bus, uint8_t address, I2CDevice* device);
+SimulatedMPU6050& defaultMPU6050();
+uint32_t getI2CTransactionCount(uint8_t bus);
+// Extra time a device holds each transfer on the async I2CMaster (clock
+// stretching, conversion time), on top of the bus time (default 0)
+void setI2CDeviceLatency(uint8_t bus, uint8_t address, uint32_t us);
+
+// Audio
+// Runs one pass of the block graph, the host equivalent of the audio
+// interrupt. Output blocks reach the sink registered here.
+using AudioSink = std::function<void(const int16_t* left, const int16_t* right, size_t samples)>;
+void renderAudioBlock();
+void setAudioSink(AudioSink sink);
+
+} // namespace Host
+} // namespace BITS
+
+#endif // BITS_HOST_SHIM_H
@@ -0,0 +1,60 @@
+#ifndef BITS_HOST_I2C_DRIVER_H
+#define BITS_HOST_I2C_DRIVER_H
+
+/*
+ * B.I.T.E.S - Host i2c_driver Shim
+ *
+ * Stand-in for the interrupt-driven I2CMaster of the teensy4_i2c library.
+ * Transfers go to the devices attached through BITS::Host::attachI2CDevice()
+ * and finish once their bus time at the set frequency, plus any latency set
+ * with BITS::Host::setI2CDeviceLatency(), has passed on the host clock.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class I2CError : uint8_t {
+    ok = 0,
+    address_nak,
+    data_nak,
+    master_not_ready,
+    invalid_request,
+};
+
+class I2CMaster {
+public:
+    explicit I2CMaster(uint8_t bus);
+
+    void begin(uint32_t frequency);
+    void end();
+    bool finished();
+    size_t get_bytes_transferred();
+    void write_async(uint8_t address, const uint8_t* buffer, size_t num_bytes, bool send_stop);
+    void read_async(uint8_t address, uint8_t* buffer, size_t num_bytes, bool send_stop);
+    bool has_error() const { return error_ != I2CError::ok; }
+    I2CError error() const { return error_; }
+
+private:
+    uint8_t bus;
+    uint32_t frequency;
+    bool started;
+    bool pending;           // Transfer started and not yet carried out
+    bool reading;
+    uint8_t address;
+    const uint8_t* writeBuffer;
+    uint8_t* readBuffer;
+    size_t length;
+    size_t transferred;
+    uint64_t doneAt;
+    I2CError error_;
+    uint8_t registerPointer[128];
+
+    void start(uint8_t address, size_t num_bytes);
+    void complete();
+};
+
+extern I2CMaster Master;    // Pins 19/18, the Wire bus
+extern I2CMaster Master1;
+extern I2CMaster Master2;
+
+#endif // BITS_HOST_I2C_DRIVER_H
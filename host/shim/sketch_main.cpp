@@ -0,0 +1,37 @@
+/*
+ * B.I.T.E.S - Host Sketch Runner
+ *
+ * Provides main() for sketch-style programs (setup()/loop()) built on the
+ * host. Options:
+ *   --virtual-time   run on the virtual clock (delay() returns immediately)
+ *   --loops N        call loop() N times and exit (default: forever)
+ *   --quiet          suppress Serial output
+ */
+
+#include <Arduino.h>
+#include "host_shim.h"
+#include <stdlib.h>
+#include <string.h>
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    long loops = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--virtual-time") == 0) {
+            BITS::Host::useVirtualTime(true);
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loops = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            BITS::Host::setSerialEnabled(false);
+        }
+    }
+
+    setup();
+    for (long i = 0; loops < 0 || i < loops; i++) {
+        loop();
+    }
+    Serial.flush();
+    return 0;
+}
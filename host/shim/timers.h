@@ -0,0 +1,27 @@
+#ifndef BITS_HOST_TIMERS_H
+#define BITS_HOST_TIMERS_H
+
+#include "FreeRTOS.h"
+
+struct tmrTimerControl;
+typedef struct tmrTimerControl* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+// Callbacks run on a single daemon thread, like the FreeRTOS timer service task
+TimerHandle_t xTimerCreate(const char* pcTimerName, TickType_t xTimerPeriodInTicks,
+                           UBaseType_t uxAutoReload, void* pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction);
+TimerHandle_t xTimerCreateStatic(const char* pcTimerName, TickType_t xTimerPeriodInTicks,
+                                 UBaseType_t uxAutoReload, void* pvTimerID,
+                                 TimerCallbackFunction_t pxCallbackFunction,
+                                 StaticTimer_t* pxTimerBuffer);
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerReset(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait);
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer);
+void* pvTimerGetTimerID(TimerHandle_t xTimer);
+const char* pcTimerGetName(TimerHandle_t xTimer);
+
+#endif // BITS_HOST_TIMERS_H
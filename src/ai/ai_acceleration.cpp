@@ -6,6 +6,8 @@
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+
 bool AIAcceleration::initialized = false;
 arm_rfft_fast_instance_f32 AIAcceleration::fftInstance;
 arm_fir_instance_f32 AIAcceleration::firInstance;
@@ -90,6 +92,7 @@ void AIAcceleration::firFilter(const float* input, float* output, const float* c
 
 void AIAcceleration::iirFilter(const float* input, float* output, const float* bCoeffs,
                                const float* aCoeffs, uint32_t blockSize, uint32_t numTaps) {
+    (void)aCoeffs;
     // IIR filter implementation using CMSIS-DSP
     // Simplified - would need proper IIR instance setup
     arm_biquad_cascade_df2T_instance_f32 iirInstance;
@@ -6,10 +6,13 @@
 #include "ai/pitch_corrector.h"
 #include "ai/pattern_learner.h"
 #include "core/logger.h"
+#include "core/trace.h"
 
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+
 bool AIEngine::initialized = false;
 bool AIEngine::gestureRecognitionEnabled = false;
 bool AIEngine::chordPredictionEnabled = false;
@@ -41,6 +44,7 @@ void AIEngine::update() {
     if (!initialized) {
         return;
     }
+    TRACE_SCOPE("AIEngine::update");
     
     if (gestureRecognitionEnabled) {
         GestureRecognition::update();
@@ -4,6 +4,8 @@
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+
 bool ChordPredictor::initialized = false;
 Chord ChordPredictor::currentChord = {0, 0, 0.0f};
 uint8_t ChordPredictor::playedNotes[16];
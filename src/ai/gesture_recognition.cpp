@@ -3,12 +3,17 @@
 #include "sensors/mpu6050_driver.h"
 #include "sensors/sensor_fusion.h"
 #include "core/logger.h"
+#include "core/trace.h"
 #include <math.h>
 #include <arm_math.h>
 
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+using Sensors::MPU6050Driver;
+using Sensors::MPU6050Data;
+
 bool GestureRecognition::initialized = false;
 bool GestureRecognition::training = false;
 GestureType GestureRecognition::lastGesture = GestureType::NONE;
@@ -61,8 +66,10 @@ bool GestureRecognition::isTraining() {
 }
 
 void GestureRecognition::extractFeatures(float* features) {
-    // Get sensor data
-    MPU6050Data data = MPU6050Driver::readAll();
+    TRACE_SCOPE("GestureRecognition::extractFeatures");
+    
+    // Latest IMU sample; the sensor task does the bus reads
+    MPU6050Data data = MPU6050Driver::get().readAll();
     
     // Extract features:
     // 0-2: Acceleration (X, Y, Z)
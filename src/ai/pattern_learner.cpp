@@ -1,10 +1,15 @@
 #include "ai/pattern_learner.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
 #include <Arduino.h>
 
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
 bool PatternLearner::initialized = false;
 bool PatternLearner::learning = false;
 Pattern PatternLearner::currentPattern = {{0}, {0}, 0, 0.0f};
@@ -12,6 +17,7 @@ Pattern PatternLearner::learnedPatterns[8];
 uint8_t PatternLearner::learnedPatternCount = 0;
 
 void PatternLearner::init() {
+    MemoryBudget::reserve(MemorySubsystem::AI, "learned patterns", sizeof(learnedPatterns));
     initialized = true;
     learning = false;
     currentPattern.noteCount = 0;
@@ -6,6 +6,8 @@
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+
 bool PitchCorrector::initialized = false;
 float PitchCorrector::correctionFactor = 1.0f;
 
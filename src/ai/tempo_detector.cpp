@@ -6,22 +6,35 @@
 namespace BITS {
 namespace AI {
 
+using Core::Logger;
+using Core::EventQueue;
+using Core::Event;
+using Core::EventType;
+
 bool TempoDetector::initialized = false;
 float TempoDetector::currentTempo = 120.0f; // BPM
 uint32_t TempoDetector::beatTimes[16];
 uint8_t TempoDetector::beatCount = 0;
 uint32_t TempoDetector::lastBeatTime = 0;
+Core::SubscriberId TempoDetector::sensorEvents = EventQueue::INVALID_SUBSCRIBER;
 
 void TempoDetector::init() {
     initialized = true;
     currentTempo = 120.0f;
     beatCount = 0;
     lastBeatTime = 0;
+    if (sensorEvents == EventQueue::INVALID_SUBSCRIBER) {
+        sensorEvents = EventQueue::addSubscriber(Core::eventMask(EventType::SENSOR_TRIGGERED));
+    }
     Logger::info("Tempo detector initialized");
 }
 
 void TempoDetector::update() {
-    // Tempo detection runs on beat events
+    // Tempo detection runs on beat events (sensor triggers)
+    Event event;
+    while (EventQueue::poll(sensorEvents, event)) {
+        recordBeat(event.timestamp);
+    }
 }
 
 float TempoDetector::detectTempo() {
@@ -46,8 +59,10 @@ uint32_t TempoDetector::getBeatInterval() {
 }
 
 void TempoDetector::recordBeat() {
-    uint32_t now = millis();
-    
+    recordBeat(micros());
+}
+
+void TempoDetector::recordBeat(uint32_t now) {
     if (beatCount >= 16) {
         // Shift array
         for (uint8_t i = 0; i < 15; i++) {
@@ -79,7 +94,8 @@ float TempoDetector::calculateTempo() {
     uint8_t intervals = 0;
     
     for (uint8_t i = 1; i < beatCount; i++) {
-        uint32_t interval = beatTimes[i] - beatTimes[i - 1];
+        // Subtract before scaling so the interval survives micros() wrapping
+        uint32_t interval = (beatTimes[i] - beatTimes[i - 1]) / 1000;
         if (interval > 200 && interval < 2000) { // Valid range: 30-300 BPM
             totalInterval += interval;
             intervals++;
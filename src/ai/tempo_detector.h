@@ -2,6 +2,7 @@
 #define BITS_AI_TEMPO_DETECTOR_H
 
 #include <stdint.h>
+#include "core/event_queue.h"
 
 namespace BITS {
 namespace AI {
@@ -16,14 +17,16 @@ public:
     static uint32_t getBeatInterval();
     
     static void recordBeat();
+    static void recordBeat(uint32_t timestampUs);      // micros(), as in events
     static void reset();
 
 private:
     static bool initialized;
     static float currentTempo;
-    static uint32_t beatTimes[16];
+    static uint32_t beatTimes[16];      // micros() of each beat
     static uint8_t beatCount;
     static uint32_t lastBeatTime;
+    static Core::SubscriberId sensorEvents;
     
     static float calculateTempo();
 };
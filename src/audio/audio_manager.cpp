@@ -7,6 +7,8 @@
 namespace BITS {
 namespace Audio {
 
+using Core::Logger;
+
 bool AudioManager::initialized = false;
 float AudioManager::masterVolume = 0.8f;
 AudioControlSGTL5000 AudioManager::codec;
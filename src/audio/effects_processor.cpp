@@ -4,8 +4,10 @@
 namespace BITS {
 namespace Audio {
 
+using Core::Logger;
+
 AudioEffectReverb EffectsProcessor::reverb;
-AudioEffectDelay EffectsProcessor::delay(16000); // 16k samples delay
+AudioEffectDelay EffectsProcessor::delay;
 AudioEffectFreeverb EffectsProcessor::freeverb;
 EffectType EffectsProcessor::trackEffects[MAX_TRACKS];
 bool EffectsProcessor::initialized = false;
@@ -48,17 +50,19 @@ void EffectsProcessor::setReverbRoomSize(float size) {
 }
 
 void EffectsProcessor::setDelayTime(float timeMs) {
-    // Convert ms to samples (at 44.1kHz)
-    uint32_t samples = static_cast<uint32_t>(timeMs * 44.1f);
-    delay.delay(0, constrain(samples, 0u, 16000u));
+    // Limit to a 16k sample delay line (at 44.1kHz)
+    delay.delay(0, constrain(timeMs, 0.0f, 16000.0f / 44.1f));
 }
 
 void EffectsProcessor::setDistortionAmount(float amount) {
+    (void)amount;
     // Distortion implementation depends on Audio library version
     // Simplified for now
 }
 
 void EffectsProcessor::setEQBand(uint8_t band, float gain) {
+    (void)band;
+    (void)gain;
     // EQ implementation depends on Audio library version
     // Simplified for now
 }
@@ -1,12 +1,25 @@
 #include "audio/mixer.h"
+#include "audio/sample_manager.h"
 #include "core/logger.h"
+#include "core/trace.h"
+#include "core/memory_budget.h"
 #include "config.h"
 
 namespace BITS {
 namespace Audio {
 
-AudioMixer4 Mixer::mixers[MAX_TRACKS / 4];
-AudioMixer4 Mixer::finalMixer;
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+static_assert(MAX_POLYPHONY / 4 <= 4, "The final mixer takes at most four voice mixers");
+
+Core::StaticPool<AudioMixer4, Mixer::VOICE_MIXERS + 1> Mixer::mixerPool;
+Core::StaticPool<AudioOutputI2S, 1> Mixer::outputPool;
+Core::StaticPool<AudioConnection, Mixer::CONNECTIONS> Mixer::connectionPool;
+AudioMixer4* Mixer::voiceMixers[VOICE_MIXERS];
+AudioMixer4* Mixer::finalMixer = nullptr;
+AudioOutputI2S* Mixer::output = nullptr;
 float Mixer::trackVolumes[MAX_TRACKS];
 float Mixer::masterVolume = 1.0f;
 bool Mixer::initialized = false;
@@ -17,21 +30,45 @@ void Mixer::init() {
         trackVolumes[i] = 0.5f;
     }
     
-    // Set mixer gains
-    for (uint8_t i = 0; i < MAX_TRACKS / 4; i++) {
-        mixers[i].gain(0, 0.25f);
-        mixers[i].gain(1, 0.25f);
-        mixers[i].gain(2, 0.25f);
-        mixers[i].gain(3, 0.25f);
+    // Voices -> voice mixers -> final mixer -> I2S (both channels).
+    // Track volume is applied per voice when a note starts. The graph
+    // lives in static pools and is only built on the first init.
+    if (finalMixer == nullptr) {
+        for (uint8_t i = 0; i < VOICE_MIXERS; i++) {
+            voiceMixers[i] = mixerPool.create();
+            for (uint8_t channel = 0; channel < 4; channel++) {
+                AudioStream* voice = SampleManager::getVoiceOutput(i * 4 + channel);
+                if (voice != nullptr) {
+                    connectionPool.create(*voice, 0, *voiceMixers[i], channel);
+                }
+            }
+        }
+        
+        finalMixer = mixerPool.create();
+        for (uint8_t i = 0; i < VOICE_MIXERS; i++) {
+            connectionPool.create(*voiceMixers[i], 0, *finalMixer, i);
+        }
+        
+        output = outputPool.create();
+        connectionPool.create(*finalMixer, 0, *output, 0);
+        connectionPool.create(*finalMixer, 0, *output, 1);
     }
     
-    finalMixer.gain(0, masterVolume);
+    for (uint8_t i = 0; i < VOICE_MIXERS; i++) {
+        for (uint8_t channel = 0; channel < 4; channel++) {
+            voiceMixers[i]->gain(channel, 0.5f);
+        }
+        finalMixer->gain(i, masterVolume);
+    }
     
+    MemoryBudget::reserve(MemorySubsystem::AUDIO, "mixer graph",
+                          mixerPool.bytes() + outputPool.bytes() + connectionPool.bytes());
     initialized = true;
     Logger::info("Mixer initialized");
 }
 
 void Mixer::update() {
+    TRACE_SCOPE("Mixer::update");
     // Mixer updates automatically via Audio library
 }
 
@@ -41,11 +78,6 @@ void Mixer::setTrackVolume(uint8_t trackId, float volume) {
     }
     
     trackVolumes[trackId] = constrain(volume, 0.0f, 1.0f);
-    
-    // Update mixer gain
-    uint8_t mixerIndex = trackId / 4;
-    uint8_t channel = trackId % 4;
-    mixers[mixerIndex].gain(channel, trackVolumes[trackId] * 0.25f);
 }
 
 float Mixer::getTrackVolume(uint8_t trackId) {
@@ -57,7 +89,12 @@ float Mixer::getTrackVolume(uint8_t trackId) {
 
 void Mixer::setMasterVolume(float volume) {
     masterVolume = constrain(volume, 0.0f, 1.0f);
-    finalMixer.gain(0, masterVolume);
+    if (!initialized) {
+        return;
+    }
+    for (uint8_t i = 0; i < VOICE_MIXERS && i < 4; i++) {
+        finalMixer->gain(i, masterVolume);
+    }
 }
 
 float Mixer::getMasterVolume() {
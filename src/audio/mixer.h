@@ -3,6 +3,8 @@
 
 #include <Audio.h>
 #include <stdint.h>
+#include "config.h"
+#include "core/static_pool.h"
 
 namespace BITS {
 namespace Audio {
@@ -19,8 +21,18 @@ public:
 
 private:
     static constexpr uint8_t MAX_TRACKS = 8;
-    static AudioMixer4 mixers[MAX_TRACKS / 4];
-    static AudioMixer4 finalMixer;
+    static constexpr uint8_t VOICE_MIXERS = MAX_POLYPHONY / 4;
+    // Voice inputs, voice mixers into the final mixer, final mixer to L/R
+    static constexpr uint8_t CONNECTIONS = VOICE_MIXERS * 4 + VOICE_MIXERS + 2;
+    
+    // Graph objects are created in init() so they follow the voice players
+    // in the audio update order (Teensy updates in construction order)
+    static Core::StaticPool<AudioMixer4, VOICE_MIXERS + 1> mixerPool;
+    static Core::StaticPool<AudioOutputI2S, 1> outputPool;
+    static Core::StaticPool<AudioConnection, CONNECTIONS> connectionPool;
+    static AudioMixer4* voiceMixers[VOICE_MIXERS];
+    static AudioMixer4* finalMixer;
+    static AudioOutputI2S* output;
     static float trackVolumes[MAX_TRACKS];
     static float masterVolume;
     static bool initialized;
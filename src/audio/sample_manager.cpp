@@ -1,19 +1,31 @@
 #include "audio/sample_manager.h"
+#include "audio/mixer.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
 #include "config.h"
 #include <Arduino.h>
 
 namespace BITS {
 namespace Audio {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+Core::StaticPool<SamplePlayer, SampleManager::MAX_VOICES> SampleManager::players;
 SampleManager::Voice SampleManager::voices[MAX_VOICES];
 uint8_t SampleManager::voiceCount = 0;
+SampleManager::Sample SampleManager::samples[MAX_SAMPLES];
+uint8_t SampleManager::sampleCount = 0;
+uint32_t SampleManager::notesPlayed = 0;
 bool SampleManager::initialized = false;
 
 void SampleManager::init() {
-    // Initialize voices
+    // Initialize voices; players are constructed once, on the first init
     for (uint8_t i = 0; i < MAX_VOICES; i++) {
-        voices[i].player = new AudioPlayMemory();
+        if (voices[i].player == nullptr) {
+            voices[i].player = players.create();
+        }
         voices[i].active = false;
         voices[i].trackId = 0;
         voices[i].noteId = 0;
@@ -21,13 +33,31 @@ void SampleManager::init() {
     }
     
     voiceCount = 0;
+    MemoryBudget::reserve(MemorySubsystem::AUDIO, "sample players", players.bytes());
+    MemoryBudget::reserve(MemorySubsystem::AUDIO, "voices and samples", sizeof(voices) + sizeof(samples));
     initialized = true;
     Logger::info("Sample manager initialized");
 }
 
 bool SampleManager::loadSample(uint8_t trackId, uint8_t noteId, const int16_t* data, uint32_t length) {
-    // Note: AudioPlayMemory uses PROGMEM data
-    // In production, implement proper sample loading from flash/SD
+    if (data == nullptr || length == 0) {
+        return false;
+    }
+    
+    // Sample data stays in flash (PROGMEM), only the reference is stored
+    Sample* sample = findSample(trackId, noteId);
+    if (sample == nullptr) {
+        if (sampleCount >= MAX_SAMPLES) {
+            Logger::warning("Sample table full");
+            return false;
+        }
+        sample = &samples[sampleCount++];
+        sample->trackId = trackId;
+        sample->noteId = noteId;
+    }
+    
+    sample->data = data;
+    sample->length = length;
     return true;
 }
 
@@ -36,25 +66,24 @@ bool SampleManager::playNote(uint8_t trackId, uint8_t noteId, float velocity) {
         return false;
     }
     
-    // Check if note is already playing
-    Voice* existing = findVoice(trackId, noteId);
-    if (existing != nullptr) {
-        // Restart note
-        existing->startTime = millis();
-        return true;
-    }
+    reclaimVoices();
     
-    // Allocate new voice
-    Voice* voice = allocateVoice(trackId, noteId);
+    // Restart the note if it is already playing, otherwise allocate a voice
+    Voice* voice = findVoice(trackId, noteId);
     if (voice == nullptr) {
-        Logger::warning("No free voices available");
-        return false;
+        voice = allocateVoice(trackId, noteId);
+        if (voice == nullptr) {
+            Logger::warning("No free voices available");
+            return false;
+        }
     }
     
-    // Play note (simplified - in production, load actual sample data)
-    // voice->player->play(...);
-    voice->active = true;
+    const Sample* sample = findSample(trackId, noteId);
+    if (sample != nullptr) {
+        voice->player->play(sample->data, sample->length, velocity * Mixer::getTrackVolume(trackId));
+    }
     voice->startTime = millis();
+    notesPlayed++;
     
     return true;
 }
@@ -79,6 +108,17 @@ bool SampleManager::isNotePlaying(uint8_t trackId, uint8_t noteId) {
     return voice != nullptr && voice->active;
 }
 
+uint32_t SampleManager::getNotesPlayed() {
+    return notesPlayed;
+}
+
+AudioStream* SampleManager::getVoiceOutput(uint8_t voice) {
+    if (!initialized || voice >= MAX_VOICES) {
+        return nullptr;
+    }
+    return voices[voice].player;
+}
+
 uint8_t SampleManager::getActiveVoices(uint8_t trackId) {
     uint8_t count = 0;
     for (uint8_t i = 0; i < MAX_VOICES; i++) {
@@ -104,6 +144,7 @@ SampleManager::Voice* SampleManager::allocateVoice(uint8_t trackId, uint8_t note
 
 void SampleManager::freeVoice(Voice* voice) {
     if (voice != nullptr && voice->active) {
+        voice->player->stop();
         voice->active = false;
         voice->trackId = 0;
         voice->noteId = 0;
@@ -123,5 +164,24 @@ SampleManager::Voice* SampleManager::findVoice(uint8_t trackId, uint8_t noteId)
     return nullptr;
 }
 
+SampleManager::Sample* SampleManager::findSample(uint8_t trackId, uint8_t noteId) {
+    for (uint8_t i = 0; i < sampleCount; i++) {
+        if (samples[i].trackId == trackId && samples[i].noteId == noteId) {
+            return &samples[i];
+        }
+    }
+    return nullptr;
+}
+
+void SampleManager::reclaimVoices() {
+    // One-shot samples free their voice once playback has finished
+    for (uint8_t i = 0; i < MAX_VOICES; i++) {
+        if (voices[i].active && !voices[i].player->isPlaying() &&
+            findSample(voices[i].trackId, voices[i].noteId) != nullptr) {
+            freeVoice(&voices[i]);
+        }
+    }
+}
+
 } // namespace Audio
 } // namespace BITS
@@ -2,6 +2,8 @@
 #define BITS_AUDIO_SAMPLE_MANAGER_H
 
 #include <Audio.h>
+#include "audio/sample_player.h"
+#include "core/static_pool.h"
 #include <stdint.h>
 
 namespace BITS {
@@ -17,24 +19,42 @@ public:
     
     static bool isNotePlaying(uint8_t trackId, uint8_t noteId);
     static uint8_t getActiveVoices(uint8_t trackId);
+    static uint32_t getNotesPlayed();
+    
+    // Voice outputs, wired into the mixer graph by Mixer::init()
+    static AudioStream* getVoiceOutput(uint8_t voice);
 
 private:
     static constexpr uint8_t MAX_TRACKS = 8;
     static constexpr uint8_t MAX_NOTES_PER_TRACK = 128;
     static constexpr uint8_t MAX_VOICES = 16;
+    static constexpr uint8_t MAX_SAMPLES = 128;
+    
+    struct Sample {
+        const int16_t* data;
+        uint32_t length;
+        uint8_t trackId;
+        uint8_t noteId;
+    };
     
     struct Voice {
-        AudioPlayMemory* player;
+        SamplePlayer* player;
         bool active;
         uint8_t trackId;
         uint8_t noteId;
         uint32_t startTime;
     };
     
+    static Core::StaticPool<SamplePlayer, MAX_VOICES> players;
     static Voice voices[MAX_VOICES];
     static uint8_t voiceCount;
+    static Sample samples[MAX_SAMPLES];
+    static uint8_t sampleCount;
+    static uint32_t notesPlayed;
     static bool initialized;
     
+    static Sample* findSample(uint8_t trackId, uint8_t noteId);
+    static void reclaimVoices();
     static Voice* allocateVoice(uint8_t trackId, uint8_t noteId);
     static void freeVoice(Voice* voice);
     static Voice* findVoice(uint8_t trackId, uint8_t noteId);
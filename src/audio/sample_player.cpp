@@ -0,0 +1,49 @@
+#include "audio/sample_player.h"
+#include <Arduino.h>
+
+namespace BITS {
+namespace Audio {
+
+void SamplePlayer::play(const int16_t* data, uint32_t length, float gain) {
+    // Parameters are read by update() in the audio interrupt
+    AudioNoInterrupts();
+    this->data = data;
+    this->length = length;
+    this->position = 0;
+    this->gain = constrain(gain, 0.0f, 1.0f);
+    playing = (data != nullptr && length > 0);
+    AudioInterrupts();
+}
+
+void SamplePlayer::stop() {
+    playing = false;
+}
+
+void SamplePlayer::update() {
+    if (!playing) {
+        return;
+    }
+    
+    audio_block_t* block = allocate();
+    if (block == nullptr) {
+        return;
+    }
+    
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        if (position < length) {
+            block->data[i] = static_cast<int16_t>(data[position++] * gain);
+        } else {
+            block->data[i] = 0;
+        }
+    }
+    
+    if (position >= length) {
+        playing = false;
+    }
+    
+    transmit(block);
+    release(block);
+}
+
+} // namespace Audio
+} // namespace BITS
@@ -0,0 +1,34 @@
+#ifndef BITS_AUDIO_SAMPLE_PLAYER_H
+#define BITS_AUDIO_SAMPLE_PLAYER_H
+
+#include <Audio.h>
+#include <stdint.h>
+
+namespace BITS {
+namespace Audio {
+
+// Plays raw 16-bit mono PCM at 44.1kHz, as generated by tools/sample_converter.py.
+// Playback starts on the next audio update after play().
+class SamplePlayer : public AudioStream {
+public:
+    SamplePlayer() : AudioStream(0, nullptr), data(nullptr), length(0), position(0),
+                     gain(0.0f), playing(false) {}
+    
+    void play(const int16_t* data, uint32_t length, float gain = 1.0f);
+    void stop();
+    bool isPlaying() const { return playing; }
+    
+    virtual void update() override;
+
+private:
+    const int16_t* data;
+    uint32_t length;
+    uint32_t position;
+    float gain;
+    volatile bool playing;
+};
+
+} // namespace Audio
+} // namespace BITS
+
+#endif // BITS_AUDIO_SAMPLE_PLAYER_H
@@ -11,16 +11,93 @@
 #define CPU_FREQ_MHZ 600
 #define SERIAL_BAUD_RATE 115200
 
+// Logging configuration (0 = DEBUG ... 4 = NONE); lower levels compile out
+#ifndef BITS_LOG_LEVEL
+#define BITS_LOG_LEVEL 1
+#endif
+#define LOG_TASK_PERIOD_MS 10
+
+// Tracing (TRACE_SCOPE compiles to nothing unless enabled)
+#ifndef BITS_TRACE_ENABLED
+#define BITS_TRACE_ENABLED 0
+#endif
+#define TRACE_BUFFER_SIZE 256
+
 // RTOS configuration
 #define RTOS_TICK_RATE_HZ 1000
 #define RTOS_MAX_TASKS 10
 
+// Event-driven wakeups: tasks sleep until sensor edges, trigger events or
+// new IMU windows wake them instead of polling at fixed periods
+#ifndef RTOS_EVENT_DRIVEN_TASKS
+#define RTOS_EVENT_DRIVEN_TASKS 1
+#endif
+#define RTOS_IDLE_WAKEUP_MS 100     // Longest sleep of an event-driven task
+#define RTOS_CHECKIN_GRACE_MS 10    // Slack before a task counts as hung
+
+// Schedule admission: measured WCETs are padded by this margin, and no task
+// period may be shorter than the minimum (5 kHz)
+#define SCHED_WCET_MARGIN_PERCENT 20
+#define SCHED_MIN_PERIOD_US 200
+
+// Static allocation: RTOS objects use the *CreateStatic APIs and any heap
+// allocation once boot has completed is a fatal error
+#ifndef BITS_STATIC_ALLOCATION
+#define BITS_STATIC_ALLOCATION 1
+#endif
+
+// Memory budgets per subsystem (KB), checked by the boot-time report
+#define MEMORY_BUDGET_CORE_KB 32
+#define MEMORY_BUDGET_RTOS_KB 50
+#define MEMORY_BUDGET_SENSORS_KB 40
+#define MEMORY_BUDGET_AUDIO_KB 200
+#define MEMORY_BUDGET_AI_KB 100
+#define MEMORY_BUDGET_NETWORK_KB 16
+
 // Sensor configuration
-#define MAX_SENSORS 16
+#define MAX_SENSORS 128      // Channel ids; a multiple of 32
 #define SENSOR_POLL_RATE_HZ 1000
 #define MPU6050_I2C_ADDRESS 0x68
 #define MPU6050_SDA_PIN 18
 #define MPU6050_SCL_PIN 19
+#define MPU6050_WIRE1_SDA_PIN 17
+#define MPU6050_WIRE1_SCL_PIN 16
+// IMU n is on Wire (even n) or Wire1 (odd n), at 0x68 for the first two
+// and 0x69 (AD0 high) for the next two, so pairs are read in parallel
+#define MAX_IMUS 4
+#define IMU_RING_SAMPLES 32  // Timestamped IMU samples kept; a power of two
+#define FUSION_BETA 0.1f     // Madgwick gain: how fast accel corrects gyro drift
+// I2C transfers are queued and run by a service interrupt, not the caller
+#define I2C_CLOCK_HZ 400000
+#define I2C_BUS_COUNT 2             // Wire and Wire1
+#define I2C_QUEUE_DEPTH 8           // Queued transactions; a power of two
+#define I2C_SERVICE_RATE_HZ 10000   // Host completion checks per second
+
+// Analog acquisition: every piezo/pressure/flex channel is scanned at this
+// rate, and the sensor task consumes the readings as blocks
+#define ADC_SCAN_RATE_HZ 10000
+#define ADC_RING_SAMPLES 32  // Readings kept per channel; a power of two
+// Polls an IR input must disagree with its debounced state to change it (1-4)
+#define DIGITAL_DEBOUNCE_SAMPLES 2
+// Background calibration averages the readings the sensor task takes anyway:
+// a channel is done when its baseline is this close (standard error), an IMU
+// after this many samples in a row at rest
+#define CALIBRATION_MIN_SAMPLES 100
+#define CALIBRATION_TOLERANCE_COUNTS 0.5f
+#define CALIBRATION_GYRO_REST_DPS 1.0f  // Gyro spread still counted as at rest
+#define CALIBRATION_TIMEOUT_MS 5000     // Channels not done by then keep their values
+#define CALIBRATION_NOISE_SIGMAS 4.0f   // Thresholds clear the resting noise by this much
+// Saved calibration profiles apply at boot if the sensor and pin match and
+// the die temperature is within this much; results that moved less than
+// these are not rewritten, to spare the EEPROM
+#define CALIBRATION_PROFILE_MAX_DRIFT_C 10
+#define CALIBRATION_PROFILE_SAVE_COUNTS 2.0f
+#define CALIBRATION_PROFILE_SAVE_DPS 0.1f
+// Once calibrated, piezo and pressure thresholds follow the resting noise
+// floor, averaged over this long; readings further out than this many
+// standard deviations count only as that far
+#define NOISE_FLOOR_TIME_CONSTANT_MS 2000
+#define NOISE_FLOOR_OUTLIER_SIGMAS 3.0f
 
 // Audio configuration
 #define AUDIO_SAMPLE_RATE_HZ 44100
@@ -36,6 +113,7 @@
 #define AI_TEMPO_ENABLED 1
 #define AI_PITCH_ENABLED 1
 #define AI_PATTERN_ENABLED 1
+#define AI_IMU_WINDOW_SAMPLES 10    // IMU samples per inference wakeup
 
 // Network configuration
 #define WIFI_MAX_RETRY 5
@@ -1,18 +1,81 @@
 #include "core/config_manager.h"
 #include "core/logger.h"
-#include <EEPROM.h>
 
 namespace BITS {
 namespace Core {
 
-const char* ConfigManager::NAMESPACE = "bits_config";
 bool ConfigManager::initialized = false;
 
-// Note: Using EEPROM for Teensy. For production, consider using EEPROM library
-// or implement NVS-like storage using Flash memory
+namespace {
+
+// Keys are hashed at compile time; per-sensor and per-feature keys derive
+// from a base key and the index
+constexpr ConfigKey KEY_INSTRUMENT_TYPE = configKey("instrument_type");
+constexpr ConfigKey KEY_SENSOR_ENABLED = configKey("sensor_en");
+constexpr ConfigKey KEY_SENSOR_GPIO = configKey("sensor_gpio");
+constexpr ConfigKey KEY_AUDIO_VOLUME = configKey("audio_volume");
+constexpr ConfigKey KEY_AI_ENABLED = configKey("ai_en");
+constexpr ConfigKey KEY_WIFI_SSID = configKey("wifi_ssid");
+constexpr ConfigKey KEY_WIFI_PASSWORD = configKey("wifi_pass");
+constexpr ConfigKey KEY_BLUETOOTH_ENABLED = configKey("bluetooth_en");
+constexpr ConfigKey KEY_TASK_PERIOD = configKey("task_period");
+constexpr ConfigKey KEY_TASK_PRIORITY = configKey("task_prio");
+constexpr ConfigKey KEY_SENSOR_CALIBRATION = configKey("sensor_cal");
+constexpr ConfigKey KEY_IMU_CALIBRATION = configKey("imu_cal");
+
+constexpr ConfigKey ALL_KEYS[] = {
+    KEY_INSTRUMENT_TYPE, KEY_SENSOR_ENABLED, KEY_SENSOR_GPIO, KEY_AUDIO_VOLUME,
+    KEY_AI_ENABLED, KEY_WIFI_SSID, KEY_WIFI_PASSWORD, KEY_BLUETOOTH_ENABLED,
+    KEY_TASK_PERIOD, KEY_TASK_PRIORITY, KEY_SENSOR_CALIBRATION, KEY_IMU_CALIBRATION
+};
+
+constexpr bool keysUnique(size_t i = 0, size_t j = 1) {
+    return i >= sizeof(ALL_KEYS) / sizeof(ALL_KEYS[0]) ? true
+         : j >= sizeof(ALL_KEYS) / sizeof(ALL_KEYS[0]) ? keysUnique(i + 1, i + 2)
+         : ALL_KEYS[i] != ALL_KEYS[j] && ALL_KEYS[i] != 0 && keysUnique(i, j + 1);
+}
+
+static_assert(keysUnique(), "Config key hash collision");
+
+// Sensor calibration records in fixed point, eight channels to an entry, so
+// a full channel table takes 16 of the store's entries rather than 128
+constexpr uint8_t CALIBRATION_BLOCK = 8;
+constexpr uint8_t NO_CALIBRATION = 0xFF;
+constexpr float BASELINE_STEPS = 16.0f;     // Per ADC count
+constexpr float NOISE_STEPS = 256.0f;
+
+struct StoredCalibration {
+    uint8_t type;           // NO_CALIBRATION if none
+    uint8_t gpio;
+    int8_t temperatureC;
+    uint8_t reserved;
+    uint16_t baseline;
+    uint16_t noise;
+};
+
+struct CalibrationBlock {
+    StoredCalibration channels[CALIBRATION_BLOCK];
+};
+
+static_assert(sizeof(CalibrationBlock) <= ConfigStore::MAX_VALUE_SIZE, "Calibration block exceeds a store entry");
+
+// No padding, so an unchanged record compares equal and is not rewritten
+struct StoredImuCalibration {
+    float gyroBias[3];
+    float accelScale;
+    int8_t temperatureC;
+    uint8_t reserved[3];
+};
+
+uint16_t toFixed(float value, float steps) {
+    float scaled = value * steps + 0.5f;
+    return scaled <= 0.0f ? 0 : (scaled >= 65535.0f ? 65535 : static_cast<uint16_t>(scaled));
+}
+
+
+} // namespace
 
 void ConfigManager::init() {
-    EEPROM.begin(512); // Allocate 512 bytes for configuration
     initialized = true;
     Logger::info("Config manager initialized");
     load();
@@ -23,8 +86,11 @@ bool ConfigManager::load() {
         init();
     }
     
-    // Load configuration from EEPROM
-    // For now, use defaults if EEPROM is empty
+    // Replays the EEPROM log into the RAM cache; missing keys use defaults
+    if (!ConfigStore::init()) {
+        Logger::error("Configuration load failed, using defaults");
+        return false;
+    }
     Logger::info("Configuration loaded");
     return true;
 }
@@ -34,129 +100,157 @@ bool ConfigManager::save() {
         return false;
     }
     
-    EEPROM.commit();
+    if (!ConfigStore::save()) {
+        Logger::error("Configuration save failed");
+        return false;
+    }
     Logger::info("Configuration saved");
     return true;
 }
 
 uint8_t ConfigManager::getInstrumentType() {
-    return getKeyUint8("instrument_type", 0);
+    return ConfigStore::get<uint8_t>(KEY_INSTRUMENT_TYPE, 0);
 }
 
 void ConfigManager::setInstrumentType(uint8_t type) {
-    setKey("instrument_type", type);
+    ConfigStore::set<uint8_t>(KEY_INSTRUMENT_TYPE, type);
 }
 
 bool ConfigManager::getSensorEnabled(uint8_t sensorId) {
-    char key[32];
-    snprintf(key, sizeof(key), "sensor_%d_en", sensorId);
-    return getKeyBool(key, true);
+    return ConfigStore::get<bool>(configKey(KEY_SENSOR_ENABLED, sensorId), true);
 }
 
 void ConfigManager::setSensorEnabled(uint8_t sensorId, bool enabled) {
-    char key[32];
-    snprintf(key, sizeof(key), "sensor_%d_en", sensorId);
-    setKey(key, enabled);
+    ConfigStore::set<bool>(configKey(KEY_SENSOR_ENABLED, sensorId), enabled);
 }
 
 uint8_t ConfigManager::getSensorGPIO(uint8_t sensorId) {
-    char key[32];
-    snprintf(key, sizeof(key), "sensor_%d_gpio", sensorId);
-    return getKeyUint8(key, 0);
+    return ConfigStore::get<uint8_t>(configKey(KEY_SENSOR_GPIO, sensorId), 0);
 }
 
 void ConfigManager::setSensorGPIO(uint8_t sensorId, uint8_t gpio) {
-    char key[32];
-    snprintf(key, sizeof(key), "sensor_%d_gpio", sensorId);
-    setKey(key, gpio);
+    ConfigStore::set<uint8_t>(configKey(KEY_SENSOR_GPIO, sensorId), gpio);
+}
+
+bool ConfigManager::getSensorCalibration(uint8_t sensorId, SensorCalibrationRecord& record) {
+    CalibrationBlock block;
+    ConfigKey key = configKey(KEY_SENSOR_CALIBRATION, sensorId / CALIBRATION_BLOCK);
+    if (!ConfigStore::get(key, &block, sizeof(block))) {
+        return false;
+    }
+    const StoredCalibration& stored = block.channels[sensorId % CALIBRATION_BLOCK];
+    if (stored.type == NO_CALIBRATION) {
+        return false;
+    }
+    record = {stored.type, stored.gpio, stored.temperatureC, stored.baseline / BASELINE_STEPS,
+              stored.noise / NOISE_STEPS};
+    return true;
+}
+
+void ConfigManager::setSensorCalibration(uint8_t sensorId, const SensorCalibrationRecord& record) {
+    CalibrationBlock block;
+    ConfigKey key = configKey(KEY_SENSOR_CALIBRATION, sensorId / CALIBRATION_BLOCK);
+    if (!ConfigStore::get(key, &block, sizeof(block))) {
+        memset(&block, 0, sizeof(block));
+        for (uint8_t i = 0; i < CALIBRATION_BLOCK; i++) {
+            block.channels[i].type = NO_CALIBRATION;
+        }
+    }
+    block.channels[sensorId % CALIBRATION_BLOCK] = {record.type, record.gpio, record.temperatureC, 0,
+                                                    toFixed(record.baseline, BASELINE_STEPS),
+                                                    toFixed(record.noise, NOISE_STEPS)};
+    ConfigStore::set(key, &block, sizeof(block));
+}
+
+bool ConfigManager::getImuCalibration(uint8_t imu, ImuCalibrationRecord& record) {
+    StoredImuCalibration stored;
+    if (!ConfigStore::get(configKey(KEY_IMU_CALIBRATION, imu), &stored, sizeof(stored))) {
+        return false;
+    }
+    record.temperatureC = stored.temperatureC;
+    memcpy(record.gyroBias, stored.gyroBias, sizeof(record.gyroBias));
+    record.accelScale = stored.accelScale;
+    return true;
+}
+
+void ConfigManager::setImuCalibration(uint8_t imu, const ImuCalibrationRecord& record) {
+    StoredImuCalibration stored = {};
+    memcpy(stored.gyroBias, record.gyroBias, sizeof(stored.gyroBias));
+    stored.accelScale = record.accelScale;
+    stored.temperatureC = record.temperatureC;
+    ConfigStore::set(configKey(KEY_IMU_CALIBRATION, imu), &stored, sizeof(stored));
 }
 
 float ConfigManager::getVolume() {
-    return getKeyFloat("audio_volume", 0.8f);
+    return ConfigStore::get<float>(KEY_AUDIO_VOLUME, 0.8f);
 }
 
 void ConfigManager::setVolume(float volume) {
-    setKey("audio_volume", volume);
+    ConfigStore::set<float>(KEY_AUDIO_VOLUME, volume);
 }
 
 bool ConfigManager::getAIEnabled(uint8_t aiFeatureId) {
-    char key[32];
-    snprintf(key, sizeof(key), "ai_%d_en", aiFeatureId);
-    return getKeyBool(key, false);
+    return ConfigStore::get<bool>(configKey(KEY_AI_ENABLED, aiFeatureId), false);
 }
 
 void ConfigManager::setAIEnabled(uint8_t aiFeatureId, bool enabled) {
-    char key[32];
-    snprintf(key, sizeof(key), "ai_%d_en", aiFeatureId);
-    setKey(key, enabled);
+    ConfigStore::set<bool>(configKey(KEY_AI_ENABLED, aiFeatureId), enabled);
 }
 
 String ConfigManager::getWiFiSSID() {
-    return getKey("wifi_ssid");
+    return ConfigStore::getString(KEY_WIFI_SSID);
+}
+
+bool ConfigManager::getWiFiSSID(char* buffer, size_t size) {
+    return ConfigStore::getString(KEY_WIFI_SSID, buffer, size);
 }
 
 void ConfigManager::setWiFiSSID(const String& ssid) {
-    setKey("wifi_ssid", ssid);
+    ConfigStore::setString(KEY_WIFI_SSID, ssid.c_str());
 }
 
 String ConfigManager::getWiFiPassword() {
-    return getKey("wifi_pass");
+    return ConfigStore::getString(KEY_WIFI_PASSWORD);
+}
+
+bool ConfigManager::getWiFiPassword(char* buffer, size_t size) {
+    return ConfigStore::getString(KEY_WIFI_PASSWORD, buffer, size);
 }
 
 void ConfigManager::setWiFiPassword(const String& password) {
-    setKey("wifi_pass", password);
+    ConfigStore::setString(KEY_WIFI_PASSWORD, password.c_str());
 }
 
 bool ConfigManager::getBluetoothEnabled() {
-    return getKeyBool("bluetooth_en", false);
+    return ConfigStore::get<bool>(KEY_BLUETOOTH_ENABLED, false);
 }
 
 void ConfigManager::setBluetoothEnabled(bool enabled) {
-    setKey("bluetooth_en", enabled);
-}
-
-void ConfigManager::resetToDefaults() {
-    setInstrumentType(0);
-    setVolume(0.8f);
-    setBluetoothEnabled(false);
-    save();
-    Logger::info("Configuration reset to defaults");
+    ConfigStore::set<bool>(KEY_BLUETOOTH_ENABLED, enabled);
 }
 
-String ConfigManager::getKey(const char* key) {
-    // Simplified implementation - in production, use proper key-value storage
-    return String("");
+uint32_t ConfigManager::getTaskPeriodUs(uint8_t taskId) {
+    return ConfigStore::get<uint32_t>(configKey(KEY_TASK_PERIOD, taskId), 0);
 }
 
-void ConfigManager::setKey(const char* key, const String& value) {
-    // Simplified implementation
+void ConfigManager::setTaskPeriodUs(uint8_t taskId, uint32_t periodUs) {
+    ConfigStore::set<uint32_t>(configKey(KEY_TASK_PERIOD, taskId), periodUs);
 }
 
-void ConfigManager::setKey(const char* key, uint8_t value) {
-    // Simplified implementation - store in EEPROM
+uint8_t ConfigManager::getTaskPriority(uint8_t taskId) {
+    return ConfigStore::get<uint8_t>(configKey(KEY_TASK_PRIORITY, taskId), 0);
 }
 
-void ConfigManager::setKey(const char* key, float value) {
-    // Simplified implementation
+void ConfigManager::setTaskPriority(uint8_t taskId, uint8_t priority) {
+    ConfigStore::set<uint8_t>(configKey(KEY_TASK_PRIORITY, taskId), priority);
 }
 
-void ConfigManager::setKey(const char* key, bool value) {
-    // Simplified implementation
-}
-
-uint8_t ConfigManager::getKeyUint8(const char* key, uint8_t defaultValue) {
-    // Simplified implementation
-    return defaultValue;
-}
-
-float ConfigManager::getKeyFloat(const char* key, float defaultValue) {
-    // Simplified implementation
-    return defaultValue;
-}
-
-bool ConfigManager::getKeyBool(const char* key, bool defaultValue) {
-    // Simplified implementation
-    return defaultValue;
+void ConfigManager::resetToDefaults() {
+    setInstrumentType(0);
+    setVolume(0.8f);
+    setBluetoothEnabled(false);
+    save();
+    Logger::info("Configuration reset to defaults");
 }
 
 } // namespace Core
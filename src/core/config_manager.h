@@ -2,12 +2,32 @@
 #define BITS_CORE_CONFIG_MANAGER_H
 
 #include <Arduino.h>
+#include "core/config_store.h"
 
 namespace BITS {
 namespace Core {
 
+// A calibrated analog channel: its resting baseline and noise in ADC
+// counts, and the sensor type, pin and die temperature they were measured at
+struct SensorCalibrationRecord {
+    uint8_t type;
+    uint8_t gpio;
+    int8_t temperatureC;
+    float baseline;
+    float noise;
+};
+
+// A calibrated IMU's corrections, and the die temperature they were measured at
+struct ImuCalibrationRecord {
+    int8_t temperatureC;
+    float gyroBias[3];      // °/s
+    float accelScale;
+};
+
 class ConfigManager {
 public:
+    // Getters read the RAM cache only; setters take effect immediately and
+    // are persisted by the next save()
     static void init();
     static bool load();
     static bool save();
@@ -22,6 +42,13 @@ public:
     static uint8_t getSensorGPIO(uint8_t sensorId);
     static void setSensorGPIO(uint8_t sensorId, uint8_t gpio);
     
+    // Calibration profiles, for a warm start at boot. Sensor records are
+    // packed eight channels to a store entry, so only one task may set them.
+    static bool getSensorCalibration(uint8_t sensorId, SensorCalibrationRecord& record);
+    static void setSensorCalibration(uint8_t sensorId, const SensorCalibrationRecord& record);
+    static bool getImuCalibration(uint8_t imu, ImuCalibrationRecord& record);
+    static void setImuCalibration(uint8_t imu, const ImuCalibrationRecord& record);
+    
     // Audio configuration
     static float getVolume();
     static void setVolume(float volume);
@@ -32,29 +59,28 @@ public:
     
     // WiFi configuration
     static String getWiFiSSID();
+    static bool getWiFiSSID(char* buffer, size_t size);
     static void setWiFiSSID(const String& ssid);
     static String getWiFiPassword();
+    static bool getWiFiPassword(char* buffer, size_t size);
     static void setWiFiPassword(const String& password);
     
     // Bluetooth configuration
     static bool getBluetoothEnabled();
     static void setBluetoothEnabled(bool enabled);
     
+    // Task scheduling, per TaskId (0 = built-in default). Applied at boot
+    // by ScheduleManager, which also writes them when a schedule is applied.
+    static uint32_t getTaskPeriodUs(uint8_t taskId);
+    static void setTaskPeriodUs(uint8_t taskId, uint32_t periodUs);
+    static uint8_t getTaskPriority(uint8_t taskId);
+    static void setTaskPriority(uint8_t taskId, uint8_t priority);
+    
     // Reset to defaults
     static void resetToDefaults();
 
 private:
-    static const char* NAMESPACE;
     static bool initialized;
-    
-    static String getKey(const char* key);
-    static void setKey(const char* key, const String& value);
-    static void setKey(const char* key, uint8_t value);
-    static void setKey(const char* key, float value);
-    static void setKey(const char* key, bool value);
-    static uint8_t getKeyUint8(const char* key, uint8_t defaultValue);
-    static float getKeyFloat(const char* key, float defaultValue);
-    static bool getKeyBool(const char* key, bool defaultValue);
 };
 
 } // namespace Core
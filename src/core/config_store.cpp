@@ -0,0 +1,503 @@
+#include "core/config_store.h"
+#include "core/logger.h"
+#include "core/memory_budget.h"
+#include "rtos/static_objects.h"
+#include <EEPROM.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+
+namespace BITS {
+namespace Core {
+
+static_assert((ConfigStore::MAX_ENTRIES & (ConfigStore::MAX_ENTRIES - 1)) == 0,
+              "Config cache size must be a power of two");
+
+namespace {
+
+// Bank layout: magic, generation, then records until erased (0xFF) space.
+// Record: key (4), size (1), data (size), CRC-8 over key, size and data.
+constexpr uint32_t BANK_MAGIC = 0x31464342UL;   // "BCF1"
+constexpr uint16_t HEADER_SIZE = 8;
+constexpr uint16_t RECORD_OVERHEAD = 6;
+constexpr uint32_t ERASED_KEY = 0xFFFFFFFFUL;
+constexpr ConfigKey COMMIT_KEY = 0;             // Ends a batch; never a valid key
+constexpr uint8_t TOMBSTONE_SIZE = 0xFE;        // Record removes its key
+
+RTOS::SemaphoreStorage storeMutexStorage;
+SemaphoreHandle_t storeMutex = nullptr;
+
+uint8_t crc8(uint8_t crc, uint8_t data) {
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+    }
+    return crc;
+}
+
+uint32_t read32(uint16_t address) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(EEPROM.read(address + i)) << (i * 8);
+    }
+    return value;
+}
+
+void write32(uint16_t address, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        EEPROM.update(address + i, (value >> (i * 8)) & 0xFF);
+    }
+}
+
+class StoreLock {
+public:
+    StoreLock() {
+        if (storeMutex != nullptr) {
+            xSemaphoreTake(storeMutex, portMAX_DELAY);
+        }
+    }
+    ~StoreLock() {
+        if (storeMutex != nullptr) {
+            xSemaphoreGive(storeMutex);
+        }
+    }
+};
+
+} // namespace
+
+ConfigStore::Entry ConfigStore::entries[MAX_ENTRIES];
+uint16_t ConfigStore::activeBank = 0;
+uint16_t ConfigStore::logEnd = HEADER_SIZE;
+uint32_t ConfigStore::generation = 0;
+uint32_t ConfigStore::compactions = 0;
+bool ConfigStore::mounted = false;
+
+bool ConfigStore::init() {
+    if (BASE_ADDRESS + 2 * BANK_SIZE > EEPROM.length()) {
+        Logger::error("Config store does not fit in EEPROM");
+        return false;
+    }
+    if (storeMutex == nullptr) {
+        storeMutex = storeMutexStorage.createMutex();
+    }
+    MemoryBudget::reserve(MemorySubsystem::CORE, "config cache",
+                          sizeof(entries) + RTOS::SemaphoreStorage::BYTES);
+
+    StoreLock lock;
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        entries[i].key = 0;
+        entries[i].size = 0;
+        entries[i].live = false;
+        entries[i].dirty = false;
+        entries[i].version.store(0, std::memory_order_relaxed);
+    }
+    compactions = 0;
+
+    // Mount the newest bank with a valid header
+    int16_t newest = -1;
+    for (uint16_t bank = 0; bank < 2; bank++) {
+        uint32_t bankGeneration = read32(bankAddress(bank) + 4);
+        if (read32(bankAddress(bank)) == BANK_MAGIC && bankGeneration != ERASED_KEY &&
+            (newest < 0 || bankGeneration > generation)) {
+            newest = bank;
+            generation = bankGeneration;
+        }
+    }
+
+    if (newest < 0) {
+        generation = 0;
+        if (!writeBank(0, 1)) {
+            return false;
+        }
+        mounted = true;
+        Logger::info("Config store formatted");
+        return true;
+    }
+
+    activeBank = static_cast<uint16_t>(newest);
+    uint16_t end = HEADER_SIZE;
+    replay(activeBank, end, false);
+    replay(activeBank, end, true);
+    logEnd = end;
+    mounted = true;
+
+    // A save interrupted mid-batch leaves records past the last commit
+    if (logEnd + 4 <= BANK_SIZE && read32(bankAddress(activeBank) + logEnd) != ERASED_KEY) {
+        Logger::warning("Config store: discarding uncommitted records");
+        writeBank(activeBank ^ 1, generation + 1);
+        compactions++;
+    }
+
+    ConfigStoreStats stats = getStats();
+    Logger::info("Config store mounted: %u entries, %u/%u bytes, generation %lu",
+                 stats.liveEntries, stats.logBytes, stats.bankSize, generation);
+    return true;
+}
+
+bool ConfigStore::save() {
+    if (!mounted) {
+        return false;
+    }
+
+    StoreLock lock;
+    uint16_t needed = RECORD_OVERHEAD;
+    uint16_t dirtyCount = 0;
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        if (entries[i].key != 0 && entries[i].dirty) {
+            needed += RECORD_OVERHEAD + (entries[i].live ? entries[i].size : 0);
+            dirtyCount++;
+        }
+    }
+    if (dirtyCount == 0) {
+        return true;
+    }
+
+    if (logEnd + needed > BANK_SIZE) {
+        // Out of space: the compacted bank carries the dirty entries too
+        if (!writeBank(activeBank ^ 1, generation + 1)) {
+            return false;
+        }
+        compactions++;
+        return true;
+    }
+
+    uint16_t address = bankAddress(activeBank) + logEnd;
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        Entry& entry = entries[i];
+        if (entry.key == 0 || !entry.dirty) {
+            continue;
+        }
+
+        // Snapshot under the critical section, write EEPROM outside it
+        uint8_t value[MAX_VALUE_SIZE];
+        uint8_t size;
+        taskENTER_CRITICAL();
+        size = entry.live ? entry.size : TOMBSTONE_SIZE;
+        if (entry.live) {
+            memcpy(value, entry.value, entry.size);
+        }
+        entry.dirty = false;
+        taskEXIT_CRITICAL();
+
+        address = writeRecord(address, entry.key, value, size);
+    }
+    address = writeRecord(address, COMMIT_KEY, nullptr, 0);
+    logEnd = address - bankAddress(activeBank);
+    return true;
+}
+
+bool ConfigStore::compact() {
+    if (!mounted) {
+        return false;
+    }
+    StoreLock lock;
+    if (!writeBank(activeBank ^ 1, generation + 1)) {
+        return false;
+    }
+    compactions++;
+    return true;
+}
+
+void ConfigStore::erase() {
+    StoreLock lock;
+    taskENTER_CRITICAL();
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        Entry& entry = entries[i];
+        entry.version.fetch_add(1, std::memory_order_acq_rel);
+        entry.key = 0;
+        entry.live = false;
+        entry.dirty = false;
+        entry.version.fetch_add(1, std::memory_order_release);
+    }
+    taskEXIT_CRITICAL();
+    writeBank(activeBank ^ 1, generation + 1);
+}
+
+bool ConfigStore::contains(ConfigKey key) {
+    Entry* entry = find(key);
+    return entry != nullptr && entry->live;
+}
+
+bool ConfigStore::remove(ConfigKey key) {
+    Entry* entry = find(key);
+    if (entry == nullptr || !entry->live) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    entry->version.fetch_add(1, std::memory_order_acq_rel);
+    entry->live = false;
+    entry->dirty = true;
+    entry->version.fetch_add(1, std::memory_order_release);
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+bool ConfigStore::get(ConfigKey key, void* value, uint8_t size) {
+    Entry* entry = find(key);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    // Sequence-checked copy: retry if a writer was active meanwhile
+    while (true) {
+        uint32_t before = entry->version.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        bool found = entry->live && entry->size == size;
+        if (found) {
+            memcpy(value, entry->value, size);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry->version.load(std::memory_order_relaxed) == before) {
+            return found;
+        }
+    }
+}
+
+bool ConfigStore::set(ConfigKey key, const void* value, uint8_t size) {
+    if (key == COMMIT_KEY || size > MAX_VALUE_SIZE) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    Entry* entry = findOrInsert(key);
+    if (entry == nullptr) {
+        taskEXIT_CRITICAL();
+        Logger::warning("Config store full, key 0x%08lX not stored", key);
+        return false;
+    }
+    if (entry->live && entry->size == size && memcmp(entry->value, value, size) == 0) {
+        taskEXIT_CRITICAL();
+        return true;
+    }
+    entry->version.fetch_add(1, std::memory_order_acq_rel);
+    memcpy(entry->value, value, size);
+    entry->size = size;
+    entry->live = true;
+    entry->dirty = true;
+    entry->version.fetch_add(1, std::memory_order_release);
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+String ConfigStore::getString(ConfigKey key, const char* defaultValue) {
+    char buffer[MAX_VALUE_SIZE + 1];
+    Entry* entry = find(key);
+    if (entry == nullptr) {
+        return String(defaultValue);
+    }
+    uint8_t size = entry->size;
+    if (!get(key, buffer, size)) {
+        return String(defaultValue);
+    }
+    buffer[size] = '\0';
+    return String(buffer);
+}
+
+bool ConfigStore::getString(ConfigKey key, char* buffer, size_t size) {
+    if (size == 0) {
+        return false;
+    }
+    buffer[0] = '\0';
+    Entry* entry = find(key);
+    if (entry == nullptr) {
+        return false;
+    }
+    uint8_t length = entry->size;
+    if (length >= size || !get(key, buffer, length)) {
+        buffer[0] = '\0';
+        return false;
+    }
+    buffer[length] = '\0';
+    return true;
+}
+
+bool ConfigStore::setString(ConfigKey key, const char* value) {
+    size_t length = strlen(value);
+    if (length > MAX_VALUE_SIZE) {
+        Logger::warning("Config value too long (%u bytes)", static_cast<unsigned>(length));
+        return false;
+    }
+    return set(key, value, static_cast<uint8_t>(length));
+}
+
+ConfigStoreStats ConfigStore::getStats() {
+    ConfigStoreStats stats;
+    stats.liveEntries = 0;
+    stats.dirtyEntries = 0;
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        if (entries[i].key != 0 && entries[i].live) {
+            stats.liveEntries++;
+        }
+        if (entries[i].key != 0 && entries[i].dirty) {
+            stats.dirtyEntries++;
+        }
+    }
+    stats.logBytes = logEnd;
+    stats.bankSize = BANK_SIZE;
+    stats.activeBankAddress = bankAddress(activeBank);
+    stats.generation = generation;
+    stats.compactions = compactions;
+    return stats;
+}
+
+ConfigStore::Entry* ConfigStore::find(ConfigKey key) {
+    // Open addressing with linear probing; slots are never freed, so a
+    // probe ends at the first empty slot
+    for (uint16_t probe = 0; probe < MAX_ENTRIES; probe++) {
+        Entry& entry = entries[(key + probe) & (MAX_ENTRIES - 1)];
+        ConfigKey slotKey = entry.key;
+        if (slotKey == key) {
+            return &entry;
+        }
+        if (slotKey == 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+ConfigStore::Entry* ConfigStore::findOrInsert(ConfigKey key) {
+    for (uint16_t probe = 0; probe < MAX_ENTRIES; probe++) {
+        Entry& entry = entries[(key + probe) & (MAX_ENTRIES - 1)];
+        if (entry.key == key) {
+            return &entry;
+        }
+        if (entry.key == 0) {
+            entry.size = 0;
+            entry.live = false;
+            entry.dirty = false;
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.key = key;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+uint16_t ConfigStore::bankAddress(uint16_t bank) {
+    return BASE_ADDRESS + bank * BANK_SIZE;
+}
+
+bool ConfigStore::replay(uint16_t bank, uint16_t& end, bool apply) {
+    // Without apply: sets end to just past the last commit record.
+    // With apply: loads the records before end into the cache.
+    uint16_t base = bankAddress(bank);
+    uint16_t offset = HEADER_SIZE;
+    uint16_t limit = apply ? end : BANK_SIZE;
+    uint16_t committed = HEADER_SIZE;
+
+    while (offset + RECORD_OVERHEAD <= limit) {
+        ConfigKey key = read32(base + offset);
+        if (key == ERASED_KEY) {
+            break;
+        }
+        uint8_t size = EEPROM.read(base + offset + 4);
+        uint8_t length = size == TOMBSTONE_SIZE ? 0 : size;
+        if (length > MAX_VALUE_SIZE || offset + RECORD_OVERHEAD + length > limit) {
+            break;
+        }
+
+        uint8_t crc = 0;
+        for (uint8_t i = 0; i < 5 + length; i++) {
+            crc = crc8(crc, EEPROM.read(base + offset + i));
+        }
+        if (crc != EEPROM.read(base + offset + 5 + length)) {
+            break;
+        }
+
+        if (apply && key != COMMIT_KEY) {
+            Entry* entry = findOrInsert(key);
+            if (entry != nullptr) {
+                entry->live = size != TOMBSTONE_SIZE;
+                entry->size = length;
+                for (uint8_t i = 0; i < length; i++) {
+                    entry->value[i] = EEPROM.read(base + offset + 5 + i);
+                }
+            }
+        }
+
+        offset += RECORD_OVERHEAD + length;
+        if (key == COMMIT_KEY) {
+            committed = offset;
+        }
+    }
+
+    if (!apply) {
+        end = committed;
+    }
+    return true;
+}
+
+uint16_t ConfigStore::writeRecord(uint16_t address, ConfigKey key, const uint8_t* data, uint8_t size) {
+    uint8_t length = size == TOMBSTONE_SIZE ? 0 : size;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t byte = (key >> (i * 8)) & 0xFF;
+        EEPROM.update(address + i, byte);
+        crc = crc8(crc, byte);
+    }
+    EEPROM.update(address + 4, size);
+    crc = crc8(crc, size);
+    for (uint8_t i = 0; i < length; i++) {
+        EEPROM.update(address + 5 + i, data[i]);
+        crc = crc8(crc, data[i]);
+    }
+    EEPROM.update(address + 5 + length, crc);
+    return address + RECORD_OVERHEAD + length;
+}
+
+bool ConfigStore::writeBank(uint16_t bank, uint32_t newGeneration) {
+    // Build the new bank completely before validating its header, so the
+    // previous bank stays authoritative until the last byte is written
+    uint16_t base = bankAddress(bank);
+    for (uint16_t i = 0; i < BANK_SIZE; i++) {
+        EEPROM.update(base + i, 0xFF);
+    }
+
+    uint16_t address = base + HEADER_SIZE;
+    for (uint16_t i = 0; i < MAX_ENTRIES; i++) {
+        Entry& entry = entries[i];
+        if (entry.key == 0) {
+            continue;
+        }
+
+        uint8_t value[MAX_VALUE_SIZE];
+        uint8_t size;
+        bool live;
+        taskENTER_CRITICAL();
+        live = entry.live;
+        size = entry.size;
+        if (live) {
+            memcpy(value, entry.value, size);
+        }
+        entry.dirty = false;
+        taskEXIT_CRITICAL();
+
+        if (!live) {
+            continue;
+        }
+        if (address + RECORD_OVERHEAD + size + RECORD_OVERHEAD > base + BANK_SIZE) {
+            // Keep everything dirty; the active bank is still intact
+            for (uint16_t j = 0; j < MAX_ENTRIES; j++) {
+                entries[j].dirty = entries[j].key != 0;
+            }
+            Logger::error("Config store: live entries exceed bank size");
+            return false;
+        }
+        address = writeRecord(address, entry.key, value, size);
+    }
+    address = writeRecord(address, COMMIT_KEY, nullptr, 0);
+
+    write32(base + 4, newGeneration);
+    write32(base, BANK_MAGIC);
+
+    activeBank = bank;
+    generation = newGeneration;
+    logEnd = address - base;
+    return true;
+}
+
+} // namespace Core
+} // namespace BITS
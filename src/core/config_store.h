@@ -0,0 +1,108 @@
+#ifndef BITS_CORE_CONFIG_STORE_H
+#define BITS_CORE_CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+namespace BITS {
+namespace Core {
+
+typedef uint32_t ConfigKey;
+
+// FNV-1a; evaluated at compile time for literal key names
+constexpr ConfigKey configKey(const char* name, ConfigKey hash = 2166136261UL) {
+    return *name == '\0' ? hash : configKey(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619UL);
+}
+
+// Per-index key (sensor 3, AI feature 1, ...) derived from a base key
+constexpr ConfigKey configKey(ConfigKey base, uint8_t index) {
+    return (base ^ index) * 16777619UL;
+}
+
+struct ConfigStoreStats {
+    uint16_t liveEntries;
+    uint16_t dirtyEntries;
+    uint16_t logBytes;          // Used bytes in the active bank
+    uint16_t bankSize;
+    uint16_t activeBankAddress;
+    uint32_t generation;
+    uint32_t compactions;
+};
+
+// Key-value store with a RAM cache in front of an append-only log in EEPROM.
+// Reads only touch the cache and never block, so they are safe from
+// real-time tasks. Writes mark entries dirty; save() appends all dirty
+// entries plus a commit record in one batch. When the active bank is full,
+// live entries are compacted into the other bank, so writes rotate over
+// the whole region instead of wearing a fixed cell.
+class ConfigStore {
+public:
+    static constexpr uint16_t MAX_ENTRIES = 64;     // Power of two
+    static constexpr uint8_t MAX_VALUE_SIZE = 64;
+    static constexpr uint16_t BASE_ADDRESS = 0;
+    static constexpr uint16_t BANK_SIZE = 2048;     // Two banks
+
+    // Mounts the newest valid bank and replays it into the cache
+    static bool init();
+    static bool save();
+    static bool compact();
+    // Drops every entry (RAM and EEPROM)
+    static void erase();
+
+    static bool contains(ConfigKey key);
+    static bool remove(ConfigKey key);
+
+    // Raw access; get() fails if the stored size differs
+    static bool get(ConfigKey key, void* value, uint8_t size);
+    static bool set(ConfigKey key, const void* value, uint8_t size);
+
+    template <typename T>
+    static T get(ConfigKey key, T defaultValue) {
+        T value;
+        return get(key, &value, sizeof(T)) ? value : defaultValue;
+    }
+
+    template <typename T>
+    static bool set(ConfigKey key, T value) {
+        return set(key, &value, sizeof(T));
+    }
+
+    static String getString(ConfigKey key, const char* defaultValue = "");
+    // Heap-free variant: copies the NUL-terminated value, or "" if missing.
+    // Fails if the key is missing or the buffer is too small.
+    static bool getString(ConfigKey key, char* buffer, size_t size);
+    static bool setString(ConfigKey key, const char* value);
+
+    static ConfigStoreStats getStats();
+
+private:
+    struct Entry {
+        std::atomic<uint32_t> version;  // Odd while being written
+        std::atomic<ConfigKey> key;     // 0 while the slot is unused
+        uint8_t size;
+        bool live;                      // False once removed
+        bool dirty;
+        uint8_t value[MAX_VALUE_SIZE];
+    };
+
+    static Entry entries[MAX_ENTRIES];
+    static uint16_t activeBank;
+    static uint16_t logEnd;             // Offset of the next record in the bank
+    static uint32_t generation;
+    static uint32_t compactions;
+    static bool mounted;
+
+    static Entry* find(ConfigKey key);
+    static Entry* findOrInsert(ConfigKey key);
+    static uint16_t bankAddress(uint16_t bank);
+    static bool replay(uint16_t bank, uint16_t& end, bool apply);
+    static uint16_t writeRecord(uint16_t address, ConfigKey key, const uint8_t* data, uint8_t size);
+    static bool writeBank(uint16_t bank, uint32_t newGeneration);
+};
+
+} // namespace Core
+} // namespace BITS
+
+#endif // BITS_CORE_CONFIG_STORE_H
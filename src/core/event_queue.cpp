@@ -1,50 +1,264 @@
 #include "core/event_queue.h"
 #include "core/logger.h"
+#include "core/trace.h"
+#include "core/memory_budget.h"
+#include "rtos/static_objects.h"
+#include <task.h>
 
 namespace BITS {
 namespace Core {
 
-QueueHandle_t EventQueue::queue = nullptr;
+static_assert((EventQueue::RING_SIZE & (EventQueue::RING_SIZE - 1)) == 0,
+              "Event ring size must be a power of two");
+
+EventQueue::Subscriber EventQueue::subscribers[MAX_SUBSCRIBERS];
+std::atomic<uint32_t> EventQueue::publishCount{0};
+
+// Wakeup semaphores, created on a slot's first use
+static RTOS::SemaphoreStorage wakeupStorage[EventQueue::MAX_SUBSCRIBERS];
 
 void EventQueue::init() {
-    queue = xQueueCreate(QUEUE_SIZE, sizeof(Event));
-    if (queue == nullptr) {
-        Logger::error("Failed to create event queue");
-    } else {
-        Logger::info("Event queue initialized");
+    // Storage is static, so subscribers registered before init() are kept
+    publishCount = 0;
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        subscribers[i].drops = 0;
+        subscribers[i].highWatermark = 0;
+    }
+    MemoryBudget::reserve(MemorySubsystem::CORE, "event rings",
+                          sizeof(subscribers) + MAX_SUBSCRIBERS * RTOS::SemaphoreStorage::BYTES);
+    Logger::info("Event queue initialized");
+}
+
+SubscriberId EventQueue::addSubscriber(uint32_t typeMask) {
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        Subscriber& subscriber = subscribers[i];
+        if (subscriber.active) {
+            continue;
+        }
+
+        if (subscriber.wakeup == nullptr) {
+            subscriber.wakeup = wakeupStorage[i].createBinary();
+            if (subscriber.wakeup == nullptr) {
+                Logger::error("Failed to create event subscriber %d", i);
+                return INVALID_SUBSCRIBER;
+            }
+        }
+
+        resetRing(subscriber);
+        subscriber.drops = 0;
+        subscriber.highWatermark = 0;
+        subscriber.waiting = false;
+        subscriber.mask = typeMask;
+        subscriber.active = true;
+        return i;
+    }
+
+    Logger::error("Maximum event subscriber count reached");
+    return INVALID_SUBSCRIBER;
+}
+
+void EventQueue::removeSubscriber(SubscriberId id) {
+    if (id >= MAX_SUBSCRIBERS) {
+        return;
+    }
+    subscribers[id].mask = 0;
+    subscribers[id].active = false;
+}
+
+void EventQueue::setSubscriberMask(SubscriberId id, uint32_t typeMask) {
+    if (id < MAX_SUBSCRIBERS) {
+        subscribers[id].mask = typeMask;
     }
 }
 
 bool EventQueue::publish(const Event& event) {
-    if (queue == nullptr) {
+    TRACE_SCOPE("EventQueue::publish");
+    uint32_t wakeMask = 0;
+    bool delivered = deliver(event, wakeMask);
+
+    // Kernel calls only for subscribers blocked in subscribe()
+    for (uint8_t i = 0; wakeMask != 0; i++, wakeMask >>= 1) {
+        if (wakeMask & 1) {
+            xSemaphoreGive(subscribers[i].wakeup);
+        }
+    }
+    return delivered;
+}
+
+bool EventQueue::publishFromISR(const Event& event, BaseType_t* higherPriorityTaskWoken) {
+    uint32_t wakeMask = 0;
+    bool delivered = deliver(event, wakeMask);
+
+    for (uint8_t i = 0; wakeMask != 0; i++, wakeMask >>= 1) {
+        if (wakeMask & 1) {
+            xSemaphoreGiveFromISR(subscribers[i].wakeup, higherPriorityTaskWoken);
+        }
+    }
+    return delivered;
+}
+
+bool EventQueue::poll(SubscriberId id, Event& event) {
+    if (id >= MAX_SUBSCRIBERS || !subscribers[id].active) {
         return false;
     }
-    
-    BaseType_t result = xQueueSend(queue, &event, 0);
-    return result == pdTRUE;
+
+    Subscriber& subscriber = subscribers[id];
+    uint32_t tail = subscriber.tail.load(std::memory_order_relaxed);
+    Slot& slot = subscriber.slots[tail & (RING_SIZE - 1)];
+
+    // Slot is readable once its publisher has stamped it with tail + 1
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+        return false;
+    }
+
+    event = slot.event;
+    slot.sequence.store(tail + RING_SIZE, std::memory_order_release);
+    subscriber.tail.store(tail + 1, std::memory_order_relaxed);
+    return true;
 }
 
-bool EventQueue::subscribe(Event& event, uint32_t timeoutMs) {
-    if (queue == nullptr) {
+bool EventQueue::subscribe(SubscriberId id, Event& event, uint32_t timeoutMs) {
+    TRACE_SCOPE("EventQueue::subscribe");
+    if (poll(id, event)) {
+        return true;
+    }
+    if (id >= MAX_SUBSCRIBERS || !subscribers[id].active || timeoutMs == 0) {
         return false;
     }
-    
-    TickType_t timeout = timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
-    BaseType_t result = xQueueReceive(queue, &event, timeout);
-    return result == pdTRUE;
+
+    Subscriber& subscriber = subscribers[id];
+    bool forever = timeoutMs == portMAX_DELAY;
+    TickType_t timeout = forever ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    TickType_t start = xTaskGetTickCount();
+
+    while (true) {
+        // Announce the wait, then re-check so a publish in between is not missed
+        subscriber.waiting = true;
+        if (poll(id, event)) {
+            subscriber.waiting = false;
+            return true;
+        }
+
+        TickType_t remaining = portMAX_DELAY;
+        if (!forever) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout) {
+                subscriber.waiting = false;
+                return false;
+            }
+            remaining = timeout - elapsed;
+        }
+
+        xSemaphoreTake(subscriber.wakeup, remaining);
+        subscriber.waiting = false;
+        if (poll(id, event)) {
+            return true;
+        }
+    }
+}
+
+uint32_t EventQueue::getQueueSize(SubscriberId id) {
+    if (id >= MAX_SUBSCRIBERS) {
+        return 0;
+    }
+    uint32_t head = subscribers[id].head.load(std::memory_order_relaxed);
+    uint32_t tail = subscribers[id].tail.load(std::memory_order_relaxed);
+    return head - tail;
 }
 
-uint32_t EventQueue::getQueueSize() {
-    if (queue == nullptr) {
+uint32_t EventQueue::getDropCount(SubscriberId id) {
+    if (id >= MAX_SUBSCRIBERS) {
         return 0;
     }
-    return uxQueueMessagesWaiting(queue);
+    return subscribers[id].drops;
+}
+
+uint32_t EventQueue::getHighWatermark(SubscriberId id) {
+    if (id >= MAX_SUBSCRIBERS) {
+        return 0;
+    }
+    return subscribers[id].highWatermark;
+}
+
+uint32_t EventQueue::getPublishCount() {
+    return publishCount;
+}
+
+uint32_t EventQueue::getTotalDrops() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        total += subscribers[i].drops;
+    }
+    return total;
+}
+
+void EventQueue::clear(SubscriberId id) {
+    // Owner context only, like poll()
+    Event discarded;
+    while (poll(id, discarded)) {
+    }
 }
 
-void EventQueue::clear() {
-    if (queue != nullptr) {
-        xQueueReset(queue);
+void EventQueue::resetRing(Subscriber& subscriber) {
+    for (uint32_t i = 0; i < RING_SIZE; i++) {
+        subscriber.slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    subscriber.head.store(0, std::memory_order_relaxed);
+    subscriber.tail.store(0, std::memory_order_release);
+}
+
+bool EventQueue::push(Subscriber& subscriber, const Event& event) {
+    // Bounded multi-producer ring: a publisher claims a slot by advancing head,
+    // which lets tasks and ISRs publish concurrently without masking interrupts
+    uint32_t head = subscriber.head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &subscriber.slots[head & (RING_SIZE - 1)];
+        int32_t diff = static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) - head);
+        if (diff == 0) {
+            if (subscriber.head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            subscriber.drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            head = subscriber.head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->event = event;
+    slot->sequence.store(head + 1, std::memory_order_release);
+
+    uint32_t depth = head + 1 - subscriber.tail.load(std::memory_order_relaxed);
+    uint32_t watermark = subscriber.highWatermark.load(std::memory_order_relaxed);
+    while (depth > watermark &&
+           !subscriber.highWatermark.compare_exchange_weak(watermark, depth, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+bool EventQueue::deliver(const Event& event, uint32_t& wakeMask) {
+    publishCount.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t typeBit = eventMask(event.type);
+    bool delivered = true;
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        Subscriber& subscriber = subscribers[i];
+        if (!subscriber.active.load(std::memory_order_acquire) ||
+            (subscriber.mask.load(std::memory_order_relaxed) & typeBit) == 0) {
+            continue;
+        }
+
+        if (!push(subscriber, event)) {
+            delivered = false;
+            continue;
+        }
+        if (subscriber.waiting.load() && subscriber.waiting.exchange(false)) {
+            wakeMask |= 1UL << i;
+        }
     }
+    return delivered;
 }
 
 } // namespace Core
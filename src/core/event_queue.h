@@ -2,8 +2,10 @@
 #define BITS_CORE_EVENT_QUEUE_H
 
 #include <FreeRTOS.h>
-#include <queue.h>
+#include <semphr.h>
 #include <stdint.h>
+#include <string.h>
+#include <atomic>
 
 namespace BITS {
 namespace Core {
@@ -21,22 +23,90 @@ enum class EventType {
 
 struct Event {
     EventType type;
-    uint32_t timestamp;
+    uint32_t timestamp;     // micros()
     uint8_t sourceId;
     uint8_t data[16];
+
+    template <typename T>
+    void setPayload(const T& payload) {
+        static_assert(sizeof(T) <= sizeof(data), "Event payload too large");
+        memcpy(data, &payload, sizeof(T));
+    }
+
+    template <typename T>
+    T getPayload() const {
+        static_assert(sizeof(T) <= sizeof(data), "Event payload too large");
+        T payload;
+        memcpy(&payload, data, sizeof(T));
+        return payload;
+    }
 };
 
+constexpr uint32_t eventMask(EventType type) {
+    return 1UL << static_cast<uint32_t>(type);
+}
+
+constexpr uint32_t ALL_EVENTS = 0xFFFFFFFFUL;
+
+typedef uint8_t SubscriberId;
+
+// Publish/subscribe bus. Every subscriber owns a ring buffer that receives
+// the event types in its mask; publishers never block, never take a lock and
+// may run in ISR context. A full ring drops the event for that subscriber
+// only and counts the drop. Each subscriber must be drained by one task.
 class EventQueue {
 public:
+    static constexpr uint8_t MAX_SUBSCRIBERS = 8;
+    static constexpr uint32_t RING_SIZE = 32;   // Power of two
+    static constexpr SubscriberId INVALID_SUBSCRIBER = 0xFF;
+
     static void init();
+
+    // Call from task context (typically during init)
+    static SubscriberId addSubscriber(uint32_t typeMask);
+    static void removeSubscriber(SubscriberId id);
+    static void setSubscriberMask(SubscriberId id, uint32_t typeMask);
+
+    // Returns false if any matching subscriber had to drop the event
     static bool publish(const Event& event);
-    static bool subscribe(Event& event, uint32_t timeoutMs = portMAX_DELAY);
-    static uint32_t getQueueSize();
-    static void clear();
+    static bool publishFromISR(const Event& event, BaseType_t* higherPriorityTaskWoken);
+
+    // Non-blocking receive
+    static bool poll(SubscriberId id, Event& event);
+    // Blocking receive; only the wait involves the kernel
+    static bool subscribe(SubscriberId id, Event& event, uint32_t timeoutMs = portMAX_DELAY);
+
+    static uint32_t getQueueSize(SubscriberId id);
+    static uint32_t getDropCount(SubscriberId id);
+    static uint32_t getHighWatermark(SubscriberId id);
+    static uint32_t getPublishCount();
+    static uint32_t getTotalDrops();
+    static void clear(SubscriberId id);
 
 private:
-    static QueueHandle_t queue;
-    static constexpr UBaseType_t QUEUE_SIZE = 32;
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        Event event;
+    };
+
+    struct Subscriber {
+        std::atomic<bool> active;
+        std::atomic<uint32_t> mask;
+        std::atomic<uint32_t> head;         // Next write position (publishers)
+        std::atomic<uint32_t> tail;         // Next read position (owner only)
+        std::atomic<uint32_t> drops;
+        std::atomic<uint32_t> highWatermark;
+        std::atomic<bool> waiting;
+        SemaphoreHandle_t wakeup;
+        Slot slots[RING_SIZE];
+    };
+
+    static Subscriber subscribers[MAX_SUBSCRIBERS];
+    static std::atomic<uint32_t> publishCount;
+
+    static void resetRing(Subscriber& subscriber);
+    static bool push(Subscriber& subscriber, const Event& event);
+    static bool deliver(const Event& event, uint32_t& wakeMask);
 };
 
 } // namespace Core
@@ -1,16 +1,122 @@
 #include "core/logger.h"
+#include "core/memory_budget.h"
 #include <stdarg.h>
+#include <stdio.h>
 
 namespace BITS {
 namespace Core {
 
+static_assert((Logger::RING_SIZE & (Logger::RING_SIZE - 1)) == 0,
+              "Log ring size must be a power of two");
+
+namespace {
+
+// Binary frame header: sync bytes followed by the frame type
+constexpr uint8_t FRAME_SYNC_0 = 0x00;
+constexpr uint8_t FRAME_SYNC_1 = 0xB5;
+constexpr uint8_t FRAME_DICTIONARY = 0x01;
+constexpr uint8_t FRAME_RECORD = 0x02;
+constexpr uint8_t FRAME_DROPS = 0x03;
+
+// Format IDs already sent in the current binary session
+constexpr uint32_t DICTIONARY_SIZE = 256;     // Power of two
+const char* sentFormats[DICTIONARY_SIZE];
+uint32_t reportedDrops = 0;
+
+uint32_t formatId(const char* format) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(format));
+}
+
+// Returns true the first time a format is seen; when the table is full the
+// format is simply sent again
+bool markFormatSent(const char* format) {
+    uint32_t hash = formatId(format) * 2654435761UL;
+    for (uint32_t probe = 0; probe < 8; probe++) {
+        const char*& entry = sentFormats[(hash + probe) & (DICTIONARY_SIZE - 1)];
+        if (entry == format) {
+            return false;
+        }
+        if (entry == nullptr) {
+            entry = format;
+            return true;
+        }
+    }
+    return true;
+}
+
+class FrameWriter {
+public:
+    void byte(uint8_t value) {
+        if (length < sizeof(buffer)) {
+            buffer[length++] = value;
+        }
+    }
+    
+    void u16(uint16_t value) {
+        byte(value & 0xFF);
+        byte(value >> 8);
+    }
+    
+    void u32(uint32_t value) {
+        for (uint8_t i = 0; i < 4; i++) {
+            byte((value >> (i * 8)) & 0xFF);
+        }
+    }
+    
+    void bytes(const void* data, size_t size) {
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            byte(source[i]);
+        }
+    }
+    
+    void begin(uint8_t type) {
+        length = 0;
+        byte(FRAME_SYNC_0);
+        byte(FRAME_SYNC_1);
+        byte(type);
+    }
+    
+    void send() {
+        Serial.write(buffer, length);
+    }
+
+private:
+    uint8_t buffer[320];
+    size_t length = 0;
+};
+
+LogRecord::ArgType argType(const LogRecord& record, uint8_t index) {
+    return static_cast<LogRecord::ArgType>((record.types >> (index * 4)) & 0x0F);
+}
+
+} // namespace
+
 LogLevel Logger::currentLevel = LogLevel::INFO;
+LogOutput Logger::output = LogOutput::TEXT;
+std::atomic<bool> Logger::deferred{false};
+Logger::Slot Logger::ring[RING_SIZE];
+std::atomic<uint32_t> Logger::head{0};
+uint32_t Logger::tail = 0;
+std::atomic<uint32_t> Logger::dropped{0};
 
 void Logger::init(uint32_t baudRate) {
+    // Boot doesn't wait for a serial monitor: without one, messages queue in
+    // the ring until the log task finds a monitor attached
     Serial.begin(baudRate);
-    while (!Serial && millis() < 5000) {
-        delay(10);
+    
+    for (uint32_t i = 0; i < RING_SIZE; i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail = 0;
+    dropped = 0;
+    reportedDrops = 0;
+    if (!Serial) {
+        deferred = true;
     }
+    MemoryBudget::reserve(MemorySubsystem::CORE, "log ring", sizeof(ring));
+    
     info("Logger initialized at %lu baud", baudRate);
 }
 
@@ -22,74 +128,337 @@ LogLevel Logger::getLevel() {
     return currentLevel;
 }
 
-void Logger::log(LogLevel level, const char* format, va_list args) {
-    if (level < currentLevel) {
+void Logger::setDeferred(bool enable) {
+    if (!enable) {
+        // Back to immediate mode; write out whatever is still queued
+        deferred = false;
+        flush();
         return;
     }
+    deferred = true;
+}
+
+bool Logger::isDeferred() {
+    return deferred;
+}
+
+void Logger::setOutput(LogOutput mode) {
+    flush();
+    output = mode;
+    for (uint32_t i = 0; i < DICTIONARY_SIZE; i++) {
+        sentFormats[i] = nullptr;
+    }
+}
+
+LogOutput Logger::getOutput() {
+    return output;
+}
+
+uint32_t Logger::process(uint32_t maxRecords) {
+    // Single consumer: the log task, or the caller of flush() once it is gone
+    uint32_t written = 0;
+    if (!Serial) {
+        return written;
+    }
+    while (written < maxRecords) {
+        Slot& slot = ring[tail & (RING_SIZE - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+            break;
+        }
+        emit(slot.record);
+        slot.sequence.store(tail + RING_SIZE, std::memory_order_release);
+        tail++;
+        written++;
+    }
     
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    
-    Serial.print("[");
-    Serial.print(levelToString(level));
-    Serial.print("] ");
-    Serial.print(millis());
-    Serial.print("ms: ");
-    Serial.println(buffer);
+    uint32_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        emitDrops(drops - reportedDrops);
+        reportedDrops = drops;
+    }
+    return written;
 }
 
-const char* Logger::levelToString(LogLevel level) {
-    switch (level) {
-        case LogLevel::DEBUG: return "DEBUG";
-        case LogLevel::INFO: return "INFO";
-        case LogLevel::WARNING: return "WARN";
-        case LogLevel::ERROR: return "ERROR";
-        default: return "UNKNOWN";
+void Logger::flush() {
+    while (process() > 0) {
     }
 }
 
-void Logger::debug(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::DEBUG, format, args);
-    va_end(args);
+uint32_t Logger::getDroppedCount() {
+    return dropped;
 }
 
-void Logger::info(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::INFO, format, args);
-    va_end(args);
+Logger::Slot* Logger::claim() {
+    // Same bounded multi-producer ring as the event bus, so any task or ISR
+    // can log without a lock
+    uint32_t position = head.load(std::memory_order_relaxed);
+    while (true) {
+        Slot* slot = &ring[position & (RING_SIZE - 1)];
+        int32_t diff = static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) - position);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return slot;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-void Logger::warning(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::WARNING, format, args);
-    va_end(args);
+void Logger::commit(Slot* slot) {
+    // A claimed slot's sequence still equals its ring position
+    uint32_t position = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(position + 1, std::memory_order_release);
 }
 
-void Logger::error(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::ERROR, format, args);
-    va_end(args);
+size_t Logger::formatRecord(const LogRecord& record, char* buffer, size_t size) {
+    // Walks the format and re-issues each conversion with a length modifier
+    // matching how the argument was captured (integers widened to long long,
+    // floats promoted to double)
+    if (size == 0) {
+        return 0;
+    }
+    
+    size_t length = 0;
+    uint8_t argIndex = 0;
+    uint8_t wordIndex = 0;
+    const char* p = record.format;
+    
+    auto append = [&](int count) {
+        if (count > 0) {
+            length += static_cast<size_t>(count);
+            if (length >= size) {
+                length = size - 1;
+            }
+        }
+    };
+    
+    while (*p != '\0' && length < size - 1) {
+        if (*p != '%') {
+            buffer[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            buffer[length++] = '%';
+            p += 2;
+            continue;
+        }
+        
+        // Copy flags, width and precision; drop any length modifier
+        char spec[24];
+        size_t specLength = 0;
+        spec[specLength++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && specLength < sizeof(spec) - 4) {
+            spec[specLength++] = *p++;
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) {
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+        
+        if (argIndex >= record.argc) {
+            append(snprintf(buffer + length, size - length, "<?>"));
+            continue;
+        }
+        
+        LogRecord::ArgType type = argType(record, argIndex++);
+        uint64_t raw = record.args[wordIndex++];
+        if (type == LogRecord::ARG_INT64 || type == LogRecord::ARG_UINT64) {
+            raw |= static_cast<uint64_t>(record.args[wordIndex++]) << 32;
+        }
+        
+        long long asSigned;
+        unsigned long long asUnsigned;
+        switch (type) {
+            case LogRecord::ARG_INT:
+                asSigned = static_cast<int32_t>(raw);
+                asUnsigned = static_cast<uint32_t>(raw);
+                break;
+            case LogRecord::ARG_INT64:
+                asSigned = static_cast<int64_t>(raw);
+                asUnsigned = raw;
+                break;
+            case LogRecord::ARG_UINT64:
+                asSigned = static_cast<long long>(raw);
+                asUnsigned = raw;
+                break;
+            default:
+                asSigned = static_cast<int32_t>(raw);
+                asUnsigned = static_cast<uint32_t>(raw);
+                break;
+        }
+        
+        if (type == LogRecord::ARG_UINT && (conversion == 'd' || conversion == 'i')) {
+            // Keep unsigned values unsigned when printed with %d, as a
+            // 32-bit target would for values below 2^31
+            asSigned = static_cast<long long>(asUnsigned);
+        }
+        
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                spec[specLength++] = 'l';
+                spec[specLength++] = 'l';
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                append(snprintf(buffer + length, size - length, spec, asSigned));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[specLength++] = 'l';
+                spec[specLength++] = 'l';
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                append(snprintf(buffer + length, size - length, spec, asUnsigned));
+                break;
+            case 'c':
+                spec[specLength++] = 'c';
+                spec[specLength] = '\0';
+                append(snprintf(buffer + length, size - length, spec, static_cast<int>(asSigned)));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G': {
+                double value;
+                if (type == LogRecord::ARG_FLOAT) {
+                    float f;
+                    uint32_t bits = static_cast<uint32_t>(raw);
+                    memcpy(&f, &bits, sizeof(f));
+                    value = f;
+                } else {
+                    value = static_cast<double>(asSigned);
+                }
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                append(snprintf(buffer + length, size - length, spec, value));
+                break;
+            }
+            case 's': {
+                const char* text = "";
+                if (type == LogRecord::ARG_STRING && raw < LogRecord::TEXT_SIZE) {
+                    text = record.text + raw;
+                }
+                spec[specLength++] = 's';
+                spec[specLength] = '\0';
+                append(snprintf(buffer + length, size - length, spec, text));
+                break;
+            }
+            case 'p':
+                append(snprintf(buffer + length, size - length, "0x%llx", asUnsigned));
+                break;
+            default:
+                append(snprintf(buffer + length, size - length, "<%c?>", conversion));
+                break;
+        }
+    }
+    
+    buffer[length] = '\0';
+    return length;
 }
 
-void Logger::debug(const String& message) {
-    debug(message.c_str());
+void Logger::emit(const LogRecord& record) {
+    if (output == LogOutput::TEXT) {
+        char line[256];
+        int prefix = snprintf(line, sizeof(line), "[%s] %lums: ",
+                              levelToString(static_cast<LogLevel>(record.level)),
+                              static_cast<unsigned long>(record.timestamp));
+        size_t length = static_cast<size_t>(prefix);
+        length += formatRecord(record, line + length, sizeof(line) - length - 2);
+        line[length++] = '\r';
+        line[length++] = '\n';
+        Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+        return;
+    }
+    
+    FrameWriter frame;
+    uint32_t id = formatId(record.format);
+    if (markFormatSent(record.format)) {
+        size_t formatLength = strnlen(record.format, 255);
+        frame.begin(FRAME_DICTIONARY);
+        frame.u32(id);
+        frame.u16(static_cast<uint16_t>(formatLength));
+        frame.bytes(record.format, formatLength);
+        frame.send();
+    }
+    
+    frame.begin(FRAME_RECORD);
+    frame.u32(id);
+    frame.u32(record.timestamp);
+    frame.byte(record.level);
+    frame.byte(record.argc);
+    frame.u32(record.types);
+    uint8_t wordIndex = 0;
+    for (uint8_t i = 0; i < record.argc; i++) {
+        LogRecord::ArgType type = argType(record, i);
+        uint32_t word = record.args[wordIndex++];
+        if (type == LogRecord::ARG_STRING) {
+            const char* text = word < LogRecord::TEXT_SIZE ? record.text + word : "";
+            size_t textLength = strnlen(text, LogRecord::TEXT_SIZE);
+            frame.byte(static_cast<uint8_t>(textLength));
+            frame.bytes(text, textLength);
+            continue;
+        }
+        frame.u32(word);
+        if (type == LogRecord::ARG_INT64 || type == LogRecord::ARG_UINT64) {
+            frame.u32(record.args[wordIndex++]);
+        }
+    }
+    frame.send();
 }
 
-void Logger::info(const String& message) {
-    info(message.c_str());
+void Logger::writeText(LogLevel level, const char* format, ...) {
+    char line[256];
+    int prefix = snprintf(line, sizeof(line), "[%s] %lums: ", levelToString(level),
+                          static_cast<unsigned long>(millis()));
+    size_t length = static_cast<size_t>(prefix);
+    size_t space = sizeof(line) - length - 2;   // Leaves room for CRLF
+    va_list args;
+    va_start(args, format);
+    int message = vsnprintf(line + length, space, format, args);
+    va_end(args);
+    if (message > 0) {
+        length += static_cast<size_t>(message) < space ? static_cast<size_t>(message) : space - 1;
+    }
+    line[length++] = '\r';
+    line[length++] = '\n';
+    Serial.write(reinterpret_cast<const uint8_t*>(line), length);
 }
 
-void Logger::warning(const String& message) {
-    warning(message.c_str());
+void Logger::emitDrops(uint32_t count) {
+    if (output == LogOutput::TEXT) {
+        char line[64];
+        int length = snprintf(line, sizeof(line), "[WARN] %lums: %lu log messages dropped\r\n",
+                              static_cast<unsigned long>(millis()), static_cast<unsigned long>(count));
+        Serial.write(reinterpret_cast<const uint8_t*>(line), static_cast<size_t>(length));
+        return;
+    }
+    
+    FrameWriter frame;
+    frame.begin(FRAME_DROPS);
+    frame.u32(count);
+    frame.send();
 }
 
-void Logger::error(const String& message) {
-    error(message.c_str());
+const char* Logger::levelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
 }
 
 } // namespace Core
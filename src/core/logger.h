@@ -2,6 +2,11 @@
 #define BITS_CORE_LOGGER_H
 
 #include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+#include "config.h"
 
 namespace BITS {
 namespace Core {
@@ -14,26 +19,225 @@ enum class LogLevel {
     NONE = 4
 };
 
+enum class LogOutput {
+    TEXT = 0,       // Formatted lines, readable in a serial monitor
+    BINARY = 1      // Compact frames, decoded on the host by tools/log_decoder.py
+};
+
+// A log call captured for deferred formatting. The format string pointer is
+// the message ID, so formats must be string literals.
+struct LogRecord {
+    static constexpr uint8_t MAX_ARGS = 8;
+    static constexpr uint8_t TEXT_SIZE = 128;
+    
+    enum ArgType : uint8_t {
+        ARG_INT = 0,
+        ARG_UINT = 1,
+        ARG_INT64 = 2,      // Two words, low first
+        ARG_UINT64 = 3,
+        ARG_FLOAT = 4,
+        ARG_STRING = 5,     // Word holds the offset into text
+        ARG_POINTER = 6
+    };
+    
+    const char* format;
+    uint32_t timestamp;     // millis()
+    uint8_t level;
+    uint8_t argc;
+    uint8_t words;
+    uint8_t textUsed;
+    uint32_t types;         // 4 bits per argument
+    uint32_t args[MAX_ARGS];
+    char text[TEXT_SIZE];
+};
+
+// Logging is deferred once the drain task runs (setDeferred(true)): callers
+// only copy the format ID and raw arguments into a lock-free ring, and the
+// drain task formats and writes them. Before that, text messages are
+// formatted and written immediately, or queued if no serial monitor is
+// attached yet; queued records are held until one is. Levels below
+// BITS_LOG_LEVEL compile to nothing.
 class Logger {
 public:
+    static constexpr uint32_t RING_SIZE = 64;   // Power of two
+    
     static void init(uint32_t baudRate = 115200);
     static void setLevel(LogLevel level);
     static LogLevel getLevel();
     
-    static void debug(const char* format, ...);
-    static void info(const char* format, ...);
-    static void warning(const char* format, ...);
-    static void error(const char* format, ...);
+    static void setDeferred(bool deferred);
+    static bool isDeferred();
+    static void setOutput(LogOutput output);
+    static LogOutput getOutput();
+    
+    // Formats and writes pending records; returns the number written
+    static uint32_t process(uint32_t maxRecords = RING_SIZE);
+    static void flush();
+    static uint32_t getDroppedCount();
+    
+    template <typename... Args>
+    static void debug(const char* format, Args... args) {
+        write<LogLevel::DEBUG>(format, args...);
+    }
+    
+    template <typename... Args>
+    static void info(const char* format, Args... args) {
+        write<LogLevel::INFO>(format, args...);
+    }
+    
+    template <typename... Args>
+    static void warning(const char* format, Args... args) {
+        write<LogLevel::WARNING>(format, args...);
+    }
     
-    static void debug(const String& message);
-    static void info(const String& message);
-    static void warning(const String& message);
-    static void error(const String& message);
+    template <typename... Args>
+    static void error(const char* format, Args... args) {
+        write<LogLevel::ERROR>(format, args...);
+    }
+    
+    static void debug(const String& message) { debug("%s", message.c_str()); }
+    static void info(const String& message) { info("%s", message.c_str()); }
+    static void warning(const String& message) { warning("%s", message.c_str()); }
+    static void error(const String& message) { error("%s", message.c_str()); }
+    
+    // Formats a captured record as text (message only, no prefix)
+    static size_t formatRecord(const LogRecord& record, char* buffer, size_t size);
 
 private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+    
     static LogLevel currentLevel;
-    static void log(LogLevel level, const char* format, va_list args);
+    static LogOutput output;
+    static std::atomic<bool> deferred;
+    static Slot ring[RING_SIZE];
+    static std::atomic<uint32_t> head;
+    static uint32_t tail;
+    static std::atomic<uint32_t> dropped;
+    
+    static Slot* claim();
+    static void commit(Slot* slot);
+    static void emit(const LogRecord& record);
+    static void writeText(LogLevel level, const char* format, ...);
+    static void emitDrops(uint32_t count);
     static const char* levelToString(LogLevel level);
+    
+    template <LogLevel Level, typename... Args>
+    static void write(const char* format, Args... args) {
+        if constexpr (static_cast<int>(Level) >= BITS_LOG_LEVEL) {
+            if (Level < currentLevel) {
+                return;
+            }
+            static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+            
+            if (!deferred.load(std::memory_order_relaxed)) {
+                // Text goes straight from the arguments, strings in full
+                if (output == LogOutput::TEXT) {
+                    writeText(Level, format, vararg(args)...);
+                    return;
+                }
+                LogRecord record;
+                begin(record, Level, format);
+                (capture(record, args), ...);
+                emit(record);
+                return;
+            }
+            
+            Slot* slot = claim();
+            if (slot == nullptr) {
+                return;
+            }
+            begin(slot->record, Level, format);
+            (capture(slot->record, args), ...);
+            commit(slot);
+        }
+    }
+    
+    static void begin(LogRecord& record, LogLevel level, const char* format) {
+        record.format = format;
+        record.timestamp = millis();
+        record.level = static_cast<uint8_t>(level);
+        record.argc = 0;
+        record.words = 0;
+        record.textUsed = 0;
+        record.types = 0;
+    }
+    
+    // Integers are passed at least as wide as long, so %d and %lu both read
+    // them right where long is 64 bits (the host build)
+    template <typename T>
+    static auto vararg(T value) {
+        if constexpr (std::is_enum<T>::value) {
+            return static_cast<long>(value);
+        } else if constexpr (std::is_integral<T>::value && sizeof(T) < sizeof(long)) {
+            using Wide = typename std::conditional<std::is_signed<T>::value, long, unsigned long>::type;
+            return static_cast<Wide>(value);
+        } else {
+            return value;
+        }
+    }
+    
+    static void addWord(LogRecord& record, LogRecord::ArgType type, uint32_t value) {
+        if (record.words >= LogRecord::MAX_ARGS) {
+            return;
+        }
+        record.types |= static_cast<uint32_t>(type) << (record.argc * 4);
+        record.args[record.words++] = value;
+        record.argc++;
+    }
+    
+    template <typename T>
+    static void capture(LogRecord& record, T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            float f = static_cast<float>(value);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            addWord(record, LogRecord::ARG_FLOAT, bits);
+        } else if constexpr (std::is_enum<T>::value) {
+            addWord(record, LogRecord::ARG_INT, static_cast<uint32_t>(value));
+        } else if constexpr (std::is_integral<T>::value && sizeof(T) > 4) {
+            if (record.words + 2 > LogRecord::MAX_ARGS) {
+                return;
+            }
+            uint64_t wide = static_cast<uint64_t>(value);
+            addWord(record, std::is_signed<T>::value ? LogRecord::ARG_INT64 : LogRecord::ARG_UINT64,
+                    static_cast<uint32_t>(wide));
+            record.args[record.words++] = static_cast<uint32_t>(wide >> 32);
+        } else if constexpr (std::is_integral<T>::value) {
+            addWord(record, std::is_signed<T>::value ? LogRecord::ARG_INT : LogRecord::ARG_UINT,
+                    static_cast<uint32_t>(value));
+        } else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+            captureString(record, value);
+        } else if constexpr (std::is_pointer<T>::value) {
+            addWord(record, LogRecord::ARG_POINTER,
+                    static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value)));
+        } else {
+            static_assert(std::is_pointer<T>::value, "Unsupported log argument type");
+        }
+    }
+    
+    static void captureString(LogRecord& record, const char* value) {
+        // Strings are copied since the caller's buffer may be gone by the
+        // time the record is formatted; one cut short to the space left
+        // ends in "..."
+        uint8_t offset = record.textUsed;
+        size_t space = LogRecord::TEXT_SIZE - offset;
+        if (space > 0) {
+            size_t length = 0;
+            while (value != nullptr && length < space - 1 && value[length] != '\0') {
+                record.text[offset + length] = value[length];
+                length++;
+            }
+            if (value != nullptr && value[length] != '\0' && length >= 3) {
+                memcpy(&record.text[offset + length - 3], "...", 3);
+            }
+            record.text[offset + length] = '\0';
+            record.textUsed = static_cast<uint8_t>(offset + length + 1);
+        }
+        addWord(record, LogRecord::ARG_STRING, space > 0 ? offset : LogRecord::TEXT_SIZE);
+    }
 };
 
 } // namespace Core
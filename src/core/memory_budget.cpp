@@ -0,0 +1,178 @@
+#include "core/memory_budget.h"
+#include "core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace BITS {
+namespace Core {
+
+namespace {
+
+const char* const SUBSYSTEM_NAMES[] = {"core", "rtos", "sensors", "audio", "ai", "network"};
+
+const size_t SUBSYSTEM_BUDGETS_KB[] = {
+    MEMORY_BUDGET_CORE_KB,
+    MEMORY_BUDGET_RTOS_KB,
+    MEMORY_BUDGET_SENSORS_KB,
+    MEMORY_BUDGET_AUDIO_KB,
+    MEMORY_BUDGET_AI_KB,
+    MEMORY_BUDGET_NETWORK_KB,
+};
+
+static_assert(sizeof(SUBSYSTEM_NAMES) / sizeof(SUBSYSTEM_NAMES[0]) ==
+              static_cast<size_t>(MemorySubsystem::COUNT), "Subsystem name missing");
+static_assert(sizeof(SUBSYSTEM_BUDGETS_KB) / sizeof(SUBSYSTEM_BUDGETS_KB[0]) ==
+              static_cast<size_t>(MemorySubsystem::COUNT), "Subsystem budget missing");
+
+void haltOnViolation(size_t) {
+    // Get the error out before stopping; the watchdog resets the board
+    Logger::flush();
+    abort();
+}
+
+} // namespace
+
+MemoryReservation MemoryBudget::reservations[MAX_RESERVATIONS];
+uint8_t MemoryBudget::reservationCount = 0;
+volatile bool MemoryBudget::heapLocked = false;
+volatile uint32_t MemoryBudget::violations = 0;
+void (*MemoryBudget::violationHandler)(size_t bytes) = haltOnViolation;
+
+void MemoryBudget::reserve(MemorySubsystem subsystem, const char* name, size_t bytes) {
+    for (uint8_t i = 0; i < reservationCount; i++) {
+        if (reservations[i].subsystem == subsystem && strcmp(reservations[i].name, name) == 0) {
+            reservations[i].bytes = bytes;
+            return;
+        }
+    }
+    if (reservationCount >= MAX_RESERVATIONS) {
+        Logger::warning("Memory budget: no slot for %s", name);
+        return;
+    }
+    reservations[reservationCount++] = {subsystem, name, bytes};
+}
+
+size_t MemoryBudget::getReserved(MemorySubsystem subsystem) {
+    size_t total = 0;
+    for (uint8_t i = 0; i < reservationCount; i++) {
+        if (reservations[i].subsystem == subsystem) {
+            total += reservations[i].bytes;
+        }
+    }
+    return total;
+}
+
+size_t MemoryBudget::getBudget(MemorySubsystem subsystem) {
+    if (subsystem >= MemorySubsystem::COUNT) {
+        return 0;
+    }
+    return SUBSYSTEM_BUDGETS_KB[static_cast<uint8_t>(subsystem)] * 1024;
+}
+
+size_t MemoryBudget::getTotalReserved() {
+    size_t total = 0;
+    for (uint8_t i = 0; i < reservationCount; i++) {
+        total += reservations[i].bytes;
+    }
+    return total;
+}
+
+uint8_t MemoryBudget::getReservationCount() {
+    return reservationCount;
+}
+
+const MemoryReservation& MemoryBudget::getReservation(uint8_t index) {
+    return reservations[index < reservationCount ? index : 0];
+}
+
+const char* MemoryBudget::getSubsystemName(MemorySubsystem subsystem) {
+    if (subsystem >= MemorySubsystem::COUNT) {
+        return "unknown";
+    }
+    return SUBSYSTEM_NAMES[static_cast<uint8_t>(subsystem)];
+}
+
+void MemoryBudget::printReport() {
+    Logger::info("=== Memory Budget ===");
+    for (uint8_t s = 0; s < static_cast<uint8_t>(MemorySubsystem::COUNT); s++) {
+        MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+        size_t reserved = getReserved(subsystem);
+        size_t budget = getBudget(subsystem);
+        Logger::info("%-8s %7lu / %7lu bytes", getSubsystemName(subsystem),
+                     static_cast<unsigned long>(reserved), static_cast<unsigned long>(budget));
+        for (uint8_t i = 0; i < reservationCount; i++) {
+            if (reservations[i].subsystem == subsystem) {
+                Logger::info("  %-22s %7lu", reservations[i].name,
+                             static_cast<unsigned long>(reservations[i].bytes));
+            }
+        }
+        if (reserved > budget) {
+            Logger::warning("Memory budget exceeded: %s", getSubsystemName(subsystem));
+        }
+    }
+    Logger::info("Static total %lu bytes, heap %s", static_cast<unsigned long>(getTotalReserved()),
+                 heapLocked ? "locked" : "open");
+}
+
+void MemoryBudget::lockHeap() {
+    heapLocked = true;
+    Logger::info("Heap locked, further allocations are fatal");
+}
+
+bool MemoryBudget::isHeapLocked() {
+    return heapLocked;
+}
+
+void MemoryBudget::onHeapAllocation(size_t bytes) {
+    if (!heapLocked) {
+        return;
+    }
+    violations = violations + 1;
+    Logger::error("Heap allocation of %lu bytes after init", static_cast<unsigned long>(bytes));
+    violationHandler(bytes);
+}
+
+uint32_t MemoryBudget::getViolationCount() {
+    return violations;
+}
+
+void MemoryBudget::setViolationHandler(void (*handler)(size_t bytes)) {
+    violationHandler = handler != nullptr ? handler : haltOnViolation;
+}
+
+} // namespace Core
+} // namespace BITS
+
+extern "C" void vApplicationHeapAllocHook(size_t xWantedSize) {
+    BITS::Core::MemoryBudget::onHeapAllocation(xWantedSize);
+}
+
+#if BITS_STATIC_ALLOCATION && !defined(BITS_HOST_BUILD)
+// Route C++ allocations through the guard. The host keeps the standard
+// operators: its shim and test harness allocate freely.
+void* operator new(size_t size) {
+    BITS::Core::MemoryBudget::onHeapAllocation(size);
+    return malloc(size);
+}
+
+void* operator new[](size_t size) {
+    BITS::Core::MemoryBudget::onHeapAllocation(size);
+    return malloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+#endif
@@ -0,0 +1,68 @@
+#ifndef BITS_CORE_MEMORY_BUDGET_H
+#define BITS_CORE_MEMORY_BUDGET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+namespace BITS {
+namespace Core {
+
+enum class MemorySubsystem : uint8_t {
+    CORE = 0,
+    RTOS,
+    SENSORS,
+    AUDIO,
+    AI,
+    NETWORK,
+    COUNT
+};
+
+struct MemoryReservation {
+    MemorySubsystem subsystem;
+    const char* name;           // String literal
+    size_t bytes;
+};
+
+// Accounts for the statically sized memory of each subsystem and guards the
+// heap. Modules reserve their pools and tables from init(); the report
+// compares the totals against the MEMORY_BUDGET_* limits in config.h.
+//
+// Once locked, every heap allocation is a fatal error: C++ new on target
+// (replaced in memory_budget.cpp) and the FreeRTOS heap through
+// vApplicationHeapAllocHook(), which the target's FreeRTOSConfig.h wires up
+// with #define traceMALLOC(pv, size) vApplicationHeapAllocHook(size).
+class MemoryBudget {
+public:
+    static constexpr uint8_t MAX_RESERVATIONS = 32;
+
+    // Records (or updates) a named reservation; safe to call on re-init
+    static void reserve(MemorySubsystem subsystem, const char* name, size_t bytes);
+    static size_t getReserved(MemorySubsystem subsystem);
+    static size_t getBudget(MemorySubsystem subsystem);
+    static size_t getTotalReserved();
+    static uint8_t getReservationCount();
+    static const MemoryReservation& getReservation(uint8_t index);
+    static const char* getSubsystemName(MemorySubsystem subsystem);
+    // Logs reservations per subsystem; warns about subsystems over budget
+    static void printReport();
+
+    static void lockHeap();
+    static bool isHeapLocked();
+    static void onHeapAllocation(size_t bytes);
+    static uint32_t getViolationCount();
+    // Replaces the default fatal handler (nullptr restores it); for tests
+    static void setViolationHandler(void (*handler)(size_t bytes));
+
+private:
+    static MemoryReservation reservations[MAX_RESERVATIONS];
+    static uint8_t reservationCount;
+    static volatile bool heapLocked;
+    static volatile uint32_t violations;
+    static void (*violationHandler)(size_t bytes);
+};
+
+} // namespace Core
+} // namespace BITS
+
+#endif // BITS_CORE_MEMORY_BUDGET_H
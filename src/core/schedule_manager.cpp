@@ -0,0 +1,225 @@
+#include "core/schedule_manager.h"
+#include "core/config_manager.h"
+#include "core/logger.h"
+#include "rtos/tasks.h"
+#include "config.h"
+#include <math.h>
+
+namespace BITS {
+namespace Core {
+
+namespace {
+
+constexpr uint8_t TASK_COUNT = static_cast<uint8_t>(TaskId::COUNT);
+constexpr uint32_t TICK_US = 1000000 / configTICK_RATE_HZ;
+// Check-in windows (two periods plus grace) must stay inside CYCCNT range
+constexpr uint32_t MAX_PERIOD_US = 3000000;
+
+const char* const TASK_NAMES[TASK_COUNT] = {"sensor", "audio", "ai", "network", "system"};
+
+constexpr uint8_t priorityOf(RTOS::TaskPriority priority) {
+    return static_cast<uint8_t>(priority);
+}
+
+// Rate-monotonic: the shorter the period, the higher the priority
+constexpr Schedule DEFAULT_SCHEDULE = {{
+    {RTOS::TASK_PERIOD_SENSOR_US, priorityOf(RTOS::TaskPriority::CRITICAL), true},
+    {RTOS::TASK_PERIOD_AUDIO_US, priorityOf(RTOS::TaskPriority::REALTIME), true},
+    {RTOS::TASK_PERIOD_AI_US, priorityOf(RTOS::TaskPriority::MEDIUM), false},
+    {RTOS::TASK_PERIOD_NETWORK_US, priorityOf(RTOS::TaskPriority::BACKGROUND), false},
+    {RTOS::TASK_PERIOD_SYSTEM_US, priorityOf(RTOS::TaskPriority::BACKGROUND), false},
+}};
+
+} // namespace
+
+Schedule ScheduleManager::active = DEFAULT_SCHEDULE;
+volatile uint32_t ScheduleManager::generation = 0;
+
+void ScheduleManager::init() {
+    // Stored values override the defaults; 0 means not set
+    Schedule schedule = DEFAULT_SCHEDULE;
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        uint32_t periodUs = ConfigManager::getTaskPeriodUs(i);
+        uint8_t priority = ConfigManager::getTaskPriority(i);
+        if (periodUs != 0) {
+            schedule.tasks[i].periodUs = periodUs;
+        }
+        if (priority != 0) {
+            schedule.tasks[i].priority = priority;
+        }
+    }
+    
+    // No WCETs are known before the tasks have run, so only limits are checked
+    if (!validate(schedule)) {
+        Logger::warning("Stored task schedule invalid, using defaults");
+        schedule = DEFAULT_SCHEDULE;
+    }
+    taskENTER_CRITICAL();
+    active = schedule;
+    generation++;
+    taskEXIT_CRITICAL();
+    Logger::info("Schedule manager initialized, sensor period %lu us", active.tasks[0].periodUs);
+}
+
+const Schedule& ScheduleManager::getSchedule() {
+    return active;
+}
+
+TaskSchedule ScheduleManager::getTaskSchedule(TaskId id) {
+    taskENTER_CRITICAL();
+    TaskSchedule schedule = active.tasks[static_cast<uint8_t>(id)];
+    taskEXIT_CRITICAL();
+    return schedule;
+}
+
+uint32_t ScheduleManager::getGeneration() {
+    return generation;
+}
+
+bool ScheduleManager::validate(const Schedule& schedule) {
+    bool valid = true;
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        const TaskSchedule& task = schedule.tasks[i];
+        if (task.periodUs < SCHED_MIN_PERIOD_US || task.periodUs > MAX_PERIOD_US) {
+            Logger::warning("Task %s period %lu us out of range", TASK_NAMES[i], task.periodUs);
+            valid = false;
+        } else if (i != static_cast<uint8_t>(TaskId::SENSOR) && task.periodUs % TICK_US != 0) {
+            // Only the sensor task has a sample timer
+            Logger::warning("Task %s period %lu us is not a whole number of ticks", TASK_NAMES[i],
+                           task.periodUs);
+            valid = false;
+        }
+        if (task.priority == 0 || task.priority >= configMAX_PRIORITIES) {
+            Logger::warning("Task %s priority %u out of range", TASK_NAMES[i], task.priority);
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+bool ScheduleManager::analyze(const Schedule& schedule, ScheduleAnalysis& analysis) {
+    uint32_t wcetUs[TASK_COUNT];
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        wcetUs[i] = getWCETUs(static_cast<TaskId>(i));
+    }
+    return analyze(schedule, wcetUs, analysis);
+}
+
+bool ScheduleManager::analyze(const Schedule& schedule, const uint32_t* wcetUs, ScheduleAnalysis& analysis) {
+    analysis.schedulable = false;
+    analysis.failedTask = TaskId::COUNT;
+    analysis.utilization = 0.0f;
+    analysis.rmBound = TASK_COUNT * (powf(2.0f, 1.0f / TASK_COUNT) - 1.0f);
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        analysis.wcetUs[i] = wcetUs[i] * (100 + SCHED_WCET_MARGIN_PERCENT) / 100;
+        analysis.responseUs[i] = UINT32_MAX;
+    }
+    if (!validate(schedule)) {
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        analysis.utilization += static_cast<float>(analysis.wcetUs[i]) / schedule.tasks[i].periodUs;
+    }
+    
+    // Worst-case response time: the fixed point of
+    // R = C_i + sum over tasks j at equal or higher priority of ceil(R / T_j) * C_j
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        const TaskSchedule& task = schedule.tasks[i];
+        uint64_t response = analysis.wcetUs[i];
+        while (true) {
+            uint64_t next = analysis.wcetUs[i];
+            for (uint8_t j = 0; j < TASK_COUNT; j++) {
+                const TaskSchedule& other = schedule.tasks[j];
+                if (j == i || other.priority < task.priority) {
+                    continue;
+                }
+                next += (response + other.periodUs - 1) / other.periodUs * analysis.wcetUs[j];
+            }
+            if (next > task.periodUs) {
+                response = next;
+                break;
+            }
+            if (next == response) {
+                break;
+            }
+            response = next;
+        }
+        if (response <= task.periodUs) {
+            analysis.responseUs[i] = static_cast<uint32_t>(response);
+        } else if (task.critical && analysis.failedTask == TaskId::COUNT) {
+            analysis.failedTask = static_cast<TaskId>(i);
+        }
+    }
+    analysis.schedulable = analysis.failedTask == TaskId::COUNT;
+    return analysis.schedulable;
+}
+
+bool ScheduleManager::apply(const Schedule& schedule, ScheduleAnalysis* analysis) {
+    ScheduleAnalysis result;
+    bool accepted = analyze(schedule, result);
+    if (analysis != nullptr) {
+        *analysis = result;
+    }
+    if (!accepted) {
+        if (result.failedTask != TaskId::COUNT) {
+            uint8_t failed = static_cast<uint8_t>(result.failedTask);
+            Logger::warning("Schedule rejected: %s task would miss its %lu us deadline",
+                           TASK_NAMES[failed], schedule.tasks[failed].periodUs);
+        } else {
+            Logger::warning("Schedule rejected: invalid periods or priorities");
+        }
+        return false;
+    }
+    
+    taskENTER_CRITICAL();
+    active = schedule;
+    generation++;
+    taskEXIT_CRITICAL();
+    
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        ConfigManager::setTaskPeriodUs(i, schedule.tasks[i].periodUs);
+        ConfigManager::setTaskPriority(i, schedule.tasks[i].priority);
+        if (result.responseUs[i] == UINT32_MAX) {
+            Logger::warning("Task %s may miss its deadline under this schedule", TASK_NAMES[i]);
+        }
+    }
+    Logger::info("Schedule applied, sensor period %lu us, utilization %.1f%%",
+                schedule.tasks[0].periodUs, result.utilization * 100.0f);
+    return true;
+}
+
+bool ScheduleManager::setTaskPeriod(TaskId id, uint32_t periodUs, ScheduleAnalysis* analysis) {
+    Schedule schedule = active;
+    schedule.tasks[static_cast<uint8_t>(id)].periodUs = periodUs;
+    return apply(schedule, analysis);
+}
+
+uint32_t ScheduleManager::getWCETUs(TaskId id) {
+    return TaskManager::getTaskTiming(id).execution.maxUs;
+}
+
+void ScheduleManager::printReport() {
+    ScheduleAnalysis analysis;
+    analyze(active, analysis);
+    
+    Logger::info("=== Task Schedule ===");
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        const TaskSchedule& task = active.tasks[i];
+        if (analysis.responseUs[i] == UINT32_MAX) {
+            Logger::info("%s: period %lu us, priority %u, WCET %lu us, response unbounded%s",
+                        TASK_NAMES[i], task.periodUs, task.priority, analysis.wcetUs[i],
+                        task.critical ? " (critical)" : "");
+        } else {
+            Logger::info("%s: period %lu us, priority %u, WCET %lu us, response %lu us%s",
+                        TASK_NAMES[i], task.periodUs, task.priority, analysis.wcetUs[i],
+                        analysis.responseUs[i], task.critical ? " (critical)" : "");
+        }
+    }
+    Logger::info("Utilization %.1f%% (rate-monotonic bound %.1f%%), %s",
+                analysis.utilization * 100.0f, analysis.rmBound * 100.0f,
+                analysis.schedulable ? "schedulable" : "NOT schedulable");
+}
+
+} // namespace Core
+} // namespace BITS
@@ -0,0 +1,73 @@
+#ifndef BITS_CORE_SCHEDULE_MANAGER_H
+#define BITS_CORE_SCHEDULE_MANAGER_H
+
+#include <stdint.h>
+#include "core/task_manager.h"
+
+namespace BITS {
+namespace Core {
+
+// Deadlines equal the periods. An event-driven task is analysed as if it
+// woke at most once per period.
+struct TaskSchedule {
+    uint32_t periodUs;
+    uint8_t priority;
+    bool critical;      // Watched by the watchdog; must pass the admission check
+};
+
+struct Schedule {
+    TaskSchedule tasks[static_cast<uint8_t>(TaskId::COUNT)];
+};
+
+// Fixed-priority response-time analysis of a schedule
+struct ScheduleAnalysis {
+    bool schedulable;
+    TaskId failedTask;      // First critical task past its deadline, COUNT if none
+    uint32_t wcetUs[static_cast<uint8_t>(TaskId::COUNT)];
+    uint32_t responseUs[static_cast<uint8_t>(TaskId::COUNT)];   // UINT32_MAX if unbounded
+    float utilization;      // Sum of WCET / period
+    float rmBound;          // Liu & Layland utilization bound for the task count
+};
+
+// Task periods and priorities, loaded from ConfigManager at boot and
+// changeable at runtime. A new schedule is only applied if it passes the
+// admission check: a response-time analysis using each task's measured
+// WCET plus SCHED_WCET_MARGIN_PERCENT. Tasks at equal priority are assumed
+// to delay each other.
+class ScheduleManager {
+public:
+    static void init();
+
+    static const Schedule& getSchedule();
+    // Consistent copy of one task's entry, safe while a schedule is applied
+    static TaskSchedule getTaskSchedule(TaskId id);
+    // Changes whenever a schedule is applied; tasks pick it up at their
+    // next activation
+    static uint32_t getGeneration();
+
+    // Checks limits and runs the analysis; false if the schedule is invalid
+    // or a critical task would miss its deadline
+    static bool analyze(const Schedule& schedule, ScheduleAnalysis& analysis);
+    // Same with given WCETs (us, per TaskId) instead of the measured ones
+    static bool analyze(const Schedule& schedule, const uint32_t* wcetUs, ScheduleAnalysis& analysis);
+    // Applies the schedule and stores it in ConfigManager (persisted by its
+    // next save()) if analyze() accepts it
+    static bool apply(const Schedule& schedule, ScheduleAnalysis* analysis = nullptr);
+    static bool setTaskPeriod(TaskId id, uint32_t periodUs, ScheduleAnalysis* analysis = nullptr);
+
+    // Longest activation since the last TaskManager::resetTaskTimings(), in
+    // run time: preemption is interference the analysis adds on its own
+    static uint32_t getWCETUs(TaskId id);
+    static void printReport();
+
+private:
+    static Schedule active;
+    static volatile uint32_t generation;
+
+    static bool validate(const Schedule& schedule);
+};
+
+} // namespace Core
+} // namespace BITS
+
+#endif // BITS_CORE_SCHEDULE_MANAGER_H
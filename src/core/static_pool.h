@@ -0,0 +1,43 @@
+#ifndef BITS_CORE_STATIC_POOL_H
+#define BITS_CORE_STATIC_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+namespace BITS {
+namespace Core {
+
+// Fixed storage for up to N objects that are constructed in place when
+// needed rather than at static initialization, e.g. to take constructor
+// arguments or to keep the audio graph in creation order. Objects stay
+// alive for the life of the program; there is no per-object release.
+template <typename T, size_t N>
+class StaticPool {
+public:
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (used >= N) {
+            return nullptr;
+        }
+        return new (&slots[used++]) T(std::forward<Args>(args)...);
+    }
+
+    size_t size() const { return used; }
+    static constexpr size_t capacity() { return N; }
+    static constexpr size_t bytes() { return sizeof(Slot) * N; }
+
+private:
+    struct alignas(T) Slot {
+        uint8_t data[sizeof(T)];
+    };
+
+    Slot slots[N];
+    size_t used = 0;
+};
+
+} // namespace Core
+} // namespace BITS
+
+#endif // BITS_CORE_STATIC_POOL_H
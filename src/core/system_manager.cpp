@@ -4,16 +4,106 @@
 #include "core/config_manager.h"
 #include "core/event_queue.h"
 #include "core/task_manager.h"
+#include "core/schedule_manager.h"
+#include "core/memory_budget.h"
+#include "rtos/static_objects.h"
 #include "rtos/tasks.h"
 #include "rtos/queues.h"
 #include "rtos/semaphores.h"
 #include "rtos/timers.h"
+#include "sensors/sensor_manager.h"
+#include "sensors/adc_engine.h"
+#include "audio/audio_manager.h"
+#include "ai/ai_engine.h"
+#include "network/wifi_manager.h"
 
 namespace BITS {
 namespace Core {
 
+namespace {
+
+constexpr uint32_t stageBit(BootStage stage) {
+    return 1UL << static_cast<uint8_t>(stage);
+}
+
+struct StageDefinition {
+    BootStage stage;
+    const char* name;
+    void (*init)();
+    uint32_t dependencies;      // stageBit() of each stage that must be done first
+    bool background;
+};
+
+void initLogger() {
+    Logger::init();
+    Logger::info("=== B.I.T.E.S System Initialization ===");
+}
+
+void initWatchdog() {
+    Watchdog::init();
+}
+
+void initTaskManager() {
+    TaskManager::init();
+    ScheduleManager::init();
+}
+
+void initSensors() {
+    Sensors::SensorManager::init();
+    // Analog channels are scanned from here on, ahead of the sensor task
+    Sensors::AdcEngine::start();
+}
+
+void initRTOSObjects() {
+    RTOS::createQueues();
+    RTOS::createSemaphores();
+    RTOS::createTimers();
+}
+
+// Everything up to TASKS is on the path to the first note. Background
+// stages may block for a long time (WiFi association waits up to 30 s) and
+// only run once the instrument plays.
+constexpr StageDefinition STAGES[] = {
+    {BootStage::LOGGER, "logger", initLogger, 0, false},
+    {BootStage::CONFIG, "config", ConfigManager::init, stageBit(BootStage::LOGGER), false},
+    {BootStage::WATCHDOG, "watchdog", initWatchdog, stageBit(BootStage::CONFIG), false},
+    {BootStage::RTOS_OBJECTS, "rtos objects", initRTOSObjects, stageBit(BootStage::LOGGER), false},
+    {BootStage::TASK_MANAGER, "task manager", initTaskManager,
+     stageBit(BootStage::CONFIG) | stageBit(BootStage::RTOS_OBJECTS), false},
+    {BootStage::EVENT_BUS, "event bus", EventQueue::init, stageBit(BootStage::RTOS_OBJECTS), false},
+    // Sensors take their calibration profiles from the config store
+    {BootStage::SENSORS, "sensors", initSensors,
+     stageBit(BootStage::CONFIG) | stageBit(BootStage::RTOS_OBJECTS) | stageBit(BootStage::EVENT_BUS), false},
+    {BootStage::AUDIO, "audio", Audio::AudioManager::init, stageBit(BootStage::CONFIG), false},
+    {BootStage::TASKS, "tasks", RTOS::createTasks,
+     stageBit(BootStage::WATCHDOG) | stageBit(BootStage::TASK_MANAGER) | stageBit(BootStage::SENSORS) |
+     stageBit(BootStage::AUDIO), false},
+    {BootStage::AI, "ai", AI::AIEngine::init, stageBit(BootStage::TASKS), true},
+    {BootStage::NETWORK, "network", Network::WiFiManager::init,
+     stageBit(BootStage::CONFIG) | stageBit(BootStage::TASKS), true},
+};
+
+static_assert(sizeof(STAGES) / sizeof(STAGES[0]) == static_cast<size_t>(BootStage::COUNT),
+              "Boot stage definition missing");
+
+constexpr bool stagesInOrder(size_t i = 0) {
+    return i >= sizeof(STAGES) / sizeof(STAGES[0]) ? true
+         : static_cast<size_t>(STAGES[i].stage) == i && stagesInOrder(i + 1);
+}
+
+static_assert(stagesInOrder(), "Boot stages must be listed in BootStage order");
+
+RTOS::TaskStorage<RTOS::TASK_STACK_BOOT> bootTaskStorage;
+TaskHandle_t bootTaskHandle = nullptr;
+
+} // namespace
+
 bool SystemManager::initialized = false;
 uint32_t SystemManager::startTime = 0;
+BootStageInfo SystemManager::stages[static_cast<uint8_t>(BootStage::COUNT)];
+volatile uint32_t SystemManager::completedStages = 0;
+volatile uint32_t SystemManager::firstNoteUs = 0;
+volatile bool SystemManager::bootComplete = false;
 
 void SystemManager::init() {
     if (initialized) {
@@ -22,34 +112,81 @@ void SystemManager::init() {
     }
     
     startTime = millis();
+    completedStages = 0;
+    firstNoteUs = 0;
+    bootComplete = false;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::COUNT); i++) {
+        stages[i] = {STAGES[i].name, STAGES[i].background, false, 0, 0};
+    }
     
-    // Initialize core components
-    Logger::init();
-    Logger::info("=== B.I.T.E.S System Initialization ===");
-    
-    // Initialize configuration
-    ConfigManager::init();
-    
-    // Initialize watchdog
-    Watchdog::init();
-    
-    // Initialize RTOS components
-    RTOS::createQueues();
-    RTOS::createSemaphores();
-    RTOS::createTimers();
+    // Critical path: everything needed to turn a hit into sound
+    runStages(false);
+    firstNoteUs = micros();
     
-    // Initialize task manager
-    TaskManager::init();
+    initialized = true;
+    Logger::info("System initialization complete, playable after %lu ms",
+                 static_cast<unsigned long>(firstNoteUs / 1000));
+    Logger::info("Free memory: %lu bytes", getFreeMemory());
     
-    // Initialize event queue
-    EventQueue::init();
+    // The rest comes up behind the first note
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "boot task", bootTaskStorage.BYTES);
+    if (bootTaskStorage.create(bootTask, "BootTask", nullptr,
+                               static_cast<UBaseType_t>(RTOS::TaskPriority::BACKGROUND),
+                               &bootTaskHandle) != pdPASS) {
+        Logger::warning("Boot task unavailable, finishing boot inline");
+        bootTaskHandle = nullptr;
+        finishBoot();
+    }
+}
+
+void SystemManager::bootTask(void* parameters) {
+    (void)parameters;
+    finishBoot();
+    vTaskDelete(nullptr);
+}
+
+void SystemManager::finishBoot() {
+    runStages(true);
     
-    // Create RTOS tasks
-    RTOS::createTasks();
+    printBootReport();
+    MemoryBudget::printReport();
+
+#if BITS_STATIC_ALLOCATION
+    // Everything from here on runs out of static storage
+    MemoryBudget::lockHeap();
+#endif
+    bootComplete = true;
+}
+
+bool SystemManager::runStages(bool background) {
+    // Start any stage whose dependencies are done until none is left; a
+    // stage left over depends on one that can't run in this pass
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::COUNT); i++) {
+            const StageDefinition& definition = STAGES[i];
+            if (stages[i].done || definition.background != background ||
+                (definition.dependencies & ~completedStages) != 0) {
+                continue;
+            }
+            stages[i].startUs = micros();
+            definition.init();
+            stages[i].durationUs = micros() - stages[i].startUs;
+            stages[i].done = true;
+            completedStages = completedStages | stageBit(definition.stage);
+            progress = true;
+        }
+    }
     
-    initialized = true;
-    Logger::info("System initialization complete");
-    Logger::info("Free memory: %lu bytes", getFreeMemory());
+    bool complete = true;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::COUNT); i++) {
+        if (!stages[i].done && STAGES[i].background == background) {
+            Logger::error("Boot stage %s has unmet dependencies", STAGES[i].name);
+            complete = false;
+        }
+    }
+    return complete;
 }
 
 void SystemManager::shutdown() {
@@ -59,6 +196,12 @@ void SystemManager::shutdown() {
     
     Logger::info("Shutting down system...");
     
+    // Stop a boot still running in the background
+    if (!bootComplete && bootTaskHandle != nullptr) {
+        vTaskDelete(bootTaskHandle);
+    }
+    bootTaskHandle = nullptr;
+    
     // Delete RTOS tasks
     RTOS::deleteTasks();
     
@@ -98,5 +241,31 @@ uint32_t SystemManager::getFreeMemory() {
     return TaskManager::getFreeHeap();
 }
 
+bool SystemManager::isBootComplete() {
+    return bootComplete;
+}
+
+uint32_t SystemManager::getTimeToFirstNote() {
+    return firstNoteUs;
+}
+
+const BootStageInfo& SystemManager::getBootStage(BootStage stage) {
+    return stages[stage < BootStage::COUNT ? static_cast<uint8_t>(stage) : 0];
+}
+
+void SystemManager::printBootReport() {
+    Logger::info("=== Boot Profile ===");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::COUNT); i++) {
+        const BootStageInfo& stage = stages[i];
+        if (!stage.done) {
+            Logger::info("%-14s %s", stage.name, stage.background ? "pending" : "not run");
+            continue;
+        }
+        Logger::info("%-14s %8lu us at %7lu us%s", stage.name, static_cast<unsigned long>(stage.durationUs),
+                     static_cast<unsigned long>(stage.startUs), stage.background ? " (background)" : "");
+    }
+    Logger::info("First note playable at %lu us", static_cast<unsigned long>(firstNoteUs));
+}
+
 } // namespace Core
 } // namespace BITS
@@ -1,9 +1,38 @@
 #ifndef BITS_CORE_SYSTEM_MANAGER_H
 #define BITS_CORE_SYSTEM_MANAGER_H
 
+#include <stdint.h>
+
 namespace BITS {
 namespace Core {
 
+// Init stages; the dependency graph is in system_manager.cpp
+enum class BootStage : uint8_t {
+    LOGGER = 0,
+    CONFIG,
+    WATCHDOG,
+    RTOS_OBJECTS,
+    TASK_MANAGER,
+    EVENT_BUS,
+    SENSORS,
+    AUDIO,
+    TASKS,
+    AI,
+    NETWORK,
+    COUNT
+};
+
+struct BootStageInfo {
+    const char* name;
+    bool background;        // Runs in the boot task once the instrument plays
+    bool done;
+    uint32_t startUs;       // micros() when the stage started
+    uint32_t durationUs;
+};
+
+// init() runs the stages the instrument needs to play in dependency order,
+// then hands the rest (AI, network) to a background boot task and returns.
+// The heap is locked once that task has finished.
 class SystemManager {
 public:
     static void init();
@@ -14,9 +43,24 @@ public:
     static float getCPUUsage();
     static uint32_t getFreeMemory();
 
+    // Boot profile
+    static bool isBootComplete();
+    // micros() since reset at which notes could first be played, 0 before
+    static uint32_t getTimeToFirstNote();
+    static const BootStageInfo& getBootStage(BootStage stage);
+    static void printBootReport();
+
 private:
     static bool initialized;
     static uint32_t startTime;
+    static BootStageInfo stages[static_cast<uint8_t>(BootStage::COUNT)];
+    static volatile uint32_t completedStages;
+    static volatile uint32_t firstNoteUs;
+    static volatile bool bootComplete;
+
+    static bool runStages(bool background);
+    static void bootTask(void* parameters);
+    static void finishBoot();
 };
 
 } // namespace Core
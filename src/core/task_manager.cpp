@@ -5,10 +5,51 @@
 namespace BITS {
 namespace Core {
 
-uint32_t TaskManager::lastIdleTime = 0;
-uint32_t TaskManager::lastTotalTime = 0;
+TaskTiming TaskManager::timings[static_cast<uint8_t>(TaskId::COUNT)];
+uint32_t TaskManager::lastSampleCycles = 0;
+float TaskManager::cpuUsage = 0.0f;
+
+void TaskHistogram::reset() {
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        counts[i] = 0;
+    }
+    total = 0;
+    maxUs = 0;
+}
+
+void TaskHistogram::record(uint32_t us) {
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS - 1 && us >= bucketLimitUs(bucket)) {
+        bucket++;
+    }
+    counts[bucket]++;
+    total++;
+    if (us > maxUs) {
+        maxUs = us;
+    }
+}
+
+uint32_t TaskHistogram::percentileUs(float fraction) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t target = static_cast<uint32_t>(fraction * total + 0.5f);
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS - 1; i++) {
+        seen += counts[i];
+        if (seen >= target) {
+            return bucketLimitUs(i) < maxUs ? bucketLimitUs(i) : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+uint32_t TaskHistogram::bucketLimitUs(uint8_t bucket) {
+    return 1UL << bucket;
+}
 
 void TaskManager::init() {
+    resetTaskTimings();
     Logger::info("Task manager initialized");
 }
 
@@ -32,6 +73,20 @@ void TaskManager::monitorHealth() {
         }
     }
     
+    sampleCPU();
+    
+    // Report slipping tasks before the slip becomes audible
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        TaskTiming& timing = timings[i];
+        uint32_t misses = timing.deadlineMisses - timing.sampledDeadlineMisses;
+        timing.sampledDeadlineMisses = timing.deadlineMisses;
+        TaskHandle_t handle = getHandle(static_cast<TaskId>(i));
+        if (misses > 0 && handle != nullptr) {
+            Logger::warning("Task %s missed %lu deadlines, worst by %lu us",
+                           pcTaskGetName(handle), misses, timing.worstOverrunUs);
+        }
+    }
+    
     // Check heap
     uint32_t freeHeap = getFreeHeap();
     if (freeHeap < 10000) {
@@ -43,6 +98,9 @@ TaskStats TaskManager::getTaskStats(TaskHandle_t handle) {
     TaskStats stats;
     if (handle == nullptr) {
         stats.name = "NULL";
+        stats.handle = nullptr;
+        stats.runtime = 0;
+        stats.cpuUsage = 0.0f;
         return stats;
     }
     
@@ -51,7 +109,15 @@ TaskStats TaskManager::getTaskStats(TaskHandle_t handle) {
     stats.priority = uxTaskPriorityGet(handle);
     stats.stackHighWaterMark = uxTaskGetStackHighWaterMark(handle);
     stats.state = eTaskGetState(handle);
-    stats.runtime = 0; // Runtime stats require configUSE_STATS_FORMATTING_FUNCTIONS
+    stats.runtime = 0;
+    stats.cpuUsage = 0.0f;
+    
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        if (getHandle(static_cast<TaskId>(i)) == handle) {
+            stats.runtime = timings[i].runtimeCycles / (F_CPU_ACTUAL / 1000000);
+            stats.cpuUsage = timings[i].cpuUsage;
+        }
+    }
     
     return stats;
 }
@@ -60,21 +126,28 @@ void TaskManager::printAllTaskStats() {
     Logger::info("=== Task Statistics ===");
     Logger::info("Free Heap: %lu bytes", getFreeHeap());
     Logger::info("Min Free Heap: %lu bytes", getMinFreeHeap());
+    Logger::info("CPU Usage: %.1f%%", getCPUUsage());
     
-    TaskHandle_t handles[] = {
-        RTOS::sensorTaskHandle,
-        RTOS::audioTaskHandle,
-        RTOS::aiTaskHandle,
-        RTOS::networkTaskHandle,
-        RTOS::systemTaskHandle
-    };
-    
-    for (auto handle : handles) {
-        if (handle != nullptr) {
-            TaskStats stats = getTaskStats(handle);
-            Logger::info("Task: %s, Priority: %d, Stack: %lu bytes, State: %d",
-                        stats.name, stats.priority, stats.stackHighWaterMark * 4, stats.state);
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        TaskHandle_t handle = getHandle(static_cast<TaskId>(i));
+        if (handle == nullptr) {
+            continue;
         }
+        
+        TaskStats stats = getTaskStats(handle);
+        const TaskTiming& timing = timings[i];
+        Logger::info("Task: %s, Priority: %d, Stack: %lu bytes, State: %d",
+                    stats.name, stats.priority, stats.stackHighWaterMark * 4, stats.state);
+        Logger::info("  CPU: %.1f%%, Runtime: %llu us, Activations: %lu, Late: %lu",
+                    stats.cpuUsage, stats.runtime, timing.activations, timing.lateActivations);
+        Logger::info("  Exec us p50/p99/max: %lu/%lu/%lu",
+                    timing.execution.percentileUs(0.5f), timing.execution.percentileUs(0.99f),
+                    timing.execution.maxUs);
+        Logger::info("  Jitter us p50/p99/max: %lu/%lu/%lu",
+                    timing.jitter.percentileUs(0.5f), timing.jitter.percentileUs(0.99f),
+                    timing.jitter.maxUs);
+        Logger::info("  Deadline misses: %lu (worst +%lu us), missed check-ins: %lu, last miss at %lu ms",
+                    timing.deadlineMisses, timing.worstOverrunUs, timing.missedCheckIns, timing.lastMissMs);
     }
 }
 
@@ -87,10 +160,235 @@ uint32_t TaskManager::getMinFreeHeap() {
 }
 
 float TaskManager::getCPUUsage() {
-    // Simplified CPU usage calculation
-    // In production, use proper runtime statistics
-    return 0.0f;
+    // Sum of the accounted tasks over the last monitorHealth() window
+    return cpuUsage;
+}
+
+void TaskManager::registerTask(TaskId id, TickType_t period, TickType_t deadline,
+                               TickType_t checkIn, bool critical) {
+    registerTaskUs(id, pdTICKS_TO_MS(period) * 1000, pdTICKS_TO_MS(deadline) * 1000,
+                   pdTICKS_TO_MS(checkIn) * 1000, critical);
+}
+
+void TaskManager::registerTaskUs(TaskId id, uint32_t periodUs, uint32_t deadlineUs,
+                                 uint32_t checkInUs, bool critical) {
+    TaskTiming& timing = timings[static_cast<uint8_t>(id)];
+    timing.periodCycles = microsToCycles(periodUs);
+    timing.deadlineCycles = microsToCycles(deadlineUs);
+    timing.checkInCycles = microsToCycles(checkInUs);
+    timing.critical = critical;
+    timing.lastCheckInCycles = ARM_DWT_CYCCNT;
+    timing.overdue = false;
+    timing.started = false;
+#ifdef BITS_HOST_BUILD
+    // The host runs every task on its own thread and never switches them
+    // out, so their run time is wall time
+    timing.runCycles = 0;
+    timing.switchedInCycles = ARM_DWT_CYCCNT;
+#endif
+}
+
+void TaskManager::beginActivation(TaskId id) {
+    TaskTiming& timing = timings[static_cast<uint8_t>(id)];
+    uint32_t now = ARM_DWT_CYCCNT;
+    timing.startCycles = runCyclesNow(timing);
+    timing.releaseCycles = now;
+    
+    if (!timing.started) {
+        timing.started = true;
+        timing.nextWakeCycles = now + timing.periodCycles;
+        return;
+    }
+    if (timing.periodCycles == 0) {
+        // Event-driven: there is no expected start to be late against
+        return;
+    }
+    
+    // The deadline runs from when the activation was due, so slipping
+    // periods count against it even if each activation is short
+    int32_t lateness = static_cast<int32_t>(now - timing.nextWakeCycles);
+    if (lateness > 0) {
+        timing.releaseCycles = timing.nextWakeCycles;
+    }
+    timing.jitter.record(lateness > 0 ? cyclesToMicros(lateness) : 0);
+    
+    if (lateness >= static_cast<int32_t>(timing.periodCycles)) {
+        // vTaskDelayUntil skips missed periods, so re-anchor on this start
+        timing.lateActivations++;
+        timing.nextWakeCycles = now + timing.periodCycles;
+    } else {
+        timing.nextWakeCycles += timing.periodCycles;
+    }
+}
+
+void TaskManager::endActivation(TaskId id) {
+    TaskTiming& timing = timings[static_cast<uint8_t>(id)];
+    uint32_t now = ARM_DWT_CYCCNT;
+    uint32_t elapsed = runCyclesNow(timing) - timing.startCycles;
+    timing.busyCycles += elapsed;
+    timing.activations++;
+    timing.execution.record(cyclesToMicros(elapsed));
+    
+    uint32_t response = now - timing.releaseCycles;
+    if (timing.deadlineCycles != 0 && response > timing.deadlineCycles) {
+        uint32_t overrunUs = cyclesToMicros(response - timing.deadlineCycles);
+        timing.deadlineMisses++;
+        timing.lastMissMs = millis();
+        if (overrunUs > timing.worstOverrunUs) {
+            timing.worstOverrunUs = overrunUs;
+        }
+    }
+    
+    // Check in
+    timing.lastCheckInCycles = now;
+    timing.overdue = false;
+}
+
+void TaskManager::taskSwitchedIn(TaskId id) {
+    if (id != TaskId::COUNT) {
+        timings[static_cast<uint8_t>(id)].switchedInCycles = ARM_DWT_CYCCNT;
+    }
+}
+
+void TaskManager::taskSwitchedOut(TaskId id) {
+    if (id != TaskId::COUNT) {
+        TaskTiming& timing = timings[static_cast<uint8_t>(id)];
+        timing.runCycles += ARM_DWT_CYCCNT - timing.switchedInCycles;
+    }
+}
+
+uint32_t TaskManager::runCyclesNow(TaskTiming& timing) {
+    // The calling task is on the CPU; a switch between the two reads would
+    // lose its time away
+    taskENTER_CRITICAL();
+    uint32_t cycles = timing.runCycles + (ARM_DWT_CYCCNT - timing.switchedInCycles);
+    taskEXIT_CRITICAL();
+    return cycles;
+}
+
+bool TaskManager::checkDeadlines() {
+    // Overdue stays set until the next check-in, so a hang is still seen
+    // after CYCCNT has wrapped past it
+    uint32_t now = ARM_DWT_CYCCNT;
+    bool onTime = true;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        TaskTiming& timing = timings[i];
+        if (timing.checkInCycles == 0) {
+            continue;
+        }
+        if (!timing.overdue && now - timing.lastCheckInCycles > timing.checkInCycles) {
+            timing.overdue = true;
+            timing.missedCheckIns++;
+            timing.lastMissMs = millis();
+            TaskHandle_t handle = getHandle(static_cast<TaskId>(i));
+            Logger::warning("Task %s missed its check-in", handle ? pcTaskGetName(handle) : "?");
+        }
+        if (timing.overdue && timing.critical) {
+            onTime = false;
+        }
+    }
+    return onTime;
+}
+
+uint32_t TaskManager::getDeadlineMisses(TaskId id) {
+    return timings[static_cast<uint8_t>(id)].deadlineMisses;
+}
+
+uint32_t TaskManager::getMissedCheckIns(TaskId id) {
+    return timings[static_cast<uint8_t>(id)].missedCheckIns;
+}
+
+TaskId TaskManager::getCurrentTaskId() {
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        if (current == getHandle(static_cast<TaskId>(i))) {
+            return static_cast<TaskId>(i);
+        }
+    }
+    return TaskId::COUNT;
+}
+
+const TaskTiming& TaskManager::getTaskTiming(TaskId id) {
+    return timings[static_cast<uint8_t>(id)];
+}
+
+float TaskManager::getTaskCPUUsage(TaskId id) {
+    return timings[static_cast<uint8_t>(id)].cpuUsage;
+}
+
+void TaskManager::resetTaskTimings() {
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        TaskTiming& timing = timings[i];
+        timing.busyCycles = 0;
+        timing.sampledBusyCycles = 0;
+        timing.runtimeCycles = 0;
+        timing.activations = 0;
+        timing.lateActivations = 0;
+        timing.cpuUsage = 0.0f;
+        timing.started = false;
+        timing.jitter.reset();
+        timing.execution.reset();
+        timing.lastCheckInCycles = ARM_DWT_CYCCNT;
+        timing.deadlineMisses = 0;
+        timing.sampledDeadlineMisses = 0;
+        timing.missedCheckIns = 0;
+        timing.lastMissMs = 0;
+        timing.worstOverrunUs = 0;
+        timing.overdue = false;
+    }
+    cpuUsage = 0.0f;
+    lastSampleCycles = ARM_DWT_CYCCNT;
+}
+
+uint32_t TaskManager::cyclesToMicros(uint32_t cycles) {
+    return cycles / (F_CPU_ACTUAL / 1000000);
+}
+
+uint32_t TaskManager::microsToCycles(uint32_t us) {
+    return us * (F_CPU_ACTUAL / 1000000);
+}
+
+void TaskManager::sampleCPU() {
+    // Busy counters are only read here, so tasks update them without locks.
+    // Must run more often than CYCCNT wraps; the system task calls it every 1 s.
+    uint32_t now = ARM_DWT_CYCCNT;
+    uint32_t elapsed = now - lastSampleCycles;
+    lastSampleCycles = now;
+    if (elapsed == 0) {
+        return;
+    }
+    
+    float total = 0.0f;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(TaskId::COUNT); i++) {
+        TaskTiming& timing = timings[i];
+        uint32_t busy = timing.busyCycles;
+        uint32_t delta = busy - timing.sampledBusyCycles;
+        timing.sampledBusyCycles = busy;
+        timing.runtimeCycles += delta;
+        timing.cpuUsage = 100.0f * delta / elapsed;
+        total += timing.cpuUsage;
+    }
+    cpuUsage = total;
+}
+
+TaskHandle_t TaskManager::getHandle(TaskId id) {
+    switch (id) {
+        case TaskId::SENSOR: return RTOS::sensorTaskHandle;
+        case TaskId::AUDIO: return RTOS::audioTaskHandle;
+        case TaskId::AI: return RTOS::aiTaskHandle;
+        case TaskId::NETWORK: return RTOS::networkTaskHandle;
+        case TaskId::SYSTEM: return RTOS::systemTaskHandle;
+        default: return nullptr;
+    }
 }
 
 } // namespace Core
 } // namespace BITS
+
+extern "C" void vApplicationTaskSwitchedInHook(void) {
+    BITS::Core::TaskManager::taskSwitchedIn(BITS::Core::TaskManager::getCurrentTaskId());
+}
+
+extern "C" void vApplicationTaskSwitchedOutHook(void) {
+    BITS::Core::TaskManager::taskSwitchedOut(BITS::Core::TaskManager::getCurrentTaskId());
+}
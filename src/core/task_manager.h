@@ -7,13 +7,72 @@
 namespace BITS {
 namespace Core {
 
+// Tasks with runtime accounting
+enum class TaskId : uint8_t {
+    SENSOR = 0,
+    AUDIO,
+    AI,
+    NETWORK,
+    SYSTEM,
+    COUNT
+};
+
 struct TaskStats {
     const char* name;
     TaskHandle_t handle;
     UBaseType_t priority;
     uint32_t stackHighWaterMark;
     eTaskState state;
-    uint32_t runtime;
+    uint64_t runtime;       // Busy time in microseconds
+    float cpuUsage;         // Percent, over the last monitorHealth() window
+};
+
+// Log2 histogram of microsecond durations: bucket 0 holds values below 1 us,
+// bucket b holds [2^(b-1), 2^b) us, the last bucket everything above
+struct TaskHistogram {
+    static constexpr uint8_t BUCKETS = 16;
+    
+    uint32_t counts[BUCKETS];
+    uint32_t total;
+    uint32_t maxUs;
+    
+    void reset();
+    void record(uint32_t us);
+    // Upper bound of the bucket holding the given fraction (0..1) of samples
+    uint32_t percentileUs(float fraction) const;
+    static uint32_t bucketLimitUs(uint8_t bucket);
+};
+
+struct TaskTiming {
+    uint32_t periodCycles;
+    uint32_t nextWakeCycles;    // Expected start of the next activation
+    uint32_t startCycles;       // Run cycles at the start of the activation
+    uint32_t busyCycles;        // Run cycles in activations, written by the task only
+    uint32_t sampledBusyCycles; // busyCycles at the last monitorHealth()
+    uint64_t runtimeCycles;
+    uint32_t activations;
+    uint32_t lateActivations;   // Started a full period or more late
+    float cpuUsage;
+    bool started;
+    TaskHistogram jitter;       // Start time minus expected start
+    TaskHistogram execution;    // Run time of one activation, preemption excluded
+    
+    // Time on the CPU, kept by the context switch hooks
+    uint32_t runCycles;         // Summed at every switch out
+    uint32_t switchedInCycles;  // CYCCNT at the latest switch in
+    
+    // Deadline monitoring, see registerTask()
+    uint32_t deadlineCycles;    // 0 = no deadline
+    uint32_t checkInCycles;     // Longest gap between check-ins, 0 = not monitored
+    uint32_t releaseCycles;     // Expected start of the current activation
+    uint32_t lastCheckInCycles; // End of the last activation
+    uint32_t deadlineMisses;    // Activations that ended past their deadline
+    uint32_t sampledDeadlineMisses;
+    uint32_t missedCheckIns;    // Times the task was found overdue (hung)
+    uint32_t lastMissMs;        // millis() of the latest miss of either kind
+    uint32_t worstOverrunUs;    // Furthest an activation ended past its deadline
+    bool critical;              // Must check in for the hardware watchdog to be fed
+    bool overdue;
 };
 
 class TaskManager {
@@ -25,10 +84,50 @@ public:
     static uint32_t getFreeHeap();
     static uint32_t getMinFreeHeap();
     static float getCPUUsage();
+    
+    // Called by each task: once before its loop, then around every activation.
+    // Cycles come from DWT CYCCNT, so an activation must stay under ~7 s.
+    // Event-driven tasks register a period of 0 and get no jitter statistics.
+    // An activation must end within `deadline` of its expected start (of its
+    // actual start when event-driven); the end of each activation is the
+    // task's check-in, and a task that goes `checkIn` without one counts as
+    // hung. 0 disables either check.
+    static void registerTask(TaskId id, TickType_t period, TickType_t deadline = 0,
+                             TickType_t checkIn = 0, bool critical = false);
+    // Same in microseconds, for periods shorter than a tick
+    static void registerTaskUs(TaskId id, uint32_t periodUs, uint32_t deadlineUs = 0,
+                               uint32_t checkInUs = 0, bool critical = false);
+    static void beginActivation(TaskId id);
+    static void endActivation(TaskId id);
+    // Context switches of task id, which keep its run time. Called by
+    // vApplicationTaskSwitchedInHook() and vApplicationTaskSwitchedOutHook(),
+    // which the target's FreeRTOSConfig.h wires up as traceTASK_SWITCHED_IN()
+    // and traceTASK_SWITCHED_OUT(); TaskId::COUNT is ignored.
+    static void taskSwitchedIn(TaskId id);
+    static void taskSwitchedOut(TaskId id);
+    
+    // Flags tasks that are overdue for their check-in. Returns false while
+    // any critical task is overdue; Watchdog::feed() then withholds the feed.
+    static bool checkDeadlines();
+    static uint32_t getDeadlineMisses(TaskId id);
+    static uint32_t getMissedCheckIns(TaskId id);
+    
+    // TaskId::COUNT for any other context (main loop, log task, timers)
+    static TaskId getCurrentTaskId();
+    static const TaskTiming& getTaskTiming(TaskId id);
+    static float getTaskCPUUsage(TaskId id);
+    static void resetTaskTimings();
+    static uint32_t cyclesToMicros(uint32_t cycles);
 
 private:
-    static uint32_t lastIdleTime;
-    static uint32_t lastTotalTime;
+    static TaskTiming timings[static_cast<uint8_t>(TaskId::COUNT)];
+    static uint32_t lastSampleCycles;
+    static float cpuUsage;
+    
+    static void sampleCPU();
+    static uint32_t runCyclesNow(TaskTiming& timing);
+    static uint32_t microsToCycles(uint32_t us);
+    static TaskHandle_t getHandle(TaskId id);
 };
 
 } // namespace Core
@@ -0,0 +1,133 @@
+#include "core/trace.h"
+#include "core/logger.h"
+#include "core/task_manager.h"
+#include <atomic>
+
+namespace BITS {
+namespace Core {
+
+#if BITS_TRACE_ENABLED
+
+static_assert((Tracer::BUFFER_SIZE & (Tracer::BUFFER_SIZE - 1)) == 0,
+              "Trace buffer size must be a power of two");
+static_assert(Tracer::TRACK_COUNT == static_cast<uint8_t>(TaskId::COUNT) + 1,
+              "One trace track per accounted task plus one shared track");
+
+namespace {
+
+struct TraceTrack {
+    std::atomic<uint32_t> head;     // Total events written
+    TraceEvent events[Tracer::BUFFER_SIZE];
+};
+
+TraceTrack tracks[Tracer::TRACK_COUNT];
+std::atomic<bool> recording{true};
+
+} // namespace
+
+void Tracer::setRecording(bool enable) {
+    recording = enable;
+}
+
+bool Tracer::isRecording() {
+    return recording;
+}
+
+void Tracer::record(const char* name, uint32_t beginCycles, uint32_t endCycles) {
+    if (!recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // The shared track can have several writers, so every track claims its
+    // slot atomically
+    TraceTrack& track = tracks[static_cast<uint8_t>(TaskManager::getCurrentTaskId())];
+    uint32_t index = track.head.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = track.events[index & (BUFFER_SIZE - 1)];
+    event.name = name;
+    event.beginCycles = beginCycles;
+    event.endCycles = endCycles;
+}
+
+void Tracer::clear() {
+    for (uint8_t i = 0; i < TRACK_COUNT; i++) {
+        tracks[i].head = 0;
+    }
+}
+
+void Tracer::dump() {
+    bool wasRecording = recording.exchange(false);
+    uint32_t now = ARM_DWT_CYCCNT;
+    uint32_t total = 0;
+
+    // Times are cycles before the dump, so the 32-bit counter only has to
+    // cover the buffered window (~7 s at 600 MHz)
+    Serial.printf("#TRACE BEGIN %lu\r\n", static_cast<unsigned long>(F_CPU_ACTUAL / 1000000));
+    for (uint8_t i = 0; i < TRACK_COUNT; i++) {
+        Serial.printf("#TRACE TRACK %u %s\r\n", i, getTrackName(i));
+
+        uint32_t head = tracks[i].head.load(std::memory_order_acquire);
+        uint32_t count = head < BUFFER_SIZE ? head : BUFFER_SIZE;
+        for (uint32_t n = head - count; n != head; n++) {
+            const TraceEvent& event = tracks[i].events[n & (BUFFER_SIZE - 1)];
+            Serial.printf("#TRACE X %u %lu %lu %s\r\n", i,
+                          static_cast<unsigned long>(now - event.beginCycles),
+                          static_cast<unsigned long>(event.endCycles - event.beginCycles),
+                          event.name);
+        }
+        total += count;
+    }
+    Serial.printf("#TRACE END %lu\r\n", static_cast<unsigned long>(total));
+
+    recording = wasRecording;
+}
+
+uint32_t Tracer::getEventCount(uint8_t track) {
+    if (track >= TRACK_COUNT) {
+        return 0;
+    }
+    uint32_t head = tracks[track].head.load(std::memory_order_relaxed);
+    return head < BUFFER_SIZE ? head : BUFFER_SIZE;
+}
+
+#else
+
+void Tracer::setRecording(bool enable) {
+    (void)enable;
+}
+
+bool Tracer::isRecording() {
+    return false;
+}
+
+void Tracer::record(const char* name, uint32_t beginCycles, uint32_t endCycles) {
+    (void)name;
+    (void)beginCycles;
+    (void)endCycles;
+}
+
+void Tracer::clear() {
+}
+
+void Tracer::dump() {
+    Logger::warning("Tracing disabled (build with BITS_TRACE_ENABLED=1)");
+}
+
+uint32_t Tracer::getEventCount(uint8_t track) {
+    (void)track;
+    return 0;
+}
+
+#endif // BITS_TRACE_ENABLED
+
+const char* Tracer::getTrackName(uint8_t track) {
+    switch (track) {
+        case 0: return "SensorTask";
+        case 1: return "AudioTask";
+        case 2: return "AITask";
+        case 3: return "NetworkTask";
+        case 4: return "SystemTask";
+        default: return "Other";
+    }
+}
+
+} // namespace Core
+} // namespace BITS
@@ -0,0 +1,64 @@
+#ifndef BITS_CORE_TRACE_H
+#define BITS_CORE_TRACE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "config.h"
+
+namespace BITS {
+namespace Core {
+
+// One completed scope; name is a string literal
+struct TraceEvent {
+    const char* name;
+    uint32_t beginCycles;
+    uint32_t endCycles;
+};
+
+// Flight recorder for hot-path scopes. Each RTOS task records into its own
+// ring (everything else shares one), overwriting the oldest events. Only
+// built when BITS_TRACE_ENABLED is set; not for use in ISRs.
+class Tracer {
+public:
+    static constexpr uint8_t TRACK_COUNT = 6;     // TaskId::COUNT + other
+    static constexpr uint32_t BUFFER_SIZE = TRACE_BUFFER_SIZE;   // Power of two
+
+    static void setRecording(bool enable);
+    static bool isRecording();
+    static void record(const char* name, uint32_t beginCycles, uint32_t endCycles);
+    static void clear();
+
+    // Writes every buffered event to Serial as "#TRACE" lines, which
+    // tools/trace_export.py converts to Chrome/Perfetto trace JSON.
+    // Recording is paused while dumping.
+    static void dump();
+    static uint32_t getEventCount(uint8_t track);
+    static const char* getTrackName(uint8_t track);
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), beginCycles(ARM_DWT_CYCCNT) {}
+    ~TraceScope() { Tracer::record(name, beginCycles, ARM_DWT_CYCCNT); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint32_t beginCycles;
+};
+
+} // namespace Core
+} // namespace BITS
+
+#define BITS_TRACE_CONCAT_INNER(a, b) a##b
+#define BITS_TRACE_CONCAT(a, b) BITS_TRACE_CONCAT_INNER(a, b)
+
+#if BITS_TRACE_ENABLED
+#define TRACE_SCOPE(name) BITS::Core::TraceScope BITS_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // BITS_CORE_TRACE_H
@@ -1,28 +1,87 @@
 #include "core/watchdog.h"
 #include "core/logger.h"
+#include "core/task_manager.h"
+#include <Arduino.h>
 
 namespace BITS {
 namespace Core {
 
+#ifndef BITS_HOST_BUILD
+namespace {
+
+// RTWDOG (WDOG3) in 32-bit command mode, clocked from the 32.768 kHz LPO
+// through the 256 prescaler: 128 counts per second, up to 512 s
+constexpr uint32_t CS_UPDATE = 1UL << 5;
+constexpr uint32_t CS_EN = 1UL << 7;
+constexpr uint32_t CS_CLK_LPO = 1UL << 8;
+constexpr uint32_t CS_RCS = 1UL << 10;
+constexpr uint32_t CS_ULK = 1UL << 11;
+constexpr uint32_t CS_PRES = 1UL << 12;
+constexpr uint32_t CS_CMD32EN = 1UL << 13;
+constexpr uint32_t UNLOCK_KEY = 0xD928C520;
+constexpr uint32_t REFRESH_KEY = 0xB480A602;
+constexpr uint32_t COUNTS_PER_SECOND = 32768 / 256;
+
+// The new configuration must be written within 255 bus clocks of the
+// unlock, so nothing may interrupt in between. UPDATE keeps it changeable.
+void configureHardware(bool enable, uint32_t counts) {
+    __disable_irq();
+    WDOG3_CNT = UNLOCK_KEY;
+    while (!(WDOG3_CS & CS_ULK)) {
+    }
+    WDOG3_WIN = 0;
+    WDOG3_TOVAL = counts;
+    WDOG3_CS = CS_CMD32EN | CS_PRES | CS_CLK_LPO | CS_UPDATE | (enable ? CS_EN : 0);
+    __enable_irq();
+    while (!(WDOG3_CS & CS_RCS)) {
+    }
+}
+
+} // namespace
+#endif
+
 bool Watchdog::enabled = false;
 uint32_t Watchdog::timeout = 10000;
+uint32_t Watchdog::feeds = 0;
+uint32_t Watchdog::withheld = 0;
 
 void Watchdog::init(uint32_t timeoutMs) {
     timeout = timeoutMs;
-    // Teensy 4.1 has hardware watchdog
-    // Note: Actual implementation depends on Teensy hardware watchdog API
+#ifndef BITS_HOST_BUILD
+    uint32_t counts = static_cast<uint32_t>(static_cast<uint64_t>(timeoutMs) * COUNTS_PER_SECOND / 1000);
+    if (counts == 0) {
+        counts = 1;
+    } else if (counts > 0xFFFF) {
+        counts = 0xFFFF;
+    }
+    configureHardware(true, counts);
+#endif
     enabled = true;
     Logger::info("Watchdog initialized with timeout: %lu ms", timeoutMs);
 }
 
-void Watchdog::feed() {
-    if (enabled) {
-        // Feed hardware watchdog
-        // Note: Implementation depends on Teensy hardware watchdog API
+bool Watchdog::feed() {
+    if (!enabled) {
+        return false;
+    }
+    
+    // A hung critical task must let the hardware reset the system
+    if (!TaskManager::checkDeadlines()) {
+        withheld++;
+        return false;
     }
+
+#ifndef BITS_HOST_BUILD
+    WDOG3_CNT = REFRESH_KEY;
+#endif
+    feeds++;
+    return true;
 }
 
 void Watchdog::disable() {
+#ifndef BITS_HOST_BUILD
+    configureHardware(false, WDOG3_TOVAL);
+#endif
     enabled = false;
     Logger::warning("Watchdog disabled");
 }
@@ -35,5 +94,13 @@ uint32_t Watchdog::getTimeout() {
     return timeout;
 }
 
+uint32_t Watchdog::getFeedCount() {
+    return feeds;
+}
+
+uint32_t Watchdog::getWithheldCount() {
+    return withheld;
+}
+
 } // namespace Core
 } // namespace BITS
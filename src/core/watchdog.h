@@ -1,20 +1,28 @@
 #ifndef BITS_CORE_WATCHDOG_H
 #define BITS_CORE_WATCHDOG_H
 
+#include <stdint.h>
+
 namespace BITS {
 namespace Core {
 
 class Watchdog {
 public:
     static void init(uint32_t timeoutMs = 10000);
-    static void feed();
+    // Feeds the hardware watchdog only while every critical task is checking
+    // in on time (TaskManager::checkDeadlines()); returns whether it was fed
+    static bool feed();
     static void disable();
     static bool isEnabled();
     static uint32_t getTimeout();
+    static uint32_t getFeedCount();
+    static uint32_t getWithheldCount();
 
 private:
     static bool enabled;
     static uint32_t timeout;
+    static uint32_t feeds;
+    static uint32_t withheld;
 };
 
 } // namespace Core
@@ -1,10 +1,34 @@
 #include "instruments/base_instrument.h"
+#include "sensors/sensor_manager.h"
+#include "core/trace.h"
 
 namespace BITS {
 namespace Instruments {
 
 BaseInstrument::BaseInstrument(InstrumentType type) 
-    : type(type), active(false), trackId(0) {
+    : type(type), active(false), trackId(0), sensorEvents(Core::EventQueue::INVALID_SUBSCRIBER) {
+}
+
+BaseInstrument::~BaseInstrument() {
+    Core::EventQueue::removeSubscriber(sensorEvents);
+}
+
+void BaseInstrument::subscribeSensorEvents() {
+    if (sensorEvents == Core::EventQueue::INVALID_SUBSCRIBER) {
+        sensorEvents = Core::EventQueue::addSubscriber(Core::eventMask(Core::EventType::SENSOR_TRIGGERED));
+    }
+}
+
+uint8_t BaseInstrument::dispatchSensorEvents() {
+    TRACE_SCOPE("BaseInstrument::dispatchSensorEvents");
+    Core::Event event;
+    uint8_t handled = 0;
+    while (Core::EventQueue::poll(sensorEvents, event)) {
+        Sensors::SensorTriggerPayload trigger = event.getPayload<Sensors::SensorTriggerPayload>();
+        handleSensorInput(event.sourceId, trigger.value, trigger.velocity);
+        handled++;
+    }
+    return handled;
 }
 
 } // namespace Instruments
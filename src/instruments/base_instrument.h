@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "config.h"
+#include "core/event_queue.h"
 
 namespace BITS {
 namespace Instruments {
@@ -10,7 +11,7 @@ namespace Instruments {
 class BaseInstrument {
 public:
     BaseInstrument(InstrumentType type);
-    virtual ~BaseInstrument() = default;
+    virtual ~BaseInstrument();
     
     virtual void init() = 0;
     virtual void update() = 0;
@@ -24,6 +25,13 @@ protected:
     InstrumentType type;
     bool active;
     uint8_t trackId;
+    Core::SubscriberId sensorEvents;
+    
+    // Sensor triggers arrive on the event bus, so a trigger is not lost
+    // between sensor polls and the instrument's update()
+    void subscribeSensorEvents();
+    // Calls handleSensorInput() for each pending trigger; returns the number handled
+    uint8_t dispatchSensorEvents();
 };
 
 } // namespace Instruments
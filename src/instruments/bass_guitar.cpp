@@ -7,6 +7,11 @@
 namespace BITS {
 namespace Instruments {
 
+using Core::Logger;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+using Audio::AudioManager;
+
 BassGuitar::BassGuitar() 
     : BaseInstrument(InstrumentType::BASS_GUITAR), stringCount(4) {
     for (uint8_t i = 0; i < MAX_STRINGS; i++) {
@@ -28,6 +33,7 @@ void BassGuitar::init() {
     // Register MPU6050 for gesture detection
     SensorManager::registerSensor(SensorType::MPU6050, stringCount, 0);
     
+    subscribeSensorEvents();
     active = true;
     Logger::info("Bass Guitar initialized with %d strings", stringCount);
 }
@@ -37,16 +43,12 @@ void BassGuitar::update() {
         return;
     }
     
-    // Check for triggered sensors
-    for (uint8_t i = 0; i < stringCount; i++) {
-        if (SensorManager::isSensorTriggered(stringSensors[i])) {
-            SensorData data = SensorManager::getSensorData(stringSensors[i]);
-            handleSensorInput(stringSensors[i], data.value, data.velocity);
-        }
-    }
+    // Handle sensor triggers since the last update
+    dispatchSensorEvents();
 }
 
 void BassGuitar::handleSensorInput(uint8_t sensorId, float value, float velocity) {
+    (void)value;
     // Map sensor to string
     uint8_t stringIndex = 255;
     for (uint8_t i = 0; i < stringCount; i++) {
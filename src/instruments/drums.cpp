@@ -7,6 +7,11 @@
 namespace BITS {
 namespace Instruments {
 
+using Core::Logger;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+using Audio::AudioManager;
+
 Drums::Drums() 
     : BaseInstrument(InstrumentType::DRUMS), padCount(8) {
     for (uint8_t i = 0; i < MAX_PADS; i++) {
@@ -38,6 +43,7 @@ void Drums::init() {
     padNotes[static_cast<uint8_t>(DrumPad::CRASH)] = 49;   // C#3
     padNotes[static_cast<uint8_t>(DrumPad::RIDE)] = 51;    // D#3
     
+    subscribeSensorEvents();
     active = true;
     Logger::info("Drums initialized with %d pads", padCount);
 }
@@ -47,16 +53,12 @@ void Drums::update() {
         return;
     }
     
-    // Check for triggered sensors
-    for (uint8_t i = 0; i < padCount; i++) {
-        if (SensorManager::isSensorTriggered(padSensors[i])) {
-            SensorData data = SensorManager::getSensorData(padSensors[i]);
-            handleSensorInput(padSensors[i], data.value, data.velocity);
-        }
-    }
+    // Handle sensor triggers since the last update
+    dispatchSensorEvents();
 }
 
 void Drums::handleSensorInput(uint8_t sensorId, float value, float velocity) {
+    (void)value;
     // Map sensor to pad
     uint8_t padIndex = 255;
     for (uint8_t i = 0; i < padCount; i++) {
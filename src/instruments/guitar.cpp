@@ -7,6 +7,11 @@
 namespace BITS {
 namespace Instruments {
 
+using Core::Logger;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+using Audio::AudioManager;
+
 Guitar::Guitar() 
     : BaseInstrument(InstrumentType::GUITAR), stringCount(6) {
     for (uint8_t i = 0; i < MAX_STRINGS; i++) {
@@ -31,6 +36,7 @@ void Guitar::init() {
     // Register MPU6050 for picking/strumming detection
     SensorManager::registerSensor(SensorType::MPU6050, stringCount, 0);
     
+    subscribeSensorEvents();
     active = true;
     Logger::info("Guitar initialized with %d strings", stringCount);
 }
@@ -40,16 +46,13 @@ void Guitar::update() {
         return;
     }
     
-    // Check for triggered sensors
-    for (uint8_t i = 0; i < stringCount; i++) {
-        if (SensorManager::isSensorTriggered(stringSensors[i])) {
-            SensorData data = SensorManager::getSensorData(stringSensors[i]);
-            handleSensorInput(stringSensors[i], data.value, data.velocity);
-        }
-    }
+    // Handle sensor triggers since the last update
+    dispatchSensorEvents();
 }
 
 void Guitar::handleSensorInput(uint8_t sensorId, float value, float velocity) {
+    (void)value;
+    (void)velocity;
     // Map sensor to string
     uint8_t stringIndex = 255;
     for (uint8_t i = 0; i < stringCount; i++) {
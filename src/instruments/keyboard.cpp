@@ -7,6 +7,11 @@
 namespace BITS {
 namespace Instruments {
 
+using Core::Logger;
+using Sensors::SensorManager;
+using Sensors::SensorType;
+using Audio::AudioManager;
+
 Keyboard::Keyboard() 
     : BaseInstrument(InstrumentType::KEYBOARD), keyCount(61) {
     for (uint8_t i = 0; i < MAX_KEYS; i++) {
@@ -28,6 +33,7 @@ void Keyboard::init() {
     // Register MPU6050 for velocity and aftertouch
     SensorManager::registerSensor(SensorType::MPU6050, keyCount, 0);
     
+    subscribeSensorEvents();
     active = true;
     Logger::info("Keyboard initialized with %d keys", keyCount);
 }
@@ -37,17 +43,12 @@ void Keyboard::update() {
         return;
     }
     
-    // Check for triggered sensors
+    // Key presses arrive as sensor trigger events
+    dispatchSensorEvents();
+    
+    // Key releases
     for (uint8_t i = 0; i < keyCount; i++) {
-        bool triggered = SensorManager::isSensorTriggered(keySensors[i]);
-        
-        if (triggered && !keyStates[i]) {
-            // Key pressed
-            SensorData data = SensorManager::getSensorData(keySensors[i]);
-            handleSensorInput(keySensors[i], data.value, data.velocity);
-            keyStates[i] = true;
-        } else if (!triggered && keyStates[i]) {
-            // Key released
+        if (keyStates[i] && !SensorManager::isSensorTriggered(keySensors[i])) {
             AudioManager::stopNote(trackId, i + 21); // MIDI note 21 = A0
             keyStates[i] = false;
         }
@@ -55,6 +56,7 @@ void Keyboard::update() {
 }
 
 void Keyboard::handleSensorInput(uint8_t sensorId, float value, float velocity) {
+    (void)velocity;
     // Map sensor to key
     uint8_t keyIndex = 255;
     for (uint8_t i = 0; i < keyCount; i++) {
@@ -64,7 +66,7 @@ void Keyboard::handleSensorInput(uint8_t sensorId, float value, float velocity)
         }
     }
     
-    if (keyIndex >= keyCount) {
+    if (keyIndex >= keyCount || keyStates[keyIndex]) {
         return;
     }
     
@@ -76,6 +78,7 @@ void Keyboard::handleSensorInput(uint8_t sensorId, float value, float velocity)
     
     // Play note
     AudioManager::playNote(trackId, noteId, normalizedVelocity);
+    keyStates[keyIndex] = true;
 }
 
 void Keyboard::setKeyCount(uint8_t count) {
@@ -2,20 +2,66 @@
 #include "config.h"
 #include "core/system_manager.h"
 #include "core/logger.h"
+#include "core/task_manager.h"
+#include "core/schedule_manager.h"
+#include "core/config_manager.h"
+#include "core/trace.h"
+#include "core/memory_budget.h"
+#include "sensors/sensor_manager.h"
 
 using namespace BITS;
 using namespace BITS::Core;
+using BITS::Sensors::SensorManager;
 
 void setup() {
-    // Initialize system
+    // Brings up everything needed to play; AI and network follow in the
+    // background
     SystemManager::init();
     
     // Additional initialization can go here
     Logger::info("B.I.T.E.S ready!");
 }
 
+static void handleCommand(const char* command) {
+    if (strcmp(command, "trace") == 0) {
+        Tracer::dump();
+    } else if (strcmp(command, "stats") == 0) {
+        TaskManager::printAllTaskStats();
+    } else if (strcmp(command, "memory") == 0) {
+        MemoryBudget::printReport();
+    } else if (strcmp(command, "boot") == 0) {
+        SystemManager::printBootReport();
+    } else if (strcmp(command, "schedule") == 0) {
+        ScheduleManager::printReport();
+    } else if (strcmp(command, "calibrate") == 0) {
+        SensorManager::calibrate();
+    } else if (strncmp(command, "sensor-period ", 14) == 0) {
+        // Kept only if the admission check accepts it
+        if (ScheduleManager::setTaskPeriod(TaskId::SENSOR, strtoul(command + 14, nullptr, 10))) {
+            ConfigManager::save();
+        }
+    } else if (command[0] != '\0') {
+        Logger::warning("Unknown command: %s", command);
+    }
+}
+
 void loop() {
     // Main loop is mostly empty - system runs in RTOS tasks
-    // This loop can be used for non-critical tasks or serial command processing
+    // Serial commands, one per line: "trace", "stats", "memory", "boot",
+    // "schedule", "calibrate", "sensor-period <us>"
+    static char command[32];
+    static uint8_t length = 0;
+    
+    while (Serial.available() > 0) {
+        char c = static_cast<char>(Serial.read());
+        if (c == '\r' || c == '\n') {
+            command[length] = '\0';
+            handleCommand(command);
+            length = 0;
+        } else if (length < sizeof(command) - 1) {
+            command[length++] = c;
+        }
+    }
+    
     delay(100);
 }
@@ -5,6 +5,9 @@
 namespace BITS {
 namespace Network {
 
+using Core::Logger;
+using Core::ConfigManager;
+
 bool BluetoothManager::initialized = false;
 bool BluetoothManager::enabled = false;
 
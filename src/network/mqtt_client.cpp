@@ -1,22 +1,46 @@
 #include "network/mqtt_client.h"
 #include "core/logger.h"
 #include "network/wifi_manager.h"
+#include "sensors/sensor_manager.h"
+#include <stdio.h>
 
 namespace BITS {
 namespace Network {
 
+using Core::Logger;
+using Core::EventQueue;
+using Core::Event;
+using Core::EventType;
+
 bool MQTTClient::initialized = false;
 bool MQTTClient::connected = false;
+Core::SubscriberId MQTTClient::sensorEvents = EventQueue::INVALID_SUBSCRIBER;
 
 void MQTTClient::init() {
     initialized = true;
     connected = false;
+    if (sensorEvents == EventQueue::INVALID_SUBSCRIBER) {
+        sensorEvents = EventQueue::addSubscriber(Core::eventMask(EventType::SENSOR_TRIGGERED));
+    }
     Logger::info("MQTT client initialized");
 }
 
 void MQTTClient::update() {
     // MQTT updates handled by library
-    // Placeholder for future implementation
+    
+    // Forward sensor triggers; drained even when offline so the ring stays fresh
+    Event event;
+    while (EventQueue::poll(sensorEvents, event)) {
+        if (!connected) {
+            continue;
+        }
+        Sensors::SensorTriggerPayload trigger = event.getPayload<Sensors::SensorTriggerPayload>();
+        char topic[32];
+        char payload[32];
+        snprintf(topic, sizeof(topic), "bits/sensor/%u", event.sourceId);
+        snprintf(payload, sizeof(payload), "%.2f", trigger.velocity);
+        publish(topic, payload);
+    }
 }
 
 bool MQTTClient::connect(const char* broker, uint16_t port) {
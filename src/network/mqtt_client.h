@@ -2,6 +2,7 @@
 #define BITS_NETWORK_MQTT_CLIENT_H
 
 #include <stdint.h>
+#include "core/event_queue.h"
 
 namespace BITS {
 namespace Network {
@@ -21,6 +22,7 @@ public:
 private:
     static bool initialized;
     static bool connected;
+    static Core::SubscriberId sensorEvents;
     // Note: Would use PubSubClient library in production
 };
 
@@ -5,6 +5,8 @@
 namespace BITS {
 namespace Network {
 
+using Core::Logger;
+
 bool OTAUpdater::initialized = false;
 bool OTAUpdater::updating = false;
 float OTAUpdater::progress = 0.0f;
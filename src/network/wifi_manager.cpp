@@ -1,6 +1,8 @@
 #include "network/wifi_manager.h"
 #include "core/config_manager.h"
 #include "core/logger.h"
+#include "core/config_store.h"
+#include "core/memory_budget.h"
 #include "config.h"
 #include <WiFi.h>
 #include <Arduino.h>
@@ -8,8 +10,15 @@
 namespace BITS {
 namespace Network {
 
+using Core::Logger;
+using Core::ConfigManager;
+using Core::ConfigStore;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
 bool WiFiManager::initialized = false;
 bool WiFiManager::connected = false;
+WiFiServer WiFiManager::server(WEB_SERVER_PORT);
 WiFiServer* WiFiManager::webServer = nullptr;
 uint32_t WiFiManager::lastConnectAttempt = 0;
 
@@ -20,14 +29,16 @@ void WiFiManager::init() {
     }
     
     WiFi.mode(WIFI_STA);
+    MemoryBudget::reserve(MemorySubsystem::NETWORK, "web server", sizeof(server));
     initialized = true;
     Logger::info("WiFi manager initialized");
     
     // Try to connect if credentials are stored
-    String ssid = ConfigManager::getWiFiSSID();
-    String password = ConfigManager::getWiFiPassword();
-    if (ssid.length() > 0) {
-        connect(ssid.c_str(), password.c_str());
+    char ssid[ConfigStore::MAX_VALUE_SIZE + 1];
+    char password[ConfigStore::MAX_VALUE_SIZE + 1];
+    if (ConfigManager::getWiFiSSID(ssid, sizeof(ssid)) && ssid[0] != '\0') {
+        ConfigManager::getWiFiPassword(password, sizeof(password));
+        connect(ssid, password);
     }
 }
 
@@ -41,6 +52,7 @@ void WiFiManager::update() {
         if (!connected) {
             connected = true;
             Logger::info("WiFi connected: %s", getIP().c_str());
+            startWebServer();
         }
         
         // Handle web server requests
@@ -78,6 +90,8 @@ bool WiFiManager::connect(const char* ssid, const char* password) {
         connected = true;
         Logger::info("WiFi connected!");
         Logger::info("IP address: %s", WiFi.localIP().toString().c_str());
+        // Nothing serves pages before there is a network to serve them on
+        startWebServer();
         return true;
     } else {
         connected = false;
@@ -112,7 +126,7 @@ int WiFiManager::getRSSI() {
 
 void WiFiManager::startWebServer() {
     if (webServer == nullptr) {
-        webServer = new WiFiServer(WEB_SERVER_PORT);
+        webServer = &server;
         webServer->begin();
         Logger::info("Web server started on port %d", WEB_SERVER_PORT);
     }
@@ -121,7 +135,6 @@ void WiFiManager::startWebServer() {
 void WiFiManager::stopWebServer() {
     if (webServer != nullptr) {
         webServer->stop();
-        delete webServer;
         webServer = nullptr;
         Logger::info("Web server stopped");
     }
@@ -130,7 +143,8 @@ void WiFiManager::stopWebServer() {
 void WiFiManager::handleWebRequest(WiFiClient& client) {
     // Simplified web request handler
     // In production, implement full HTTP server
-    String request = client.readStringUntil('\r');
+    char request[128];
+    client.readBytesUntil('\r', request, sizeof(request));
     client.flush();
     
     // Send simple response
@@ -24,9 +24,12 @@ public:
 private:
     static bool initialized;
     static bool connected;
-    static WiFiServer* webServer;
+    static WiFiServer server;
+    static WiFiServer* webServer;   // &server while running
     static uint32_t lastConnectAttempt;
     static constexpr uint32_t CONNECT_TIMEOUT_MS = 30000;
+    
+    static void handleWebRequest(WiFiClient& client);
 };
 
 } // namespace Network
@@ -1,21 +1,36 @@
 #include "rtos/queues.h"
+#include "rtos/static_objects.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
 
 namespace BITS {
 namespace RTOS {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
 // Queue handles
 QueueHandle_t sensorQueue = nullptr;
 QueueHandle_t audioQueue = nullptr;
 QueueHandle_t aiQueue = nullptr;
 QueueHandle_t networkQueue = nullptr;
 
+// Queue storage
+static QueueStorage<QUEUE_SIZE_SENSOR, SensorEvent> sensorQueueStorage;
+static QueueStorage<QUEUE_SIZE_AUDIO, AudioCommand> audioQueueStorage;
+static QueueStorage<QUEUE_SIZE_AI, AIResult> aiQueueStorage;
+static QueueStorage<QUEUE_SIZE_NETWORK, NetworkMessage> networkQueueStorage;
+
 // Create all queues
 void createQueues() {
-    sensorQueue = xQueueCreate(QUEUE_SIZE_SENSOR, sizeof(SensorEvent));
-    audioQueue = xQueueCreate(QUEUE_SIZE_AUDIO, sizeof(AudioCommand));
-    aiQueue = xQueueCreate(QUEUE_SIZE_AI, sizeof(AIResult));
-    networkQueue = xQueueCreate(QUEUE_SIZE_NETWORK, sizeof(NetworkMessage));
+    sensorQueue = sensorQueueStorage.create();
+    audioQueue = audioQueueStorage.create();
+    aiQueue = aiQueueStorage.create();
+    networkQueue = networkQueueStorage.create();
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "queues",
+                          sensorQueueStorage.BYTES + audioQueueStorage.BYTES +
+                          aiQueueStorage.BYTES + networkQueueStorage.BYTES);
     
     if (sensorQueue && audioQueue && aiQueue && networkQueue) {
         Logger::info("All RTOS queues created");
@@ -1,9 +1,15 @@
 #include "rtos/semaphores.h"
+#include "rtos/static_objects.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
 
 namespace BITS {
 namespace RTOS {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
 // Semaphore handles
 SemaphoreHandle_t audioMutex = nullptr;
 SemaphoreHandle_t sensorMutex = nullptr;
@@ -16,19 +22,30 @@ SemaphoreHandle_t sensorDataReady = nullptr;
 SemaphoreHandle_t audioBufferReady = nullptr;
 SemaphoreHandle_t aiInferenceReady = nullptr;
 
+// Semaphore storage
+static SemaphoreStorage audioMutexStorage;
+static SemaphoreStorage sensorMutexStorage;
+static SemaphoreStorage aiMutexStorage;
+static SemaphoreStorage configMutexStorage;
+static SemaphoreStorage i2cMutexStorage;
+static SemaphoreStorage sensorDataReadyStorage;
+static SemaphoreStorage audioBufferReadyStorage;
+static SemaphoreStorage aiInferenceReadyStorage;
+
 // Create all semaphores
 void createSemaphores() {
     // Mutexes
-    audioMutex = xSemaphoreCreateMutex();
-    sensorMutex = xSemaphoreCreateMutex();
-    aiMutex = xSemaphoreCreateMutex();
-    configMutex = xSemaphoreCreateMutex();
-    i2cMutex = xSemaphoreCreateMutex();
+    audioMutex = audioMutexStorage.createMutex();
+    sensorMutex = sensorMutexStorage.createMutex();
+    aiMutex = aiMutexStorage.createMutex();
+    configMutex = configMutexStorage.createMutex();
+    i2cMutex = i2cMutexStorage.createMutex();
     
     // Binary semaphores
-    sensorDataReady = xSemaphoreCreateBinary();
-    audioBufferReady = xSemaphoreCreateBinary();
-    aiInferenceReady = xSemaphoreCreateBinary();
+    sensorDataReady = sensorDataReadyStorage.createBinary();
+    audioBufferReady = audioBufferReadyStorage.createBinary();
+    aiInferenceReady = aiInferenceReadyStorage.createBinary();
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "semaphores", 8 * SemaphoreStorage::BYTES);
     
     if (audioMutex && sensorMutex && aiMutex && configMutex && i2cMutex &&
         sensorDataReady && audioBufferReady && aiInferenceReady) {
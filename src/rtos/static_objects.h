@@ -0,0 +1,109 @@
+#ifndef BITS_RTOS_STATIC_OBJECTS_H
+#define BITS_RTOS_STATIC_OBJECTS_H
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <timers.h>
+#include "config.h"
+
+namespace BITS {
+namespace RTOS {
+
+// Backing memory for RTOS objects. With BITS_STATIC_ALLOCATION the objects
+// are created with the *CreateStatic APIs inside this storage; otherwise
+// they come from the FreeRTOS heap and the storage is empty. BYTES is the
+// memory the object costs either way, for the memory budget.
+
+template <uint32_t StackDepth>
+class TaskStorage {
+public:
+    static constexpr size_t BYTES = StackDepth * sizeof(StackType_t) + sizeof(StaticTask_t);
+
+    BaseType_t create(TaskFunction_t function, const char* name, void* parameters,
+                      UBaseType_t priority, TaskHandle_t* handle) {
+#if BITS_STATIC_ALLOCATION
+        *handle = xTaskCreateStatic(function, name, StackDepth, parameters, priority, stack, &control);
+        return *handle != nullptr ? pdPASS : pdFAIL;
+#else
+        return xTaskCreate(function, name, StackDepth, parameters, priority, handle);
+#endif
+    }
+
+private:
+#if BITS_STATIC_ALLOCATION
+    StackType_t stack[StackDepth];
+    StaticTask_t control;
+#endif
+};
+
+template <UBaseType_t Length, typename Item>
+class QueueStorage {
+public:
+    static constexpr size_t BYTES = Length * sizeof(Item) + sizeof(StaticQueue_t);
+
+    QueueHandle_t create() {
+#if BITS_STATIC_ALLOCATION
+        return xQueueCreateStatic(Length, sizeof(Item), items, &control);
+#else
+        return xQueueCreate(Length, sizeof(Item));
+#endif
+    }
+
+private:
+#if BITS_STATIC_ALLOCATION
+    uint8_t items[Length * sizeof(Item)];
+    StaticQueue_t control;
+#endif
+};
+
+class SemaphoreStorage {
+public:
+    static constexpr size_t BYTES = sizeof(StaticSemaphore_t);
+
+    SemaphoreHandle_t createMutex() {
+#if BITS_STATIC_ALLOCATION
+        return xSemaphoreCreateMutexStatic(&control);
+#else
+        return xSemaphoreCreateMutex();
+#endif
+    }
+
+    SemaphoreHandle_t createBinary() {
+#if BITS_STATIC_ALLOCATION
+        return xSemaphoreCreateBinaryStatic(&control);
+#else
+        return xSemaphoreCreateBinary();
+#endif
+    }
+
+private:
+#if BITS_STATIC_ALLOCATION
+    StaticSemaphore_t control;
+#endif
+};
+
+class TimerStorage {
+public:
+    static constexpr size_t BYTES = sizeof(StaticTimer_t);
+
+    TimerHandle_t create(const char* name, TickType_t period, UBaseType_t autoReload, void* id,
+                         TimerCallbackFunction_t callback) {
+#if BITS_STATIC_ALLOCATION
+        return xTimerCreateStatic(name, period, autoReload, id, callback, &control);
+#else
+        return xTimerCreate(name, period, autoReload, id, callback);
+#endif
+    }
+
+private:
+#if BITS_STATIC_ALLOCATION
+    StaticTimer_t control;
+#endif
+};
+
+} // namespace RTOS
+} // namespace BITS
+
+#endif // BITS_RTOS_STATIC_OBJECTS_H
@@ -1,160 +1,333 @@
 #include "rtos/tasks.h"
+#include "rtos/static_objects.h"
+#include "rtos/semaphores.h"
 #include "core/task_manager.h"
+#include "core/schedule_manager.h"
 #include "sensors/sensor_manager.h"
 #include "audio/audio_manager.h"
 #include "ai/ai_engine.h"
 #include "network/wifi_manager.h"
 #include "network/bluetooth_manager.h"
+#include "instruments/base_instrument.h"
 #include "core/watchdog.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
+#include <Arduino.h>
+#include <atomic>
 
 namespace BITS {
 namespace RTOS {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+using Core::Watchdog;
+using Core::TaskManager;
+using Core::TaskId;
+using Core::TaskSchedule;
+using Core::ScheduleManager;
+using Sensors::SensorManager;
+using Audio::AudioManager;
+using AI::AIEngine;
+using Network::WiFiManager;
+using Network::BluetoothManager;
+
 // Task handles
 TaskHandle_t sensorTaskHandle = nullptr;
 TaskHandle_t audioTaskHandle = nullptr;
 TaskHandle_t aiTaskHandle = nullptr;
 TaskHandle_t networkTaskHandle = nullptr;
 TaskHandle_t systemTaskHandle = nullptr;
+TaskHandle_t logTaskHandle = nullptr;
+
+namespace {
+
+volatile bool eventDriven = RTOS_EVENT_DRIVEN_TASKS;
+Instruments::BaseInstrument* volatile activeInstrument = nullptr;
+// Set by the calibration timer, cleared by the system task's EEPROM write
+std::atomic<bool> calibrationSaveDue{false};
+
+const TickType_t IDLE_WAKEUP = pdMS_TO_TICKS(RTOS_IDLE_WAKEUP_MS);
+const uint32_t TICK_US = 1000000 / configTICK_RATE_HZ;
+
+// Paces the sensor task when its period is shorter than a tick
+IntervalTimer sensorSampleTimer;
+
+// Runs one task's loop at its scheduled period, or event-driven (see
+// tasks.h). Mode and schedule changes take effect at the next activation.
+class TaskPacer {
+public:
+    TaskPacer(TaskId id, IntervalTimer* sampleTimer = nullptr)
+        : id(id), sampleTimer(sampleTimer), eventMode(eventDriven), lastWakeTime(xTaskGetTickCount()) {
+        configure();
+    }
+    
+    void begin() {
+        if (eventMode != eventDriven || generation != ScheduleManager::getGeneration()) {
+            eventMode = eventDriven;
+            configure();
+            lastWakeTime = xTaskGetTickCount();
+        }
+        if (eventMode) {
+            lastWakeTime = xTaskGetTickCount();
+        }
+        TaskManager::beginActivation(id);
+    }
+    
+    void end() {
+        TaskManager::endActivation(id);
+    }
+    
+    // Scheduled period in ticks, 0 when paced by the sample timer
+    TickType_t getPeriod() const {
+        return timerPaced ? 0 : period;
+    }
+    
+    // Fixed mode: sleeps until the next period. Event-driven mode: sleeps
+    // until `wakeup` is given (the task notification if nullptr) or until
+    // `timeout` after the start of this activation. Timer-paced: sleeps
+    // until the next sample timer interrupt in either mode.
+    void sleep(SemaphoreHandle_t wakeup, TickType_t timeout) {
+        if (timerPaced) {
+            ulTaskNotifyTake(pdTRUE, timeout > 0 ? timeout : 1);
+            return;
+        }
+        if (!eventMode) {
+            vTaskDelayUntil(&lastWakeTime, period);
+            return;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - lastWakeTime;
+        TickType_t remaining = elapsed < timeout ? timeout - elapsed : 0;
+        if (wakeup != nullptr) {
+            xSemaphoreTake(wakeup, remaining);
+        } else {
+            ulTaskNotifyTake(pdTRUE, remaining);
+        }
+    }
+
+private:
+    TaskId id;
+    IntervalTimer* sampleTimer;
+    uint32_t generation;
+    TickType_t period;
+    bool timerPaced;
+    bool eventMode;
+    TickType_t lastWakeTime;
+    
+    void configure() {
+        generation = ScheduleManager::getGeneration();
+        TaskSchedule schedule = ScheduleManager::getTaskSchedule(id);
+        vTaskPrioritySet(nullptr, schedule.priority);
+        period = schedule.periodUs / TICK_US;
+        timerPaced = sampleTimer != nullptr && schedule.periodUs % TICK_US != 0;
+        if (sampleTimer != nullptr) {
+            if (timerPaced) {
+                sampleTimer->begin(wakeSensorTaskFromISR, schedule.periodUs);
+            } else {
+                sampleTimer->end();
+            }
+        }
+        
+        // Deadlines are the periods; check-ins are at most the longest
+        // sleep plus the deadline apart
+        bool periodic = !eventMode || timerPaced;
+        uint32_t longestSleepUs = schedule.periodUs;
+        if (!periodic && longestSleepUs < RTOS_IDLE_WAKEUP_MS * 1000) {
+            longestSleepUs = RTOS_IDLE_WAKEUP_MS * 1000;
+        }
+        TaskManager::registerTaskUs(id, periodic ? schedule.periodUs : 0, schedule.periodUs,
+                                    longestSleepUs + schedule.periodUs + RTOS_CHECKIN_GRACE_MS * 1000,
+                                    schedule.critical);
+    }
+};
 
-// Sensor Task - High priority, polls sensors at 1kHz
+} // namespace
+
+// Sensor Task - Highest priority, polls sensors at 1kHz by default
 void sensorTask(void* parameters) {
-    const TickType_t xFrequency = pdMS_TO_TICKS(1); // 1ms = 1kHz
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    (void)parameters;
+    uint32_t lastIMUWindow = SensorManager::getIMUSampleCount();
     
     Logger::info("Sensor task started");
+    TaskPacer pacer(TaskId::SENSOR, &sensorSampleTimer);
     
     while (true) {
+        pacer.begin();
+        
         // Poll all sensors
-        SensorManager::update();
+        uint8_t changed = SensorManager::update();
         
-        // Yield CPU
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // Trigger changes go to the instrument in the audio task, complete
+        // IMU windows to the AI task
+        if (changed > 0 && sensorDataReady) {
+            xSemaphoreGive(sensorDataReady);
+        }
+        uint32_t imuSamples = SensorManager::getIMUSampleCount();
+        if (imuSamples - lastIMUWindow >= AI_IMU_WINDOW_SAMPLES) {
+            lastIMUWindow = imuSamples;
+            if (aiInferenceReady) {
+                xSemaphoreGive(aiInferenceReady);
+            }
+        }
+        
+        pacer.end();
+        
+        // Analog channels are sampled every period; pin edges wake early
+        pacer.sleep(nullptr, SensorManager::needsPolling() ? pacer.getPeriod() : IDLE_WAKEUP);
     }
 }
 
-// Audio Task - High priority, processes audio samples
+// Audio Task - High priority, processes audio samples every 2ms by default
 void audioTask(void* parameters) {
-    const TickType_t xFrequency = pdMS_TO_TICKS(2); // 2ms for audio processing
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
+    (void)parameters;
     Logger::info("Audio task started");
+    TaskPacer pacer(TaskId::AUDIO);
     
     while (true) {
+        pacer.begin();
+        
+        // Turn pending sensor triggers into notes
+        Instruments::BaseInstrument* instrument = activeInstrument;
+        if (instrument != nullptr) {
+            instrument->update();
+        }
+        
         // Process audio samples
         AudioManager::update();
         
-        // Yield CPU
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        pacer.end();
+        
+        pacer.sleep(sensorDataReady, IDLE_WAKEUP);
     }
 }
 
-// AI Task - Medium priority, runs ML inference
+// AI Task - Medium priority, runs ML inference every 10ms by default
 void aiTask(void* parameters) {
-    const TickType_t xFrequency = pdMS_TO_TICKS(10); // 10ms for AI processing
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
+    (void)parameters;
     Logger::info("AI task started");
+    TaskPacer pacer(TaskId::AI);
     
     while (true) {
+        pacer.begin();
+        
         // Run AI inference
         AIEngine::update();
         
-        // Yield CPU
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        pacer.end();
+        
+        pacer.sleep(aiInferenceReady, IDLE_WAKEUP);
     }
 }
 
-// Network Task - Low priority, handles WiFi/Bluetooth
+// Network Task - Low priority, handles WiFi/Bluetooth every 100ms by default
 void networkTask(void* parameters) {
-    const TickType_t xFrequency = pdMS_TO_TICKS(100); // 100ms for network
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
+    (void)parameters;
     Logger::info("Network task started");
+    TaskPacer pacer(TaskId::NETWORK);
     
     while (true) {
+        pacer.begin();
+        
         // Handle WiFi
         WiFiManager::update();
         
         // Handle Bluetooth
         BluetoothManager::update();
         
-        // Yield CPU
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        pacer.end();
+        
+        // Sockets have no interrupt here, so keep checking at the period
+        pacer.sleep(nullptr, pacer.getPeriod());
     }
 }
 
-// System Task - Low priority, watchdog and health monitoring
+// System Task - Low priority, watchdog and health monitoring every 1s
 void systemTask(void* parameters) {
-    const TickType_t xFrequency = pdMS_TO_TICKS(1000); // 1s for system tasks
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
+    (void)parameters;
     Logger::info("System task started");
+    TaskPacer pacer(TaskId::SYSTEM);
     
     while (true) {
-        // Feed watchdog
+        pacer.begin();
+        
+        // Feed watchdog, unless a critical task has stopped checking in
         Watchdog::feed();
         
         // System health monitoring
         TaskManager::monitorHealth();
         
-        // Yield CPU
+        // EEPROM writes stall for milliseconds, so they wait for this task
+        if (calibrationSaveDue.exchange(false)) {
+            SensorManager::saveCalibration();
+        }
+        
+        pacer.end();
+        
+        // Nothing wakes this task early
+        pacer.sleep(nullptr, pacer.getPeriod());
+    }
+}
+
+// Log Task - Lowest priority, formats and writes deferred log records
+void logTask(void* parameters) {
+    (void)parameters;
+    const TickType_t xFrequency = pdMS_TO_TICKS(LOG_TASK_PERIOD_MS);
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    
+    // From here on, callers only queue records
+    Logger::setDeferred(true);
+    Logger::info("Log task started");
+    
+    while (true) {
+        Logger::process();
+        
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
     }
 }
 
+// Task stacks and control blocks
+static TaskStorage<TASK_STACK_SENSOR> sensorTaskStorage;
+static TaskStorage<TASK_STACK_AUDIO> audioTaskStorage;
+static TaskStorage<TASK_STACK_AI> aiTaskStorage;
+static TaskStorage<TASK_STACK_NETWORK> networkTaskStorage;
+static TaskStorage<TASK_STACK_SYSTEM> systemTaskStorage;
+static TaskStorage<TASK_STACK_LOG> logTaskStorage;
+
 // Create all tasks
 void createTasks() {
-    // Sensor Task (High Priority)
-    xTaskCreate(
-        sensorTask,
-        "SensorTask",
-        TASK_STACK_SENSOR,
-        nullptr,
-        static_cast<UBaseType_t>(TaskPriority::HIGH),
-        &sensorTaskHandle
-    );
+    // Priorities come from the active schedule (rate-monotonic by default)
+    const Core::Schedule& schedule = ScheduleManager::getSchedule();
+    
+    // Sensor Task (Critical Priority)
+    sensorTaskStorage.create(sensorTask, "SensorTask", nullptr,
+                             schedule.tasks[static_cast<uint8_t>(TaskId::SENSOR)].priority, &sensorTaskHandle);
     
     // Audio Task (High Priority)
-    xTaskCreate(
-        audioTask,
-        "AudioTask",
-        TASK_STACK_AUDIO,
-        nullptr,
-        static_cast<UBaseType_t>(TaskPriority::HIGH),
-        &audioTaskHandle
-    );
+    audioTaskStorage.create(audioTask, "AudioTask", nullptr,
+                            schedule.tasks[static_cast<uint8_t>(TaskId::AUDIO)].priority, &audioTaskHandle);
     
     // AI Task (Medium Priority)
-    xTaskCreate(
-        aiTask,
-        "AITask",
-        TASK_STACK_AI,
-        nullptr,
-        static_cast<UBaseType_t>(TaskPriority::MEDIUM),
-        &aiTaskHandle
-    );
+    aiTaskStorage.create(aiTask, "AITask", nullptr,
+                         schedule.tasks[static_cast<uint8_t>(TaskId::AI)].priority, &aiTaskHandle);
     
     // Network Task (Low Priority)
-    xTaskCreate(
-        networkTask,
-        "NetworkTask",
-        TASK_STACK_NETWORK,
-        nullptr,
-        static_cast<UBaseType_t>(TaskPriority::LOW),
-        &networkTaskHandle
-    );
+    networkTaskStorage.create(networkTask, "NetworkTask", nullptr,
+                              schedule.tasks[static_cast<uint8_t>(TaskId::NETWORK)].priority, &networkTaskHandle);
     
     // System Task (Low Priority)
-    xTaskCreate(
-        systemTask,
-        "SystemTask",
-        TASK_STACK_SYSTEM,
-        nullptr,
-        static_cast<UBaseType_t>(TaskPriority::LOW),
-        &systemTaskHandle
-    );
+    systemTaskStorage.create(systemTask, "SystemTask", nullptr,
+                             schedule.tasks[static_cast<uint8_t>(TaskId::SYSTEM)].priority, &systemTaskHandle);
+    
+    // Log Task (Lowest Priority)
+    logTaskStorage.create(logTask, "LogTask", nullptr,
+                          static_cast<UBaseType_t>(TaskPriority::BACKGROUND), &logTaskHandle);
+    
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "sensor task", sensorTaskStorage.BYTES);
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "audio task", audioTaskStorage.BYTES);
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "ai task", aiTaskStorage.BYTES);
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "network task", networkTaskStorage.BYTES);
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "system task", systemTaskStorage.BYTES);
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "log task", logTaskStorage.BYTES);
     
     Logger::info("All RTOS tasks created");
 }
@@ -179,11 +352,54 @@ void resumeTasks() {
 
 // Delete all tasks
 void deleteTasks() {
+    sensorSampleTimer.end();
     if (sensorTaskHandle) vTaskDelete(sensorTaskHandle);
     if (audioTaskHandle) vTaskDelete(audioTaskHandle);
     if (aiTaskHandle) vTaskDelete(aiTaskHandle);
     if (networkTaskHandle) vTaskDelete(networkTaskHandle);
     if (systemTaskHandle) vTaskDelete(systemTaskHandle);
+    
+    // Without the log task, go back to writing messages immediately
+    if (logTaskHandle) vTaskDelete(logTaskHandle);
+    Logger::setDeferred(false);
+}
+
+void setActiveInstrument(Instruments::BaseInstrument* instrument) {
+    activeInstrument = instrument;
+}
+
+void setEventDriven(bool enable) {
+    eventDriven = enable;
+    
+    // Wake every sleeper so it picks up the new mode
+    if (sensorDataReady) xSemaphoreGive(sensorDataReady);
+    if (aiInferenceReady) xSemaphoreGive(aiInferenceReady);
+    if (sensorTaskHandle) xTaskNotifyGive(sensorTaskHandle);
+    if (networkTaskHandle) xTaskNotifyGive(networkTaskHandle);
+    Logger::info("Task wakeups: %s", enable ? "event-driven" : "fixed period");
+}
+
+bool isEventDriven() {
+    return eventDriven;
+}
+
+void wakeSensorTaskFromISR() {
+    if (sensorTaskHandle == nullptr) {
+        return;
+    }
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(sensorTaskHandle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+void requestCalibrationSave() {
+    calibrationSaveDue = true;
+}
+
+void wakeNetworkTask() {
+    if (networkTaskHandle) {
+        xTaskNotifyGive(networkTaskHandle);
+    }
 }
 
 } // namespace RTOS
@@ -5,13 +5,17 @@
 #include <task.h>
 
 namespace BITS {
+namespace Instruments {
+class BaseInstrument;
+}
+
 namespace RTOS {
 
 // Task priorities
 enum class TaskPriority {
-    LOW = 1,
+    BACKGROUND = 1,
     MEDIUM = 2,
-    HIGH = 3,
+    REALTIME = 3,
     CRITICAL = 4
 };
 
@@ -21,6 +25,18 @@ constexpr uint32_t TASK_STACK_AUDIO = 2048;       // 8KB
 constexpr uint32_t TASK_STACK_AI = 4096;          // 16KB
 constexpr uint32_t TASK_STACK_NETWORK = 1536;     // 6KB
 constexpr uint32_t TASK_STACK_SYSTEM = 512;       // 2KB
+constexpr uint32_t TASK_STACK_LOG = 1024;         // 4KB
+constexpr uint32_t TASK_STACK_BOOT = 1536;        // 6KB, background boot stages
+
+// Default task periods, each also the task's deadline. Periods and
+// priorities can be changed from config through Core::ScheduleManager.
+// The sensor task runs off a sample timer when its period is shorter than
+// a tick; every other period must be a whole number of ticks.
+constexpr uint32_t TASK_PERIOD_SENSOR_US = 1000;
+constexpr uint32_t TASK_PERIOD_AUDIO_US = 2000;
+constexpr uint32_t TASK_PERIOD_AI_US = 10000;
+constexpr uint32_t TASK_PERIOD_NETWORK_US = 100000;
+constexpr uint32_t TASK_PERIOD_SYSTEM_US = 1000000;
 
 // Task handles
 extern TaskHandle_t sensorTaskHandle;
@@ -28,6 +44,7 @@ extern TaskHandle_t audioTaskHandle;
 extern TaskHandle_t aiTaskHandle;
 extern TaskHandle_t networkTaskHandle;
 extern TaskHandle_t systemTaskHandle;
+extern TaskHandle_t logTaskHandle;
 
 // Task function prototypes
 void sensorTask(void* parameters);
@@ -35,6 +52,7 @@ void audioTask(void* parameters);
 void aiTask(void* parameters);
 void networkTask(void* parameters);
 void systemTask(void* parameters);
+void logTask(void* parameters);
 
 // Task management
 void createTasks();
@@ -42,6 +60,23 @@ void suspendTasks();
 void resumeTasks();
 void deleteTasks();
 
+// Instrument driven by the audio task; nullptr for none
+void setActiveInstrument(Instruments::BaseInstrument* instrument);
+
+// Wakeups (RTOS_EVENT_DRIVEN_TASKS). In event-driven mode the sensor task
+// sleeps until a pin edge or its next poll of analog channels, the audio
+// task until a trigger changes state (sensorDataReady), the AI task until
+// an IMU window is complete (aiInferenceReady) and the network task until
+// woken or its period passes. Otherwise every task runs at a fixed period.
+void setEventDriven(bool enable);
+bool isEventDriven();
+void wakeSensorTaskFromISR();       // Pin edge or conversion complete
+void wakeNetworkTask();             // Outgoing message queued
+
+// Has the system task write changed calibration profiles to EEPROM at its
+// next activation (within TASK_PERIOD_SYSTEM_US)
+void requestCalibrationSave();
+
 } // namespace RTOS
 } // namespace BITS
 
@@ -1,35 +1,41 @@
 #include "rtos/timers.h"
+#include "rtos/static_objects.h"
+#include "rtos/tasks.h"
 #include "core/logger.h"
-#include "core/watchdog.h"
-#include "sensors/sensor_manager.h"
+#include "core/memory_budget.h"
 
 namespace BITS {
 namespace RTOS {
 
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
 // Timer handles
 TimerHandle_t heartbeatTimer = nullptr;
-TimerHandle_t watchdogTimer = nullptr;
 TimerHandle_t calibrationTimer = nullptr;
 
+// Timer storage
+static TimerStorage heartbeatTimerStorage;
+static TimerStorage calibrationTimerStorage;
+
 // Heartbeat timer callback
 void heartbeatTimerCallback(TimerHandle_t xTimer) {
+    (void)xTimer;
     Logger::info("System heartbeat");
     // Can be used for system health monitoring
 }
 
-// Watchdog timer callback
-void watchdogTimerCallback(TimerHandle_t xTimer) {
-    Watchdog::feed();
-}
-
-// Calibration timer callback
+// Calibration timer callback: only flags the save, which the system task
+// carries out, so no EEPROM write holds up the timer daemon
 void calibrationTimerCallback(TimerHandle_t xTimer) {
-    SensorManager::calibrate();
+    (void)xTimer;
+    requestCalibrationSave();
 }
 
 // Create all timers
 void createTimers() {
-    heartbeatTimer = xTimerCreate(
+    heartbeatTimer = heartbeatTimerStorage.create(
         "Heartbeat",
         pdMS_TO_TICKS(TIMER_PERIOD_HEARTBEAT),
         pdTRUE,  // Auto-reload
@@ -37,25 +43,18 @@ void createTimers() {
         heartbeatTimerCallback
     );
     
-    watchdogTimer = xTimerCreate(
-        "Watchdog",
-        pdMS_TO_TICKS(TIMER_PERIOD_WATCHDOG),
-        pdTRUE,  // Auto-reload
-        nullptr,
-        watchdogTimerCallback
-    );
-    
-    calibrationTimer = xTimerCreate(
+    calibrationTimer = calibrationTimerStorage.create(
         "Calibration",
         pdMS_TO_TICKS(TIMER_PERIOD_CALIBRATION),
         pdTRUE,  // Auto-reload
         nullptr,
         calibrationTimerCallback
     );
+    MemoryBudget::reserve(MemorySubsystem::RTOS, "timers", 2 * TimerStorage::BYTES);
     
-    if (heartbeatTimer && watchdogTimer && calibrationTimer) {
+    if (heartbeatTimer && calibrationTimer) {
         xTimerStart(heartbeatTimer, 0);
-        xTimerStart(watchdogTimer, 0);
+        xTimerStart(calibrationTimer, 0);
         Logger::info("All RTOS timers created");
     } else {
         Logger::error("Failed to create RTOS timers");
@@ -65,7 +64,6 @@ void createTimers() {
 // Delete all timers
 void deleteTimers() {
     if (heartbeatTimer) xTimerDelete(heartbeatTimer, 0);
-    if (watchdogTimer) xTimerDelete(watchdogTimer, 0);
     if (calibrationTimer) xTimerDelete(calibrationTimer, 0);
 }
 
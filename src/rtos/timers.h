@@ -9,17 +9,14 @@ namespace RTOS {
 
 // Timer periods (in milliseconds)
 constexpr uint32_t TIMER_PERIOD_HEARTBEAT = 5000;    // 5 seconds
-constexpr uint32_t TIMER_PERIOD_WATCHDOG = 1000;      // 1 second
 constexpr uint32_t TIMER_PERIOD_CALIBRATION = 10000;  // 10 seconds
 
 // Timer handles
 extern TimerHandle_t heartbeatTimer;
-extern TimerHandle_t watchdogTimer;
 extern TimerHandle_t calibrationTimer;
 
 // Timer callback functions
 void heartbeatTimerCallback(TimerHandle_t xTimer);
-void watchdogTimerCallback(TimerHandle_t xTimer);
 void calibrationTimerCallback(TimerHandle_t xTimer);
 
 // Timer management
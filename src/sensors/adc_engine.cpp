@@ -0,0 +1,422 @@
+#include "sensors/adc_engine.h"
+#include "core/logger.h"
+#include "core/memory_budget.h"
+#include <Arduino.h>
+#include <string.h>
+#ifndef BITS_HOST_BUILD
+#include <DMAChannel.h>
+#endif
+
+namespace BITS {
+namespace Sensors {
+
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+static_assert((ADC_RING_SAMPLES & (ADC_RING_SAMPLES - 1)) == 0, "ADC ring size must be a power of two");
+static_assert(ADC_RING_SAMPLES <= 255, "ADC blocks are counted in uint8_t");
+
+namespace {
+
+constexpr uint32_t SCAN_PERIOD_US = 1000000 / ADC_SCAN_RATE_HZ;
+
+// Readings of the scan in progress, indexed by channel id
+uint16_t scanReadings[MAX_SENSORS];
+
+#ifdef BITS_HOST_BUILD
+// The host has no ADC_ETC: a timer converts the channels in software and
+// publishes each scan itself
+IntervalTimer scanTimer;
+#else
+// QTIMER4 timer 0 toggles at twice the scan rate; each rising edge goes
+// through XBAR1 to the ADC_ETC, which runs one conversion chain per ADC.
+// The chain that finishes last requests DMA: one channel copies ADC1's
+// results, a linked one ADC2's, and its completion interrupt publishes
+// the scan. No CPU time is spent waiting on a conversion.
+constexpr uint8_t ADCS = 2;
+constexpr uint8_t CHAIN_LENGTH = 8;         // Segments per trigger, one per HC register
+constexpr uint8_t NO_INPUT = 0xFF;
+// 10-bit, hardware averaging off, with margin
+constexpr uint32_t CONVERSION_NS = 3000;
+
+// ADC_ETC: trigger 0 drives ADC1, trigger 4 ADC2
+constexpr uint8_t TRIGGERS[ADCS] = {0, 4};
+constexpr uint32_t ETC_CTRL_TSC_BYPASS = 1UL << 30;
+constexpr uint32_t ETC_CTRL_SOFTRST = 1UL << 31;
+constexpr uint32_t ETC_TRIG_CHAIN_SHIFT = 8;
+constexpr uint32_t ETC_CHAIN_HWTS_SHIFT = 4;
+constexpr uint32_t ETC_CHAIN_B2B = 1UL << 12;
+// Lets ADC1 finish first when both chains are the same length
+constexpr uint32_t ETC_ADC2_INIT_DELAY = 4;
+// ADC: hardware trigger, averaging, HC input taken from the ADC_ETC
+constexpr uint32_t ADC_CFG_HW_TRIGGER = 1UL << 13;
+constexpr uint32_t ADC_GC_AVERAGE = 1UL << 5;
+constexpr uint32_t ADC_HC_FROM_ETC = 16;
+// QTIMER4: count the IP bus clock up to COMP1, reload, toggle the output
+constexpr uint16_t TMR_CTRL_COUNT_RISING = 1U << 13;
+constexpr uint16_t TMR_CTRL_IP_BUS_CLOCK = 8U << 9;
+constexpr uint16_t TMR_CTRL_LENGTH = 1U << 5;
+constexpr uint16_t TMR_CTRL_TOGGLE = 3U;
+
+// Teensy 4.x analog pins and their ADC inputs
+struct AnalogInput {
+    uint8_t pin;
+    uint8_t inputs[ADCS];
+};
+const AnalogInput ANALOG_INPUTS[] = {
+    {14, {7, 7}}, {15, {8, 8}}, {16, {12, 12}}, {17, {11, 11}}, {18, {6, 6}}, {19, {5, 5}},
+    {20, {15, 15}}, {21, {0, 0}}, {22, {13, 13}}, {23, {14, 14}}, {24, {1, NO_INPUT}},
+    {25, {2, NO_INPUT}}, {26, {NO_INPUT, 3}}, {27, {NO_INPUT, 4}}, {38, {NO_INPUT, 1}},
+    {39, {NO_INPUT, 2}}, {40, {9, 9}}, {41, {10, 10}},
+};
+
+// Channel ids and ADC inputs by chain segment; written with interrupts
+// off, read by the DMA completion interrupt
+struct Chains {
+    uint8_t ids[ADCS][CHAIN_LENGTH];
+    uint8_t inputs[ADCS][CHAIN_LENGTH];
+    uint8_t lengths[ADCS];
+};
+Chains chains;
+uint32_t results[ADCS][CHAIN_LENGTH / 2];   // ADC_ETC result registers, two readings a word
+DMAChannel resultCopies[ADCS];
+
+const AnalogInput* analogInput(uint8_t pin) {
+    for (const AnalogInput& input : ANALOG_INPUTS) {
+        if (input.pin == pin) {
+            return &input;
+        }
+    }
+    return nullptr;
+}
+
+// Pins that only one ADC reaches go first, the rest to the shorter chain
+bool planChains(const uint32_t* bits, const uint8_t* pins, Chains& plan) {
+    memset(&plan, 0, sizeof(plan));
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint8_t id = 0; id < MAX_SENSORS; id++) {
+            if (!(bits[id / 32] & (1UL << (id & 31)))) {
+                continue;
+            }
+            const AnalogInput* input = analogInput(pins[id]);
+            if (!input) {
+                return false;
+            }
+            bool both = input->inputs[0] != NO_INPUT && input->inputs[1] != NO_INPUT;
+            if (both != (pass == 1)) {
+                continue;
+            }
+            uint8_t adc = input->inputs[0] == NO_INPUT ? 1 : 0;
+            if (both && plan.lengths[1] < plan.lengths[0]) {
+                adc = 1;
+            }
+            if (plan.lengths[adc] == CHAIN_LENGTH) {
+                return false;
+            }
+            plan.ids[adc][plan.lengths[adc]] = id;
+            plan.inputs[adc][plan.lengths[adc]] = input->inputs[adc];
+            plan.lengths[adc]++;
+        }
+    }
+    return true;
+}
+
+uint32_t scanNs(const Chains& plan) {
+    uint8_t longest = plan.lengths[0] > plan.lengths[1] ? plan.lengths[0] : plan.lengths[1];
+    return longest * CONVERSION_NS;
+}
+
+volatile uint32_t& adcConfig(uint8_t adc) {
+    return adc == 0 ? ADC1_CFG : ADC2_CFG;
+}
+
+volatile uint32_t& adcControl(uint8_t adc) {
+    return adc == 0 ? ADC1_GC : ADC2_GC;
+}
+
+volatile uint32_t* adcChannels(uint8_t adc) {
+    return adc == 0 ? &ADC1_HC0 : &ADC2_HC0;
+}
+
+void connectXbar(uint32_t input, uint32_t output) {
+    volatile uint16_t* select = &XBARA1_SEL0 + output / 2;
+    if (output & 1) {
+        *select = (*select & 0x00FF) | (input << 8);
+    } else {
+        *select = (*select & 0xFF00) | input;
+    }
+}
+
+// Chain segments and the DMA request source; a trigger arriving meanwhile
+// is ignored, so at most one scan is lost
+void applyChains(const Chains& plan) {
+    __disable_irq();
+    chains = plan;
+    uint32_t enabled = 0;
+    for (uint8_t adc = 0; adc < ADCS; adc++) {
+        auto& trigger = IMXRT_ADC_ETC.TRIG[TRIGGERS[adc]];
+        uint8_t length = plan.lengths[adc];
+        if (length == 0) {
+            continue;
+        }
+        uint32_t segments[CHAIN_LENGTH / 2] = {};
+        for (uint8_t s = 0; s < length; s++) {
+            uint32_t segment = plan.inputs[adc][s] | (1UL << (ETC_CHAIN_HWTS_SHIFT + s)) | ETC_CHAIN_B2B;
+            segments[s / 2] |= segment << (16 * (s & 1));
+            adcChannels(adc)[s] = ADC_HC_FROM_ETC;
+        }
+        trigger.CHAIN_1_0 = segments[0];
+        trigger.CHAIN_3_2 = segments[1];
+        trigger.CHAIN_5_4 = segments[2];
+        trigger.CHAIN_7_6 = segments[3];
+        trigger.COUNTER = adc == 1 ? ETC_ADC2_INIT_DELAY : 0;
+        trigger.CTRL = static_cast<uint32_t>(length - 1) << ETC_TRIG_CHAIN_SHIFT;
+        enabled |= 1UL << TRIGGERS[adc];
+    }
+    uint8_t last = plan.lengths[1] >= plan.lengths[0] && plan.lengths[1] > 0 ? TRIGGERS[1] : TRIGGERS[0];
+    ADC_ETC_DMA_CTRL = enabled ? 1UL << last : 0;
+    ADC_ETC_CTRL = ETC_CTRL_TSC_BYPASS | enabled;
+    __enable_irq();
+}
+
+void startHardware(void (*scanDone)()) {
+    CCM_CCGR2 |= CCM_CCGR2_XBAR1(CCM_CCGR_ON);
+    CCM_CCGR6 |= CCM_CCGR6_QTIMER4(CCM_CCGR_ON);
+    for (uint8_t adc = 0; adc < ADCS; adc++) {
+        adcControl(adc) &= ~ADC_GC_AVERAGE;
+        adcConfig(adc) |= ADC_CFG_HW_TRIGGER;
+    }
+    ADC_ETC_CTRL = ETC_CTRL_SOFTRST;
+    ADC_ETC_CTRL = ETC_CTRL_TSC_BYPASS;
+    connectXbar(XBARA1_IN_QTIMER4_TIMER0, XBARA1_OUT_ADC_ETC_TRIG00);
+    connectXbar(XBARA1_IN_QTIMER4_TIMER0, XBARA1_OUT_ADC_ETC_TRIG10);
+    
+    // Each ADC_ETC request copies both chains' results in one go
+    for (uint8_t adc = 0; adc < ADCS; adc++) {
+        DMAChannel& copy = resultCopies[adc];
+        copy.begin();
+        copy.sourceBuffer(&IMXRT_ADC_ETC.TRIG[TRIGGERS[adc]].RESULT_1_0, sizeof(results[adc]));
+        copy.destinationBuffer(results[adc], sizeof(results[adc]));
+        copy.TCD->NBYTES = sizeof(results[adc]);
+        copy.transferCount(1);
+    }
+    resultCopies[0].triggerAtHardwareEvent(DMAMUX_SOURCE_ADC_ETC);
+    resultCopies[1].triggerAtCompletionOf(resultCopies[0]);
+    resultCopies[1].interruptAtCompletion();
+    resultCopies[1].attachInterrupt(scanDone);
+    resultCopies[1].enable();
+    resultCopies[0].enable();
+    
+    uint16_t toggleCounts = static_cast<uint16_t>(F_BUS_ACTUAL / (2 * ADC_SCAN_RATE_HZ));
+    TMR4_ENBL &= ~1;
+    TMR4_CNTR0 = 0;
+    TMR4_LOAD0 = 0;
+    TMR4_COMP10 = toggleCounts - 1;
+    TMR4_CMPLD10 = toggleCounts - 1;
+    TMR4_CTRL0 = TMR_CTRL_COUNT_RISING | TMR_CTRL_IP_BUS_CLOCK | TMR_CTRL_LENGTH | TMR_CTRL_TOGGLE;
+    TMR4_ENBL |= 1;
+}
+
+// analogRead() needs the ADCs software-triggered again
+void stopHardware() {
+    TMR4_CTRL0 = 0;
+    ADC_ETC_CTRL = ETC_CTRL_TSC_BYPASS;
+    ADC_ETC_DMA_CTRL = 0;
+    for (uint8_t adc = 0; adc < ADCS; adc++) {
+        resultCopies[adc].disable();
+        adcConfig(adc) &= ~ADC_CFG_HW_TRIGGER;
+    }
+}
+#endif
+
+} // namespace
+
+uint16_t AdcEngine::rings[MAX_SENSORS][ADC_RING_SAMPLES];
+uint8_t AdcEngine::pins[MAX_SENSORS];
+uint32_t AdcEngine::firstScan[MAX_SENSORS];
+uint32_t AdcEngine::scanMicros[ADC_RING_SAMPLES];
+std::atomic<uint32_t> AdcEngine::channelBits[WORDS];
+std::atomic<uint32_t> AdcEngine::scanCount{0};
+uint32_t AdcEngine::overruns = 0;
+bool AdcEngine::running = false;
+
+void AdcEngine::init() {
+    for (uint8_t w = 0; w < WORDS; w++) {
+        channelBits[w].store(0, std::memory_order_relaxed);
+    }
+    scanCount.store(0, std::memory_order_relaxed);
+    overruns = 0;
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "adc rings", sizeof(rings) + sizeof(scanReadings) + sizeof(scanMicros));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "adc channels", sizeof(pins) + sizeof(firstScan));
+#ifndef BITS_HOST_BUILD
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "adc chains", sizeof(chains) + sizeof(results));
+#endif
+    Logger::info("ADC engine initialized (%d Hz scans, %d-reading rings)", ADC_SCAN_RATE_HZ, ADC_RING_SAMPLES);
+}
+
+bool AdcEngine::start() {
+    if (running) {
+        return true;
+    }
+#ifdef BITS_HOST_BUILD
+    if (!scanTimer.begin(scanISR, SCAN_PERIOD_US)) {
+        Logger::error("ADC scan timer unavailable");
+        return false;
+    }
+#else
+    startHardware(scanISR);
+    Chains plan;
+    uint32_t bits[WORDS];
+    loadChannelBits(bits);
+    planChains(bits, pins, plan);
+    applyChains(plan);
+#endif
+    running = true;
+    return true;
+}
+
+void AdcEngine::stop() {
+#ifdef BITS_HOST_BUILD
+    scanTimer.end();
+#else
+    stopHardware();
+#endif
+    running = false;
+}
+
+bool AdcEngine::isRunning() {
+    return running;
+}
+
+bool AdcEngine::addChannel(uint8_t id, uint8_t gpio) {
+    if (id >= MAX_SENSORS) {
+        return false;
+    }
+#ifndef BITS_HOST_BUILD
+    // The channel must fit a chain, and the chains a scan period
+    uint32_t bits[WORDS];
+    loadChannelBits(bits);
+    bits[id / 32] |= 1UL << (id & 31);
+    uint8_t pin = pins[id];
+    pins[id] = gpio;
+    Chains plan;
+    if (!planChains(bits, pins, plan) || scanNs(plan) > SCAN_PERIOD_US * 1000) {
+        pins[id] = pin;
+        Logger::error("ADC scan has no room for sensor %d on pin %d", id, gpio);
+        return false;
+    }
+#endif
+    // The scan in progress may already have passed this channel
+    pins[id] = gpio;
+    firstScan[id] = scanCount.load(std::memory_order_acquire) + 1;
+    channelBits[id / 32].fetch_or(1UL << (id & 31), std::memory_order_release);
+#ifndef BITS_HOST_BUILD
+    if (running) {
+        applyChains(plan);
+    }
+#endif
+    return true;
+}
+
+void AdcEngine::removeChannel(uint8_t id) {
+    if (id >= MAX_SENSORS) {
+        return;
+    }
+    channelBits[id / 32].fetch_and(~(1UL << (id & 31)), std::memory_order_release);
+#ifndef BITS_HOST_BUILD
+    if (running) {
+        uint32_t bits[WORDS];
+        loadChannelBits(bits);
+        Chains plan;
+        planChains(bits, pins, plan);
+        applyChains(plan);
+    }
+#endif
+}
+
+void AdcEngine::completeScan(const uint16_t* readings) {
+    uint32_t scan = scanCount.load(std::memory_order_relaxed);
+    uint32_t slot = scan & RING_MASK;
+    for (uint8_t w = 0; w < WORDS; w++) {
+        uint32_t bits = channelBits[w].load(std::memory_order_acquire);
+        while (bits) {
+            uint8_t id = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            rings[id][slot] = readings[id];
+        }
+    }
+    scanMicros[slot] = micros();
+    scanCount.store(scan + 1, std::memory_order_release);
+}
+
+uint32_t AdcEngine::getScanCount() {
+    return scanCount.load(std::memory_order_acquire);
+}
+
+uint32_t AdcEngine::getScanMicros(uint32_t scan) {
+    return scanMicros[scan & RING_MASK];
+}
+
+uint8_t AdcEngine::readBlock(uint8_t id, uint32_t fromScan, uint32_t toScan, uint16_t* out) {
+    if (id >= MAX_SENSORS) {
+        return 0;
+    }
+    if (static_cast<int32_t>(firstScan[id] - fromScan) > 0) {
+        fromScan = firstScan[id];
+    }
+    if (static_cast<int32_t>(toScan - fromScan) <= 0) {
+        return 0;
+    }
+    
+    // The slot of scan toScan is being written, so one fewer than the ring
+    // size is safe to read
+    uint32_t available = toScan - fromScan;
+    if (available > ADC_RING_SAMPLES - 1) {
+        overruns += available - (ADC_RING_SAMPLES - 1);
+        fromScan = toScan - (ADC_RING_SAMPLES - 1);
+        available = ADC_RING_SAMPLES - 1;
+    }
+    const uint16_t* ring = rings[id];
+    for (uint32_t i = 0; i < available; i++) {
+        out[i] = ring[(fromScan + i) & RING_MASK];
+    }
+    return static_cast<uint8_t>(available);
+}
+
+uint32_t AdcEngine::getOverrunCount() {
+    return overruns;
+}
+
+void AdcEngine::loadChannelBits(uint32_t* bits) {
+    for (uint8_t w = 0; w < WORDS; w++) {
+        bits[w] = channelBits[w].load(std::memory_order_relaxed);
+    }
+}
+
+void AdcEngine::scanISR() {
+#ifdef BITS_HOST_BUILD
+    // Convert the active channels back to back, then publish the scan
+    for (uint8_t w = 0; w < WORDS; w++) {
+        uint32_t bits = channelBits[w].load(std::memory_order_acquire);
+        while (bits) {
+            uint8_t id = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            scanReadings[id] = static_cast<uint16_t>(analogRead(pins[id]));
+        }
+    }
+#else
+    // DMA complete: both chains' results are in, segment by segment
+    resultCopies[1].clearInterrupt();
+    for (uint8_t adc = 0; adc < ADCS; adc++) {
+        for (uint8_t s = 0; s < chains.lengths[adc]; s++) {
+            uint32_t word = results[adc][s / 2] >> (16 * (s & 1));
+            scanReadings[chains.ids[adc][s]] = static_cast<uint16_t>(word & 0xFFF);
+        }
+    }
+#endif
+    completeScan(scanReadings);
+}
+
+} // namespace Sensors
+} // namespace BITS
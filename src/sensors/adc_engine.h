@@ -0,0 +1,67 @@
+#ifndef BITS_SENSORS_ADC_ENGINE_H
+#define BITS_SENSORS_ADC_ENGINE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+
+namespace BITS {
+namespace Sensors {
+
+// Continuous acquisition of the analog sensor channels. A timer-triggered
+// scan converts every active channel and appends the readings to
+// per-channel rings; the sensor task reads them back as blocks instead of
+// waiting on conversions itself. On target the ADC_ETC runs the
+// conversions and DMA collects them, so no CPU time goes to waiting; on
+// the host a timer converts in software. completeScan() is the producer
+// side, so any source of complete scans (the DMA completion, the host
+// timer, a test) feeds the same rings.
+class AdcEngine {
+public:
+    static void init();
+    // Begins scanning at ADC_SCAN_RATE_HZ
+    static bool start();
+    static void stop();
+    static bool isRunning();
+    
+    // Channels are numbered like the sensors they belong to. On target a
+    // channel needs an analog pin and room in the conversion chains (8 per
+    // ADC) within a scan period; otherwise it is refused.
+    static bool addChannel(uint8_t id, uint8_t gpio);
+    static void removeChannel(uint8_t id);
+    
+    // Producer: one reading per active channel, indexed by channel id
+    static void completeScan(const uint16_t* readings);
+    
+    // Scans completed so far; a reading is addressed by its scan number
+    static uint32_t getScanCount();
+    // micros() when a scan still in the rings completed
+    static uint32_t getScanMicros(uint32_t scan);
+    // Copies a channel's readings from scans [fromScan, toScan) that are
+    // still in its ring, oldest first; returns how many were copied
+    static uint8_t readBlock(uint8_t id, uint32_t fromScan, uint32_t toScan, uint16_t* out);
+    // Readings overwritten before readBlock() got to them
+    static uint32_t getOverrunCount();
+
+private:
+    static constexpr uint8_t WORDS = MAX_SENSORS / 32;
+    static constexpr uint32_t RING_MASK = ADC_RING_SAMPLES - 1;
+    
+    static uint16_t rings[MAX_SENSORS][ADC_RING_SAMPLES];
+    static uint8_t pins[MAX_SENSORS];
+    static uint32_t firstScan[MAX_SENSORS];     // First scan that includes the channel
+    static uint32_t scanMicros[ADC_RING_SAMPLES];
+    static std::atomic<uint32_t> channelBits[WORDS];
+    static std::atomic<uint32_t> scanCount;
+    static uint32_t overruns;
+    static bool running;
+    
+    static void loadChannelBits(uint32_t* bits);
+    // Publishes a scan: the DMA completion on target, the scan timer on the host
+    static void scanISR();
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_ADC_ENGINE_H
@@ -0,0 +1,219 @@
+#include "sensors/calibration_engine.h"
+#include "core/logger.h"
+#include "core/memory_budget.h"
+#include <math.h>
+#include <string.h>
+
+namespace BITS {
+namespace Sensors {
+
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+static_assert(MAX_IMUS <= 8, "Pending IMUs are tracked in a uint8_t");
+static_assert(CALIBRATION_MIN_SAMPLES >= 2, "A variance needs two samples");
+
+namespace {
+
+// IMU samples copied from a ring at a time, on the sensor task's stack
+constexpr uint8_t IMU_BLOCK = 8;
+
+inline uint32_t bitOf(uint8_t id) {
+    return 1UL << (id & 31);
+}
+
+inline uint8_t takeLowestBit(uint32_t& bits, uint8_t w) {
+    uint8_t id = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+    bits &= bits - 1;
+    return id;
+}
+
+} // namespace
+
+float CalibrationEngine::means[MAX_SENSORS];
+float CalibrationEngine::squares[MAX_SENSORS];
+uint32_t CalibrationEngine::samples[MAX_SENSORS];
+ChannelCalibration CalibrationEngine::results[MAX_SENSORS];
+uint32_t CalibrationEngine::pendingBits[WORDS];
+uint32_t CalibrationEngine::convergedBits[WORDS];
+CalibrationEngine::ImuStats CalibrationEngine::imus[MAX_IMUS];
+uint8_t CalibrationEngine::pendingImus = 0;
+uint8_t CalibrationEngine::calibratedImus = 0;
+uint32_t CalibrationEngine::startMs = 0;
+std::atomic<bool> CalibrationEngine::running{false};
+
+void CalibrationEngine::init() {
+    memset(pendingBits, 0, sizeof(pendingBits));
+    memset(convergedBits, 0, sizeof(convergedBits));
+    pendingImus = 0;
+    calibratedImus = 0;
+    running.store(false, std::memory_order_release);
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "calibration stats",
+                          sizeof(means) + sizeof(squares) + sizeof(samples) + sizeof(results) + sizeof(imus));
+}
+
+void CalibrationEngine::start(const uint32_t* channelBits, uint8_t imuBits, uint32_t nowMs) {
+    for (uint8_t w = 0; w < WORDS; w++) {
+        pendingBits[w] = channelBits[w];
+        convergedBits[w] = 0;
+        uint32_t bits = channelBits[w];
+        while (bits) {
+            uint8_t id = takeLowestBit(bits, w);
+            means[id] = 0.0f;
+            squares[id] = 0.0f;
+            samples[id] = 0;
+        }
+    }
+    pendingImus = 0;
+    calibratedImus = 0;
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        const MPU6050Driver& driver = MPU6050Driver::get(imu);
+        imus[imu] = {};
+        if ((imuBits & (1 << imu)) && driver.isInitialized()) {
+            imus[imu].nextSample = driver.getSampleCount();
+            pendingImus |= 1 << imu;
+        }
+    }
+    startMs = nowMs;
+    running.store(true, std::memory_order_release);
+}
+
+bool CalibrationEngine::isRunning() {
+    return running.load(std::memory_order_acquire);
+}
+
+bool CalibrationEngine::update(const float* counts, const uint32_t* skipBits, uint8_t end, uint32_t nowMs,
+                               uint32_t* doneBits) {
+    if (!running.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    // Welford's update per channel; the baseline is good enough once its
+    // standard error, sqrt(variance / n), is within the tolerance
+    constexpr float TOLERANCE_SQ = CALIBRATION_TOLERANCE_COUNTS * CALIBRATION_TOLERANCE_COUNTS;
+    bool pending = false;
+    for (uint8_t w = 0; w < (end + 31) / 32; w++) {
+        uint32_t bits = pendingBits[w] & ~skipBits[w];
+        while (bits) {
+            uint8_t id = takeLowestBit(bits, w);
+            if (id >= end) {
+                break;
+            }
+            float x = counts[id];
+            uint32_t n = ++samples[id];
+            float delta = x - means[id];
+            means[id] += delta / n;
+            squares[id] += delta * (x - means[id]);
+            if (n >= CALIBRATION_MIN_SAMPLES && squares[id] <= TOLERANCE_SQ * n * (n - 1)) {
+                results[id] = {means[id], sqrtf(squares[id] / (n - 1))};
+                pendingBits[w] &= ~bitOf(id);
+                convergedBits[w] |= bitOf(id);
+            }
+        }
+    }
+    for (uint8_t w = 0; w < WORDS; w++) {
+        pending = pending || pendingBits[w] != 0;
+    }
+    
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        if (pendingImus & (1 << imu)) {
+            updateImu(imu);
+        }
+    }
+    
+    if ((pending || pendingImus) && nowMs - startMs < CALIBRATION_TIMEOUT_MS) {
+        return false;
+    }
+    finish(doneBits);
+    return true;
+}
+
+ChannelCalibration CalibrationEngine::getChannel(uint8_t id) {
+    return results[id < MAX_SENSORS ? id : 0];
+}
+
+uint8_t CalibrationEngine::getCalibratedImus() {
+    return calibratedImus;
+}
+
+void CalibrationEngine::updateImu(uint8_t imu) {
+    const MPU6050Driver& driver = MPU6050Driver::get(imu);
+    ImuStats& stats = imus[imu];
+    constexpr float REST_SQ = CALIBRATION_GYRO_REST_DPS * CALIBRATION_GYRO_REST_DPS;
+    
+    MPU6050Data block[IMU_BLOCK];
+    uint8_t copied;
+    do {
+        uint32_t count = driver.getSampleCount();
+        if (count - stats.nextSample > IMU_RING_SAMPLES - 1) {
+            stats.nextSample = count - (IMU_RING_SAMPLES - 1);
+        }
+        copied = driver.readSamples(stats.nextSample, block, IMU_BLOCK);
+        stats.nextSample += copied;
+        for (uint8_t i = 0; i < copied && !stats.done; i++) {
+            const MPU6050Data& sample = block[i];
+            const float gyro[3] = {sample.gyroX, sample.gyroY, sample.gyroZ};
+            uint32_t n = ++stats.samples;
+            bool atRest = true;
+            for (uint8_t axis = 0; axis < 3; axis++) {
+                float delta = gyro[axis] - stats.gyroMeans[axis];
+                stats.gyroMeans[axis] += delta / n;
+                stats.gyroSquares[axis] += delta * (gyro[axis] - stats.gyroMeans[axis]);
+                atRest = atRest && stats.gyroSquares[axis] <= REST_SQ * (n > 1 ? n - 1 : 1);
+            }
+            float accel = sqrtf(sample.accelX * sample.accelX + sample.accelY * sample.accelY +
+                                sample.accelZ * sample.accelZ);
+            stats.accelMean += (accel - stats.accelMean) / n;
+            
+            // Moved: start over from this sample
+            if (!atRest) {
+                stats.samples = 0;
+                memset(stats.gyroMeans, 0, sizeof(stats.gyroMeans));
+                memset(stats.gyroSquares, 0, sizeof(stats.gyroSquares));
+                stats.accelMean = 0.0f;
+                continue;
+            }
+            if (n >= CALIBRATION_MIN_SAMPLES && stats.accelMean > 0.0f) {
+                // The samples were already corrected by the current
+                // calibration, so the result builds on it
+                ImuCalibration current = driver.getCalibration();
+                for (uint8_t axis = 0; axis < 3; axis++) {
+                    stats.result.gyroBias[axis] = current.gyroBias[axis] + stats.gyroMeans[axis];
+                }
+                stats.result.accelScale = current.accelScale / stats.accelMean;
+                stats.done = true;
+                pendingImus &= ~(1 << imu);
+            }
+        }
+    } while (copied == IMU_BLOCK && !stats.done);
+}
+
+void CalibrationEngine::finish(uint32_t* doneBits) {
+    uint8_t channels = 0;
+    uint8_t missed = 0;
+    for (uint8_t w = 0; w < WORDS; w++) {
+        doneBits[w] = convergedBits[w];
+        channels += __builtin_popcount(convergedBits[w]);
+        missed += __builtin_popcount(pendingBits[w]);
+        pendingBits[w] = 0;
+        convergedBits[w] = 0;
+    }
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        if (imus[imu].done) {
+            MPU6050Driver::get(imu).setCalibration(imus[imu].result);
+            calibratedImus |= 1 << imu;
+        }
+    }
+    if (missed > 0 || pendingImus) {
+        Logger::warning("Calibration timed out: %d channels and %d IMUs not settled", missed,
+                        __builtin_popcount(pendingImus));
+    }
+    pendingImus = 0;
+    running.store(false, std::memory_order_release);
+    Logger::info("Sensor calibration complete (%d analog channels, %d IMUs)", channels,
+                 __builtin_popcount(calibratedImus));
+}
+
+} // namespace Sensors
+} // namespace BITS
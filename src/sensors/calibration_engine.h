@@ -0,0 +1,78 @@
+#ifndef BITS_SENSORS_CALIBRATION_ENGINE_H
+#define BITS_SENSORS_CALIBRATION_ENGINE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+#include "sensors/mpu6050_driver.h"
+
+namespace BITS {
+namespace Sensors {
+
+// Resting state of an analog channel, in ADC counts
+struct ChannelCalibration {
+    float baseline;
+    float noise;            // Standard deviation at rest
+};
+
+// Background calibration from the readings the sensor task takes anyway,
+// with no ADC reads or delays of its own. start() only marks what to learn.
+// Each tick, update() folds the tick's reading of those channels and every
+// new sample of each IMU into running means and variances (Welford). A
+// channel is done once its baseline's standard error is within
+// CALIBRATION_TOLERANCE_COUNTS, an IMU once it has been at rest for
+// CALIBRATION_MIN_SAMPLES samples. The run ends when everything is done or
+// at CALIBRATION_TIMEOUT_MS. Only then are results handed over, all in the
+// same tick, so thresholds never come from two different runs.
+class CalibrationEngine {
+public:
+    static void init();
+    // Under sensorMutex: (re)starts learning these channels and IMUs (one
+    // bit each); only IMUs that are being polled can finish
+    static void start(const uint32_t* channelBits, uint8_t imuBits, uint32_t nowMs);
+    // From any task
+    static bool isRunning();
+    
+    // Sensor task, once per tick. Channels in skipBits (triggered) are left
+    // out of this tick. True on the tick the run ends: doneBits then holds
+    // the channels with a new calibration, and the IMUs' corrections are set.
+    static bool update(const float* counts, const uint32_t* skipBits, uint8_t end, uint32_t nowMs,
+                       uint32_t* doneBits);
+    static ChannelCalibration getChannel(uint8_t id);
+    // IMUs the last run calibrated, one bit each
+    static uint8_t getCalibratedImus();
+
+private:
+    static constexpr uint8_t WORDS = MAX_SENSORS / 32;
+    
+    struct ImuStats {
+        uint32_t nextSample;                // Next ring sample to fold in
+        uint32_t samples;                   // At rest in a row
+        float gyroMeans[3];
+        float gyroSquares[3];               // Welford's sums of squared deviations
+        float accelMean;                    // Magnitude, g
+        bool done;
+        ImuCalibration result;
+    };
+    
+    // Per-channel statistics as structure-of-arrays
+    static float means[MAX_SENSORS];
+    static float squares[MAX_SENSORS];
+    static uint32_t samples[MAX_SENSORS];
+    static ChannelCalibration results[MAX_SENSORS];
+    static uint32_t pendingBits[WORDS];
+    static uint32_t convergedBits[WORDS];
+    static ImuStats imus[MAX_IMUS];
+    static uint8_t pendingImus;             // One bit per IMU
+    static uint8_t calibratedImus;
+    static uint32_t startMs;
+    static std::atomic<bool> running;
+    
+    static void updateImu(uint8_t imu);
+    static void finish(uint32_t* doneBits);
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_CALIBRATION_ENGINE_H
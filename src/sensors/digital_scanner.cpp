@@ -0,0 +1,169 @@
+#include "sensors/digital_scanner.h"
+#include "core/logger.h"
+#include "core/memory_budget.h"
+#include <Arduino.h>
+#include <string.h>
+
+namespace BITS {
+namespace Sensors {
+
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+static_assert(DIGITAL_DEBOUNCE_SAMPLES >= 1 && DIGITAL_DEBOUNCE_SAMPLES <= 4,
+              "A two-bit vertical counter debounces over 1-4 samples");
+
+namespace {
+
+// Counter preset: 4 - DIGITAL_DEBOUNCE_SAMPLES disagreeing scans short of
+// wrapping, as an all-ones or all-zeros mask per counter bit
+constexpr uint8_t PRESET = 4 - DIGITAL_DEBOUNCE_SAMPLES;
+constexpr uint32_t PRESET0 = (PRESET & 1) ? 0xFFFFFFFFUL : 0;
+constexpr uint32_t PRESET1 = (PRESET & 2) ? 0xFFFFFFFFUL : 0;
+
+} // namespace
+
+DigitalScanner::Port DigitalScanner::ports[MAX_PORTS];
+uint8_t DigitalScanner::portCount = 0;
+uint8_t DigitalScanner::channelPorts[MAX_SENSORS];
+uint8_t DigitalScanner::channelBitIndex[MAX_SENSORS];
+uint32_t DigitalScanner::stateBits[WORDS];
+
+void DigitalScanner::init() {
+    memset(ports, 0, sizeof(ports));
+    portCount = 0;
+    memset(channelPorts, NO_PORT, sizeof(channelPorts));
+    memset(stateBits, 0, sizeof(stateBits));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "digital ports",
+                          sizeof(ports) + sizeof(channelPorts) + sizeof(channelBitIndex) + sizeof(stateBits));
+    Logger::info("Digital scanner initialized (%d ports)", MAX_PORTS);
+}
+
+bool DigitalScanner::addChannel(uint8_t id, uint8_t gpio, bool activeLow) {
+    if (id >= MAX_SENSORS || channelPorts[id] != NO_PORT) {
+        return false;
+    }
+    volatile uint32_t* input = portInputRegister(gpio);
+    uint8_t port = findPort(input);
+    if (port == NO_PORT) {
+        if (portCount >= MAX_PORTS) {
+            Logger::error("Digital scanner: no port slot for GPIO %d", gpio);
+            return false;
+        }
+        port = portCount++;
+        ports[port].input = input;
+    }
+    
+    uint32_t mask = digitalPinToBitMask(gpio);
+    Port& p = ports[port];
+    if (p.used & mask) {
+        Logger::error("Digital scanner: GPIO %d already scanned", gpio);
+        return false;
+    }
+    p.ids[__builtin_ctz(mask)] = id;
+    p.activeLow = activeLow ? (p.activeLow | mask) : (p.activeLow & ~mask);
+    
+    // Start from the pin's current level rather than debouncing into it
+    uint32_t level = (*p.input ^ p.activeLow) & mask;
+    p.state = (p.state & ~mask) | level;
+    p.count0 = (p.count0 & ~mask) | (PRESET0 & mask);
+    p.count1 = (p.count1 & ~mask) | (PRESET1 & mask);
+    p.used |= mask;
+    channelPorts[id] = port;
+    channelBitIndex[id] = static_cast<uint8_t>(__builtin_ctz(mask));
+    if (level) {
+        stateBits[id / 32] |= 1UL << (id & 31);
+    } else {
+        stateBits[id / 32] &= ~(1UL << (id & 31));
+    }
+    return true;
+}
+
+void DigitalScanner::removeChannel(uint8_t id) {
+    if (id >= MAX_SENSORS || channelPorts[id] == NO_PORT) {
+        return;
+    }
+    Port& p = ports[channelPorts[id]];
+    uint32_t mask = 1UL << channelBitIndex[id];
+    p.used &= ~mask;
+    p.state &= ~mask;
+    p.count0 &= ~mask;
+    p.count1 &= ~mask;
+    channelPorts[id] = NO_PORT;
+    stateBits[id / 32] &= ~(1UL << (id & 31));
+}
+
+void DigitalScanner::setActiveLow(uint8_t id, bool activeLow) {
+    if (id >= MAX_SENSORS || channelPorts[id] == NO_PORT) {
+        return;
+    }
+    Port& p = ports[channelPorts[id]];
+    uint32_t mask = 1UL << channelBitIndex[id];
+    p.activeLow = activeLow ? (p.activeLow | mask) : (p.activeLow & ~mask);
+}
+
+bool DigitalScanner::isActiveLow(uint8_t id) {
+    if (id >= MAX_SENSORS || channelPorts[id] == NO_PORT) {
+        return false;
+    }
+    return (ports[channelPorts[id]].activeLow >> channelBitIndex[id]) & 1;
+}
+
+bool DigitalScanner::scan(uint32_t* changed) {
+    bool any = false;
+    for (uint8_t i = 0; i < portCount; i++) {
+        Port& p = ports[i];
+        uint32_t sample = (*p.input ^ p.activeLow) & p.used;
+        
+        // Vertical counter: bits that disagree with the debounced state count
+        // up, bits that agree go back to the preset; a bit flips when its
+        // counter wraps
+        uint32_t delta = sample ^ p.state;
+        p.count1 = ((p.count1 ^ p.count0) & delta) | (PRESET1 & ~delta);
+        p.count0 = (~p.count0 & delta) | (PRESET0 & ~delta);
+        uint32_t toggle = delta & ~(p.count0 | p.count1);
+        if (toggle == 0) {
+            continue;
+        }
+        p.state ^= toggle;
+        p.count0 |= PRESET0 & toggle;
+        p.count1 |= PRESET1 & toggle;
+        
+        // Only the channels that changed are mapped back to ids
+        any = true;
+        while (toggle) {
+            uint8_t id = p.ids[__builtin_ctz(toggle)];
+            toggle &= toggle - 1;
+            changed[id / 32] |= 1UL << (id & 31);
+            stateBits[id / 32] ^= 1UL << (id & 31);
+        }
+    }
+    return any;
+}
+
+const uint32_t* DigitalScanner::getStateBits() {
+    return stateBits;
+}
+
+bool DigitalScanner::isSettling() {
+    for (uint8_t i = 0; i < portCount; i++) {
+        const Port& p = ports[i];
+        if (((p.count0 ^ PRESET0) | (p.count1 ^ PRESET1)) & p.used) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t DigitalScanner::findPort(volatile uint32_t* input) {
+    for (uint8_t i = 0; i < portCount; i++) {
+        if (ports[i].input == input) {
+            return i;
+        }
+    }
+    return NO_PORT;
+}
+
+} // namespace Sensors
+} // namespace BITS
@@ -0,0 +1,62 @@
+#ifndef BITS_SENSORS_DIGITAL_SCANNER_H
+#define BITS_SENSORS_DIGITAL_SCANNER_H
+
+#include <stdint.h>
+#include "config.h"
+
+namespace BITS {
+namespace Sensors {
+
+// Digital sensor channels (IR beams) read a GPIO port register at a time.
+// Each channel's pin is resolved to a port and bit when it is added; a scan
+// then reads every port once and debounces all of its bits together with a
+// two-bit vertical counter, so the cost depends on the number of ports, not
+// channels. A channel changes state after DIGITAL_DEBOUNCE_SAMPLES scans
+// that all disagree with it.
+class DigitalScanner {
+public:
+    static void init();
+    static bool addChannel(uint8_t id, uint8_t gpio, bool activeLow);
+    static void removeChannel(uint8_t id);
+    static void setActiveLow(uint8_t id, bool activeLow);
+    static bool isActiveLow(uint8_t id);
+    
+    // Samples and debounces every port; sets the bits of channels whose
+    // debounced state changed in changed[MAX_SENSORS / 32]. Returns true
+    // if any did.
+    static bool scan(uint32_t* changed);
+    // Debounced state as bits by channel id, set while active
+    static const uint32_t* getStateBits();
+    // A channel has an input change that is not yet debounced
+    static bool isSettling();
+
+private:
+    static constexpr uint8_t WORDS = MAX_SENSORS / 32;
+    static constexpr uint8_t MAX_PORTS = 4;     // GPIO6-9 on Teensy 4
+    static constexpr uint8_t NO_PORT = 0xFF;
+    
+    // Per port, one bit per pin: bit n of count0/count1 is pin n's counter.
+    // Counters rest at a preset and toggle the state when they wrap to zero.
+    struct Port {
+        volatile uint32_t* input;
+        uint32_t used;
+        uint32_t activeLow;
+        uint32_t state;         // Debounced, true when active
+        uint32_t count0;
+        uint32_t count1;
+        uint8_t ids[32];        // Channel id of each bit
+    };
+    
+    static Port ports[MAX_PORTS];
+    static uint8_t portCount;
+    static uint8_t channelPorts[MAX_SENSORS];
+    static uint8_t channelBitIndex[MAX_SENSORS];
+    static uint32_t stateBits[WORDS];
+    
+    static uint8_t findPort(volatile uint32_t* input);
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_DIGITAL_SCANNER_H
@@ -0,0 +1,179 @@
+#include "sensors/filter_bank.h"
+#include <arm_math.h>
+#include <math.h>
+#include <string.h>
+#include <Arduino.h>
+
+namespace BITS {
+namespace Sensors {
+
+static_assert(MAX_SENSORS % 32 == 0, "Filter channels are tracked in 32-bit words");
+
+namespace {
+
+inline uint32_t bitOf(uint8_t channel) {
+    return 1UL << (channel & 31);
+}
+
+// Compare-and-select rather than fminf()/fmaxf(), which are library calls
+// without VMINNM and keep the median loop from vectorizing on the host
+inline float minOf(float a, float b) {
+    return a < b ? a : b;
+}
+
+inline float maxOf(float a, float b) {
+    return a > b ? a : b;
+}
+
+// One-pole low-pass weight of a new sample
+inline float lowPassGain(float cutoffHz, float sampleRateHz) {
+    return 1.0f - expf(-2.0f * PI * cutoffHz / sampleRateHz);
+}
+
+} // namespace
+
+FilterBank::FilterBank() {
+    init();
+}
+
+void FilterBank::init() {
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        clear(i);
+    }
+}
+
+bool FilterBank::configure(uint8_t channel, const FilterConfig& config, float sampleRateHz) {
+    if (channel >= MAX_SENSORS) {
+        return false;
+    }
+    float alpha = 1.0f;
+    switch (config.type) {
+        case FilterType::NONE:
+        case FilterType::MEDIAN3:
+            break;
+        case FilterType::KALMAN:
+            if (config.a <= 0.0f || config.b <= 0.0f) {
+                return false;
+            }
+            break;
+        case FilterType::EWMA:
+            if (config.a <= 0.0f || config.a > 1.0f) {
+                return false;
+            }
+            alpha = config.a;
+            break;
+        case FilterType::LOW_PASS:
+            if (config.a <= 0.0f || sampleRateHz <= 0.0f) {
+                return false;
+            }
+            alpha = lowPassGain(config.a, sampleRateHz);
+            break;
+    }
+    
+    clear(channel);
+    types[channel] = config.type;
+    gains[channel] = alpha;
+    holds[channel] = 1.0f - alpha;
+    cutoffs[channel] = config.type == FilterType::LOW_PASS ? config.a : 0.0f;
+    medianMasks[channel] = config.type == FilterType::MEDIAN3 ? 1.0f : 0.0f;
+    if (config.type == FilterType::KALMAN) {
+        variances[channel] = 1.0f;
+        processNoise[channel] = config.a;
+        measurementNoise[channel] = config.b;
+        kalmanBits[channel / 32] |= bitOf(channel);
+    }
+    return true;
+}
+
+void FilterBank::setSampleRate(float sampleRateHz) {
+    if (sampleRateHz <= 0.0f) {
+        return;
+    }
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (types[i] == FilterType::LOW_PASS) {
+            gains[i] = lowPassGain(cutoffs[i], sampleRateHz);
+            holds[i] = 1.0f - gains[i];
+        }
+    }
+}
+
+void FilterBank::clear(uint8_t channel) {
+    if (channel >= MAX_SENSORS) {
+        return;
+    }
+    types[channel] = FilterType::NONE;
+    outputs[channel] = 0.0f;
+    gains[channel] = 1.0f;
+    holds[channel] = 0.0f;
+    cutoffs[channel] = 0.0f;
+    medianMasks[channel] = 0.0f;
+    previous[channel] = 0.0f;
+    beforePrevious[channel] = 0.0f;
+    variances[channel] = 0.0f;
+    processNoise[channel] = 0.0f;
+    measurementNoise[channel] = 0.0f;
+    kalmanBits[channel / 32] &= ~bitOf(channel);
+    unseededBits[channel / 32] |= bitOf(channel);
+}
+
+FilterType FilterBank::getType(uint8_t channel) const {
+    return channel < MAX_SENSORS ? types[channel] : FilterType::NONE;
+}
+
+void FilterBank::process(float* values, uint8_t count) {
+    if (count > MAX_SENSORS) {
+        count = MAX_SENSORS;
+    }
+    uint8_t words = (count + 31) / 32;
+    
+    // A channel's first sample fills its state, so nothing ramps up from 0
+    for (uint8_t w = 0; w < words; w++) {
+        uint32_t bits = unseededBits[w];
+        while (bits) {
+            uint8_t i = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            if (i >= count) {
+                break;
+            }
+            outputs[i] = values[i];
+            previous[i] = values[i];
+            beforePrevious[i] = values[i];
+            unseededBits[w] &= ~bitOf(i);
+        }
+    }
+    
+    // Median of 3 for every channel, kept where the mask is set
+    for (uint8_t i = 0; i < count; i++) {
+        float x = values[i];
+        float median = maxOf(minOf(x, previous[i]), minOf(maxOf(x, previous[i]), beforePrevious[i]));
+        beforePrevious[i] = previous[i];
+        previous[i] = x;
+        values[i] = x + medianMasks[i] * (median - x);
+    }
+    
+    // Kalman gains follow the predicted variance
+    for (uint8_t w = 0; w < words; w++) {
+        uint32_t bits = kalmanBits[w];
+        while (bits) {
+            uint8_t i = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            if (i >= count) {
+                break;
+            }
+            float predicted = variances[i] + processNoise[i];
+            float gain = predicted / (predicted + measurementNoise[i]);
+            variances[i] = predicted - gain * predicted;
+            gains[i] = gain;
+            holds[i] = 1.0f - gain;
+        }
+    }
+    
+    // y = g * x + (1 - g) * y, then hand y back
+    arm_mult_f32(values, gains, values, count);
+    arm_mult_f32(outputs, holds, outputs, count);
+    arm_add_f32(outputs, values, outputs, count);
+    memcpy(values, outputs, count * sizeof(float));
+}
+
+} // namespace Sensors
+} // namespace BITS
@@ -0,0 +1,75 @@
+#ifndef BITS_SENSORS_FILTER_BANK_H
+#define BITS_SENSORS_FILTER_BANK_H
+
+#include <stdint.h>
+#include "config.h"
+
+namespace BITS {
+namespace Sensors {
+
+enum class FilterType : uint8_t {
+    NONE,
+    KALMAN,     // 1-D random-walk Kalman filter
+    EWMA,       // Exponentially weighted moving average
+    LOW_PASS,   // One-pole low-pass at a cutoff frequency
+    MEDIAN3     // Median of the last three samples
+};
+
+struct FilterConfig {
+    FilterType type;
+    float a;    // Kalman process noise, EWMA alpha or low-pass cutoff in Hz
+    float b;    // Kalman measurement noise
+    
+    static FilterConfig none() { return {FilterType::NONE, 0.0f, 0.0f}; }
+    static FilterConfig kalman(float processNoise, float measurementNoise) {
+        return {FilterType::KALMAN, processNoise, measurementNoise};
+    }
+    static FilterConfig ewma(float alpha) { return {FilterType::EWMA, alpha, 0.0f}; }
+    static FilterConfig lowPass(float cutoffHz) { return {FilterType::LOW_PASS, cutoffHz, 0.0f}; }
+    static FilterConfig median3() { return {FilterType::MEDIAN3, 0.0f, 0.0f}; }
+};
+
+// Smoothing for up to MAX_SENSORS channels at once, one sample per channel
+// per call. State is kept as structure-of-arrays, and process() runs every
+// channel through the same passes whatever its filter: Kalman, EWMA and
+// low-pass are all y = g * x + (1 - g) * y, with g the Kalman gain or a
+// fixed alpha (1 passes the input through exactly), and a median channel
+// swaps in its median with a 0/1 mask. Only Kalman channels have per-tick
+// work of their own, the gain; the rest runs as CMSIS-DSP vector operations.
+class FilterBank {
+public:
+    FilterBank();
+    void init();
+    
+    // Takes effect from the next sample, which also seeds the filter
+    bool configure(uint8_t channel, const FilterConfig& config, float sampleRateHz);
+    // Recomputes low-pass gains for a new sample rate, keeping their state
+    void setSampleRate(float sampleRateHz);
+    void clear(uint8_t channel);
+    FilterType getType(uint8_t channel) const;
+    
+    // Filters values[0, count) in place
+    void process(float* values, uint8_t count);
+
+private:
+    static constexpr uint8_t WORDS = MAX_SENSORS / 32;
+    
+    FilterType types[MAX_SENSORS];
+    float outputs[MAX_SENSORS];
+    float gains[MAX_SENSORS];               // Weight of the new sample
+    float holds[MAX_SENSORS];               // 1 - gain
+    float cutoffs[MAX_SENSORS];             // Hz, low-pass channels
+    float medianMasks[MAX_SENSORS];         // 1 for median channels
+    float previous[MAX_SENSORS];            // Last two inputs, for the median
+    float beforePrevious[MAX_SENSORS];
+    float variances[MAX_SENSORS];           // Kalman P, Q and R
+    float processNoise[MAX_SENSORS];
+    float measurementNoise[MAX_SENSORS];
+    uint32_t kalmanBits[WORDS];
+    uint32_t unseededBits[WORDS];           // Next sample starts the filter
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_FILTER_BANK_H
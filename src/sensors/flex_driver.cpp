@@ -5,6 +5,8 @@
 namespace BITS {
 namespace Sensors {
 
+using Core::Logger;
+
 FlexDriver::FlexSensor FlexDriver::sensors[MAX_FLEX_SENSORS];
 uint8_t FlexDriver::sensorCount = 0;
 bool FlexDriver::initialized = false;
@@ -22,7 +24,7 @@ bool FlexDriver::initSensor(uint8_t id, uint8_t gpio) {
     
     FlexSensor* sensor = &sensors[id];
     sensor->gpio = gpio;
-    sensor->threshold = 0.5f; // Default threshold (normalized)
+    sensor->threshold = DEFAULT_THRESHOLD;
     sensor->baseline = 0.0f;
     sensor->triggered = false;
     
@@ -54,7 +56,7 @@ float FlexDriver::read(uint8_t id) {
     
     int raw = analogRead(sensor->gpio);
     // Normalize: 0.0 = unbent, 1.0 = fully bent
-    float normalized = abs(raw - sensor->baseline) / 4095.0f;
+    float normalized = abs(raw - sensor->baseline) * FULL_SCALE_PER_COUNT;
     return normalized;
 }
 
@@ -17,6 +17,11 @@ public:
     
     static void setThreshold(uint8_t id, float threshold);
     static float getThreshold(uint8_t id);
+    
+    // Conversion and defaults, shared with SensorManager's channel table.
+    // Readings are the distance from the unbent baseline, 0.0 to 1.0.
+    static constexpr float FULL_SCALE_PER_COUNT = 1.0f / 4095.0f;
+    static constexpr float DEFAULT_THRESHOLD = 0.5f;
 
 private:
     static constexpr uint8_t MAX_FLEX_SENSORS = 8;
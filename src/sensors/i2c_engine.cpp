@@ -0,0 +1,271 @@
+#include "sensors/i2c_engine.h"
+#include "core/logger.h"
+#include "core/memory_budget.h"
+#include "rtos/semaphores.h"
+#include <Arduino.h>
+#include <i2c_driver.h>
+
+namespace BITS {
+namespace Sensors {
+
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+
+static_assert((I2C_QUEUE_DEPTH & (I2C_QUEUE_DEPTH - 1)) == 0, "I2C queue depth must be a power of two");
+static_assert(I2C_BUS_COUNT >= 1 && I2C_BUS_COUNT <= 3, "Teensy 4 has three I2C buses");
+
+namespace {
+
+// How often transfer() looks at the transaction it waits for when there is
+// no task to block
+constexpr uint32_t WAIT_POLL_US = 20;
+
+// LPI2C1 on pins 19/18 (Wire), LPI2C3 on 16/17 (Wire1), LPI2C4 on 24/25
+I2CMaster* const masters[] = {&Master, &Master1, &Master2};
+
+#ifdef BITS_HOST_BUILD
+// The host masters raise no interrupts: a timer at I2C_SERVICE_RATE_HZ
+// stands in for them
+constexpr uint32_t SERVICE_PERIOD_US = 1000000 / I2C_SERVICE_RATE_HZ;
+IntervalTimer serviceTimer;
+#else
+IMX_RT1060_I2CMaster* const drivers[] = {&Master, &Master1, &Master2};
+const IRQ_NUMBER_t busIrqs[] = {IRQ_LPI2C1, IRQ_LPI2C3, IRQ_LPI2C4};
+#endif
+
+// Orders submitters; the bus interrupts never take it
+class I2CLock {
+public:
+    I2CLock() {
+        if (RTOS::i2cMutex != nullptr) {
+            xSemaphoreTake(RTOS::i2cMutex, portMAX_DELAY);
+        }
+    }
+    ~I2CLock() {
+        if (RTOS::i2cMutex != nullptr) {
+            xSemaphoreGive(RTOS::i2cMutex);
+        }
+    }
+};
+
+} // namespace
+
+I2CEngine::Bus I2CEngine::buses[I2C_BUS_COUNT];
+uint32_t I2CEngine::completed = 0;
+uint32_t I2CEngine::failed = 0;
+uint32_t I2CEngine::rejected = 0;
+bool I2CEngine::running = false;
+
+bool I2CEngine::init(uint32_t clockHz) {
+    if (running) {
+        return true;
+    }
+    for (uint8_t b = 0; b < I2C_BUS_COUNT; b++) {
+        Bus& bus = buses[b];
+        bus.queueHead.store(0, std::memory_order_relaxed);
+        bus.queueTail.store(0, std::memory_order_relaxed);
+        bus.current = nullptr;
+        masters[b]->begin(clockHz);
+    }
+    completed = 0;
+    failed = 0;
+    rejected = 0;
+#ifdef BITS_HOST_BUILD
+    if (!serviceTimer.begin(serviceISR, SERVICE_PERIOD_US)) {
+        Logger::error("I2C service timer unavailable");
+        return false;
+    }
+#else
+    // Takes over each master's interrupt vector from the library, which
+    // begin() installed, so the end of a transfer moves its queue on
+    static void (*const handlers[])() = {busISR<0>, busISR<1>, busISR<2>};
+    for (uint8_t b = 0; b < I2C_BUS_COUNT; b++) {
+        attachInterruptVector(busIrqs[b], handlers[b]);
+    }
+#endif
+    running = true;
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "i2c queues", sizeof(buses));
+    Logger::info("I2C engine initialized (%d buses at %lu Hz, %d-transaction queues)", I2C_BUS_COUNT,
+                 static_cast<unsigned long>(clockHz), I2C_QUEUE_DEPTH);
+    return true;
+}
+
+bool I2CEngine::isRunning() {
+    return running;
+}
+
+bool I2CEngine::submit(I2CTransaction& transaction) {
+    if (transaction.bus >= I2C_BUS_COUNT || transaction.isPending()) {
+        return false;
+    }
+    Bus& bus = buses[transaction.bus];
+    I2CLock lock;
+    uint32_t tail = bus.queueTail.load(std::memory_order_relaxed);
+    if (tail - bus.queueHead.load(std::memory_order_acquire) >= I2C_QUEUE_DEPTH) {
+        rejected++;
+        return false;
+    }
+    transaction.status.store(I2CStatus::QUEUED, std::memory_order_relaxed);
+    bus.queue[tail & QUEUE_MASK] = &transaction;
+    bus.queueTail.store(tail + 1, std::memory_order_release);
+    
+    // An idle bus raises no interrupt, so the submitter starts it
+    taskENTER_CRITICAL();
+    if (bus.current == nullptr) {
+        startNext(transaction.bus);
+    }
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+bool I2CEngine::transfer(I2CTransaction& transaction) {
+    if (!running) {
+        return false;
+    }
+    TaskHandle_t self = nullptr;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        self = xTaskGetCurrentTaskHandle();
+    }
+    transaction.waiter = self;
+    if (!submit(transaction)) {
+        transaction.waiter = nullptr;
+        return false;
+    }
+    if (self == nullptr) {
+        // No task to block before the scheduler runs: services the bus
+        // itself, apart from its interrupt by the critical section
+        while (transaction.isPending()) {
+            delayMicroseconds(WAIT_POLL_US);
+            taskENTER_CRITICAL();
+            serviceBus(transaction.bus);
+            taskEXIT_CRITICAL();
+        }
+    } else {
+        // Sleeps until finish() gives the notification. Gives from anyone
+        // else are handed back, so the task's count is what it would have
+        // been without the transfer
+        uint32_t foreign = 0;
+        while (true) {
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+            if (!transaction.isPending()) {
+                break;
+            }
+            foreign++;
+        }
+        while (foreign-- > 0) {
+            xTaskNotifyGive(self);
+        }
+    }
+    transaction.waiter = nullptr;
+    return transaction.status.load(std::memory_order_acquire) == I2CStatus::DONE;
+}
+
+bool I2CEngine::isIdle() {
+    uint32_t submitted = 0;
+    for (uint8_t b = 0; b < I2C_BUS_COUNT; b++) {
+        submitted += buses[b].queueTail.load(std::memory_order_acquire);
+    }
+    return completed + failed == submitted;
+}
+
+uint32_t I2CEngine::getCompletedCount() {
+    return completed;
+}
+
+uint32_t I2CEngine::getFailedCount() {
+    return failed;
+}
+
+uint32_t I2CEngine::getRejectedCount() {
+    return rejected;
+}
+
+#ifdef BITS_HOST_BUILD
+void I2CEngine::serviceISR() {
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    for (uint8_t b = 0; b < I2C_BUS_COUNT; b++) {
+        serviceBus(b);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(state);
+}
+#else
+template <uint8_t B>
+void I2CEngine::busISR() {
+    drivers[B]->_interrupt_service_routine();
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    serviceBus(B);
+    taskEXIT_CRITICAL_FROM_ISR(state);
+}
+#endif
+
+void I2CEngine::serviceBus(uint8_t b) {
+    Bus& bus = buses[b];
+    I2CMaster& master = *masters[b];
+    if (bus.current == nullptr) {
+        startNext(b);
+        return;
+    }
+    if (!master.finished()) {
+        return;
+    }
+    
+    // The write phase leaves the bus claimed for the read after it
+    I2CTransaction* current = bus.current;
+    if (master.has_error()) {
+        finish(b, false);
+    } else if (!bus.reading && current->readLength > 0) {
+        bus.reading = true;
+        master.read_async(current->address, current->readData, current->readLength, true);
+        return;
+    } else {
+        finish(b, true);
+    }
+    startNext(b);
+}
+
+void I2CEngine::startNext(uint8_t b) {
+    Bus& bus = buses[b];
+    uint32_t head = bus.queueHead.load(std::memory_order_relaxed);
+    if (head == bus.queueTail.load(std::memory_order_acquire)) {
+        return;
+    }
+    I2CTransaction* current = bus.queue[head & QUEUE_MASK];
+    bus.current = current;
+    bus.queueHead.store(head + 1, std::memory_order_release);
+    current->status.store(I2CStatus::BUSY, std::memory_order_relaxed);
+    
+    // A transaction without data is an address probe
+    I2CMaster& master = *masters[b];
+    if (current->writeLength > 0 || current->readLength == 0) {
+        bus.reading = false;
+        master.write_async(current->address, current->writeData, current->writeLength, current->readLength == 0);
+    } else {
+        bus.reading = true;
+        master.read_async(current->address, current->readData, current->readLength, true);
+    }
+}
+
+void I2CEngine::finish(uint8_t b, bool ok) {
+    I2CTransaction* transaction = buses[b].current;
+    buses[b].current = nullptr;
+    if (ok) {
+        completed++;
+    } else {
+        failed++;
+    }
+    if (transaction->onComplete != nullptr) {
+        transaction->onComplete(*transaction, ok);
+    }
+    // The waiter may reuse the transaction once the status has changed
+    TaskHandle_t waiter = transaction->waiter;
+    transaction->status.store(ok ? I2CStatus::DONE : I2CStatus::FAILED, std::memory_order_release);
+    if (waiter != nullptr) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(waiter, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    }
+}
+
+} // namespace Sensors
+} // namespace BITS
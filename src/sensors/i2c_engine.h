@@ -0,0 +1,100 @@
+#ifndef BITS_SENSORS_I2C_ENGINE_H
+#define BITS_SENSORS_I2C_ENGINE_H
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+
+namespace BITS {
+namespace Sensors {
+
+enum class I2CStatus : uint8_t {
+    IDLE,       // Not submitted yet
+    QUEUED,
+    BUSY,       // On the bus
+    DONE,
+    FAILED      // NACK or bus error
+};
+
+// A register-style transfer: writeLength bytes (usually the register
+// address, then data), then readLength bytes after a repeated start. The
+// buffers belong to the caller and must stay valid until the transaction
+// has finished.
+struct I2CTransaction {
+    uint8_t bus = 0;        // 0 is Wire, 1 is Wire1
+    uint8_t address = 0;
+    const uint8_t* writeData = nullptr;
+    uint8_t writeLength = 0;
+    uint8_t* readData = nullptr;
+    uint8_t readLength = 0;
+    // Runs in the bus interrupt when the transfer ends, before status
+    // changes to DONE or FAILED; may be null
+    void (*onComplete)(I2CTransaction& transaction, bool ok) = nullptr;
+    void* context = nullptr;
+    std::atomic<I2CStatus> status{I2CStatus::IDLE};
+    TaskHandle_t waiter = nullptr;      // Task blocked in transfer(), engine only
+    
+    bool isPending() const {
+        I2CStatus s = status.load(std::memory_order_acquire);
+        return s == I2CStatus::QUEUED || s == I2CStatus::BUSY;
+    }
+};
+
+// Queued, non-blocking I2C on the sensor buses. Tasks submit transactions,
+// taking i2cMutex only for the enqueue; an interrupt-driven master per bus
+// moves the bytes while the submitting task carries on. The engine chains
+// each master's LPI2C interrupt: when a transfer ends it runs the completion
+// callback and starts the next transaction on that bus, and a submit to an
+// idle bus starts it at once. Every bus has its
+// own queue, which is the only order on it, so transfers on different
+// buses run at the same time.
+class I2CEngine {
+public:
+    // Starts the masters at clockHz and takes over their interrupts
+    static bool init(uint32_t clockHz = I2C_CLOCK_HZ);
+    static bool isRunning();
+    
+    // Non-blocking; false if the bus is unknown, its queue is full or the
+    // transaction is still pending from an earlier submit
+    static bool submit(I2CTransaction& transaction);
+    // Submits and waits for the transfer, for configuration outside the
+    // sampling path; true if it succeeded. A task sleeps on a notification
+    // from the bus interrupt; before the scheduler runs it polls the bus
+    static bool transfer(I2CTransaction& transaction);
+    
+    static bool isIdle();
+    static uint32_t getCompletedCount();
+    static uint32_t getFailedCount();
+    static uint32_t getRejectedCount();     // Submits refused, queue full
+
+private:
+    static constexpr uint32_t QUEUE_MASK = I2C_QUEUE_DEPTH - 1;
+    
+    struct Bus {
+        I2CTransaction* queue[I2C_QUEUE_DEPTH];
+        std::atomic<uint32_t> queueHead;        // Next to start, in a critical section
+        std::atomic<uint32_t> queueTail;        // Next free slot, under i2cMutex
+        I2CTransaction* current;
+        bool reading;                           // current is in its read phase
+    };
+    
+    static Bus buses[I2C_BUS_COUNT];
+    static uint32_t completed;
+    static uint32_t failed;
+    static uint32_t rejected;
+    static bool running;
+    
+    static void serviceISR();              // Host: the timer standing in for the interrupts
+    template <uint8_t B>
+    static void busISR();                   // Target: the LPI2C interrupt of bus B
+    static void serviceBus(uint8_t bus);
+    static void startNext(uint8_t bus);
+    static void finish(uint8_t bus, bool ok);
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_I2C_ENGINE_H
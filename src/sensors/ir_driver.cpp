@@ -1,10 +1,13 @@
 #include "sensors/ir_driver.h"
 #include "core/logger.h"
+#include "rtos/tasks.h"
 #include <Arduino.h>
 
 namespace BITS {
 namespace Sensors {
 
+using Core::Logger;
+
 IRDriver::IRSensor IRDriver::sensors[MAX_IR_SENSORS];
 uint8_t IRDriver::sensorCount = 0;
 bool IRDriver::initialized = false;
@@ -28,6 +31,8 @@ bool IRDriver::initSensor(uint8_t id, uint8_t gpio) {
     sensor->triggered = false;
     
     pinMode(gpio, INPUT_PULLUP);
+    // Beam changes wake the sensor task instead of waiting for its next poll
+    attachInterrupt(digitalPinToInterrupt(gpio), RTOS::wakeSensorTaskFromISR, CHANGE);
     sensorCount++;
     
     Logger::info("IR sensor %d initialized on GPIO %d", id, gpio);
@@ -69,6 +74,12 @@ void IRDriver::setThreshold(uint8_t id, bool threshold) {
     }
 }
 
+bool IRDriver::getThreshold(uint8_t id) {
+    IRSensor* sensor = getSensor(id);
+    if (!sensor) return false;
+    return sensor->threshold;
+}
+
 void IRDriver::setDebounceTime(uint8_t id, uint32_t timeMs) {
     IRSensor* sensor = getSensor(id);
     if (sensor) {
@@ -15,6 +15,7 @@ public:
     static bool isTriggered(uint8_t id);
     
     static void setThreshold(uint8_t id, bool threshold);
+    static bool getThreshold(uint8_t id);
     static void setDebounceTime(uint8_t id, uint32_t timeMs);
 
 private:
@@ -1,29 +1,92 @@
 #include "sensors/mpu6050_driver.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
+#include "rtos/semaphores.h"
 #include "config.h"
-#include <Wire.h>
 #include <math.h>
 #include <Arduino.h>
 
 namespace BITS {
 namespace Sensors {
 
-bool MPU6050Driver::initialized = false;
-uint8_t MPU6050Driver::deviceAddress = 0x68;
-MPU6050Data MPU6050Driver::lastReading = {0};
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
 
-bool MPU6050Driver::init(uint8_t address) {
-    deviceAddress = address;
-    Wire.begin();
-    Wire.setClock(400000); // 400kHz I2C
+static_assert((IMU_RING_SAMPLES & (IMU_RING_SAMPLES - 1)) == 0, "IMU ring size must be a power of two");
+static_assert(IMU_RING_SAMPLES <= 255, "IMU samples are counted in uint8_t");
+static_assert(SENSOR_POLL_RATE_HZ >= 4 && SENSOR_POLL_RATE_HZ <= 1000, "The IMU samples at 1 kHz / (1..256)");
+static_assert(MAX_IMUS >= 1 && MAX_IMUS <= 2 * I2C_BUS_COUNT, "Two MPU6050 addresses per bus");
+
+namespace {
+
+// MPU6050 registers
+constexpr uint8_t REG_SMPLRT_DIV = 0x19;
+constexpr uint8_t REG_CONFIG = 0x1A;
+constexpr uint8_t REG_INT_ENABLE = 0x38;
+constexpr uint8_t REG_INT_STATUS = 0x3A;
+constexpr uint8_t REG_PWR_MGMT_1 = 0x6B;
+constexpr uint8_t DATA_RDY = 0x01;
+
+const uint8_t burstStart = REG_INT_STATUS;
+
+int16_t readWord(const uint8_t* bytes) {
+    return static_cast<int16_t>(bytes[0] << 8 | bytes[1]);
+}
+
+// Converts a burst; true if INT_STATUS flagged new data
+bool decodeBurst(const uint8_t* bytes, MPU6050Data& data) {
+    // Convert to physical units (simplified - assumes ±2g and ±250°/s)
+    data.accelX = readWord(&bytes[1]) / 16384.0f;
+    data.accelY = readWord(&bytes[3]) / 16384.0f;
+    data.accelZ = readWord(&bytes[5]) / 16384.0f;
+    data.temperature = readWord(&bytes[7]) / 340.0f + 36.53f;
+    data.gyroX = readWord(&bytes[9]) / 131.0f;
+    data.gyroY = readWord(&bytes[11]) / 131.0f;
+    data.gyroZ = readWord(&bytes[13]) / 131.0f;
+    data.timestamp = micros();
+    
+    // Calculate roll and pitch
+    data.roll = atan2(data.accelY, data.accelZ) * 180.0f / PI;
+    data.pitch = atan2(-data.accelX,
+                       sqrt(data.accelY * data.accelY +
+                            data.accelZ * data.accelZ)) * 180.0f / PI;
+    return (bytes[0] & DATA_RDY) != 0;
+}
+
+} // namespace
+
+MPU6050Driver MPU6050Driver::imus[MAX_IMUS];
+
+MPU6050Driver& MPU6050Driver::get(uint8_t imu) {
+    return imus[imu < MAX_IMUS ? imu : 0];
+}
+
+void MPU6050Driver::pollAll() {
+    // Bursts on different buses run side by side
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        imus[imu].poll();
+    }
+}
+
+bool MPU6050Driver::init() {
+    if (initialized) {
+        return true;
+    }
+    uint8_t imu = static_cast<uint8_t>(this - imus);
+    bus = imu % I2C_BUS_COUNT;
+    address = MPU6050_I2C_ADDRESS + imu / I2C_BUS_COUNT;
+    if (!I2CEngine::init()) {
+        return false;
+    }
     
     // Wake up MPU6050
-    writeRegister(0x6B, 0x00);
+    writeRegister(REG_PWR_MGMT_1, 0x00);
     delay(100);
     
     // Check connection
     if (!isConnected()) {
-        Logger::error("MPU6050 not connected");
+        Logger::error("MPU6050 %d not connected (bus %d, 0x%02X)", imu, bus, address);
         return false;
     }
     
@@ -33,73 +96,143 @@ bool MPU6050Driver::init(uint8_t address) {
     // Configure gyroscope range (±250°/s)
     setGyroRange(0);
     
+    // New samples at the poll rate (1 kHz with the 184 Hz low-pass, divided
+    // down), flagged in INT_STATUS so a poll can tell them from stale ones
+    writeRegister(REG_CONFIG, 0x01);
+    writeRegister(REG_SMPLRT_DIV, 1000 / SENSOR_POLL_RATE_HZ - 1);
+    writeRegister(REG_INT_ENABLE, DATA_RDY);
+    
+    burst.bus = bus;
+    burst.address = address;
+    burst.writeData = &burstStart;
+    burst.writeLength = 1;
+    burst.readData = burstBytes;
+    burst.readLength = BURST_BYTES;
+    burst.onComplete = onBurst;
+    burst.context = this;
+    
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "imu rings", sizeof(imus));
     initialized = true;
-    Logger::info("MPU6050 initialized");
+    Logger::info("MPU6050 %d initialized (bus %d, 0x%02X)", imu, bus, address);
     return true;
 }
 
-void MPU6050Driver::calibrate() {
-    Logger::info("Calibrating MPU6050...");
-    
-    // Read multiple samples and average
-    float accelXSum = 0, accelYSum = 0, accelZSum = 0;
-    float gyroXSum = 0, gyroYSum = 0, gyroZSum = 0;
-    const int samples = 100;
-    
-    for (int i = 0; i < samples; i++) {
-        update();
-        accelXSum += lastReading.accelX;
-        accelYSum += lastReading.accelY;
-        accelZSum += lastReading.accelZ;
-        gyroXSum += lastReading.gyroX;
-        gyroYSum += lastReading.gyroY;
-        gyroZSum += lastReading.gyroZ;
-        delay(10);
-    }
-    
-    // Store offsets (simplified - in production use proper calibration)
-    Logger::info("MPU6050 calibration complete");
+bool MPU6050Driver::isInitialized() const {
+    return initialized;
 }
 
 bool MPU6050Driver::isConnected() {
-    Wire.beginTransmission(deviceAddress);
-    return Wire.endTransmission() == 0;
+    // An address-only transfer, acknowledged if the device is there
+    I2CTransaction probe;
+    probe.bus = bus;
+    probe.address = address;
+    return I2CEngine::transfer(probe);
+}
+
+uint8_t MPU6050Driver::getBus() const {
+    return bus;
+}
+
+uint8_t MPU6050Driver::getAddress() const {
+    return address;
 }
 
-float MPU6050Driver::readAccel() {
-    update();
+bool MPU6050Driver::poll() {
+    if (!initialized) {
+        return false;
+    }
+    // At the sample rate a burst takes well under a tick; if the bus is
+    // slower, skip rather than queue a backlog of stale reads
+    if (burst.isPending()) {
+        busyPolls++;
+        return false;
+    }
+    return I2CEngine::submit(burst);
+}
+
+uint32_t MPU6050Driver::getBusyPollCount() const {
+    return busyPolls;
+}
+
+void MPU6050Driver::onBurst(I2CTransaction& transaction, bool ok) {
+    MPU6050Driver& imu = *static_cast<MPU6050Driver*>(transaction.context);
+    MPU6050Data data = {};
+    if (!ok || !decodeBurst(imu.burstBytes, data)) {
+        return;
+    }
+    const ImuCalibration& calibration = imu.calibration;
+    data.accelX *= calibration.accelScale;
+    data.accelY *= calibration.accelScale;
+    data.accelZ *= calibration.accelScale;
+    data.gyroX -= calibration.gyroBias[0];
+    data.gyroY -= calibration.gyroBias[1];
+    data.gyroZ -= calibration.gyroBias[2];
+    uint32_t count = imu.sampleCount.load(std::memory_order_relaxed);
+    imu.ring[count & RING_MASK] = data;
+    imu.sampleCount.store(count + 1, std::memory_order_release);
+}
+
+uint32_t MPU6050Driver::getSampleCount() const {
+    return sampleCount.load(std::memory_order_acquire);
+}
+
+uint8_t MPU6050Driver::readSamples(uint32_t fromSample, MPU6050Data* out, uint8_t maxSamples) const {
+    uint32_t count = sampleCount.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(count - fromSample) <= 0) {
+        return 0;
+    }
+    
+    // The slot after the newest may be being written
+    uint32_t available = count - fromSample;
+    if (available > IMU_RING_SAMPLES - 1) {
+        fromSample = count - (IMU_RING_SAMPLES - 1);
+        available = IMU_RING_SAMPLES - 1;
+    }
+    if (available > maxSamples) {
+        available = maxSamples;
+    }
+    uint8_t copied = 0;
+    while (copied < available && readSlot(fromSample + copied, out[copied])) {
+        copied++;
+    }
+    return copied;
+}
+
+float MPU6050Driver::readAccel() const {
+    MPU6050Data data = readAll();
     // Return magnitude of acceleration
-    return sqrt(lastReading.accelX * lastReading.accelX +
-                lastReading.accelY * lastReading.accelY +
-                lastReading.accelZ * lastReading.accelZ);
+    return sqrt(data.accelX * data.accelX +
+                data.accelY * data.accelY +
+                data.accelZ * data.accelZ);
 }
 
-float MPU6050Driver::readGyro() {
-    update();
+float MPU6050Driver::readGyro() const {
+    MPU6050Data data = readAll();
     // Return magnitude of angular velocity
-    return sqrt(lastReading.gyroX * lastReading.gyroX +
-                lastReading.gyroY * lastReading.gyroY +
-                lastReading.gyroZ * lastReading.gyroZ);
+    return sqrt(data.gyroX * data.gyroX +
+                data.gyroY * data.gyroY +
+                data.gyroZ * data.gyroZ);
 }
 
-MPU6050Data MPU6050Driver::readAll() {
-    update();
-    return lastReading;
+MPU6050Data MPU6050Driver::readAll() const {
+    MPU6050Data data = {};
+    uint32_t count = sampleCount.load(std::memory_order_acquire);
+    while (count > 0 && !readSlot(count - 1, data)) {
+        count = sampleCount.load(std::memory_order_acquire);
+    }
+    return data;
 }
 
-float MPU6050Driver::getRoll() {
-    update();
-    return lastReading.roll;
+float MPU6050Driver::getRoll() const {
+    return readAll().roll;
 }
 
-float MPU6050Driver::getPitch() {
-    update();
-    return lastReading.pitch;
+float MPU6050Driver::getPitch() const {
+    return readAll().pitch;
 }
 
-float MPU6050Driver::getYaw() {
-    update();
-    return lastReading.yaw;
+float MPU6050Driver::getYaw() const {
+    return readAll().yaw;
 }
 
 void MPU6050Driver::setAccelRange(uint8_t range) {
@@ -112,54 +245,48 @@ void MPU6050Driver::setGyroRange(uint8_t range) {
     writeRegister(0x1B, value | (range << 3));
 }
 
-void MPU6050Driver::update() {
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(0x3B); // Start register
-    Wire.endTransmission(false);
-    Wire.requestFrom(deviceAddress, 14, true);
-    
-    // Read accelerometer
-    int16_t accelX = Wire.read() << 8 | Wire.read();
-    int16_t accelY = Wire.read() << 8 | Wire.read();
-    int16_t accelZ = Wire.read() << 8 | Wire.read();
-    
-    // Read temperature
-    int16_t temp = Wire.read() << 8 | Wire.read();
-    
-    // Read gyroscope
-    int16_t gyroX = Wire.read() << 8 | Wire.read();
-    int16_t gyroY = Wire.read() << 8 | Wire.read();
-    int16_t gyroZ = Wire.read() << 8 | Wire.read();
-    
-    // Convert to physical units (simplified - assumes ±2g and ±250°/s)
-    lastReading.accelX = accelX / 16384.0f;
-    lastReading.accelY = accelY / 16384.0f;
-    lastReading.accelZ = accelZ / 16384.0f;
-    lastReading.temperature = temp / 340.0f + 36.53f;
-    lastReading.gyroX = gyroX / 131.0f;
-    lastReading.gyroY = gyroY / 131.0f;
-    lastReading.gyroZ = gyroZ / 131.0f;
-    
-    // Calculate roll and pitch
-    lastReading.roll = atan2(lastReading.accelY, lastReading.accelZ) * 180.0f / PI;
-    lastReading.pitch = atan2(-lastReading.accelX, 
-                              sqrt(lastReading.accelY * lastReading.accelY + 
-                                   lastReading.accelZ * lastReading.accelZ)) * 180.0f / PI;
+void MPU6050Driver::setCalibration(const ImuCalibration& correction) {
+    // onBurst() reads it in the I2C service interrupt
+    taskENTER_CRITICAL();
+    calibration = correction;
+    taskEXIT_CRITICAL();
+}
+
+ImuCalibration MPU6050Driver::getCalibration() const {
+    taskENTER_CRITICAL();
+    ImuCalibration correction = calibration;
+    taskEXIT_CRITICAL();
+    return correction;
+}
+
+bool MPU6050Driver::readSlot(uint32_t sample, MPU6050Data& data) const {
+    data = ring[sample & RING_MASK];
+    // The slot is rewritten once the producer is a whole ring past it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sampleCount.load(std::memory_order_relaxed) - sample < IMU_RING_SAMPLES;
 }
 
 int16_t MPU6050Driver::readRegister(uint8_t reg) {
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(reg);
-    Wire.endTransmission(false);
-    Wire.requestFrom(deviceAddress, 1, true);
-    return Wire.read();
+    uint8_t value = 0;
+    I2CTransaction transaction;
+    transaction.bus = bus;
+    transaction.address = address;
+    transaction.writeData = &reg;
+    transaction.writeLength = 1;
+    transaction.readData = &value;
+    transaction.readLength = 1;
+    I2CEngine::transfer(transaction);
+    return value;
 }
 
 void MPU6050Driver::writeRegister(uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(reg);
-    Wire.write(value);
-    Wire.endTransmission();
+    uint8_t bytes[2] = {reg, value};
+    I2CTransaction transaction;
+    transaction.bus = bus;
+    transaction.address = address;
+    transaction.writeData = bytes;
+    transaction.writeLength = 2;
+    I2CEngine::transfer(transaction);
 }
 
 } // namespace Sensors
@@ -1,7 +1,9 @@
 #ifndef BITS_SENSORS_MPU6050_DRIVER_H
 #define BITS_SENSORS_MPU6050_DRIVER_H
 
-#include <Wire.h>
+#include <atomic>
+#include "config.h"
+#include "sensors/i2c_engine.h"
 
 namespace BITS {
 namespace Sensors {
@@ -11,33 +13,86 @@ struct MPU6050Data {
     float gyroX, gyroY, gyroZ;
     float temperature;
     float roll, pitch, yaw;
+    uint32_t timestamp;     // micros() when the sample was read
 };
 
+// Corrections applied to every sample as it is decoded
+struct ImuCalibration {
+    float gyroBias[3];      // °/s, subtracted
+    float accelScale;       // So that the accel reads 1 g at rest
+};
+
+// One MPU6050 on the I2CEngine. There is a fixed instance per IMU: IMU n
+// is on bus n % I2C_BUS_COUNT at MPU6050_I2C_ADDRESS + n / I2C_BUS_COUNT,
+// so the first two sit on different buses and are read in parallel.
+// IMUs are read by the sensor task only: pollAll() queues one I2C burst of
+// the data-ready flag and a sample per IMU and returns at once. When a
+// burst completes, a new sample is appended to that IMU's timestamped ring.
+// Every other accessor reads the ring and never touches the bus, so gesture
+// recognition and fusion can run in other tasks.
 class MPU6050Driver {
 public:
-    static bool init(uint8_t address = 0x68);
-    static void calibrate();
-    static bool isConnected();
+    // imu < MAX_IMUS; its accessors return zeros until it is initialized
+    static MPU6050Driver& get(uint8_t imu = 0);
+    // Once per sensor tick: queues a burst for every initialized IMU
+    static void pollAll();
+    
+    // Wakes and configures the IMU; true at once if already done
+    bool init();
+    bool isInitialized() const;
+    bool isConnected();
+    uint8_t getBus() const;
+    uint8_t getAddress() const;
+    
+    // Queues this IMU's burst; false if the previous one is still on the bus
+    bool poll();
+    // Ticks skipped because the previous burst had not finished
+    uint32_t getBusyPollCount() const;
+    // Samples appended so far; a sample is addressed by its number
+    uint32_t getSampleCount() const;
+    // Copies samples [fromSample, getSampleCount()) still in the ring,
+    // oldest first and at most maxSamples; returns how many were copied
+    uint8_t readSamples(uint32_t fromSample, MPU6050Data* out, uint8_t maxSamples) const;
     
-    static float readAccel();
-    static float readGyro();
-    static MPU6050Data readAll();
+    // Latest sample
+    float readAccel() const;
+    float readGyro() const;
+    MPU6050Data readAll() const;
     
-    static float getRoll();
-    static float getPitch();
-    static float getYaw();
+    float getRoll() const;
+    float getPitch() const;
+    float getYaw() const;
     
-    static void setAccelRange(uint8_t range);
-    static void setGyroRange(uint8_t range);
+    void setAccelRange(uint8_t range);
+    void setGyroRange(uint8_t range);
+    
+    // Learned in the background by CalibrationEngine; applies from the next sample
+    void setCalibration(const ImuCalibration& correction);
+    ImuCalibration getCalibration() const;
 
 private:
-    static bool initialized;
-    static uint8_t deviceAddress;
-    static MPU6050Data lastReading;
+    static constexpr uint32_t RING_MASK = IMU_RING_SAMPLES - 1;
+    // INT_STATUS, then accel, temperature and gyro words
+    static constexpr uint8_t BURST_BYTES = 15;
+    
+    static MPU6050Driver imus[MAX_IMUS];
+    
+    uint8_t bus = 0;
+    uint8_t address = MPU6050_I2C_ADDRESS;
+    bool initialized = false;
+    MPU6050Data ring[IMU_RING_SAMPLES] = {};
+    std::atomic<uint32_t> sampleCount{0};
+    uint32_t busyPolls = 0;
+    ImuCalibration calibration = {{0.0f, 0.0f, 0.0f}, 1.0f};
+    // poll()'s transaction, reused every tick
+    uint8_t burstBytes[BURST_BYTES] = {};
+    I2CTransaction burst;
     
-    static void update();
-    static int16_t readRegister(uint8_t reg);
-    static void writeRegister(uint8_t reg, uint8_t value);
+    // Completion of poll()'s burst, in the I2C service interrupt
+    static void onBurst(I2CTransaction& transaction, bool ok);
+    bool readSlot(uint32_t sample, MPU6050Data& data) const;
+    int16_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint8_t value);
 };
 
 } // namespace Sensors
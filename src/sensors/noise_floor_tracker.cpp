@@ -0,0 +1,97 @@
+#include "sensors/noise_floor_tracker.h"
+#include <math.h>
+
+namespace BITS {
+namespace Sensors {
+
+namespace {
+
+// ADC quantisation noise, 1/12 count squared: a channel that reads the same
+// count every tick still gets a clamp wider than one count
+constexpr float MIN_VARIANCE = 1.0f / 12.0f;
+
+inline float minOf(float a, float b) {
+    return a < b ? a : b;
+}
+
+inline float maxOf(float a, float b) {
+    return a > b ? a : b;
+}
+
+} // namespace
+
+NoiseFloorTracker::NoiseFloorTracker() {
+    init();
+}
+
+void NoiseFloorTracker::init() {
+    setSampleRate(SENSOR_POLL_RATE_HZ);
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        clear(i);
+    }
+}
+
+void NoiseFloorTracker::setSampleRate(float sampleRateHz) {
+    if (sampleRateHz > 0.0f) {
+        alpha = 1.0f - expf(-1000.0f / (NOISE_FLOOR_TIME_CONSTANT_MS * sampleRateHz));
+    }
+}
+
+void NoiseFloorTracker::track(uint8_t channel, float meanCounts, float noiseCounts, float marginCounts) {
+    if (channel >= MAX_SENSORS) {
+        return;
+    }
+    means[channel] = meanCounts;
+    variances[channel] = maxOf(noiseCounts * noiseCounts, MIN_VARIANCE);
+    margins[channel] = marginCounts;
+    masks[channel] = 1.0f;
+}
+
+void NoiseFloorTracker::clear(uint8_t channel) {
+    if (channel >= MAX_SENSORS) {
+        return;
+    }
+    // Untracked channels still go through update(), so keep them finite
+    means[channel] = 0.0f;
+    variances[channel] = MIN_VARIANCE;
+    margins[channel] = 0.0f;
+    masks[channel] = 0.0f;
+}
+
+bool NoiseFloorTracker::isTracking(uint8_t channel) const {
+    return channel < MAX_SENSORS && masks[channel] != 0.0f;
+}
+
+float NoiseFloorTracker::getFloor(uint8_t channel) const {
+    return channel < MAX_SENSORS ? means[channel] : 0.0f;
+}
+
+float NoiseFloorTracker::getNoise(uint8_t channel) const {
+    return channel < MAX_SENSORS ? sqrtf(variances[channel]) : 0.0f;
+}
+
+void NoiseFloorTracker::update(const float* counts, const uint32_t* heldBits, const float* scales,
+                               float* thresholds, uint8_t count) {
+    if (count > MAX_SENSORS) {
+        count = MAX_SENSORS;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        float held = static_cast<float>((heldBits[i / 32] >> (i & 31)) & 1);
+        float weight = alpha * masks[i] * (1.0f - held);
+        float sigma = sqrtf(variances[i]);
+        
+        // Winsorised innovation: spikes count as NOISE_FLOOR_OUTLIER_SIGMAS,
+        // which a lasting shift still gets through as the variance grows
+        float bound = NOISE_FLOOR_OUTLIER_SIGMAS * sigma;
+        float delta = minOf(maxOf(counts[i] - means[i], -bound), bound);
+        means[i] += weight * delta;
+        variances[i] = maxOf((1.0f - weight) * (variances[i] + weight * delta * delta), MIN_VARIANCE);
+        
+        float threshold = (means[i] + maxOf(margins[i], CALIBRATION_NOISE_SIGMAS * sigma)) * scales[i];
+        thresholds[i] += masks[i] * (threshold - thresholds[i]);
+    }
+}
+
+} // namespace Sensors
+} // namespace BITS
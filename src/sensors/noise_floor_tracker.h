@@ -0,0 +1,52 @@
+#ifndef BITS_SENSORS_NOISE_FLOOR_TRACKER_H
+#define BITS_SENSORS_NOISE_FLOOR_TRACKER_H
+
+#include <stdint.h>
+#include "config.h"
+
+namespace BITS {
+namespace Sensors {
+
+// Keeps analog thresholds at a channel's noise floor plus k standard
+// deviations (CALIBRATION_NOISE_SIGMAS) as the floor moves on stage. Each
+// tracked channel has an exponentially weighted mean and variance of its
+// resting readings, in ADC counts, over NOISE_FLOOR_TIME_CONSTANT_MS.
+// Readings are clamped to NOISE_FLOOR_OUTLIER_SIGMAS around the mean, so a
+// stray spike moves nothing much while a lasting shift still gets through,
+// and channels in use are held. State is structure-of-arrays and update()
+// runs the same branch-free pass over every channel, with a 0/1 mask for
+// the channels being tracked.
+class NoiseFloorTracker {
+public:
+    NoiseFloorTracker();
+    void init();
+    // Readings per second, for the time constant; SENSOR_POLL_RATE_HZ until set
+    void setSampleRate(float sampleRateHz);
+    
+    // Starts from a calibrated floor; the threshold never comes closer to
+    // the mean than marginCounts
+    void track(uint8_t channel, float meanCounts, float noiseCounts, float marginCounts);
+    void clear(uint8_t channel);
+    bool isTracking(uint8_t channel) const;
+    float getFloor(uint8_t channel) const;
+    float getNoise(uint8_t channel) const;
+    
+    // One tick of readings in counts. Channels in heldBits (triggered or
+    // above threshold) are not learned from. thresholds[i] is set to
+    // (mean + max(margin, k * sigma)) * scales[i] for tracked channels and
+    // left alone for the rest.
+    void update(const float* counts, const uint32_t* heldBits, const float* scales, float* thresholds,
+                uint8_t count);
+
+private:
+    float alpha;                            // EWMA weight of a new reading
+    float means[MAX_SENSORS];
+    float variances[MAX_SENSORS];
+    float margins[MAX_SENSORS];             // Counts
+    float masks[MAX_SENSORS];               // 1 for tracked channels
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_NOISE_FLOOR_TRACKER_H
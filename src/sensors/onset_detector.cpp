@@ -0,0 +1,105 @@
+#include "sensors/onset_detector.h"
+
+namespace BITS {
+namespace Sensors {
+
+namespace {
+
+constexpr float ENVELOPE_RELEASE_US = 2000.0f;
+constexpr float NOISE_FLOOR_TAU_US = 200000.0f;
+constexpr float NOISE_MARGIN = 4.0f;        // Threshold above the noise floor
+constexpr float MASK_RATIO = 0.9f;          // Mask start, relative to the held peak
+
+// Per-sample coefficient of a one-pole filter with time constant tau
+inline float coefficient(uint32_t dt, float tau) {
+    float k = dt / tau;
+    return k < 1.0f ? k : 1.0f;
+}
+
+} // namespace
+
+OnsetDetector::OnsetDetector()
+    : peakHoldUs(1000), maskUs(30000), envelope(0.0f), noiseFloor(0.0f), peak(0.0f), lastSample(0.0f),
+      onsetMicros(0), lastMicros(0), state(State::IDLE) {}
+
+void OnsetDetector::init(uint32_t peakHoldUs, uint32_t retriggerMaskUs) {
+    this->peakHoldUs = peakHoldUs;
+    maskUs = retriggerMaskUs;
+    reset();
+}
+
+void OnsetDetector::reset() {
+    envelope = 0.0f;
+    noiseFloor = 0.0f;
+    peak = 0.0f;
+    lastSample = 0.0f;
+    onsetMicros = 0;
+    lastMicros = 0;
+    state = State::IDLE;
+}
+
+void OnsetDetector::setRetriggerMask(uint32_t maskUs) {
+    this->maskUs = maskUs;
+}
+
+bool OnsetDetector::process(float sample, uint32_t timeUs, float threshold, Hit& hit) {
+    uint32_t dt = timeUs - lastMicros;
+    envelope -= envelope * coefficient(dt, ENVELOPE_RELEASE_US);
+    if (sample > envelope) {
+        envelope = sample;
+    }
+    
+    bool complete = false;
+    if (state == State::HOLDING) {
+        peak = sample > peak ? sample : peak;
+        if (timeUs - onsetMicros >= peakHoldUs) {
+            hit.onsetMicros = onsetMicros;
+            hit.peak = peak;
+            state = State::MASKED;
+            complete = true;
+        }
+    } else {
+        float level = noiseFloor * NOISE_MARGIN;
+        level = level > threshold ? level : threshold;
+        if (state == State::MASKED) {
+            // The mask falls linearly from near the peak to nothing
+            uint32_t elapsed = timeUs - onsetMicros - peakHoldUs;
+            if (elapsed >= maskUs) {
+                state = State::IDLE;
+            } else {
+                float mask = peak * MASK_RATIO * (1.0f - static_cast<float>(elapsed) / maskUs);
+                level = mask > level ? mask : level;
+            }
+        }
+        if (state == State::IDLE) {
+            noiseFloor += (envelope - noiseFloor) * coefficient(dt, NOISE_FLOOR_TAU_US);
+        }
+        
+        if (sample > level && lastSample <= level) {
+            // Onset where the signal crossed the level between the two samples;
+            // a signal that stays above the level is still the same hit
+            onsetMicros = timeUs;
+            if (dt < peakHoldUs) {
+                float fraction = (level - lastSample) / (sample - lastSample);
+                onsetMicros = lastMicros + static_cast<uint32_t>(fraction * dt);
+            }
+            peak = sample;
+            state = State::HOLDING;
+        }
+    }
+    
+    lastSample = sample;
+    lastMicros = timeUs;
+    return complete;
+}
+
+float OnsetDetector::getEnvelope() const {
+    return envelope;
+}
+
+float OnsetDetector::getNoiseFloor() const {
+    return noiseFloor;
+}
+
+} // namespace Sensors
+} // namespace BITS
@@ -0,0 +1,56 @@
+#ifndef BITS_SENSORS_ONSET_DETECTOR_H
+#define BITS_SENSORS_ONSET_DETECTOR_H
+
+#include <stdint.h>
+
+namespace BITS {
+namespace Sensors {
+
+// Hit detection for one piezo channel, fed every ADC scan. An onset is a
+// reading rising through an adaptive threshold: the channel's threshold,
+// raised above the noise floor of a peak-following envelope and, after a
+// hit, above a mask that decays from the hit's peak so ringing does not
+// retrigger but a roll does.
+// A hit is reported once its peak-hold window closes, with the onset time
+// interpolated between samples and the held peak as its velocity.
+class OnsetDetector {
+public:
+    struct Hit {
+        uint32_t onsetMicros;
+        float peak;             // Largest sample in the peak-hold window
+    };
+    
+    OnsetDetector();
+    void init(uint32_t peakHoldUs, uint32_t retriggerMaskUs);
+    void reset();
+    void setRetriggerMask(uint32_t maskUs);
+    
+    // Feeds one rectified sample taken at timeUs; threshold is the channel's
+    // configured minimum. Returns true when a hit is complete.
+    bool process(float sample, uint32_t timeUs, float threshold, Hit& hit);
+    
+    float getEnvelope() const;
+    float getNoiseFloor() const;
+
+private:
+    enum class State : uint8_t {
+        IDLE,
+        HOLDING,    // Onset found, collecting the peak
+        MASKED      // Hit reported, retrigger threshold decaying
+    };
+    
+    uint32_t peakHoldUs;
+    uint32_t maskUs;
+    float envelope;
+    float noiseFloor;
+    float peak;
+    float lastSample;
+    uint32_t onsetMicros;
+    uint32_t lastMicros;
+    State state;
+};
+
+} // namespace Sensors
+} // namespace BITS
+
+#endif // BITS_SENSORS_ONSET_DETECTOR_H
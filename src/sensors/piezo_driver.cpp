@@ -5,6 +5,8 @@
 namespace BITS {
 namespace Sensors {
 
+using Core::Logger;
+
 PiezoDriver::PiezoSensor PiezoDriver::sensors[MAX_PIEZO_SENSORS];
 uint8_t PiezoDriver::sensorCount = 0;
 bool PiezoDriver::initialized = false;
@@ -22,11 +24,11 @@ bool PiezoDriver::initSensor(uint8_t id, uint8_t gpio) {
     
     PiezoSensor* sensor = &sensors[id];
     sensor->gpio = gpio;
-    sensor->threshold = 100.0f; // Default threshold (mV)
+    sensor->threshold = DEFAULT_THRESHOLD_MV;
     sensor->lastValue = 0.0f;
     sensor->velocity = 0.0f;
     sensor->lastTriggerTime = 0;
-    sensor->debounceTime = 50; // 50ms debounce
+    sensor->debounceTime = DEFAULT_DEBOUNCE_MS;
     sensor->triggered = false;
     
     pinMode(gpio, INPUT);
@@ -47,10 +49,10 @@ void PiezoDriver::calibrate(uint8_t id) {
         sum += analogRead(sensor->gpio);
         delay(10);
     }
-    float baseline = (sum / samples) * (3.3f / 4095.0f) * 1000.0f; // Convert to mV
+    float baseline = (sum / samples) * MILLIVOLTS_PER_COUNT;
     
     // Set threshold slightly above baseline
-    sensor->threshold = baseline + 50.0f;
+    sensor->threshold = baseline + CALIBRATION_MARGIN_MV;
     Logger::info("Piezo sensor %d calibrated: threshold = %.2f mV", id, sensor->threshold);
 }
 
@@ -59,7 +61,7 @@ float PiezoDriver::read(uint8_t id) {
     if (!sensor) return 0.0f;
     
     int raw = analogRead(sensor->gpio);
-    float voltage = (raw / 4095.0f) * 3.3f * 1000.0f; // Convert to mV
+    float voltage = raw * MILLIVOLTS_PER_COUNT;
     
     // Calculate velocity (rate of change)
     sensor->velocity = abs(voltage - sensor->lastValue);
@@ -19,6 +19,15 @@ public:
     static void setThreshold(uint8_t id, float threshold);
     static float getThreshold(uint8_t id);
     static void setDebounceTime(uint8_t id, uint32_t timeMs);
+    
+    // Conversion and defaults, shared with SensorManager's channel table
+    static constexpr float MILLIVOLTS_PER_COUNT = 3.3f * 1000.0f / 4095.0f;
+    static constexpr float DEFAULT_THRESHOLD_MV = 100.0f;
+    static constexpr float CALIBRATION_MARGIN_MV = 50.0f;     // Above the resting baseline
+    static constexpr uint32_t DEFAULT_DEBOUNCE_MS = 50;
+    // Onset detection on ADC engine scans (see OnsetDetector)
+    static constexpr uint32_t PEAK_HOLD_US = 1000;
+    static constexpr uint32_t DEFAULT_RETRIGGER_MASK_US = 30000;
 
 private:
     static constexpr uint8_t MAX_PIEZO_SENSORS = 8;
@@ -5,6 +5,8 @@
 namespace BITS {
 namespace Sensors {
 
+using Core::Logger;
+
 PressureDriver::PressureSensor PressureDriver::sensors[MAX_PRESSURE_SENSORS];
 uint8_t PressureDriver::sensorCount = 0;
 bool PressureDriver::initialized = false;
@@ -22,7 +24,7 @@ bool PressureDriver::initSensor(uint8_t id, uint8_t gpio) {
     
     PressureSensor* sensor = &sensors[id];
     sensor->gpio = gpio;
-    sensor->threshold = 100.0f; // Default threshold
+    sensor->threshold = DEFAULT_THRESHOLD_V;
     sensor->lastValue = 0.0f;
     sensor->velocity = 0.0f;
     sensor->triggered = false;
@@ -45,10 +47,10 @@ void PressureDriver::calibrate(uint8_t id) {
         sum += analogRead(sensor->gpio);
         delay(10);
     }
-    float baseline = (sum / samples) * (5.0f / 4095.0f); // Convert to volts
+    float baseline = (sum / samples) * VOLTS_PER_COUNT;
     
     // Set threshold slightly above baseline
-    sensor->threshold = baseline + 0.1f;
+    sensor->threshold = baseline + CALIBRATION_MARGIN_V;
     Logger::info("Pressure sensor %d calibrated: threshold = %.2f V", id, sensor->threshold);
 }
 
@@ -57,7 +59,7 @@ float PressureDriver::read(uint8_t id) {
     if (!sensor) return 0.0f;
     
     int raw = analogRead(sensor->gpio);
-    float voltage = (raw / 4095.0f) * 5.0f; // Convert to volts
+    float voltage = raw * VOLTS_PER_COUNT;
     
     // Calculate velocity (rate of change)
     sensor->velocity = abs(voltage - sensor->lastValue);
@@ -18,6 +18,11 @@ public:
     
     static void setThreshold(uint8_t id, float threshold);
     static float getThreshold(uint8_t id);
+    
+    // Conversion and defaults, shared with SensorManager's channel table
+    static constexpr float VOLTS_PER_COUNT = 5.0f / 4095.0f;
+    static constexpr float DEFAULT_THRESHOLD_V = 100.0f;     // Not reachable until calibrated
+    static constexpr float CALIBRATION_MARGIN_V = 0.1f;
 
 private:
     static constexpr uint8_t MAX_PRESSURE_SENSORS = 8;
@@ -1,54 +1,125 @@
 #include "sensors/sensor_fusion.h"
 #include "core/logger.h"
+#include "core/memory_budget.h"
+#include "rtos/semaphores.h"
 #include <math.h>
 
 namespace BITS {
 namespace Sensors {
 
-KalmanFilter::KalmanFilter() : Q(0.1f), R(0.1f), P(1.0f), X(0.0f), K(0.0f) {}
+using Core::Logger;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
 
-void KalmanFilter::init(float processNoise, float measurementNoise) {
-    Q = processNoise;
-    R = measurementNoise;
-    P = 1.0f;
-    X = 0.0f;
-    K = 0.0f;
+namespace {
+
+constexpr float DEG_TO_RADIANS = 0.0174532925f;
+constexpr float RAD_TO_DEGREES = 57.2957795f;
+constexpr float NOMINAL_DT = 1.0f / SENSOR_POLL_RATE_HZ;
+// Longer gaps (a stalled sensor task) are integrated as this much
+constexpr float MAX_DT = 10.0f * NOMINAL_DT;
+// Samples copied from a ring at a time, on the sensor task's stack
+constexpr uint8_t FUSE_BLOCK = 8;
+
+// VSQRT and VDIV on the M7's FPU are faster than the bit-trick inverse
+// square root, and exact
+inline float invSqrt(float x) {
+    return 1.0f / sqrtf(x);
 }
 
-float KalmanFilter::update(float measurement) {
-    // Prediction step
-    P = P + Q;
+} // namespace
+
+MadgwickFilter::MadgwickFilter() : beta(FUSION_BETA), q{1.0f, 0.0f, 0.0f, 0.0f} {}
+
+void MadgwickFilter::init(float gain) {
+    beta = gain;
+    reset();
+}
+
+void MadgwickFilter::reset() {
+    q = {1.0f, 0.0f, 0.0f, 0.0f};
+}
+
+void MadgwickFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
     
-    // Update step
-    K = P / (P + R);
-    X = X + K * (measurement - X);
-    P = (1 - K) * P;
+    // Rate of change of the quaternion from the gyro
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
     
-    return X;
+    // Gradient descent step towards the attitude gravity implies; skipped
+    // in free fall, where the accelerometer has no direction
+    float accelNormSq = ax * ax + ay * ay + az * az;
+    if (accelNormSq > 0.0f) {
+        float recipNorm = invSqrt(accelNormSq);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+        
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 +
+                   _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 +
+                   _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        float stepNormSq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (stepNormSq > 0.0f) {
+            float step = beta * invSqrt(stepNormSq);
+            qDot0 -= step * s0;
+            qDot1 -= step * s1;
+            qDot2 -= step * s2;
+            qDot3 -= step * s3;
+        }
+    }
+    
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    float recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q = {q0 * recipNorm, q1 * recipNorm, q2 * recipNorm, q3 * recipNorm};
+}
+
+void MadgwickFilter::getGravity(float& x, float& y, float& z) const {
+    x = 2.0f * (q.x * q.z - q.w * q.y);
+    y = 2.0f * (q.w * q.x + q.y * q.z);
+    z = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
 }
 
-void KalmanFilter::reset() {
-    P = 1.0f;
-    X = 0.0f;
-    K = 0.0f;
+void MadgwickFilter::getEuler(float& roll, float& pitch, float& yaw) const {
+    float gravityX, gravityY, gravityZ;
+    getGravity(gravityX, gravityY, gravityZ);
+    float sinPitch = -gravityX;
+    sinPitch = sinPitch > 1.0f ? 1.0f : (sinPitch < -1.0f ? -1.0f : sinPitch);
+    roll = atan2f(gravityY, gravityZ) * RAD_TO_DEGREES;
+    pitch = asinf(sinPitch) * RAD_TO_DEGREES;
+    yaw = atan2f(2.0f * (q.x * q.y + q.w * q.z), q.w * q.w + q.x * q.x - q.y * q.y - q.z * q.z) * RAD_TO_DEGREES;
 }
 
 // Sensor fusion static members
-KalmanFilter SensorFusion::rollFilter;
-KalmanFilter SensorFusion::pitchFilter;
-KalmanFilter SensorFusion::yawFilter;
-KalmanFilter SensorFusion::accelFilter;
-KalmanFilter SensorFusion::gyroFilter;
+SensorFusion::ImuState SensorFusion::states[MAX_IMUS];
 bool SensorFusion::initialized = false;
 
 void SensorFusion::init() {
-    rollFilter.init(0.1f, 0.1f);
-    pitchFilter.init(0.1f, 0.1f);
-    yawFilter.init(0.1f, 0.1f);
-    accelFilter.init(0.1f, 0.1f);
-    gyroFilter.init(0.1f, 0.1f);
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        ImuState& state = states[imu];
+        state.filter.init(FUSION_BETA);
+        state.nextSample = 0;
+        state.fused = 0;
+        state.started = false;
+        state.published = {};
+        state.published.q = state.filter.getQuaternion();
+    }
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "fusion state", sizeof(states));
     initialized = true;
-    Logger::info("Sensor fusion initialized");
+    Logger::info("Sensor fusion initialized (Madgwick, beta %.3f)", FUSION_BETA);
 }
 
 void SensorFusion::update() {
@@ -56,42 +127,131 @@ void SensorFusion::update() {
         init();
     }
     
-    MPU6050Data data = MPU6050Driver::readAll();
-    
-    // Update filters
-    rollFilter.update(data.roll);
-    pitchFilter.update(data.pitch);
-    yawFilter.update(data.yaw);
-    
-    float accelMag = sqrt(data.accelX * data.accelX +
-                          data.accelY * data.accelY +
-                          data.accelZ * data.accelZ);
-    accelFilter.update(accelMag);
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        const MPU6050Driver& driver = MPU6050Driver::get(imu);
+        if (!driver.isInitialized()) {
+            continue;
+        }
+        ImuState& state = states[imu];
+        
+        // Behind by more than the ring: resume at the oldest sample kept
+        uint32_t count = driver.getSampleCount();
+        if (count - state.nextSample > IMU_RING_SAMPLES - 1) {
+            state.nextSample = count - (IMU_RING_SAMPLES - 1);
+        }
+        MPU6050Data block[FUSE_BLOCK];
+        MPU6050Data last;
+        bool any = false;
+        uint8_t copied;
+        do {
+            copied = driver.readSamples(state.nextSample, block, FUSE_BLOCK);
+            for (uint8_t i = 0; i < copied; i++) {
+                fuse(state, block[i]);
+            }
+            if (copied > 0) {
+                last = block[copied - 1];
+                any = true;
+            }
+            state.nextSample += copied;
+        } while (copied == FUSE_BLOCK);
+        
+        if (any) {
+            publish(state, last);
+        }
+    }
+}
+
+Orientation SensorFusion::getOrientation(uint8_t imu) {
+    const ImuState& state = stateFor(imu);
     
-    float gyroMag = sqrt(data.gyroX * data.gyroX +
-                         data.gyroY * data.gyroY +
-                         data.gyroZ * data.gyroZ);
-    gyroFilter.update(gyroMag);
+    // Sequence-checked copy: retry if update() was publishing meanwhile
+    while (true) {
+        uint32_t before = state.version.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        Orientation orientation = state.published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (state.version.load(std::memory_order_relaxed) == before) {
+            return orientation;
+        }
+    }
+}
+
+Quaternion SensorFusion::getQuaternion(uint8_t imu) {
+    return getOrientation(imu).q;
+}
+
+float SensorFusion::getRoll(uint8_t imu) {
+    return getOrientation(imu).roll;
+}
+
+float SensorFusion::getPitch(uint8_t imu) {
+    return getOrientation(imu).pitch;
 }
 
-float SensorFusion::getRoll() {
-    return rollFilter.update(MPU6050Driver::getRoll());
+float SensorFusion::getYaw(uint8_t imu) {
+    return getOrientation(imu).yaw;
 }
 
-float SensorFusion::getPitch() {
-    return pitchFilter.update(MPU6050Driver::getPitch());
+float SensorFusion::getAccelMagnitude(uint8_t imu) {
+    return getOrientation(imu).accelMagnitude;
 }
 
-float SensorFusion::getYaw() {
-    return yawFilter.update(MPU6050Driver::getYaw());
+float SensorFusion::getLinearAccelMagnitude(uint8_t imu) {
+    Orientation orientation = getOrientation(imu);
+    return sqrtf(orientation.linearX * orientation.linearX + orientation.linearY * orientation.linearY +
+                 orientation.linearZ * orientation.linearZ);
 }
 
-float SensorFusion::getAccelMagnitude() {
-    return accelFilter.update(MPU6050Driver::readAccel());
+float SensorFusion::getGyroMagnitude(uint8_t imu) {
+    return getOrientation(imu).gyroMagnitude;
 }
 
-float SensorFusion::getGyroMagnitude() {
-    return gyroFilter.update(MPU6050Driver::readGyro());
+uint32_t SensorFusion::getFusedCount(uint8_t imu) {
+    return stateFor(imu).fused;
+}
+
+SensorFusion::ImuState& SensorFusion::stateFor(uint8_t imu) {
+    // Same fallback as MPU6050Driver::get(), so state and driver agree
+    return states[imu < MAX_IMUS ? imu : 0];
+}
+
+void SensorFusion::fuse(ImuState& state, const MPU6050Data& sample) {
+    float dt = NOMINAL_DT;
+    if (state.started) {
+        dt = (sample.timestamp - state.lastTimestamp) * 1e-6f;
+        dt = dt < MAX_DT ? dt : MAX_DT;
+    }
+    state.started = true;
+    state.lastTimestamp = sample.timestamp;
+    state.filter.update(sample.gyroX * DEG_TO_RADIANS, sample.gyroY * DEG_TO_RADIANS, sample.gyroZ * DEG_TO_RADIANS,
+                        sample.accelX, sample.accelY, sample.accelZ, dt);
+    state.fused++;
+}
+
+void SensorFusion::publish(ImuState& state, const MPU6050Data& sample) {
+    Orientation orientation;
+    orientation.q = state.filter.getQuaternion();
+    state.filter.getEuler(orientation.roll, orientation.pitch, orientation.yaw);
+    float gravityX, gravityY, gravityZ;
+    state.filter.getGravity(gravityX, gravityY, gravityZ);
+    orientation.linearX = sample.accelX - gravityX;
+    orientation.linearY = sample.accelY - gravityY;
+    orientation.linearZ = sample.accelZ - gravityZ;
+    orientation.accelMagnitude = sqrtf(sample.accelX * sample.accelX + sample.accelY * sample.accelY +
+                                       sample.accelZ * sample.accelZ);
+    orientation.gyroMagnitude = sqrtf(sample.gyroX * sample.gyroX + sample.gyroY * sample.gyroY +
+                                      sample.gyroZ * sample.gyroZ);
+    orientation.timestamp = sample.timestamp;
+    
+    // Readers spin while the version is odd, so keep the writer from being
+    // preempted in between
+    taskENTER_CRITICAL();
+    state.version.fetch_add(1, std::memory_order_acq_rel);
+    state.published = orientation;
+    state.version.fetch_add(1, std::memory_order_release);
+    taskEXIT_CRITICAL();
 }
 
 } // namespace Sensors
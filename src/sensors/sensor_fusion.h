@@ -1,51 +1,95 @@
 #ifndef BITS_SENSORS_SENSOR_FUSION_H
 #define BITS_SENSORS_SENSOR_FUSION_H
 
+#include <atomic>
+#include "config.h"
 #include "sensors/mpu6050_driver.h"
 
 namespace BITS {
 namespace Sensors {
 
-// Kalman filter for sensor fusion
-class KalmanFilter {
+struct Quaternion {
+    float w, x, y, z;
+};
+
+// Fused state of one IMU, as of its last fused sample
+struct Orientation {
+    Quaternion q;                           // Sensor attitude in the world frame
+    float roll, pitch, yaw;                 // Degrees
+    float linearX, linearY, linearZ;        // Acceleration with gravity removed, g, sensor frame
+    float accelMagnitude;                   // g, gravity included
+    float gyroMagnitude;                    // °/s
+    uint32_t timestamp;                     // micros() of the sample
+};
+
+// Madgwick's gradient-descent orientation filter for a 6-axis IMU: the
+// gyro rate is integrated into a quaternion and beta pulls it towards the
+// attitude the accelerometer's gravity vector implies. Float only, one
+// square root per normalization and no trigonometry, for 1-4 kHz updates.
+class MadgwickFilter {
 public:
-    KalmanFilter();
-    void init(float processNoise, float measurementNoise);
-    float update(float measurement);
+    MadgwickFilter();
+    void init(float beta);
     void reset();
+    // Gyro in rad/s, accel in any unit, dt in seconds
+    void update(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+    const Quaternion& getQuaternion() const { return q; }
+    // Gravity in the sensor frame, as a unit vector
+    void getGravity(float& x, float& y, float& z) const;
+    // Z-Y-X (yaw, pitch, roll) angles in degrees
+    void getEuler(float& roll, float& pitch, float& yaw) const;
 
 private:
-    float Q; // Process noise covariance
-    float R; // Measurement noise covariance
-    float P; // Estimation error covariance
-    float X; // State estimate
-    float K; // Kalman gain
+    float beta;
+    Quaternion q;
 };
 
-// Sensor fusion manager
+// Orientation of every IMU. The sensor task fuses each IMU sample exactly
+// once as it arrives in the driver's ring and publishes the result; the
+// getters return that cached state from any task, so reading it does not
+// advance the filter.
 class SensorFusion {
 public:
     static void init();
+    // Sensor task only: fuses the samples since the last call, per IMU
     static void update();
     
+    // Consistent copy of the last fused state
+    static Orientation getOrientation(uint8_t imu = 0);
+    static Quaternion getQuaternion(uint8_t imu = 0);
+    
     // Get fused orientation
-    static float getRoll();
-    static float getPitch();
-    static float getYaw();
+    static float getRoll(uint8_t imu = 0);
+    static float getPitch(uint8_t imu = 0);
+    static float getYaw(uint8_t imu = 0);
+    
+    // Get acceleration: raw magnitude, and magnitude without gravity
+    static float getAccelMagnitude(uint8_t imu = 0);
+    static float getLinearAccelMagnitude(uint8_t imu = 0);
     
-    // Get fused acceleration
-    static float getAccelMagnitude();
+    // Get angular velocity magnitude
+    static float getGyroMagnitude(uint8_t imu = 0);
     
-    // Get fused angular velocity
-    static float getGyroMagnitude();
+    // Samples fused so far for an IMU
+    static uint32_t getFusedCount(uint8_t imu = 0);
 
 private:
-    static KalmanFilter rollFilter;
-    static KalmanFilter pitchFilter;
-    static KalmanFilter yawFilter;
-    static KalmanFilter accelFilter;
-    static KalmanFilter gyroFilter;
+    struct ImuState {
+        MadgwickFilter filter;
+        uint32_t nextSample;                // Next ring sample to fuse
+        uint32_t lastTimestamp;
+        uint32_t fused;
+        bool started;
+        Orientation published;
+        std::atomic<uint32_t> version;      // Odd while published is rewritten
+    };
+    
+    static ImuState states[MAX_IMUS];
     static bool initialized;
+    
+    static ImuState& stateFor(uint8_t imu);
+    static void fuse(ImuState& state, const MPU6050Data& sample);
+    static void publish(ImuState& state, const MPU6050Data& sample);
 };
 
 } // namespace Sensors
@@ -1,17 +1,129 @@
 #include "sensors/sensor_manager.h"
+#include "sensors/adc_engine.h"
+#include "sensors/calibration_engine.h"
 #include "sensors/mpu6050_driver.h"
+#include "sensors/sensor_fusion.h"
 #include "sensors/piezo_driver.h"
-#include "sensors/ir_driver.h"
+#include "sensors/digital_scanner.h"
 #include "sensors/pressure_driver.h"
 #include "sensors/flex_driver.h"
+#include "core/config_manager.h"
+#include "core/schedule_manager.h"
 #include "core/logger.h"
+#include "core/trace.h"
+#include "core/event_queue.h"
+#include "core/memory_budget.h"
 #include "rtos/semaphores.h"
+#include "rtos/tasks.h"
+#include <math.h>
+#include <string.h>
 
 namespace BITS {
 namespace Sensors {
 
-SensorData SensorManager::sensors[MAX_SENSORS];
+using Core::ConfigManager;
+using Core::Logger;
+using Core::EventQueue;
+using Core::Event;
+using Core::EventType;
+using Core::MemoryBudget;
+using Core::MemorySubsystem;
+using Core::ScheduleManager;
+using Core::TaskId;
+
+static_assert(MAX_SENSORS % 32 == 0, "Sensor bit sets hold whole 32-bit words");
+static_assert(MAX_SENSORS < 255, "Sensor ids are uint8_t and 255 means none");
+
+namespace {
+
+// Serialises changes to the sensor table: polling and (un)registering
+class SensorLock {
+public:
+    SensorLock() {
+        if (RTOS::sensorMutex != nullptr) {
+            xSemaphoreTake(RTOS::sensorMutex, portMAX_DELAY);
+        }
+    }
+    ~SensorLock() {
+        if (RTOS::sensorMutex != nullptr) {
+            xSemaphoreGive(RTOS::sensorMutex);
+        }
+    }
+};
+
+SensorData emptySensorData() {
+    SensorData empty;
+    empty.type = SensorType::MPU6050;
+    empty.id = 255;
+    empty.value = 0.0f;
+    empty.velocity = 0.0f;
+    empty.timestamp = 0;
+    empty.triggered = false;
+    return empty;
+}
+
+inline uint32_t bitOf(uint8_t id) {
+    return 1UL << (id & 31);
+}
+
+// Block reductions: piezo strikes can be shorter than a tick, so they keep
+// the peak; pressure and flex are averaged to reduce noise
+uint16_t blockPeak(const uint16_t* block, uint8_t count) {
+    uint16_t peak = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        peak = block[i] > peak ? block[i] : peak;
+    }
+    return peak;
+}
+
+float blockMean(const uint16_t* block, uint8_t count) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        sum += block[i];
+    }
+    return static_cast<float>(sum) / count;
+}
+
+// Lowest set bit as a sensor id in word w, clearing it
+inline uint8_t takeLowestBit(uint32_t& bits, uint8_t w) {
+    uint8_t id = static_cast<uint8_t>(w * 32 + __builtin_ctz(bits));
+    bits &= bits - 1;
+    return id;
+}
+
+} // namespace
+
+SensorType SensorManager::types[MAX_SENSORS];
+uint8_t SensorManager::gpios[MAX_SENSORS];
+float SensorManager::counts[MAX_SENSORS];
+float SensorManager::scales[MAX_SENSORS];
+float SensorManager::offsets[MAX_SENSORS];
+float SensorManager::values[MAX_SENSORS];
+float SensorManager::velocities[MAX_SENSORS];
+float SensorManager::thresholds[MAX_SENSORS];
+uint32_t SensorManager::timestamps[MAX_SENSORS];
+uint32_t SensorManager::lastTriggerMs[MAX_SENSORS];
+OnsetDetector SensorManager::onsets[MAX_SENSORS];
+OnsetDetector::Hit SensorManager::hits[MAX_SENSORS];
+FilterBank SensorManager::filters;
+NoiseFloorTracker SensorManager::noiseFloors;
+uint32_t SensorManager::registeredBits[WORDS];
+uint32_t SensorManager::analogBits[WORDS];
+uint32_t SensorManager::levelBits[WORDS];
+uint32_t SensorManager::piezoBits[WORDS];
+uint32_t SensorManager::driverBits[WORDS];
+uint32_t SensorManager::digitalBits[WORDS];
+uint32_t SensorManager::triggerBits[WORDS];
+uint32_t SensorManager::driftBits[WORDS];
+uint8_t SensorManager::driftImus = 0;
+std::atomic<bool> SensorManager::profilesDirty{false};
+uint8_t SensorManager::channelEnd = 0;
+uint32_t SensorManager::lastScan = 0;
+uint32_t SensorManager::scheduleGeneration = 0;
+float SensorManager::pollRateHz = SENSOR_POLL_RATE_HZ;
 uint8_t SensorManager::sensorCount = 0;
+SensorManager::Snapshot SensorManager::snapshot;
+std::atomic<uint32_t> SensorManager::snapshotVersion{0};
 bool SensorManager::initialized = false;
 
 void SensorManager::init() {
@@ -20,136 +132,431 @@ void SensorManager::init() {
         return;
     }
     
-    // Initialize sensor drivers
-    MPU6050Driver::init();
-    PiezoDriver::init();
-    IRDriver::init();
-    PressureDriver::init();
-    FlexDriver::init();
+    // Initialize sensor drivers; analog channels live in the table below
+    MPU6050Driver::get(0).init();
+    SensorFusion::init();
+    DigitalScanner::init();
+    AdcEngine::init();
+    CalibrationEngine::init();
     
+    for (uint8_t w = 0; w < WORDS; w++) {
+        registeredBits[w] = 0;
+        analogBits[w] = 0;
+        levelBits[w] = 0;
+        piezoBits[w] = 0;
+        driverBits[w] = 0;
+        digitalBits[w] = 0;
+        triggerBits[w] = 0;
+        driftBits[w] = 0;
+    }
+    driftImus = 0;
+    channelEnd = 0;
     sensorCount = 0;
+    filters.init();
+    noiseFloors.init();
+    // Coefficients start from the current sensor period
+    scheduleGeneration = ScheduleManager::getGeneration() - 1;
+    followSchedule();
+    publishSnapshot();
+    
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "sensor table",
+                          sizeof(types) + sizeof(gpios) + sizeof(counts) + sizeof(scales) + sizeof(offsets) +
+                          sizeof(values) + sizeof(velocities) + sizeof(thresholds) + sizeof(timestamps) +
+                          sizeof(lastTriggerMs) + 8 * sizeof(registeredBits));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "piezo onsets", sizeof(onsets) + sizeof(hits));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "sensor filters", sizeof(filters));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "noise floors", sizeof(noiseFloors));
+    MemoryBudget::reserve(MemorySubsystem::SENSORS, "sensor snapshot", sizeof(snapshot));
     initialized = true;
-    Logger::info("Sensor manager initialized");
+    Logger::info("Sensor manager initialized (%d channels)", MAX_SENSORS);
 }
 
-void SensorManager::update() {
+uint8_t SensorManager::update() {
     if (!initialized) {
-        return;
+        return 0;
     }
+    TRACE_SCOPE("SensorManager::update");
+    
+    uint8_t changed = 0;
     
-    // Take mutex for sensor access
+    // The mutex keeps (un)registering and settings out; readers use the snapshot
     if (RTOS::sensorMutex && xSemaphoreTake(RTOS::sensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        // Poll all registered sensors
-        for (uint8_t i = 0; i < sensorCount; i++) {
-            pollSensor(i);
+        uint32_t now = millis();
+        uint8_t end = channelEnd;
+        uint8_t words = (end + 31) / 32;
+        bool scanning = AdcEngine::isRunning();
+        followSchedule();
+        
+        // Take the analog channels' readings since the last tick as blocks,
+        // or convert each channel once when the ADC engine is not scanning
+        uint32_t onsetBits[WORDS] = {};
+        if (scanning) {
+            uint32_t scans = AdcEngine::getScanCount();
+            uint16_t block[ADC_RING_SAMPLES];
+            for (uint8_t w = 0; w < words; w++) {
+                uint32_t bits = analogBits[w];
+                while (bits) {
+                    uint8_t id = takeLowestBit(bits, w);
+                    uint8_t count = AdcEngine::readBlock(id, lastScan, scans, block);
+                    if (count == 0) {
+                        continue;
+                    }
+                    if (!(piezoBits[w] & bitOf(id))) {
+                        counts[id] = blockMean(block, count);
+                        continue;
+                    }
+                    
+                    // Piezo hits are found at the scan rate, not per tick
+                    counts[id] = blockPeak(block, count);
+                    uint32_t scan = scans - count;
+                    for (uint8_t i = 0; i < count; i++, scan++) {
+                        if (onsets[id].process(block[i] * scales[id], AdcEngine::getScanMicros(scan), thresholds[id],
+                                               hits[id])) {
+                            onsetBits[w] |= bitOf(id);
+                        }
+                    }
+                }
+            }
+            lastScan = scans;
+        } else {
+            for (uint8_t w = 0; w < words; w++) {
+                uint32_t bits = analogBits[w];
+                while (bits) {
+                    uint8_t id = takeLowestBit(bits, w);
+                    counts[id] = analogRead(gpios[id]);
+                }
+            }
+        }
+        
+        // Digital channels: a read per port, debounced together; their state
+        // goes through the conversion pass as a 0/1 count
+        uint32_t digitalChanged[WORDS] = {};
+        if (DigitalScanner::scan(digitalChanged)) {
+            const uint32_t* state = DigitalScanner::getStateBits();
+            for (uint8_t w = 0; w < words; w++) {
+                uint32_t bits = digitalChanged[w] & digitalBits[w];
+                while (bits) {
+                    uint8_t id = takeLowestBit(bits, w);
+                    counts[id] = (state[w] & bitOf(id)) ? 1.0f : 0.0f;
+                }
+            }
+        }
+        
+        // Channels and IMUs started from a profile are checked for drift by
+        // a background run, once none is in progress
+        if (!CalibrationEngine::isRunning()) {
+            uint32_t pending = driftImus;
+            for (uint8_t w = 0; w < WORDS; w++) {
+                pending |= driftBits[w];
+            }
+            if (pending) {
+                CalibrationEngine::start(driftBits, driftImus, now);
+                memset(driftBits, 0, sizeof(driftBits));
+                driftImus = 0;
+            }
+        }
+        
+        // Background calibration learns from this tick's readings, leaving
+        // out channels in use; its results all apply before the conversion
+        if (CalibrationEngine::isRunning()) {
+            uint32_t skip[WORDS];
+            for (uint8_t w = 0; w < WORDS; w++) {
+                skip[w] = triggerBits[w] | onsetBits[w];
+                uint32_t bits = w < words ? analogBits[w] : 0;
+                while (bits) {
+                    uint8_t id = takeLowestBit(bits, w);
+                    if (fabsf(counts[id] * scales[id] - offsets[id]) > thresholds[id]) {
+                        skip[w] |= bitOf(id);
+                    }
+                }
+            }
+            uint32_t done[WORDS];
+            if (CalibrationEngine::update(counts, skip, end, now, done)) {
+                applyCalibration(done);
+                storeProfiles(done);
+            }
+        }
+        
+        // Convert every channel in one pass, then smooth them all in
+        // another. Velocities hold the new values in between; readers only
+        // see the snapshot.
+        for (uint8_t i = 0; i < end; i++) {
+            velocities[i] = fabsf(counts[i] * scales[i] - offsets[i]);
+        }
+        filters.process(velocities, end);
+        for (uint8_t i = 0; i < end; i++) {
+            float value = velocities[i];
+            velocities[i] = fabsf(value - values[i]);
+            values[i] = value;
+            timestamps[i] = now;
+        }
+        
+        // A piezo hit's velocity is its held peak
+        for (uint8_t w = 0; w < words; w++) {
+            uint32_t bits = onsetBits[w];
+            while (bits) {
+                uint8_t id = takeLowestBit(bits, w);
+                velocities[id] = hits[id].peak;
+            }
+        }
+        
+        // IMU channels keep their state in the driver, which queues one bus
+        // read per IMU and tick however many channels and consumers there are
+        uint32_t driverAny = 0;
+        for (uint8_t w = 0; w < words; w++) {
+            driverAny |= driverBits[w];
+        }
+        if (driverAny) {
+            // Fuse the samples that arrived since the last tick, then queue
+            // the next reads
+            SensorFusion::update();
+            MPU6050Driver::pollAll();
+        }
+        uint32_t driverTriggered[WORDS] = {};
+        for (uint8_t w = 0; w < words; w++) {
+            uint32_t bits = driverBits[w];
+            while (bits) {
+                uint8_t id = takeLowestBit(bits, w);
+                if (pollDriverChannel(id)) {
+                    driverTriggered[w] |= bitOf(id);
+                }
+            }
+        }
+        
+        // Thresholds and trigger edges, a word of channels at a time
+        uint32_t edges[WORDS] = {};
+        uint32_t heldBits[WORDS] = {};
+        for (uint8_t w = 0; w < words; w++) {
+            const float* wordValues = &values[w * 32];
+            const float* wordThresholds = &thresholds[w * 32];
+            uint32_t above = 0;
+            for (uint8_t b = 0; b < 32; b++) {
+                above |= static_cast<uint32_t>(wordValues[b] > wordThresholds[b]) << b;
+            }
+            above &= analogBits[w];
+            
+            // Piezo hits come from the onset detectors, or without scans
+            // re-trigger at most once per debounce interval
+            uint32_t piezoTriggered = onsetBits[w];
+            uint32_t piezoAbove = scanning ? 0 : above & piezoBits[w];
+            while (piezoAbove) {
+                uint8_t id = takeLowestBit(piezoAbove, w);
+                if (now - lastTriggerMs[id] > PiezoDriver::DEFAULT_DEBOUNCE_MS) {
+                    lastTriggerMs[id] = now;
+                    hits[id] = {micros(), values[id]};
+                    piezoTriggered |= bitOf(id);
+                }
+            }
+            
+            uint32_t digitalActive = DigitalScanner::getStateBits()[w] & digitalBits[w];
+            uint32_t triggered = (above & levelBits[w]) | piezoTriggered | driverTriggered[w] | digitalActive;
+            changed += __builtin_popcount(triggered ^ triggerBits[w]);
+            edges[w] = triggered & ~triggerBits[w];
+            triggerBits[w] = triggered;
+            heldBits[w] = above | triggered | onsetBits[w];
+        }
+        
+        // Next tick's thresholds follow the noise floor of the channels at rest
+        noiseFloors.update(counts, heldBits, scales, thresholds, end);
+        publishSnapshot();
+        
+        // Fan out trigger edges to instruments, AI and network
+        for (uint8_t w = 0; w < words; w++) {
+            while (edges[w]) {
+                publishTrigger(takeLowestBit(edges[w], w));
+            }
         }
         
         xSemaphoreGive(RTOS::sensorMutex);
     }
+    return changed;
 }
 
 void SensorManager::calibrate() {
-    Logger::info("Calibrating sensors...");
-    
-    // Calibrate MPU6050
-    MPU6050Driver::calibrate();
-    
-    // Calibrate other sensors
-    for (uint8_t i = 0; i < sensorCount; i++) {
-        switch (sensors[i].type) {
-            case SensorType::PIEZO:
-                PiezoDriver::calibrate(sensors[i].id);
-                break;
-            case SensorType::PRESSURE:
-                PressureDriver::calibrate(sensors[i].id);
-                break;
-            case SensorType::FLEX:
-                FlexDriver::calibrate(sensors[i].id);
-                break;
-            default:
-                break;
-        }
+    SensorLock lock;
+    // Covers every channel and IMU, drift checks included
+    memset(driftBits, 0, sizeof(driftBits));
+    driftImus = 0;
+    CalibrationEngine::start(analogBits, registeredImus(), millis());
+    Logger::info("Calibrating sensors in the background...");
+}
+
+bool SensorManager::isCalibrating() {
+    return CalibrationEngine::isRunning();
+}
+
+void SensorManager::saveCalibration() {
+    if (profilesDirty.exchange(false) && !ConfigManager::save()) {
+        profilesDirty = true;
     }
-    
-    Logger::info("Sensor calibration complete");
 }
 
 bool SensorManager::registerSensor(SensorType type, uint8_t id, uint8_t gpio) {
-    if (sensorCount >= MAX_SENSORS) {
-        Logger::error("Maximum sensor count reached");
-        return false;
-    }
-    
+    SensorLock lock;
     if (id >= MAX_SENSORS) {
         Logger::error("Invalid sensor ID");
         return false;
     }
     
-    sensors[sensorCount].type = type;
-    sensors[sensorCount].id = id;
-    sensors[sensorCount].value = 0.0f;
-    sensors[sensorCount].velocity = 0.0f;
-    sensors[sensorCount].timestamp = millis();
-    sensors[sensorCount].triggered = false;
+    if (isRegistered(id)) {
+        Logger::error("Sensor %d already registered", id);
+        return false;
+    }
     
     // Initialize sensor driver based on type
     bool success = false;
     switch (type) {
         case SensorType::MPU6050:
-            success = MPU6050Driver::init();
+            // The pin field selects the IMU
+            if (gpio >= MAX_IMUS) {
+                Logger::error("Invalid IMU %d for sensor %d", gpio, id);
+                return false;
+            }
+            success = MPU6050Driver::get(gpio).init();
+            if (success) {
+                loadImuProfile(gpio);
+            }
+            break;
+        case SensorType::IR:
+            // Beam changes wake the sensor task instead of waiting for its next poll
+            pinMode(gpio, INPUT_PULLUP);
+            success = DigitalScanner::addChannel(id, gpio, true);
+            if (success) {
+                attachInterrupt(digitalPinToInterrupt(gpio), RTOS::wakeSensorTaskFromISR, CHANGE);
+            }
             break;
         case SensorType::PIEZO:
-            success = PiezoDriver::initSensor(id, gpio);
+        case SensorType::PRESSURE:
+        case SensorType::FLEX:
+            pinMode(gpio, INPUT);
+            success = AdcEngine::addChannel(id, gpio);
             break;
-        case SensorType::IR:
-            success = IRDriver::initSensor(id, gpio);
+    }
+    if (!success) {
+        return false;
+    }
+    
+    uint8_t w = id / 32;
+    filters.clear(id);
+    noiseFloors.clear(id);
+    types[id] = type;
+    gpios[id] = gpio;
+    counts[id] = 0.0f;
+    scales[id] = 0.0f;
+    offsets[id] = 0.0f;
+    values[id] = 0.0f;
+    velocities[id] = 0.0f;
+    thresholds[id] = 0.0f;
+    timestamps[id] = millis();
+    lastTriggerMs[id] = 0;
+    switch (type) {
+        case SensorType::PIEZO:
+            scales[id] = PiezoDriver::MILLIVOLTS_PER_COUNT;
+            thresholds[id] = PiezoDriver::DEFAULT_THRESHOLD_MV;
+            onsets[id].init(PiezoDriver::PEAK_HOLD_US, PiezoDriver::DEFAULT_RETRIGGER_MASK_US);
+            piezoBits[w] |= bitOf(id);
             break;
         case SensorType::PRESSURE:
-            success = PressureDriver::initSensor(id, gpio);
+            scales[id] = PressureDriver::VOLTS_PER_COUNT;
+            thresholds[id] = PressureDriver::DEFAULT_THRESHOLD_V;
+            levelBits[w] |= bitOf(id);
             break;
         case SensorType::FLEX:
-            success = FlexDriver::initSensor(id, gpio);
+            scales[id] = FlexDriver::FULL_SCALE_PER_COUNT;
+            thresholds[id] = FlexDriver::DEFAULT_THRESHOLD;
+            levelBits[w] |= bitOf(id);
+            break;
+        case SensorType::IR:
+            scales[id] = 1.0f;
+            counts[id] = (DigitalScanner::getStateBits()[w] & bitOf(id)) ? 1.0f : 0.0f;
+            digitalBits[w] |= bitOf(id);
+            break;
+        default:
+            driverBits[w] |= bitOf(id);
             break;
     }
-    
-    if (success) {
-        sensorCount++;
-        Logger::info("Sensor %d registered (type: %d, GPIO: %d)", id, static_cast<int>(type), gpio);
+    if (type == SensorType::PIEZO || type == SensorType::PRESSURE || type == SensorType::FLEX) {
+        analogBits[w] |= bitOf(id);
+        loadProfile(id);
+    }
+    registeredBits[w] |= bitOf(id);
+    triggerBits[w] &= ~bitOf(id);
+    sensorCount++;
+    if (id >= channelEnd) {
+        channelEnd = id + 1;
     }
+    publishSnapshot();
     
-    return success;
+    Logger::info("Sensor %d registered (type: %d, GPIO: %d)", id, static_cast<int>(type), gpio);
+    return true;
 }
 
 bool SensorManager::unregisterSensor(uint8_t id) {
-    for (uint8_t i = 0; i < sensorCount; i++) {
-        if (sensors[i].id == id) {
-            // Shift remaining sensors
-            for (uint8_t j = i; j < sensorCount - 1; j++) {
-                sensors[j] = sensors[j + 1];
-            }
-            sensorCount--;
-            Logger::info("Sensor %d unregistered", id);
-            return true;
-        }
+    SensorLock lock;
+    if (!isRegistered(id)) {
+        return false;
+    }
+    
+    if (analogBits[id / 32] & bitOf(id)) {
+        AdcEngine::removeChannel(id);
+    }
+    if (digitalBits[id / 32] & bitOf(id)) {
+        detachInterrupt(digitalPinToInterrupt(gpios[id]));
+        DigitalScanner::removeChannel(id);
     }
-    return false;
+    uint8_t w = id / 32;
+    uint32_t mask = ~bitOf(id);
+    registeredBits[w] &= mask;
+    analogBits[w] &= mask;
+    levelBits[w] &= mask;
+    piezoBits[w] &= mask;
+    driverBits[w] &= mask;
+    digitalBits[w] &= mask;
+    triggerBits[w] &= mask;
+    driftBits[w] &= mask;
+    
+    // Keep the conversion pass producing zeros for the free slot
+    counts[id] = 0.0f;
+    scales[id] = 0.0f;
+    offsets[id] = 0.0f;
+    values[id] = 0.0f;
+    filters.clear(id);
+    noiseFloors.clear(id);
+    sensorCount--;
+    while (channelEnd > 0 && !isRegistered(channelEnd - 1)) {
+        channelEnd--;
+    }
+    publishSnapshot();
+    
+    Logger::info("Sensor %d unregistered", id);
+    return true;
 }
 
 SensorData SensorManager::getSensorData(uint8_t id) {
-    for (uint8_t i = 0; i < sensorCount; i++) {
-        if (sensors[i].id == id) {
-            return sensors[i];
-        }
+    if (id >= MAX_SENSORS) {
+        return emptySensorData();
     }
+    uint8_t w = id / 32;
     
-    SensorData empty;
-    empty.type = SensorType::MPU6050;
-    empty.id = 255;
-    empty.value = 0.0f;
-    empty.velocity = 0.0f;
-    empty.timestamp = 0;
-    empty.triggered = false;
-    return empty;
+    // Sequence-checked copy: retry if update() was publishing meanwhile
+    while (true) {
+        uint32_t before = snapshotVersion.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        bool registered = snapshot.registeredBits[w] & bitOf(id);
+        SensorData data;
+        data.type = snapshot.types[id];
+        data.id = id;
+        data.value = snapshot.values[id];
+        data.velocity = snapshot.velocities[id];
+        data.timestamp = snapshot.timestamps[id];
+        data.triggered = snapshot.triggerBits[w] & bitOf(id);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshotVersion.load(std::memory_order_relaxed) == before) {
+            return registered ? data : emptySensorData();
+        }
+    }
 }
 
 bool SensorManager::isSensorTriggered(uint8_t id) {
@@ -157,87 +564,292 @@ bool SensorManager::isSensorTriggered(uint8_t id) {
     return data.triggered;
 }
 
+uint8_t SensorManager::getAllSensorData(SensorData* out, uint8_t maxCount) {
+    uint8_t count = 0;
+    for (uint8_t id = 0; id < MAX_SENSORS && count < maxCount; id++) {
+        SensorData data = getSensorData(id);
+        if (data.id == id) {
+            out[count++] = data;
+        }
+    }
+    return count;
+}
+
+uint32_t SensorManager::getSnapshotVersion() {
+    return snapshotVersion.load(std::memory_order_acquire);
+}
+
 void SensorManager::setThreshold(uint8_t id, float threshold) {
-    for (uint8_t i = 0; i < sensorCount; i++) {
-        if (sensors[i].id == id) {
-            // Threshold stored per sensor type driver
-            switch (sensors[i].type) {
-                case SensorType::PIEZO:
-                    PiezoDriver::setThreshold(id, threshold);
-                    break;
-                case SensorType::IR:
-                    IRDriver::setThreshold(id, threshold);
-                    break;
-                case SensorType::PRESSURE:
-                    PressureDriver::setThreshold(id, threshold);
-                    break;
-                case SensorType::FLEX:
-                    FlexDriver::setThreshold(id, threshold);
-                    break;
-                default:
-                    break;
-            }
+    SensorLock lock;
+    if (!isRegistered(id)) {
+        return;
+    }
+    
+    switch (types[id]) {
+        case SensorType::IR:
+            // Non-zero: the beam is broken while the pin is LOW
+            DigitalScanner::setActiveLow(id, threshold != 0.0f);
+            break;
+        case SensorType::PIEZO:
+        case SensorType::PRESSURE:
+        case SensorType::FLEX:
+            noiseFloors.clear(id);
+            thresholds[id] = threshold;
+            break;
+        default:
             break;
-        }
     }
 }
 
 float SensorManager::getThreshold(uint8_t id) {
-    SensorData data = getSensorData(id);
-    switch (data.type) {
-        case SensorType::PIEZO:
-            return PiezoDriver::getThreshold(id);
+    if (!isRegistered(id)) {
+        return 0.0f;
+    }
+    
+    switch (types[id]) {
         case SensorType::IR:
-            return IRDriver::getThreshold(id);
+            return DigitalScanner::isActiveLow(id) ? 1.0f : 0.0f;
+        case SensorType::PIEZO:
         case SensorType::PRESSURE:
-            return PressureDriver::getThreshold(id);
         case SensorType::FLEX:
-            return FlexDriver::getThreshold(id);
+            return thresholds[id];
         default:
             return 0.0f;
     }
 }
 
+void SensorManager::setRetriggerMask(uint8_t id, uint32_t maskUs) {
+    SensorLock lock;
+    if (!isRegistered(id) || types[id] != SensorType::PIEZO) {
+        return;
+    }
+    onsets[id].setRetriggerMask(maskUs);
+}
+
+bool SensorManager::setFilter(uint8_t id, const FilterConfig& config) {
+    SensorLock lock;
+    if (!isRegistered(id) || !(analogBits[id / 32] & bitOf(id))) {
+        Logger::error("Sensor %d has no analog value to filter", id);
+        return false;
+    }
+    if (!filters.configure(id, config, pollRateHz)) {
+        Logger::error("Invalid filter for sensor %d", id);
+        return false;
+    }
+    return true;
+}
+
 uint8_t SensorManager::getSensorCount() {
     return sensorCount;
 }
 
-SensorData* SensorManager::getAllSensorData() {
-    return sensors;
+bool SensorManager::needsPolling() {
+    for (uint8_t w = 0; w < WORDS; w++) {
+        if (analogBits[w] != 0 || driverBits[w] != 0) {
+            return true;
+        }
+    }
+    // A pin edge is debounced over the next few polls
+    return DigitalScanner::isSettling();
 }
 
-void SensorManager::pollSensor(uint8_t index) {
-    if (index >= sensorCount) {
+uint32_t SensorManager::getIMUSampleCount(uint8_t imu) {
+    return MPU6050Driver::get(imu).getSampleCount();
+}
+
+bool SensorManager::isRegistered(uint8_t id) {
+    return id < MAX_SENSORS && (registeredBits[id / 32] & bitOf(id)) != 0;
+}
+
+void SensorManager::followSchedule() {
+    // Samples arrive once per sensor task period, which the schedule can
+    // change at runtime; filter cutoffs stay the same in Hz and noise
+    // floor time constants in ms
+    uint32_t generation = ScheduleManager::getGeneration();
+    if (generation == scheduleGeneration) {
         return;
     }
+    scheduleGeneration = generation;
+    float rateHz = 1000000.0f / ScheduleManager::getTaskSchedule(TaskId::SENSOR).periodUs;
+    if (rateHz == pollRateHz) {
+        return;
+    }
+    pollRateHz = rateHz;
+    filters.setSampleRate(rateHz);
+    noiseFloors.setSampleRate(rateHz);
+}
+
+uint8_t SensorManager::registeredImus() {
+    // Only these are polled; SensorManager::init() wakes IMU 0 regardless
+    uint8_t imus = 0;
+    for (uint8_t w = 0; w < WORDS; w++) {
+        uint32_t bits = driverBits[w];
+        while (bits) {
+            uint8_t id = takeLowestBit(bits, w);
+            if (types[id] == SensorType::MPU6050) {
+                imus |= 1 << gpios[id];
+            }
+        }
+    }
+    return imus;
+}
+
+bool SensorManager::pollDriverChannel(uint8_t id) {
+    TRACE_SCOPE("SensorManager::pollDriverChannel");
     
-    SensorData& sensor = sensors[index];
-    sensor.timestamp = millis();
-    
-    switch (sensor.type) {
-        case SensorType::MPU6050:
-            sensor.value = MPU6050Driver::readAccel();
-            sensor.velocity = MPU6050Driver::readGyro();
-            break;
+    switch (types[id]) {
+        case SensorType::MPU6050: {
+            MPU6050Data data = MPU6050Driver::get(gpios[id]).readAll();
+            values[id] = sqrtf(data.accelX * data.accelX + data.accelY * data.accelY + data.accelZ * data.accelZ);
+            velocities[id] = sqrtf(data.gyroX * data.gyroX + data.gyroY * data.gyroY + data.gyroZ * data.gyroZ);
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+void SensorManager::applyCalibration(const uint32_t* doneBits) {
+    for (uint8_t w = 0; w < WORDS; w++) {
+        uint32_t bits = doneBits[w] & analogBits[w];
+        while (bits) {
+            uint8_t id = takeLowestBit(bits, w);
+            applyChannelCalibration(id, CalibrationEngine::getChannel(id));
+        }
+    }
+}
+
+void SensorManager::applyChannelCalibration(uint8_t id, const ChannelCalibration& calibration) {
+    // Thresholds sit above the baseline by the margin or the resting noise,
+    // whichever is larger, and track both from here on; flex readings are
+    // measured from the baseline, which is a position rather than a floor
+    float baseline = calibration.baseline * scales[id];
+    float noise = CALIBRATION_NOISE_SIGMAS * calibration.noise * scales[id];
+    switch (types[id]) {
         case SensorType::PIEZO:
-            sensor.value = PiezoDriver::read(sensor.id);
-            sensor.velocity = PiezoDriver::getVelocity(sensor.id);
-            sensor.triggered = PiezoDriver::isTriggered(sensor.id);
-            break;
-        case SensorType::IR:
-            sensor.value = IRDriver::read(sensor.id) ? 1.0f : 0.0f;
-            sensor.triggered = IRDriver::isTriggered(sensor.id);
+            thresholds[id] = baseline + fmaxf(PiezoDriver::CALIBRATION_MARGIN_MV, noise);
+            noiseFloors.track(id, calibration.baseline, calibration.noise,
+                              PiezoDriver::CALIBRATION_MARGIN_MV / scales[id]);
             break;
         case SensorType::PRESSURE:
-            sensor.value = PressureDriver::read(sensor.id);
-            sensor.velocity = PressureDriver::getVelocity(sensor.id);
-            sensor.triggered = PressureDriver::isTriggered(sensor.id);
+            thresholds[id] = baseline + fmaxf(PressureDriver::CALIBRATION_MARGIN_V, noise);
+            noiseFloors.track(id, calibration.baseline, calibration.noise,
+                              PressureDriver::CALIBRATION_MARGIN_V / scales[id]);
             break;
         case SensorType::FLEX:
-            sensor.value = FlexDriver::read(sensor.id);
-            sensor.triggered = FlexDriver::isTriggered(sensor.id);
+            offsets[id] = baseline;
             break;
+        default:
+            break;
+    }
+}
+
+void SensorManager::loadProfile(uint8_t id) {
+    // Only a profile from the same sensor on the same pin, at about the
+    // same temperature, says anything about this channel's resting state
+    Core::SensorCalibrationRecord record;
+    if (!ConfigManager::getSensorCalibration(id, record) || record.type != static_cast<uint8_t>(types[id]) ||
+        record.gpio != gpios[id] || fabsf(tempmonGetTemp() - record.temperatureC) > CALIBRATION_PROFILE_MAX_DRIFT_C) {
+        return;
+    }
+    applyChannelCalibration(id, {record.baseline, record.noise});
+    driftBits[id / 32] |= bitOf(id);
+}
+
+void SensorManager::loadImuProfile(uint8_t imu) {
+    Core::ImuCalibrationRecord record;
+    if (!ConfigManager::getImuCalibration(imu, record) ||
+        fabsf(tempmonGetTemp() - record.temperatureC) > CALIBRATION_PROFILE_MAX_DRIFT_C) {
+        return;
+    }
+    ImuCalibration calibration;
+    memcpy(calibration.gyroBias, record.gyroBias, sizeof(calibration.gyroBias));
+    calibration.accelScale = record.accelScale;
+    MPU6050Driver::get(imu).setCalibration(calibration);
+    driftImus |= 1 << imu;
+}
+
+void SensorManager::storeProfiles(const uint32_t* doneBits) {
+    // Profiles are rewritten only when a result moved enough to matter, or
+    // was measured on another sensor, pin or at another temperature; the
+    // store is RAM until saveCalibration()
+    float temperature = tempmonGetTemp();
+    int8_t temperatureC = static_cast<int8_t>(lroundf(temperature));
+    uint8_t channels = 0;
+    for (uint8_t w = 0; w < WORDS; w++) {
+        uint32_t bits = doneBits[w] & analogBits[w];
+        while (bits) {
+            uint8_t id = takeLowestBit(bits, w);
+            ChannelCalibration calibration = CalibrationEngine::getChannel(id);
+            Core::SensorCalibrationRecord saved;
+            if (ConfigManager::getSensorCalibration(id, saved) && saved.type == static_cast<uint8_t>(types[id]) &&
+                saved.gpio == gpios[id] &&
+                fabsf(temperature - saved.temperatureC) <= CALIBRATION_PROFILE_MAX_DRIFT_C / 2.0f &&
+                fabsf(calibration.baseline - saved.baseline) <= CALIBRATION_PROFILE_SAVE_COUNTS &&
+                fabsf(calibration.noise - saved.noise) <= CALIBRATION_PROFILE_SAVE_COUNTS) {
+                continue;
+            }
+            ConfigManager::setSensorCalibration(id, {static_cast<uint8_t>(types[id]), gpios[id], temperatureC,
+                                                     calibration.baseline, calibration.noise});
+            channels++;
+        }
+    }
+    
+    uint8_t imus = 0;
+    uint8_t calibrated = CalibrationEngine::getCalibratedImus();
+    for (uint8_t imu = 0; imu < MAX_IMUS; imu++) {
+        if (!(calibrated & (1 << imu))) {
+            continue;
+        }
+        ImuCalibration calibration = MPU6050Driver::get(imu).getCalibration();
+        Core::ImuCalibrationRecord saved;
+        bool current = ConfigManager::getImuCalibration(imu, saved) &&
+                       fabsf(temperature - saved.temperatureC) <= CALIBRATION_PROFILE_MAX_DRIFT_C / 2.0f;
+        for (uint8_t axis = 0; axis < 3 && current; axis++) {
+            current = fabsf(calibration.gyroBias[axis] - saved.gyroBias[axis]) <= CALIBRATION_PROFILE_SAVE_DPS;
+        }
+        // An accel scale off by 0.1% is a milli-g at rest
+        if (current && fabsf(calibration.accelScale - saved.accelScale) <= 0.001f) {
+            continue;
+        }
+        Core::ImuCalibrationRecord record;
+        record.temperatureC = temperatureC;
+        memcpy(record.gyroBias, calibration.gyroBias, sizeof(record.gyroBias));
+        record.accelScale = calibration.accelScale;
+        ConfigManager::setImuCalibration(imu, record);
+        imus++;
     }
+    
+    if (channels > 0 || imus > 0) {
+        profilesDirty = true;
+        Logger::info("Calibration profiles updated (%d channels, %d IMUs)", channels, imus);
+    }
+}
+
+void SensorManager::publishSnapshot() {
+    // Readers never take sensorMutex, so the copy is made inside a critical
+    // section to keep them from spinning on a preempted writer
+    uint8_t end = channelEnd;
+    taskENTER_CRITICAL();
+    snapshotVersion.fetch_add(1, std::memory_order_acq_rel);
+    memcpy(snapshot.values, values, end * sizeof(float));
+    memcpy(snapshot.velocities, velocities, end * sizeof(float));
+    memcpy(snapshot.timestamps, timestamps, end * sizeof(uint32_t));
+    memcpy(snapshot.types, types, end * sizeof(SensorType));
+    memcpy(snapshot.registeredBits, registeredBits, sizeof(registeredBits));
+    memcpy(snapshot.triggerBits, triggerBits, sizeof(triggerBits));
+    snapshotVersion.fetch_add(1, std::memory_order_release);
+    taskEXIT_CRITICAL();
+}
+
+void SensorManager::publishTrigger(uint8_t id) {
+    Event event;
+    event.type = EventType::SENSOR_TRIGGERED;
+    event.timestamp = micros();
+    event.sourceId = id;
+    uint32_t onset = types[id] == SensorType::PIEZO ? hits[id].onsetMicros : event.timestamp;
+    event.setPayload(SensorTriggerPayload{types[id], values[id], velocities[id], onset});
+    EventQueue::publish(event);
 }
 
 } // namespace Sensors
@@ -2,11 +2,17 @@
 #define BITS_SENSORS_SENSOR_MANAGER_H
 
 #include <stdint.h>
+#include <atomic>
+#include "config.h"
+#include "sensors/onset_detector.h"
+#include "sensors/filter_bank.h"
+#include "sensors/calibration_engine.h"
+#include "sensors/noise_floor_tracker.h"
 
 namespace BITS {
 namespace Sensors {
 
-enum class SensorType {
+enum class SensorType : uint8_t {
     MPU6050 = 0,
     PIEZO = 1,
     IR = 2,
@@ -23,30 +29,120 @@ struct SensorData {
     bool triggered;
 };
 
+// Payload of Core::EventType::SENSOR_TRIGGERED events (sourceId = sensor id)
+struct SensorTriggerPayload {
+    SensorType type;
+    float value;
+    float velocity;
+    uint32_t onsetMicros;   // Piezo hit onset; the poll time for other sensors
+};
+
 class SensorManager {
 public:
     static void init();
-    static void update();
+    // Polls every sensor; returns the number whose trigger state changed
+    static uint8_t update();
+    // Returns at once: the sensor task learns every analog channel's resting
+    // baseline and noise, and each IMU's bias, from its own readings and
+    // applies them together when done
     static void calibrate();
+    static bool isCalibrating();
+    // Calibration results are also kept as profiles in the config store, and
+    // a channel or IMU registered with a matching profile starts from it at
+    // once, checked for drift in the background. This writes profiles that
+    // changed to EEPROM; it is called from the calibration timer, off the
+    // sensor task.
+    static void saveCalibration();
     
+    // For an MPU6050 channel, gpio is the IMU (below MAX_IMUS) instead of a pin
     static bool registerSensor(SensorType type, uint8_t id, uint8_t gpio);
     static bool unregisterSensor(uint8_t id);
+    
+    // Readers get the last published reading by id without taking
+    // sensorMutex; a copy is never torn by a concurrent update()
     static SensorData getSensorData(uint8_t id);
     static bool isSensorTriggered(uint8_t id);
+    // Copies the published reading of every registered sensor; returns the count
+    static uint8_t getAllSensorData(SensorData* out, uint8_t maxCount);
+    // Changes after every update() pass, to skip work when nothing was polled
+    static uint32_t getSnapshotVersion();
     
+    // Piezo and pressure thresholds follow the channel's noise floor once
+    // calibrated; setting one fixes it until the next calibration
     static void setThreshold(uint8_t id, float threshold);
     static float getThreshold(uint8_t id);
+    // Piezo channels: how long after a hit ringing cannot retrigger it
+    static void setRetriggerMask(uint8_t id, uint32_t maskUs);
+    // Smoothing of an analog channel's value, applied every poll; none by default
+    static bool setFilter(uint8_t id, const FilterConfig& config);
     
     static uint8_t getSensorCount();
-    static SensorData* getAllSensorData();
+    // False when every sensor reports changes through pin interrupts
+    static bool needsPolling();
+    // New samples read so far from one IMU, for windowing
+    static uint32_t getIMUSampleCount(uint8_t imu = 0);
 
 private:
-    static constexpr uint8_t MAX_SENSORS = 16;
-    static SensorData sensors[MAX_SENSORS];
+    static constexpr uint8_t WORDS = MAX_SENSORS / 32;  // Per-channel bit sets
+    
+    // Channel table as structure-of-arrays indexed by sensor id. Owned by
+    // the poller; (un)registering takes sensorMutex.
+    static SensorType types[MAX_SENSORS];
+    static uint8_t gpios[MAX_SENSORS];
+    static float counts[MAX_SENSORS];       // Latest ADC reading of analog channels
+    static float scales[MAX_SENSORS];       // Counts to driver units
+    static float offsets[MAX_SENSORS];      // Baseline subtracted after scaling
+    static float values[MAX_SENSORS];
+    static float velocities[MAX_SENSORS];
+    static float thresholds[MAX_SENSORS];
+    static uint32_t timestamps[MAX_SENSORS];
+    static uint32_t lastTriggerMs[MAX_SENSORS];
+    static OnsetDetector onsets[MAX_SENSORS];       // Piezo channels, fed by ADC engine scans
+    static OnsetDetector::Hit hits[MAX_SENSORS];    // Last piezo hit
+    static FilterBank filters;              // Per-channel smoothing, run in the conversion pass
+    static NoiseFloorTracker noiseFloors;   // Adaptive piezo and pressure thresholds
+    static uint32_t registeredBits[WORDS];
+    static uint32_t analogBits[WORDS];      // Piezo, pressure and flex
+    static uint32_t levelBits[WORDS];       // Triggered while above threshold (pressure, flex)
+    static uint32_t piezoBits[WORDS];       // Triggered once per debounce interval
+    static uint32_t driverBits[WORDS];      // Polled through their driver (IMU)
+    static uint32_t digitalBits[WORDS];     // Read and debounced by DigitalScanner (IR)
+    static uint32_t triggerBits[WORDS];
+    static uint32_t driftBits[WORDS];       // Started from a profile, not yet checked
+    static uint8_t driftImus;               // One bit per IMU
+    static std::atomic<bool> profilesDirty; // Set in the store, not yet saved
+    static uint8_t channelEnd;              // One past the highest registered id
+    static uint32_t lastScan;               // ADC engine scans consumed so far
+    static uint32_t scheduleGeneration;     // Schedule the poll rate was taken from
+    static float pollRateHz;                // The sensor task's, from its scheduled period
     static uint8_t sensorCount;
+    
+    // Readers' copy, published after every poll. The version is odd while
+    // it is being written.
+    struct Snapshot {
+        float values[MAX_SENSORS];
+        float velocities[MAX_SENSORS];
+        uint32_t timestamps[MAX_SENSORS];
+        SensorType types[MAX_SENSORS];
+        uint32_t registeredBits[WORDS];
+        uint32_t triggerBits[WORDS];
+    };
+    static Snapshot snapshot;
+    static std::atomic<uint32_t> snapshotVersion;
+    
     static bool initialized;
     
-    static void pollSensor(uint8_t id);
+    static bool isRegistered(uint8_t id);
+    static void followSchedule();           // Rate-dependent coefficients track the sensor period
+    static uint8_t registeredImus();        // One bit per IMU with a channel
+    static bool pollDriverChannel(uint8_t id);  // True if triggered
+    static void applyCalibration(const uint32_t* doneBits);
+    static void applyChannelCalibration(uint8_t id, const ChannelCalibration& calibration);
+    static void loadProfile(uint8_t id);
+    static void loadImuProfile(uint8_t imu);
+    static void storeProfiles(const uint32_t* doneBits);
+    static void publishSnapshot();
+    static void publishTrigger(uint8_t id);
 };
 
 } // namespace Sensors
@@ -58,6 +58,15 @@ void testTempoDetector() {
     
     float tempo = TempoDetector::getCurrentTempo();
     Logger::info("Detected tempo: %.1f BPM", tempo);
+    
+    // Beats either side of the 32-bit micros() wrap
+    TempoDetector::reset();
+    uint32_t beat = 0xFFFFFFFFUL - 700000UL;
+    for (int i = 0; i < 4; i++) {
+        TempoDetector::recordBeat(beat);
+        beat += 500000UL; // 120 BPM
+    }
+    Logger::info("Tempo across the micros() wrap: %.1f BPM", TempoDetector::getCurrentTempo());
     Logger::info("Tempo Detector test passed");
 }
 
@@ -16,19 +16,20 @@ using namespace BITS::Core;
 void testMPU6050() {
     Logger::info("Testing MPU6050...");
     
-    if (!MPU6050Driver::init()) {
+    MPU6050Driver& imu = MPU6050Driver::get(0);
+    if (!imu.init()) {
         Logger::error("MPU6050 initialization failed");
         return;
     }
     
     delay(100);
     
-    if (!MPU6050Driver::isConnected()) {
+    if (!imu.isConnected()) {
         Logger::error("MPU6050 not connected");
         return;
     }
     
-    MPU6050Data data = MPU6050Driver::readAll();
+    MPU6050Data data = imu.readAll();
     Logger::info("MPU6050 data: Accel(%.2f, %.2f, %.2f) Gyro(%.2f, %.2f, %.2f)",
                 data.accelX, data.accelY, data.accelZ,
                 data.gyroX, data.gyroY, data.gyroZ);
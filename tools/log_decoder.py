@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+B.I.T.E.S Log Decoder
+Turns binary logger output (Logger::setOutput(LogOutput::BINARY)) back into
+text lines. Bytes outside binary frames are passed through unchanged, so a
+capture that mixes boot text and binary frames decodes in one pass.
+"""
+
+import re
+import struct
+import sys
+
+SYNC = b'\x00\xb5'
+FRAME_DICTIONARY = 0x01
+FRAME_RECORD = 0x02
+FRAME_DROPS = 0x03
+
+LEVELS = {0: "DEBUG", 1: "INFO", 2: "WARN", 3: "ERROR"}
+
+ARG_INT = 0
+ARG_UINT = 1
+ARG_INT64 = 2
+ARG_UINT64 = 3
+ARG_FLOAT = 4
+ARG_STRING = 5
+ARG_POINTER = 6
+
+SPEC = re.compile(r'%([-+ #0-9.]*)(?:hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGcsp%])')
+
+def format_message(fmt, args):
+    """Apply a C format string to decoded arguments"""
+    values = iter(args)
+
+    def replace(match):
+        flags, conversion = match.group(1), match.group(2)
+        if conversion == '%':
+            return '%'
+        try:
+            value = next(values)
+        except StopIteration:
+            return '<?>'
+        if conversion == 'p':
+            return '0x%x' % value
+        if conversion in 'iu':
+            conversion = 'd'
+        if conversion == 'c':
+            value = chr(value & 0xFF)
+        return ('%' + flags + conversion) % value
+
+    return SPEC.sub(replace, fmt)
+
+def read_args(data, pos, argc, types):
+    """Decode argc arguments starting at pos; returns (args, new position)"""
+    args = []
+    for i in range(argc):
+        arg_type = (types >> (i * 4)) & 0x0F
+        if arg_type == ARG_STRING:
+            length = data[pos]
+            args.append(data[pos + 1:pos + 1 + length].decode('utf-8', 'replace'))
+            pos += 1 + length
+        elif arg_type in (ARG_INT64, ARG_UINT64):
+            code = '<q' if arg_type == ARG_INT64 else '<Q'
+            args.append(struct.unpack_from(code, data, pos)[0])
+            pos += 8
+        else:
+            code = {ARG_INT: '<i', ARG_FLOAT: '<f'}.get(arg_type, '<I')
+            args.append(struct.unpack_from(code, data, pos)[0])
+            pos += 4
+    return args, pos
+
+def decode(data, out):
+    """Decode a byte string, writing text lines to out"""
+    formats = {}
+    pos = 0
+    while pos < len(data):
+        start = data.find(SYNC, pos)
+        if start < 0:
+            out.write(data[pos:].decode('utf-8', 'replace'))
+            break
+        out.write(data[pos:start].decode('utf-8', 'replace'))
+        pos = start + 2
+        if pos >= len(data):
+            break
+
+        frame_type = data[pos]
+        pos += 1
+        try:
+            if frame_type == FRAME_DICTIONARY:
+                format_id, length = struct.unpack_from('<IH', data, pos)
+                pos += 6
+                formats[format_id] = data[pos:pos + length].decode('utf-8', 'replace')
+                pos += length
+            elif frame_type == FRAME_RECORD:
+                format_id, timestamp, level, argc, types = struct.unpack_from('<IIBBI', data, pos)
+                pos += 14
+                args, pos = read_args(data, pos, argc, types)
+                fmt = formats.get(format_id)
+                if fmt is None:
+                    message = 'unknown format 0x%08x %r' % (format_id, args)
+                else:
+                    message = format_message(fmt, args)
+                out.write('[%s] %dms: %s\n' % (LEVELS.get(level, 'UNKNOWN'), timestamp, message))
+            elif frame_type == FRAME_DROPS:
+                count = struct.unpack_from('<I', data, pos)[0]
+                pos += 4
+                out.write('[WARN] %d log messages dropped\n' % count)
+            else:
+                # Not a frame after all
+                out.write(data[start:pos].decode('utf-8', 'replace'))
+        except (struct.error, IndexError):
+            print("Error: truncated frame at offset %d" % start, file=sys.stderr)
+            break
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: log_decoder.py <capture_file>   (use - for stdin)")
+        sys.exit(1)
+
+    if sys.argv[1] == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[1], 'rb') as capture:
+            data = capture.read()
+
+    decode(data, sys.stdout)
+
+if __name__ == "__main__":
+    main()
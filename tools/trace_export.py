@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+B.I.T.E.S Trace Exporter
+Converts a serial capture containing a trace dump ("trace" command, or
+bench_trace --out) to Chrome trace JSON, viewable in chrome://tracing or
+ui.perfetto.dev. Lines that are not part of the dump are ignored.
+"""
+
+import json
+import sys
+
+def parse_dump(lines):
+    """Returns (cpu_mhz, track names, events) from #TRACE lines"""
+    cpu_mhz = 600
+    tracks = {}
+    events = []
+    for line in lines:
+        line = line.strip()
+        if not line.startswith('#TRACE '):
+            continue
+        fields = line.split(' ', 5)
+        kind = fields[1]
+        if kind == 'BEGIN':
+            cpu_mhz = int(fields[2])
+            # A later dump in the same capture replaces an earlier one
+            tracks = {}
+            events = []
+        elif kind == 'TRACK':
+            tracks[int(fields[2])] = fields[3]
+        elif kind == 'X' and len(fields) == 6:
+            events.append((int(fields[2]), int(fields[3]), int(fields[4]), fields[5]))
+    return cpu_mhz, tracks, events
+
+def to_chrome_trace(cpu_mhz, tracks, events):
+    """Build the trace dict; times are cycles before the dump, shifted so the
+    oldest event starts at 0"""
+    oldest = max((age for _, age, _, _ in events), default=0)
+    trace_events = []
+    for track, name in sorted(tracks.items()):
+        trace_events.append({
+            "name": "thread_name", "ph": "M", "pid": 1, "tid": track,
+            "args": {"name": name}
+        })
+        trace_events.append({
+            "name": "thread_sort_index", "ph": "M", "pid": 1, "tid": track,
+            "args": {"sort_index": track}
+        })
+    for track, age, duration, name in events:
+        trace_events.append({
+            "name": name,
+            "ph": "X",
+            "pid": 1,
+            "tid": track,
+            "ts": (oldest - age) / cpu_mhz,
+            "dur": duration / cpu_mhz
+        })
+    return {"traceEvents": trace_events, "displayTimeUnit": "ns"}
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: trace_export.py <capture_file> [output.json]   (use - for stdin)")
+        sys.exit(1)
+
+    if sys.argv[1] == '-':
+        lines = sys.stdin.readlines()
+    else:
+        with open(sys.argv[1], 'r', errors='replace') as capture:
+            lines = capture.readlines()
+
+    cpu_mhz, tracks, events = parse_dump(lines)
+    if not events:
+        print("Error: no trace events found")
+        sys.exit(1)
+
+    output = json.dumps(to_chrome_trace(cpu_mhz, tracks, events))
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as out:
+            out.write(output)
+        print(f"Wrote {len(events)} events on {len(tracks)} tracks to {sys.argv[2]}")
+    else:
+        print(output)
+
+if __name__ == "__main__":
+    main()